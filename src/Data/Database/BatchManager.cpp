@@ -5,10 +5,27 @@
 #include <QDir>
 #include <QDebug>
 #include <QStandardPaths>
+#include <QPointer>
+#include <QRunnable>
+#include <QThreadPool>
 #include "../Models/WorkpieceData.h"
+#include "../STEP/WorkpieceFeatureExtractor.h"
+#include "DatabaseManager.h"
 
 namespace Data {
 
+namespace {
+
+// 特征长度单位为mm，批次统计使用m²/m³
+const double kSquareMillimetersToSquareMeters = 1.0e-6;
+const double kCubicMillimetersToCubicMeters = 1.0e-9;
+
+// 没有几何数据时的估算值
+const double kDefaultWorkpieceVolume = 0.1;        // m³
+const double kDefaultWorkpieceSurfaceArea = 2.0;   // m²
+
+} // namespace
+
 BatchManager::BatchManager(QObject* parent)
     : QObject(parent)
 {
@@ -104,6 +121,9 @@ bool BatchManager::addWorkpieceToBatch(const QString& batchId, const QString& wo
         if (batch.batchId == batchId) {
             if (!batch.workpieceIds.contains(workpieceId)) {
                 batch.workpieceIds.append(workpieceId);
+                if (!m_workpieceFeatures.contains(workpieceId)) {
+                    calculateWorkpieceFeatures(workpieceId);
+                }
                 updateBatchStatistics(batchId);
                 
                 qDebug() << "BatchManager: 添加工件" << workpieceId << "到批次" << batchId;
@@ -267,12 +287,21 @@ double BatchManager::calculateSpaceUtilization(const QString& batchId) const
         return 0.0;
     }
     
-    // 简化的空间利用率计算
-    // 实际实现中需要考虑工件的实际几何形状和布局
-    double totalVolume = batch.totalVolume;
-    double availableSpace = 10000000.0; // 假设可用空间 10m³
+    // 工件占用空间按有向包围盒计算，没有几何特征的工件使用估算体积
+    // 实际布局还需考虑工件间距和挂具
+    double occupiedVolume = 0.0;
+    for (const QString& workpieceId : batch.workpieceIds) {
+        auto it = m_workpieceFeatures.constFind(workpieceId);
+        if (it != m_workpieceFeatures.constEnd() && it->valid) {
+            occupiedVolume += it->obbSize.x() * it->obbSize.y() * it->obbSize.z() *
+                              kCubicMillimetersToCubicMeters;
+        } else {
+            occupiedVolume += kDefaultWorkpieceVolume;
+        }
+    }
+    double availableSpace = 10.0; // 假设可用空间 10m³
     
-    double utilization = totalVolume / availableSpace;
+    double utilization = occupiedVolume / availableSpace;
     return qMin(utilization, 1.0); // 最大100%
 }
 
@@ -283,13 +312,26 @@ double BatchManager::estimateBatchProcessingTime(const QString& batchId) const
         return 0.0;
     }
     
-    // 简化的时间估算
-    // 实际实现中需要考虑工件复杂度、喷涂参数等
-    double baseTimePerWorkpiece = 30.0; // 基础时间30分钟/工件
+    // 喷涂时间按表面积和复杂度估算，没有几何特征的工件使用基础时间
+    // 实际实现中还需要考虑喷涂参数等
+    double baseTimePerWorkpiece = 30.0; // 基础时间30分钟/工件（按典型表面积2m²）
     double setupTime = 15.0; // 设置时间15分钟
     double cleanupTime = 10.0; // 清理时间10分钟
     
-    double totalTime = setupTime + (batch.workpieceIds.size() * baseTimePerWorkpiece) + cleanupTime;
+    double sprayTime = 0.0;
+    for (const QString& workpieceId : batch.workpieceIds) {
+        auto it = m_workpieceFeatures.constFind(workpieceId);
+        if (it != m_workpieceFeatures.constEnd() && it->valid) {
+            double areaRatio = it->surfaceArea * kSquareMillimetersToSquareMeters / kDefaultWorkpieceSurfaceArea;
+            // 复杂度0.5时与基础时间一致，曲面和凹区域越多喷枪姿态调整越多；没有曲率数据时按中等复杂度
+            double complexity = it->curvatureHistogram.isEmpty() ? 0.5 : it->complexityScore();
+            sprayTime += baseTimePerWorkpiece * areaRatio * (0.75 + 0.5 * complexity);
+        } else {
+            sprayTime += baseTimePerWorkpiece;
+        }
+    }
+    
+    double totalTime = setupTime + sprayTime + cleanupTime;
     
     return totalTime;
 }
@@ -390,16 +432,155 @@ QString BatchManager::generateUniqueId() const
     return QUuid::createUuid().toString(QUuid::WithoutBraces);
 }
 
+void BatchManager::setWorkpieceFeatures(const QString& workpieceId, const WorkpieceGeometryFeatures& features)
+{
+    m_workpieceFeatures[workpieceId] = features;
+    
+    for (const BatchInfo& batch : m_batches) {
+        if (batch.workpieceIds.contains(workpieceId)) {
+            updateBatchStatistics(batch.batchId);
+            emit batchUpdated(batch.batchId);
+        }
+    }
+}
+
+void BatchManager::registerWorkpiece(const QString& workpieceId)
+{
+    // 丢弃旧的登记结果，按数据库中的当前模型文件重新判断
+    m_workpieceFeatures.remove(workpieceId);
+    calculateWorkpieceFeatures(workpieceId);
+    
+    for (const BatchInfo& batch : m_batches) {
+        if (batch.workpieceIds.contains(workpieceId)) {
+            updateBatchStatistics(batch.batchId);
+            emit batchUpdated(batch.batchId);
+        }
+    }
+}
+
+void BatchManager::calculateWorkpieceFeatures(const QString& workpieceId)
+{
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    bool ok = false;
+    int id = workpieceId.toInt(&ok);
+    if (!ok || !dbManager->isConnected(DatabaseManager::SQLite)) {
+        return;
+    }
+    
+    std::unique_ptr<WorkpieceData> workpiece(dbManager->loadWorkpiece(id, DatabaseManager::SQLite));
+    if (!workpiece) {
+        return;
+    }
+    
+    // 缓存的特征与模型文件不一致（或尚未计算）时在后台重新提取，完成前先用现有数据近似
+    const QString sourceKey = WorkpieceFeatureExtractor::sourceKey(workpiece->modelFilePath());
+    if (!sourceKey.isEmpty()
+        && (!workpiece->hasGeometryFeatures() || workpiece->geometryFeatures().sourceKey != sourceKey)) {
+        extractWorkpieceFeatures(workpieceId, workpiece->modelFilePath());
+    }
+    
+    if (workpiece->hasGeometryFeatures()) {
+        m_workpieceFeatures[workpieceId] = workpiece->geometryFeatures();
+        return;
+    }
+    
+    // 没有计算结果时，用录入的尺寸和表面积近似
+    QVector3D dims = workpiece->dimensions();
+    if (dims.x() > 0 && dims.y() > 0 && dims.z() > 0) {
+        WorkpieceGeometryFeatures features;
+        features.valid = true;
+        features.source = "manual";
+        features.obbSize = dims;
+        features.volume = workpiece->getVolume();
+        features.surfaceArea = workpiece->surfaceArea() > 0.0
+            ? workpiece->surfaceArea()
+            : 2.0 * (dims.x() * dims.y() + dims.y() * dims.z() + dims.x() * dims.z());
+        m_workpieceFeatures[workpieceId] = features;
+    }
+}
+
+void BatchManager::extractWorkpieceFeatures(const QString& workpieceId, const QString& modelFilePath)
+{
+    if (m_extractingWorkpieces.contains(workpieceId)) {
+        return;
+    }
+    m_extractingWorkpieces.insert(workpieceId);
+    qDebug() << "BatchManager: 后台提取工件几何特征:" << workpieceId << modelFilePath;
+    
+    QPointer<BatchManager> guard(this);
+    QThreadPool::globalInstance()->start(QRunnable::create([guard, workpieceId, modelFilePath]() {
+        // 临时工件对象只在工作线程中使用，extract可以直接修改它
+        WorkpieceData workpiece;
+        workpiece.setModelFilePath(modelFilePath);
+        WorkpieceGeometryFeatures features;
+        try {
+            if (WorkpieceFeatureExtractor::extract(&workpiece)) {
+                features = workpiece.geometryFeatures();
+            }
+        } catch (const std::exception& e) {
+            qCritical() << "BatchManager: 几何特征提取异常:" << e.what();
+        }
+        
+        QMetaObject::invokeMethod(guard.data(), [guard, workpieceId, features]() {
+            if (guard) {
+                guard->applyExtractedFeatures(workpieceId, features);
+            }
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void BatchManager::applyExtractedFeatures(const QString& workpieceId, const WorkpieceGeometryFeatures& features)
+{
+    m_extractingWorkpieces.remove(workpieceId);
+    if (!features.valid) {
+        qWarning() << "BatchManager: 工件几何特征提取失败，继续使用估算值:" << workpieceId;
+        emit workpieceFeaturesReady(workpieceId, false);
+        return;
+    }
+    
+    // 写回本地缓存，下次加入批次时直接读取
+    DatabaseManager* dbManager = DatabaseManager::instance();
+    bool ok = false;
+    int id = workpieceId.toInt(&ok);
+    if (ok && dbManager->isConnected(DatabaseManager::SQLite)) {
+        std::unique_ptr<WorkpieceData> workpiece(dbManager->loadWorkpiece(id, DatabaseManager::SQLite));
+        if (workpiece && WorkpieceFeatureExtractor::sourceKey(workpiece->modelFilePath()) != features.sourceKey) {
+            // 提取期间模型文件已更换，丢弃结果并按新文件重新提取
+            qDebug() << "BatchManager: 模型文件已变化，丢弃过期的几何特征:" << workpieceId;
+            calculateWorkpieceFeatures(workpieceId);
+            return;
+        }
+        if (workpiece) {
+            workpiece->setGeometryFeatures(features);
+            if (!dbManager->saveWorkpiece(workpiece.get(), DatabaseManager::SQLite)) {
+                qWarning() << "BatchManager: 保存工件几何特征失败:" << dbManager->lastError();
+            }
+        }
+    }
+    
+    setWorkpieceFeatures(workpieceId, features);
+    emit workpieceFeaturesReady(workpieceId, true);
+}
+
 void BatchManager::updateBatchStatistics(const QString& batchId)
 {
     for (auto& batch : m_batches) {
         if (batch.batchId == batchId) {
             batch.totalWorkpieces = batch.workpieceIds.size();
             
-            // 这里应该从实际的工件数据中计算统计信息
-            // 简化实现，使用估算值
-            batch.totalVolume = batch.totalWorkpieces * 0.1; // 假设每个工件0.1m³
-            batch.totalSurfaceArea = batch.totalWorkpieces * 2.0; // 假设每个工件2m²
+            // 有几何特征的工件使用实际体积和表面积，其余使用估算值
+            batch.totalVolume = 0.0;
+            batch.totalSurfaceArea = 0.0;
+            for (const QString& workpieceId : batch.workpieceIds) {
+                auto it = m_workpieceFeatures.constFind(workpieceId);
+                if (it != m_workpieceFeatures.constEnd() && it->valid) {
+                    batch.totalVolume += it->volume * kCubicMillimetersToCubicMeters;
+                    batch.totalSurfaceArea += it->surfaceArea * kSquareMillimetersToSquareMeters;
+                } else {
+                    batch.totalVolume += kDefaultWorkpieceVolume;
+                    batch.totalSurfaceArea += kDefaultWorkpieceSurfaceArea;
+                }
+            }
             batch.estimatedTime = estimateBatchProcessingTime(batchId);
             
             break;
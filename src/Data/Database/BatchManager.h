@@ -2,6 +2,8 @@
 
 #include <QObject>
 #include <QList>
+#include <QMap>
+#include <QSet>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QString>
@@ -78,6 +80,22 @@ public:
     bool removeWorkpieceFromBatch(const QString& batchId, const QString& workpieceId);
     QList<QString> getWorkpiecesInBatch(const QString& batchId) const;
     
+    /**
+     * @brief 登记工件的几何特征（由WorkpieceFeatureExtractor计算），并刷新相关批次统计
+     * @param workpieceId 工件ID
+     * @param features 几何特征（长度单位mm）
+     */
+    void setWorkpieceFeatures(const QString& workpieceId, const WorkpieceGeometryFeatures& features);
+    
+    /**
+     * @brief 登记新导入或模型文件已更换的工件
+     * 
+     * 数据库中没有与模型文件一致的几何特征时，在后台线程调用WorkpieceFeatureExtractor提取，
+     * 完成后写回本地缓存并刷新相关批次统计（workpieceFeaturesReady）。
+     * @param workpieceId 工件ID（本地缓存中的id）
+     */
+    void registerWorkpiece(const QString& workpieceId);
+    
     // 工件类别管理
     QString createCategory(const QString& categoryName, const QString& description = "");
     bool deleteCategory(const QString& categoryId);
@@ -129,6 +147,12 @@ signals:
      * @brief 批次分析完成信号
      */
     void batchAnalysisCompleted(const QString& batchId, const QJsonObject& results);
+    
+    /**
+     * @brief 工件几何特征后台提取结束信号
+     * @param success 失败时继续使用由尺寸估算的特征
+     */
+    void workpieceFeaturesReady(const QString& workpieceId, bool success);
 
 private:
     /**
@@ -137,10 +161,23 @@ private:
     QString generateUniqueId() const;
     
     /**
-     * @brief 计算工件几何特征
+     * @brief 获取工件几何特征
+     * 
+     * 优先使用数据库中缓存的计算结果，否则用录入的尺寸和表面积近似；
+     * 缓存缺失或与模型文件不一致时启动后台提取，完成后替换近似值
      */
     void calculateWorkpieceFeatures(const QString& workpieceId);
     
+    /**
+     * @brief 在后台线程读取模型文件提取几何特征，同一工件同时只提取一次
+     */
+    void extractWorkpieceFeatures(const QString& workpieceId, const QString& modelFilePath);
+    
+    /**
+     * @brief 后台提取完成（UI线程）：写回本地缓存并登记到批次统计
+     */
+    void applyExtractedFeatures(const QString& workpieceId, const WorkpieceGeometryFeatures& features);
+    
     /**
      * @brief 更新批次统计信息
      */
@@ -159,6 +196,8 @@ private:
 private:
     QList<BatchInfo> m_batches;           // 批次列表
     QList<WorkpieceCategory> m_categories; // 工件类别列表
+    QMap<QString, WorkpieceGeometryFeatures> m_workpieceFeatures; // 工件ID -> 几何特征
+    QSet<QString> m_extractingWorkpieces; // 正在后台提取特征的工件ID
     QString m_currentBatchId;             // 当前活动批次ID
 };
 
@@ -249,13 +249,13 @@ bool DatabaseManager::saveWorkpiece(WorkpieceData* workpiece, DatabaseType type)
         // 插入新记录
         sql = QString("INSERT INTO %1 (name, description, category, model_file_path, "
                      "model_file_size, model_file_hash, dimensions, material, surface_area, "
-                     "complexity_score, created_by, created_at, updated_at, is_active) "
-                     "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)").arg(tableName);
+                     "complexity_score, geometry_features, created_by, created_at, updated_at, is_active) "
+                     "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)").arg(tableName);
     } else {
         // 更新现有记录
         sql = QString("UPDATE %1 SET name=?, description=?, category=?, model_file_path=?, "
                      "model_file_size=?, model_file_hash=?, dimensions=?, material=?, surface_area=?, "
-                     "complexity_score=?, updated_at=?, is_active=? WHERE id=?").arg(tableName);
+                     "complexity_score=?, geometry_features=?, updated_at=?, is_active=? WHERE id=?").arg(tableName);
     }
     
     QSqlQuery query = prepareQuery(sql, type);
@@ -279,6 +279,13 @@ bool DatabaseManager::saveWorkpiece(WorkpieceData* workpiece, DatabaseType type)
     query.addBindValue(workpiece->surfaceArea());
     query.addBindValue(workpiece->complexityScore());
     
+    // 几何特征序列化为JSON，没有计算结果时写入NULL
+    if (workpiece->hasGeometryFeatures()) {
+        query.addBindValue(QJsonDocument(workpiece->geometryFeatures().toJson()).toJson(QJsonDocument::Compact));
+    } else {
+        query.addBindValue(QVariant(QMetaType::fromType<QString>()));
+    }
+    
     if (isNew) {
         query.addBindValue(workpiece->createdBy());
         query.addBindValue(workpiece->createdAt());
@@ -347,6 +354,13 @@ WorkpieceData* DatabaseManager::loadWorkpiece(int id, DatabaseType type)
     workpiece->setMaterial(query.value("material").toString());
     workpiece->setSurfaceArea(query.value("surface_area").toDouble());
     workpiece->setComplexityScore(query.value("complexity_score").toDouble());
+    
+    // 解析几何特征JSON（旧数据库中该列为NULL）
+    QJsonDocument featuresDoc = QJsonDocument::fromJson(query.value("geometry_features").toByteArray());
+    if (featuresDoc.isObject()) {
+        workpiece->setGeometryFeatures(WorkpieceGeometryFeatures::fromJson(featuresDoc.object()));
+    }
+    
     workpiece->setCreatedBy(query.value("created_by").toInt());
     workpiece->setCreatedAt(query.value("created_at").toDateTime());
     workpiece->setUpdatedAt(query.value("updated_at").toDateTime());
@@ -408,6 +422,13 @@ QList<WorkpieceData*> DatabaseManager::loadWorkpieces(const QString& category, D
         workpiece->setMaterial(query.value("material").toString());
         workpiece->setSurfaceArea(query.value("surface_area").toDouble());
         workpiece->setComplexityScore(query.value("complexity_score").toDouble());
+        
+        // 解析几何特征JSON
+        QJsonDocument featuresDoc = QJsonDocument::fromJson(query.value("geometry_features").toByteArray());
+        if (featuresDoc.isObject()) {
+            workpiece->setGeometryFeatures(WorkpieceGeometryFeatures::fromJson(featuresDoc.object()));
+        }
+        
         workpiece->setCreatedBy(query.value("created_by").toInt());
         workpiece->setCreatedAt(query.value("created_at").toDateTime());
         workpiece->setUpdatedAt(query.value("updated_at").toDateTime());
@@ -481,10 +502,38 @@ bool DatabaseManager::createTables(DatabaseType type)
         }
     }
     
+    // 已存在的旧表不会被CREATE TABLE IF NOT EXISTS更新，补齐新增列
+    if (!upgradeTables(type)) {
+        return false;
+    }
+    
     qDebug() << "DatabaseManager: 表结构创建完成";
     return true;
 }
 
+bool DatabaseManager::upgradeTables(DatabaseType type)
+{
+    QSqlDatabase db = getDatabase(type);
+    if (!db.isValid() || !db.isOpen()) {
+        m_lastError = "数据库未连接";
+        return false;
+    }
+    
+    // 工件几何特征列（WorkpieceGeometryFeatures的JSON）
+    QString tableName = (type == MySQL) ? "workpieces" : "cache_workpieces";
+    if (!db.record(tableName).contains("geometry_features")) {
+        QString columnType = (type == MySQL) ? "JSON" : "TEXT";
+        QString sql = QString("ALTER TABLE %1 ADD COLUMN geometry_features %2").arg(tableName, columnType);
+        if (!executeQuery(sql, type)) {
+            qWarning() << "DatabaseManager: 升级表结构失败:" << sql;
+            return false;
+        }
+        qDebug() << "DatabaseManager: 已为" << tableName << "添加geometry_features列";
+    }
+    
+    return true;
+}
+
 QSqlDatabase DatabaseManager::getDatabase(DatabaseType type)
 {
     QString connectionName = getDatabaseConnectionName(type);
@@ -554,6 +603,7 @@ QStringList DatabaseManager::getMySQLTableDefinitions()
             material VARCHAR(50),
             surface_area DECIMAL(10,2),
             complexity_score DECIMAL(3,2),
+            geometry_features JSON,
             created_by INT,
             created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
             updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
@@ -610,6 +660,7 @@ QStringList DatabaseManager::getSQLiteTableDefinitions()
             material TEXT,
             surface_area REAL,
             complexity_score REAL,
+            geometry_features TEXT,
             created_by INTEGER,
             created_at TEXT,
             updated_at TEXT,
@@ -705,7 +756,6 @@ bool DatabaseManager::deleteTrajectory(int id, DatabaseType type) { return false
 bool DatabaseManager::syncToLocal() { return false; }
 bool DatabaseManager::syncToRemote() { return false; }
 bool DatabaseManager::syncModel(BaseModel* model, DatabaseType fromType, DatabaseType toType) { return false; }
-bool DatabaseManager::upgradeTables(DatabaseType type) { return false; }
 bool DatabaseManager::optimizeDatabase(DatabaseType type) { return false; }
 bool DatabaseManager::backupDatabase(const QString& backupPath, DatabaseType type) { return false; }
 
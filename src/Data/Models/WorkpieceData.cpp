@@ -6,6 +6,110 @@
 
 namespace Data {
 
+namespace {
+
+QJsonArray vectorToJson(const QVector3D& v)
+{
+    return QJsonArray{v.x(), v.y(), v.z()};
+}
+
+QVector3D vectorFromJson(const QJsonValue& value)
+{
+    QJsonArray array = value.toArray();
+    if (array.size() != 3) {
+        return QVector3D();
+    }
+    return QVector3D(array[0].toDouble(), array[1].toDouble(), array[2].toDouble());
+}
+
+} // namespace
+
+double WorkpieceGeometryFeatures::curvedAreaRatio() const
+{
+    if (curvatureHistogram.isEmpty()) {
+        return 0.0;
+    }
+    // 第一个区间近似为平面
+    return qBound(0.0, 1.0 - curvatureHistogram.first(), 1.0);
+}
+
+double WorkpieceGeometryFeatures::complexityScore() const
+{
+    if (!valid) {
+        return 0.0;
+    }
+    
+    // 曲面占比和凹区域数各占一半，20个以上凹区域视为最复杂
+    const double concavity = qMin(concaveRegionCount / 20.0, 1.0);
+    return qBound(0.0, 0.5 * curvedAreaRatio() + 0.5 * concavity, 1.0);
+}
+
+QJsonObject WorkpieceGeometryFeatures::toJson() const
+{
+    QJsonObject json;
+    json["valid"] = valid;
+    json["source"] = source;
+    json["source_key"] = sourceKey;
+    json["surface_area"] = surfaceArea;
+    json["volume"] = volume;
+    json["closed"] = closed;
+    json["face_count"] = faceCount;
+    
+    QJsonObject obb;
+    obb["center"] = vectorToJson(obbCenter);
+    obb["axis_x"] = vectorToJson(obbAxisX);
+    obb["axis_y"] = vectorToJson(obbAxisY);
+    obb["axis_z"] = vectorToJson(obbAxisZ);
+    obb["size"] = vectorToJson(obbSize);
+    json["obb"] = obb;
+    
+    QJsonArray histogram;
+    for (double value : curvatureHistogram) {
+        histogram.append(value);
+    }
+    json["curvature_histogram"] = histogram;
+    json["curvature_flat_limit"] = curvatureFlatLimit;
+    json["curvature_bin_width"] = curvatureBinWidth;
+    json["concave_region_count"] = concaveRegionCount;
+    json["computed_at"] = computedAt.toString(Qt::ISODate);
+    json["compute_time_ms"] = computeTimeMs;
+    
+    return json;
+}
+
+WorkpieceGeometryFeatures WorkpieceGeometryFeatures::fromJson(const QJsonObject& json)
+{
+    WorkpieceGeometryFeatures features;
+    features.valid = json["valid"].toBool();
+    features.source = json["source"].toString();
+    features.sourceKey = json["source_key"].toString();
+    features.surfaceArea = json["surface_area"].toDouble();
+    features.volume = json["volume"].toDouble();
+    features.closed = json["closed"].toBool();
+    features.faceCount = json["face_count"].toInt();
+    
+    QJsonObject obb = json["obb"].toObject();
+    features.obbCenter = vectorFromJson(obb["center"]);
+    features.obbAxisX = vectorFromJson(obb["axis_x"]);
+    features.obbAxisY = vectorFromJson(obb["axis_y"]);
+    features.obbAxisZ = vectorFromJson(obb["axis_z"]);
+    features.obbSize = vectorFromJson(obb["size"]);
+    
+    const QJsonArray histogram = json["curvature_histogram"].toArray();
+    for (const QJsonValue& value : histogram) {
+        features.curvatureHistogram.append(value.toDouble());
+    }
+    features.curvatureBinWidth = json["curvature_bin_width"].toDouble();
+    // 旧缓存为等宽区间，相当于平面上限等于区间宽度
+    features.curvatureFlatLimit = json.contains("curvature_flat_limit")
+        ? json["curvature_flat_limit"].toDouble() : features.curvatureBinWidth;
+    features.concaveRegionCount = json["concave_region_count"].toInt();
+    features.computedAt = QDateTime::fromString(json["computed_at"].toString(), Qt::ISODate);
+    features.computeTimeMs = json["compute_time_ms"].toDouble();
+    
+    return features;
+}
+
 WorkpieceData::WorkpieceData(QObject *parent)
     : BaseModel(parent)
     , m_modelFileSize(0)
@@ -106,6 +210,21 @@ void WorkpieceData::setComplexityScore(double score)
     }
 }
 
+void WorkpieceData::setGeometryFeatures(const WorkpieceGeometryFeatures& features)
+{
+    m_geometryFeatures = features;
+    
+    if (features.valid) {
+        // OBB尺寸已按从大到小排列，对应长、宽、高
+        setDimensions(features.obbSize);
+        setSurfaceArea(features.surfaceArea);
+        setComplexityScore(features.complexityScore());
+    }
+    
+    emit geometryFeaturesChanged();
+    notifyDataChanged();
+}
+
 void WorkpieceData::setCreatedBy(int userId)
 {
     if (m_createdBy != userId) {
@@ -135,6 +254,9 @@ QJsonObject WorkpieceData::toJson() const
     json["material"] = m_material;
     json["surface_area"] = m_surfaceArea;
     json["complexity_score"] = m_complexityScore;
+    if (m_geometryFeatures.valid) {
+        json["geometry_features"] = m_geometryFeatures.toJson();
+    }
     json["created_by"] = m_createdBy;
     
     return json;
@@ -189,6 +311,12 @@ void WorkpieceData::fromJson(const QJsonObject& json)
         setComplexityScore(json["complexity_score"].toDouble());
     }
     
+    if (json.contains("geometry_features")) {
+        // 直接恢复缓存的特征，不覆盖上面读取的尺寸等字段
+        m_geometryFeatures = WorkpieceGeometryFeatures::fromJson(json["geometry_features"].toObject());
+        emit geometryFeaturesChanged();
+    }
+    
     if (json.contains("created_by")) {
         setCreatedBy(json["created_by"].toInt());
     }
@@ -231,7 +359,7 @@ QStringList WorkpieceData::validationErrors() const
             errors << "模型文件不存在";
         }
         
-        QStringList supportedFormats = {"stl", "obj", "ply", "pcd"};
+        QStringList supportedFormats = {"stl", "obj", "ply", "pcd", "step", "stp"};
         if (!supportedFormats.contains(fileInfo.suffix().toLower())) {
             errors << "不支持的模型文件格式";
         }
@@ -250,6 +378,10 @@ BaseModel* WorkpieceData::clone() const
 
 double WorkpieceData::getVolume() const
 {
+    // 优先使用由实际几何计算的体积
+    if (m_geometryFeatures.valid && m_geometryFeatures.volume > 0.0) {
+        return m_geometryFeatures.volume;
+    }
     return m_dimensions.x() * m_dimensions.y() * m_dimensions.z();
 }
 
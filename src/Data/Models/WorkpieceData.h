@@ -4,9 +4,60 @@
 #include "BaseModel.h"
 #include <QJsonObject>
 #include <QVector3D>
+#include <QVector>
+#include <QDateTime>
 
 namespace Data {
 
+/**
+ * @brief 由实际几何计算得到的工件特征
+ * 
+ * 由WorkpieceFeatureExtractor从STEP形状或重建网格计算，随工件一起缓存。
+ * 长度单位与源模型一致（STEP通常为mm）。
+ */
+struct WorkpieceGeometryFeatures
+{
+    bool valid = false;
+    QString source;                   // 来源："step" 或 "mesh"
+    QString sourceKey;                // 源文件标识（路径+大小+修改时间），不一致时需重新计算
+    
+    double surfaceArea = 0.0;         // 表面积
+    double volume = 0.0;              // 体积（网格不封闭时为0）
+    bool closed = false;              // 是否为封闭实体
+    int faceCount = 0;                // 面数（STEP为B-Rep面，网格为三角形）
+    
+    // 有向包围盒（OBB），轴按尺寸从大到小排列
+    QVector3D obbCenter;
+    QVector3D obbAxisX;
+    QVector3D obbAxisY;
+    QVector3D obbAxisZ;
+    QVector3D obbSize;                // 沿三个轴的全长
+    
+    // 曲率直方图：按面积加权的占比。第0个区间为平面 [0, curvatureFlatLimit)，
+    // 第i个区间 (i ≥ 1) 为 curvatureFlatLimit + [i-1, i) * curvatureBinWidth，最后一个区间包含更大值
+    QVector<double> curvatureHistogram;
+    double curvatureFlatLimit = 0.0;  // 平面曲率上限（1/包围盒对角线长度）
+    double curvatureBinWidth = 0.0;   // 非平面区间的宽度，由曲率分布范围确定（1/长度单位）
+    
+    int concaveRegionCount = 0;       // 凹区域数（由凹边连通的面组；不封闭的网格为0）
+    
+    QDateTime computedAt;
+    double computeTimeMs = 0.0;
+    
+    /**
+     * @brief 曲面（非平面）面积占比
+     */
+    double curvedAreaRatio() const;
+    
+    /**
+     * @brief 由曲率分布和凹区域数估算的复杂度评分（0-1）
+     */
+    double complexityScore() const;
+    
+    QJsonObject toJson() const;
+    static WorkpieceGeometryFeatures fromJson(const QJsonObject& json);
+};
+
 /**
  * @brief 工件数据模型
  * 
@@ -69,6 +120,11 @@ public:
     double complexityScore() const { return m_complexityScore; }
     void setComplexityScore(double score);
 
+    // 几何特征（设置时同步更新尺寸、表面积和复杂度评分）
+    const WorkpieceGeometryFeatures& geometryFeatures() const { return m_geometryFeatures; }
+    void setGeometryFeatures(const WorkpieceGeometryFeatures& features);
+    bool hasGeometryFeatures() const { return m_geometryFeatures.valid; }
+
     // 创建者
     int createdBy() const { return m_createdBy; }
     void setCreatedBy(int userId);
@@ -97,6 +153,7 @@ signals:
     void materialChanged();
     void surfaceAreaChanged();
     void complexityScoreChanged();
+    void geometryFeaturesChanged();
     void createdByChanged();
 
 private:
@@ -110,6 +167,7 @@ private:
     QString m_material;
     double m_surfaceArea;
     double m_complexityScore;
+    WorkpieceGeometryFeatures m_geometryFeatures;
     int m_createdBy;
 };
 
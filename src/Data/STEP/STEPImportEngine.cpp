@@ -0,0 +1,347 @@
+#include "STEPImportEngine.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <chrono>
+
+// OpenCASCADE includes
+#include <STEPCAFControl_Controller.hxx>
+#include <STEPCAFControl_Reader.hxx>
+#include <XCAFApp_Application.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+#include <TDataStd_Name.hxx>
+#include <Bnd_Box.hxx>
+#include <BRepBndLib.hxx>
+
+QMutex STEPImportEngine::s_applicationMutex;
+
+STEPImportResult::~STEPImportResult()
+{
+    // 最后一个使用方释放结果时关闭文档
+    shapeTool.Nullify();
+    STEPImportEngine::closeDocument(document);
+}
+
+STEPImportEngine* STEPImportEngine::instance()
+{
+    static STEPImportEngine* s_instance = []() {
+        // STEP转换器的静态参数只需初始化一次，且应在并发导入之前完成
+        STEPCAFControl_Controller::Init();
+        return new STEPImportEngine();
+    }();
+    return s_instance;
+}
+
+STEPImportResultPtr STEPImportEngine::import(const QString& filePath,
+                                             const Handle(STEPProgressIndicator)& progress,
+                                             const Message_ProgressRange& range,
+                                             QString* errorMessage)
+{
+    QFileInfo fileInfo(filePath);
+    const QString key = fileInfo.canonicalFilePath();
+    if (key.isEmpty()) {
+        qWarning() << "STEPImportEngine: 文件不存在:" << filePath;
+        if (errorMessage) {
+            *errorMessage = QString("文件不存在: %1").arg(filePath);
+        }
+        return nullptr;
+    }
+    const QDateTime lastModified = fileInfo.lastModified();
+    
+    std::promise<STEPImportResultPtr> promise;
+    std::shared_future<STEPImportResultPtr> future;
+    bool owner = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end() && it->lastModified == lastModified) {
+            future = it->future;
+        } else {
+            future = promise.get_future().share();
+            m_entries[key] = Entry{lastModified, future};
+            owner = true;
+        }
+        m_recent.removeAll(key);
+        m_recent.append(key);
+        
+        // 淘汰最久未使用且已完成的结果
+        for (int i = 0; i < m_recent.size() && m_recent.size() > kMaxCachedResults; ) {
+            const QString& candidate = m_recent[i];
+            auto entry = m_entries.constFind(candidate);
+            bool ready = entry == m_entries.constEnd() ||
+                entry->future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            if (candidate != key && ready) {
+                m_entries.remove(candidate);
+                m_recent.removeAt(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+    
+    if (!owner) {
+        // 同一文件正在导入或已导入，等待并共享结果
+        if (!progress.IsNull()) {
+            progress->setStage("等待同一文件的导入完成...");
+        }
+        while (future.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready) {
+            if (range.UserBreak()) {
+                if (errorMessage) {
+                    *errorMessage = "加载已取消";
+                }
+                return nullptr;
+            }
+        }
+        
+        STEPImportResultPtr result = future.get();
+        if (result) {
+            qDebug() << "STEPImportEngine: 复用已导入的文档:" << key;
+            return result;
+        }
+        
+        // 之前的导入失败或被取消（条目已移除），由本次调用重新导入
+        return import(filePath, progress, range, errorMessage);
+    }
+    
+    STEPImportResultPtr result;
+    try {
+        result = doImport(key, lastModified, progress, range, errorMessage);
+    } catch (const std::exception& e) {
+        qCritical() << "STEPImportEngine: 导入异常:" << e.what();
+        if (errorMessage) {
+            *errorMessage = QString("加载异常: %1").arg(e.what());
+        }
+    } catch (...) {
+        qCritical() << "STEPImportEngine: 导入未知异常";
+        if (errorMessage) {
+            *errorMessage = "未知异常";
+        }
+    }
+    
+    if (!result) {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end() && it->lastModified == lastModified) {
+            m_entries.erase(it);
+            m_recent.removeAll(key);
+        }
+    }
+    promise.set_value(result);
+    return result;
+}
+
+STEPImportResultPtr STEPImportEngine::cached(const QString& filePath) const
+{
+    const QString key = QFileInfo(filePath).canonicalFilePath();
+    
+    QMutexLocker locker(&m_mutex);
+    auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd() ||
+        it->future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return nullptr;
+    }
+    return it->future.get();
+}
+
+void STEPImportEngine::release(const QString& filePath)
+{
+    const QString key = QFileInfo(filePath).canonicalFilePath();
+    
+    QMutexLocker locker(&m_mutex);
+    m_entries.remove(key);
+    m_recent.removeAll(key);
+}
+
+void STEPImportEngine::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_recent.clear();
+}
+
+void STEPImportEngine::closeDocument(Handle(TDocStd_Document)& document)
+{
+    if (document.IsNull()) {
+        return;
+    }
+    
+    QMutexLocker locker(&s_applicationMutex);
+    try {
+        Handle(XCAFApp_Application) app = XCAFApp_Application::GetApplication();
+        if (!app.IsNull()) {
+            app->Close(document);
+        }
+    } catch (...) {
+        qWarning() << "STEPImportEngine: 关闭文档时异常";
+    }
+    document.Nullify();
+}
+
+STEPImportResultPtr STEPImportEngine::doImport(const QString& filePath, const QDateTime& lastModified,
+                                               const Handle(STEPProgressIndicator)& progress,
+                                               const Message_ProgressRange& range,
+                                               QString* errorMessage)
+{
+    auto setStage = [&progress](const QString& stage) {
+        if (!progress.IsNull()) {
+            progress->setStage(stage);
+        }
+    };
+    auto canceled = [errorMessage]() -> STEPImportResultPtr {
+        qDebug() << "STEPImportEngine: 导入已取消";
+        if (errorMessage) {
+            *errorMessage = "加载已取消";
+        }
+        return nullptr;
+    };
+    auto failed = [errorMessage](const QString& message) -> STEPImportResultPtr {
+        qCritical() << "STEPImportEngine:" << message;
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return nullptr;
+    };
+    
+    qDebug() << "STEPImportEngine: 开始导入STEP文件:" << filePath;
+    QElapsedTimer timer;
+    timer.start();
+    
+    // 总进度划分：读取30%，转换50%，解析结构20%
+    Message_ProgressScope scope(range, "STEP Import", 100);
+    
+    auto result = std::make_shared<STEPImportResult>();
+    result->filePath = filePath;
+    result->lastModified = lastModified;
+    {
+        QMutexLocker locker(&s_applicationMutex);
+        XCAFApp_Application::GetApplication()->NewDocument("MDTV-XCAF", result->document);
+    }
+    if (result->document.IsNull()) {
+        return failed("无法创建XCAF文档");
+    }
+    
+    // 读取（ReadFile不支持进度范围，只能在前后检查取消；OCCT按UTF-8解释文件名）
+    setStage("正在读取STEP文件...");
+    STEPCAFControl_Reader reader;
+    Message_ProgressRange readRange = scope.Next(30);
+    if (scope.UserBreak()) {
+        return canceled();
+    }
+    IFSelect_ReturnStatus status = reader.ReadFile(filePath.toUtf8().constData());
+    readRange.Close();
+    if (scope.UserBreak()) {
+        return canceled();
+    }
+    
+    if (status != IFSelect_RetDone) {
+        QString reason;
+        switch (status) {
+            case IFSelect_RetError:
+                reason = "读取文件时发生错误";
+                break;
+            case IFSelect_RetFail:
+                reason = "读取文件失败";
+                break;
+            case IFSelect_RetVoid:
+                reason = "文件为空或无效";
+                break;
+            default:
+                reason = "未知读取错误";
+                break;
+        }
+        return failed(QString("无法读取STEP文件 (%1)").arg(reason));
+    }
+    qDebug() << "STEPImportEngine: 读取完成，耗时" << timer.elapsed() << "ms";
+    
+    // 转换
+    setStage("正在转换STEP数据...");
+    bool transferred = reader.Transfer(result->document, scope.Next(50));
+    if (scope.UserBreak()) {
+        return canceled();
+    }
+    if (!transferred) {
+        return failed("无法转换STEP数据");
+    }
+    qDebug() << "STEPImportEngine: 转换完成，累计耗时" << timer.elapsed() << "ms";
+    
+    // 解析结构，收集叶子部件
+    setStage("正在解析模型结构...");
+    result->shapeTool = XCAFDoc_DocumentTool::ShapeTool(result->document->Main());
+    if (result->shapeTool.IsNull()) {
+        return failed("无法获取XCAF形状工具");
+    }
+    result->shapeTool->GetFreeShapes(result->freeShapes);
+    
+    const int freeCount = result->freeShapes.Length();
+    Message_ProgressScope partScope(scope.Next(20), "Parts", std::max(freeCount, 1));
+    for (Standard_Integer i = 1; i <= freeCount && !partScope.UserBreak(); i++) {
+        TDF_Label label = result->freeShapes.Value(i);
+        TopoDS_Shape shape = result->shapeTool->GetShape(label);
+        if (!shape.IsNull()) {
+            QString name = labelName(label);
+            result->topLevelName = name.isEmpty() ? "Model" : name;
+            collectParts(*result, label, shape, partScope);
+        }
+        partScope.Next();
+    }
+    if (partScope.UserBreak()) {
+        return canceled();
+    }
+    
+    qDebug() << "STEPImportEngine: 导入完成，" << freeCount << "个顶层形状，"
+             << result->parts.size() << "个部件，总耗时" << timer.elapsed() << "ms";
+    return result;
+}
+
+void STEPImportEngine::collectParts(STEPImportResult& result, const TDF_Label& label,
+                                    const TopoDS_Shape& shape, Message_ProgressScope& scope)
+{
+    if (scope.UserBreak()) {
+        return;
+    }
+    
+    // 命名规则与模型树控件/缓存保持一致：无名称时按计数生成Part_N
+    QString name = labelName(label);
+    if (name.isEmpty()) {
+        name = QString("Part_%1").arg(++result.shapeCounter);
+    }
+    
+    TDF_LabelSequence components;
+    if (result.shapeTool->GetComponents(label, components) && components.Length() > 0) {
+        for (Standard_Integer i = 1; i <= components.Length(); i++) {
+            TDF_Label compLabel = components.Value(i);
+            TopoDS_Shape compShape = result.shapeTool->GetShape(compLabel);
+            if (!compShape.IsNull()) {
+                collectParts(result, compLabel, compShape, scope);
+            }
+        }
+        return;
+    }
+    
+    STEPImportPart part;
+    part.name = name;
+    part.label = label;
+    part.shape = shape;
+    
+    Bnd_Box box;
+    BRepBndLib::Add(shape, box, Standard_False);
+    if (!box.IsVoid()) {
+        Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
+        box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+        part.bounds = QVector<double>{xmin, xmax, ymin, ymax, zmin, zmax};
+    }
+    
+    result.parts[name] = part;
+    result.shapeCounter++;
+}
+
+QString STEPImportEngine::labelName(const TDF_Label& label)
+{
+    Handle(TDataStd_Name) nameAttr;
+    if (label.FindAttribute(TDataStd_Name::GetID(), nameAttr)) {
+        return QString::fromUtf8(TCollection_AsciiString(nameAttr->Get()).ToCString());
+    }
+    return QString();
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QVector>
+#include <QMutex>
+#include <QDateTime>
+#include <memory>
+#include <future>
+
+// OpenCASCADE includes
+#include <TopoDS_Shape.hxx>
+#include <TDocStd_Document.hxx>
+#include <TDF_Label.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+#include <Message_ProgressRange.hxx>
+#include "STEPProgressIndicator.h"
+
+/**
+ * @brief STEP叶子部件
+ */
+struct STEPImportPart {
+    QString name;                // 部件名称（无名称时为Part_N）
+    TDF_Label label;             // 文档中的标签
+    TopoDS_Shape shape;          // 带装配位置的形状
+    QVector<double> bounds;      // 包围盒 {xmin, xmax, ymin, ymax, zmin, zmax}，形状为空时为空
+};
+
+/**
+ * @brief 一次STEP导入的结果
+ * 
+ * 导入完成后只读，通过shared_ptr在模型树、加载线程等使用方之间共享。
+ * 网格化写入的三角剖分保存在共享的形状上，后续使用方可直接复用。
+ */
+struct STEPImportResult {
+    ~STEPImportResult();
+
+    QString filePath;                        // 规范化的文件路径
+    QDateTime lastModified;                  // 导入时文件的修改时间
+    Handle(TDocStd_Document) document;       // XCAF文档
+    Handle(XCAFDoc_ShapeTool) shapeTool;     // 形状工具
+    TDF_LabelSequence freeShapes;            // 顶层形状标签
+    QString topLevelName;                    // 最后一个顶层形状的名称
+    QMap<QString, STEPImportPart> parts;     // 叶子部件（同名部件保留最后一个）
+    int shapeCounter = 0;                    // 部件计数（与缓存格式中的shapeCounter一致）
+};
+
+using STEPImportResultPtr = std::shared_ptr<const STEPImportResult>;
+
+/**
+ * @brief 统一的STEP导入引擎
+ * 
+ * 每个文件只读取和转换一次，结果在内存中共享给所有使用方。
+ * 同一文件的并发导入请求会等待正在进行的导入完成，而不是重复读取。
+ */
+class STEPImportEngine {
+public:
+    static STEPImportEngine* instance();
+
+    // 内存中保留的最近导入结果数（使用方持有的结果不受此限制）
+    static constexpr int kMaxCachedResults = 2;
+
+    /**
+     * @brief 导入STEP文件
+     * 
+     * 文件路径和修改时间与已缓存的结果一致时直接返回共享结果。
+     * @param filePath STEP文件路径
+     * @param progress 进度指示器，用于显示阶段描述，可为空
+     * @param range 进度范围（读取30%、转换50%、解析结构20%），取消时提前返回
+     * @param errorMessage 失败或取消时的原因
+     * @return 导入结果，失败或取消时为空
+     */
+    STEPImportResultPtr import(const QString& filePath,
+                               const Handle(STEPProgressIndicator)& progress = Handle(STEPProgressIndicator)(),
+                               const Message_ProgressRange& range = Message_ProgressRange(),
+                               QString* errorMessage = nullptr);
+
+    /**
+     * @brief 获取已缓存的导入结果（不触发导入）
+     */
+    STEPImportResultPtr cached(const QString& filePath) const;
+
+    /**
+     * @brief 从缓存中移除指定文件的结果
+     */
+    void release(const QString& filePath);
+
+    /**
+     * @brief 清空缓存
+     */
+    void clear();
+
+    /**
+     * @brief 关闭XCAF文档（与创建文档一样需要串行）
+     */
+    static void closeDocument(Handle(TDocStd_Document)& document);
+
+private:
+    STEPImportEngine() = default;
+
+    STEPImportResultPtr doImport(const QString& filePath, const QDateTime& lastModified,
+                                 const Handle(STEPProgressIndicator)& progress,
+                                 const Message_ProgressRange& range, QString* errorMessage);
+    void collectParts(STEPImportResult& result, const TDF_Label& label,
+                      const TopoDS_Shape& shape, Message_ProgressScope& scope);
+    static QString labelName(const TDF_Label& label);
+
+    struct Entry {
+        QDateTime lastModified;
+        std::shared_future<STEPImportResultPtr> future;
+    };
+
+    mutable QMutex m_mutex;
+    QMap<QString, Entry> m_entries;   // 规范化路径 -> 导入结果（含正在进行的导入）
+    QStringList m_recent;             // 最近使用顺序，末尾为最新
+
+    static QMutex s_applicationMutex; // XCAFApp_Application 创建/关闭文档需串行
+};
@@ -4,12 +4,11 @@
 #include <QDebug>
 #include <QFileInfo>
 #include <QThread>
-#include <QCoreApplication>
-#include <QTimer>
+#include <algorithm>
+#include "STEPProgressIndicator.h"
+#include "STEPImportEngine.h"
 
 // OpenCASCADE includes
-#include <STEPCAFControl_Reader.hxx>
-#include <XCAFApp_Application.hxx>
 #include <XCAFDoc_DocumentTool.hxx>
 #include <TDataStd_Name.hxx>
 #include <TDF_ChildIterator.hxx>
@@ -28,7 +27,13 @@ STEPModelTree::STEPModelTree(QObject* parent)
     , m_isLoading(false)
     , m_totalLabels(0)
     , m_processedLabels(0)
+    , m_lastProgress(0)
 {
+    // OCCT读取/转换阶段占总进度的10%-50%
+    m_progress = new STEPProgressIndicator([this](int percent, const QString& stage) {
+        emit loadProgress(10 + percent * 40 / 100, stage);
+    });
+
     // 设置Qt模型的列标题
     m_qtModel->setHorizontalHeaderLabels({
         tr("组件名称"), 
@@ -63,15 +68,9 @@ STEPModelTree::~STEPModelTree()
         m_colorTool.Nullify();
         m_layerTool.Nullify();
         
-        // 清理STEP文档
-        if (!m_stepDocument.IsNull()) {
-            // 关闭文档
-            Handle(XCAFApp_Application) app = XCAFApp_Application::GetApplication();
-            if (!app.IsNull()) {
-                app->Close(m_stepDocument);
-            }
-            m_stepDocument.Nullify();
-        }
+        // 释放STEP文档引用（文档由导入引擎共享，最后一个使用方释放时关闭）
+        m_stepDocument.Nullify();
+        m_importResult.reset();
         
         qDebug() << "STEPModelTree: OpenCASCADE资源清理完成";
         
@@ -133,29 +132,9 @@ bool STEPModelTree::loadFromSTEPFile(const QString& filePath)
         
         qDebug() << "STEPModelTree: File size:" << fileInfo.size() << "bytes";
         
-        // 创建STEP读取器
-        qDebug() << "STEPModelTree: Creating STEP reader...";
-        STEPCAFControl_Reader reader;
-        
-        // 创建XCAF文档
-        qDebug() << "STEPModelTree: Creating XCAF document...";
-        Handle(XCAFApp_Application) app = XCAFApp_Application::GetApplication();
-        if (app.IsNull()) {
-            qCritical() << "STEPModelTree: Failed to get XCAFApp_Application";
-            emit modelTreeLoaded(false, tr("无法初始化XCAF应用程序"));
-            m_isLoading = false;
-            return false;
-        }
-        
-        app->NewDocument("MDTV-XCAF", m_stepDocument);
-        if (m_stepDocument.IsNull()) {
-            qCritical() << "STEPModelTree: Failed to create XCAF document";
-            emit modelTreeLoaded(false, tr("无法创建XCAF文档"));
-            m_isLoading = false;
-            return false;
-        }
-        
-        emit loadProgress(10, tr("读取STEP文件..."));
+        // 重置进度，并让线程中断请求也能中止OCCT的转换过程
+        m_progress->Reset();
+        m_progress->watchThreadInterruption(QThread::currentThread());
         
         // 检查线程中断
         if (QThread::currentThread()->isInterruptionRequested()) {
@@ -164,92 +143,31 @@ bool STEPModelTree::loadFromSTEPFile(const QString& filePath)
             return false;
         }
         
-        // 读取STEP文件
-        qDebug() << "STEPModelTree: Reading STEP file...";
-        IFSelect_ReturnStatus status = reader.ReadFile(filePath.toLocal8Bit().constData());
-        qDebug() << "STEPModelTree: Read status:" << (int)status;
+        // 通过统一导入引擎读取和转换：同一文件已被其他使用方导入时直接共享文档
+        qDebug() << "STEPModelTree: Importing STEP file via STEPImportEngine...";
+        QString errorMessage;
+        m_importResult = STEPImportEngine::instance()->import(filePath, m_progress,
+                                                              m_progress->Start(), &errorMessage);
         
-        if (status != IFSelect_RetDone) {
-            QString errorMsg;
-            switch (status) {
-                case IFSelect_RetError:
-                    errorMsg = tr("读取文件时发生错误");
-                    break;
-                case IFSelect_RetFail:
-                    errorMsg = tr("读取文件失败");
-                    break;
-                case IFSelect_RetVoid:
-                    errorMsg = tr("文件为空或无效");
-                    break;
-                default:
-                    errorMsg = tr("未知读取错误");
-                    break;
-            }
-            qCritical() << "STEPModelTree: Failed to read STEP file:" << errorMsg;
-            emit modelTreeLoaded(false, tr("无法读取STEP文件: %1 (%2)").arg(filePath).arg(errorMsg));
+        if (m_progress->UserBreak()) {
+            qDebug() << "STEPModelTree: Load canceled";
+            m_importResult.reset();
+            emit modelTreeLoaded(false, tr("加载已取消"));
             m_isLoading = false;
             return false;
         }
-
-        emit loadProgress(30, tr("传输数据到文档..."));
         
-        // 检查线程中断
-        if (QThread::currentThread()->isInterruptionRequested()) {
-            qDebug() << "STEPModelTree: Thread interruption requested before transfer";
+        if (!m_importResult) {
+            qCritical() << "STEPModelTree: Failed to import STEP file:" << errorMessage;
+            emit modelTreeLoaded(false, tr("无法导入STEP文件: %1 (%2)").arg(filePath).arg(errorMessage));
             m_isLoading = false;
             return false;
         }
         
-        // 传输数据到文档 - 这是最容易阻塞的步骤
-        qDebug() << "STEPModelTree: Transferring data to document...";
-        
-        // 使用QTimer延迟发送进度更新，避免信号阻塞
-        QTimer::singleShot(0, this, [this]() {
-            emit loadProgress(35, tr("正在传输STEP数据..."));
-        });
-        
-        try {
-            qDebug() << "STEPModelTree: 即将调用reader.Transfer()...";
-            
-            if (!reader.Transfer(m_stepDocument)) {
-                qCritical() << "STEPModelTree: Failed to transfer STEP data to document";
-                emit modelTreeLoaded(false, tr("无法传输STEP数据到文档"));
-                m_isLoading = false;
-                return false;
-            }
-            
-            qDebug() << "STEPModelTree: reader.Transfer() 调用完成";
-            
-        } catch (const std::exception& e) {
-            qWarning() << "STEPModelTree: Transfer异常:" << e.what();
-            emit modelTreeLoaded(false, tr("数据传输异常: %1").arg(e.what()));
-            m_isLoading = false;
-            return false;
-        } catch (...) {
-            qWarning() << "STEPModelTree: Transfer未知异常";
-            emit modelTreeLoaded(false, tr("数据传输发生未知异常"));
-            m_isLoading = false;
-            return false;
-        }
-        
-        // 关键修复：多重线程状态刷新，确保Transfer完成后能继续
-        qDebug() << "STEPModelTree: Transfer completed, applying thread state refresh...";
-        
-        // 第一次刷新
-        QThread::msleep(10);
-        QCoreApplication::processEvents();
-        
-        // 第二次刷新，确保信号队列被处理
-        QThread::msleep(5);
-        QCoreApplication::processEvents();
-        
-        // 使用定时器延迟发送后续信号，避免阻塞
-        qDebug() << "STEPModelTree: Scheduling delayed progress update...";
-        QTimer::singleShot(10, this, [this]() {
-            qDebug() << "STEPModelTree: Delayed progress update - XCAF tools initialization";
-            emit loadProgress(50, tr("初始化XCAF工具..."));
-        });
+        m_stepDocument = m_importResult->document;
         
+        // 进度信号跨线程时由Qt以队列方式送达，无需在此处休眠或泵事件
+        emit loadProgress(50, tr("初始化XCAF工具..."));
         qDebug() << "STEPModelTree: Transfer completed, continuing to XCAF tools...";
         
         // 检查线程中断
@@ -309,6 +227,7 @@ bool STEPModelTree::loadFromSTEPFile(const QString& filePath)
         m_shapeTool->GetFreeShapes(freeShapes);
         m_totalLabels = freeShapes.Length();
         m_processedLabels = 0;
+        m_lastProgress = 70;
         
         qDebug() << "STEPModelTree: Found" << m_totalLabels << "free shapes";
 
@@ -388,10 +307,6 @@ bool STEPModelTree::loadFromSTEPFile(const QString& filePath)
             return false;
         }
 
-        // 强制刷新线程状态，防止信号发送阻塞
-        QThread::msleep(5);
-        QCoreApplication::processEvents();
-
         emit loadProgress(100, tr("加载完成"));
         
         qDebug() << "STEPModelTree: Sending completion signal...";
@@ -426,13 +341,6 @@ void STEPModelTree::parseSTEPLabel(const TDF_Label& label,
             return;
         }
 
-        // 每处理一定数量的节点就让出CPU时间
-        static int processedCount = 0;
-        processedCount++;
-        if (processedCount % 50 == 0) {
-            QThread::msleep(1); // 让出1ms CPU时间
-        }
-
         qDebug() << "STEPModelTree: Parsing label at level" << level << "(depth limit:" << maxDepth << ")";
 
         // 创建当前节点
@@ -458,8 +366,12 @@ void STEPModelTree::parseSTEPLabel(const TDF_Label& label,
         // 更新进度
         m_processedLabels++;
         if (m_totalLabels > 0) {
-            int progress = 70 + (m_processedLabels * 20) / m_totalLabels;
-            emit loadProgress(progress, tr("解析组件: %1 (层级: %2)").arg(node->name).arg(level));
+            // 子标签也计入已处理数，进度封顶在90%；只在百分比变化时发出信号，避免淹没事件队列
+            int progress = std::min(89, 70 + (m_processedLabels * 20) / m_totalLabels);
+            if (progress != m_lastProgress) {
+                m_lastProgress = progress;
+                emit loadProgress(progress, tr("解析组件: %1 (层级: %2)").arg(node->name).arg(level));
+            }
         }
 
         // 递归处理子标签 - 增强逻辑
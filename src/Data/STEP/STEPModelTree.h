@@ -18,6 +18,8 @@
 #include <XCAFDoc_LayerTool.hxx>
 #include <TDF_Label.hxx>
 #include <TDataStd_Name.hxx>
+#include "STEPProgressIndicator.h"
+#include "STEPImportEngine.h"
 
 // VTK includes
 #include <vtkSmartPointer.h>
@@ -62,6 +64,11 @@ public:
      */
     bool loadFromSTEPFile(const QString& filePath);
 
+    /**
+     * @brief 请求取消正在进行的加载（线程安全）
+     */
+    void requestCancel() { m_progress->requestCancel(); }
+
     /**
      * @brief 获取模型树的根节点
      * @return 根节点指针
@@ -244,6 +251,7 @@ private:
 
 private:
     Handle(TDocStd_Document) m_stepDocument;        // STEP文档
+    STEPImportResultPtr m_importResult;             // 共享的导入结果（保证文档在使用期间有效）
     Handle(XCAFDoc_ShapeTool) m_shapeTool;          // 形状工具
     Handle(XCAFDoc_ColorTool) m_colorTool;          // 颜色工具
     Handle(XCAFDoc_LayerTool) m_layerTool;          // 图层工具
@@ -258,4 +266,6 @@ private:
     bool m_isLoading;                               // 是否正在加载
     int m_totalLabels;                              // 总标签数
     int m_processedLabels;                          // 已处理标签数
+    int m_lastProgress;                             // 上一次发出的解析进度
+    Handle(STEPProgressIndicator) m_progress;       // OCCT进度指示器（支持取消）
 };
\ No newline at end of file
@@ -3,8 +3,6 @@
 
 #include <QDebug>
 #include <QThread>
-#include <QCoreApplication>
-#include <QTimer>
 
 STEPModelTreeWorker::STEPModelTreeWorker(QObject* parent)
     : QObject(parent)
@@ -89,36 +87,12 @@ void STEPModelTreeWorker::loadSTEPFile(const QString& filePath)
             
             qDebug() << "=== WORKER THREAD: STEP model tree loading completed successfully ===";
             
-            // 关键修复：确保工作线程状态稳定后再发送完成信号
-            qDebug() << "STEPModelTreeWorker: 准备发送完成信号，先稳定线程状态...";
-            
-            // 多重状态稳定措施
-            QThread::msleep(10);  // 给OpenCASCADE时间完成内部清理
-            QCoreApplication::processEvents(); // 处理待处理的事件
-            QThread::msleep(5);   // 再次等待
-            
-            // 使用QTimer延迟发送信号，确保不在OpenCASCADE调用栈中发送
-            QTimer::singleShot(20, this, [this, rootNode]() {
-                qDebug() << "STEPModelTreeWorker: 延迟发送完成信号";
-                try {
-                    emit modelTreeLoaded(true, "STEP模型树加载成功", rootNode);
-                    qDebug() << "STEPModelTreeWorker: 完成信号已发送";
-                } catch (const std::exception& e) {
-                    qCritical() << "STEPModelTreeWorker: 发送完成信号异常:" << e.what();
-                    emit loadFailed(QString("发送完成信号异常: %1").arg(e.what()));
-                } catch (...) {
-                    qCritical() << "STEPModelTreeWorker: 发送完成信号未知异常";
-                    emit loadFailed("发送完成信号发生未知异常");
-                }
-            });
+            // 跨线程信号由Qt排队送达接收方，直接发出即可
+            emit modelTreeLoaded(true, "STEP模型树加载成功", rootNode);
             
         } else {
             qDebug() << "=== WORKER THREAD: STEP model tree loading failed ===";
-            
-            // 失败情况也延迟发送
-            QTimer::singleShot(10, this, [this]() {
-                emit modelTreeLoaded(false, "STEP模型树加载失败", nullptr);
-            });
+            emit modelTreeLoaded(false, "STEP模型树加载失败", nullptr);
         }
 
     } catch (const std::exception& e) {
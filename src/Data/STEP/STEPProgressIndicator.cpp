@@ -0,0 +1,49 @@
+#include "STEPProgressIndicator.h"
+
+#include <cmath>
+
+STEPProgressIndicator::STEPProgressIndicator(Callback callback)
+    : m_callback(std::move(callback))
+    , m_lastPercent(-1)
+    , m_cancelRequested(false)
+{
+}
+
+void STEPProgressIndicator::setStage(const QString& stage)
+{
+    m_stage = stage;
+    if (m_callback) {
+        m_callback(m_lastPercent < 0 ? 0 : m_lastPercent, m_stage);
+    }
+}
+
+void STEPProgressIndicator::Reset()
+{
+    Message_ProgressIndicator::Reset();
+    m_lastPercent = -1;
+    m_cancelRequested = false;
+}
+
+Standard_Boolean STEPProgressIndicator::UserBreak()
+{
+    if (m_cancelRequested) {
+        return Standard_True;
+    }
+    return m_watchedThread && m_watchedThread->isInterruptionRequested();
+}
+
+void STEPProgressIndicator::Show(const Message_ProgressScope& theScope, const Standard_Boolean isForce)
+{
+    Q_UNUSED(theScope)
+    
+    // OCCT调用非常频繁，只在百分比变化时回调
+    int percent = static_cast<int>(std::floor(GetPosition() * 100.0));
+    if (percent == m_lastPercent && !isForce) {
+        return;
+    }
+    m_lastPercent = percent;
+    
+    if (m_callback) {
+        m_callback(percent, m_stage);
+    }
+}
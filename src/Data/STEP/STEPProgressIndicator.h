@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QString>
+#include <QPointer>
+#include <QThread>
+#include <atomic>
+#include <functional>
+
+// OpenCASCADE includes
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressScope.hxx>
+#include <Message_ProgressRange.hxx>
+
+/**
+ * @brief STEP加载进度指示器
+ * 
+ * 接入OpenCASCADE的进度机制，使ReadFile/Transfer/网格化能够报告真实进度。
+ * UI线程调用requestCancel()后，OCCT在下一次检查UserBreak()时中止当前操作。
+ */
+class STEPProgressIndicator : public Message_ProgressIndicator {
+    DEFINE_STANDARD_RTTI_INLINE(STEPProgressIndicator, Message_ProgressIndicator)
+
+public:
+    /**
+     * @brief 进度回调（在加载线程中调用）
+     * @param percent 总进度百分比 (0-100)
+     * @param stage 当前阶段描述
+     */
+    using Callback = std::function<void(int percent, const QString& stage)>;
+
+    explicit STEPProgressIndicator(Callback callback = Callback());
+
+    /**
+     * @brief 设置当前阶段描述，随后的进度回调会携带该描述
+     */
+    void setStage(const QString& stage);
+
+    /**
+     * @brief 请求取消（线程安全，可从UI线程直接调用）
+     */
+    void requestCancel() { m_cancelRequested = true; }
+
+    /**
+     * @brief 是否已请求取消
+     */
+    bool isCancelRequested() const { return m_cancelRequested; }
+
+    /**
+     * @brief 同时监视线程的中断请求（QThread::requestInterruption）
+     */
+    void watchThreadInterruption(QThread* thread) { m_watchedThread = thread; }
+
+    /**
+     * @brief 重置进度和取消状态，开始新的加载前调用
+     */
+    void Reset() override;
+
+    Standard_Boolean UserBreak() override;
+
+protected:
+    void Show(const Message_ProgressScope& theScope, const Standard_Boolean isForce) override;
+
+private:
+    Callback m_callback;
+    QString m_stage;
+    int m_lastPercent;
+    std::atomic<bool> m_cancelRequested;
+    QPointer<QThread> m_watchedThread;
+};
+
+DEFINE_STANDARD_HANDLE(STEPProgressIndicator, Message_ProgressIndicator)
@@ -0,0 +1,712 @@
+#include "WorkpieceFeatureExtractor.h"
+#include "STEPImportEngine.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QtMath>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+// VTK includes
+#include <vtkTriangleFilter.h>
+#include <vtkCleanPolyData.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkMath.h>
+#include <vtkSTLReader.h>
+#include <vtkOBJReader.h>
+#include <vtkPLYReader.h>
+
+// OpenCASCADE includes
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepGProp.hxx>
+#include <BRepLProp_SLProps.hxx>
+#include <BRepOffset_Analyse.hxx>
+#include <BRepTools.hxx>
+#include <Bnd_OBB.hxx>
+#include <GProp_GProps.hxx>
+#include <OSD_Parallel.hxx>
+#include <Precision.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+
+namespace {
+
+/**
+ * @brief 并查集，用于把由凹边连接的面合并为凹区域
+ */
+class UnionFind {
+public:
+    explicit UnionFind(int size) : m_parent(size) { std::iota(m_parent.begin(), m_parent.end(), 0); }
+
+    int find(int i)
+    {
+        while (m_parent[i] != i) {
+            m_parent[i] = m_parent[m_parent[i]];
+            i = m_parent[i];
+        }
+        return i;
+    }
+
+    void unite(int a, int b) { m_parent[find(a)] = find(b); }
+
+private:
+    std::vector<int> m_parent;
+};
+
+/**
+ * @brief 统计面积足够大的凹区域数
+ * @param isConcave 每个面/三角形是否与凹边相邻
+ */
+int countConcaveRegions(UnionFind& regions, const std::vector<char>& isConcave,
+                        const std::vector<double>& areas, double minArea)
+{
+    std::unordered_map<int, double> regionAreas;
+    for (size_t i = 0; i < isConcave.size(); ++i) {
+        if (isConcave[i]) {
+            regionAreas[regions.find(static_cast<int>(i))] += areas[i];
+        }
+    }
+
+    int count = 0;
+    for (const auto& region : regionAreas) {
+        if (region.second >= minArea) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 写入OBB，三个轴按尺寸从大到小排列
+ */
+void setOrientedBox(Data::WorkpieceGeometryFeatures& features, const double center[3],
+                    const double axes[3][3], const double sizes[3])
+{
+    std::array<int, 3> order = {0, 1, 2};
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return sizes[a] > sizes[b]; });
+
+    auto axis = [&](int i) { return QVector3D(axes[i][0], axes[i][1], axes[i][2]); };
+    features.obbCenter = QVector3D(center[0], center[1], center[2]);
+    features.obbAxisX = axis(order[0]);
+    features.obbAxisY = axis(order[1]);
+    features.obbAxisZ = axis(order[2]);
+    features.obbSize = QVector3D(sizes[order[0]], sizes[order[1]], sizes[order[2]]);
+}
+
+/**
+ * @brief 曲率样本：曲率和所代表的面积
+ */
+struct CurvatureSample {
+    double curvature;
+    double area;
+};
+
+/**
+ * @brief 由曲率样本生成按面积归一化的直方图
+ *
+ * 第0个区间为平面 [0, flatLimit)，其余区间等宽覆盖 [flatLimit, 面积加权分位数处的曲率]，
+ * 宽度由数据范围确定：小圆角等高曲率区域按实际分布展开，而不是全部落入最后一个区间；
+ * 超过分位数的少量离群值（退化三角形、尖点）计入最后一个区间。
+ */
+void buildCurvatureHistogram(std::vector<CurvatureSample>& samples, double flatLimit,
+                             const WorkpieceFeatureExtractor::Options& options,
+                             Data::WorkpieceGeometryFeatures& features)
+{
+    const int bins = std::max(1, options.curvatureBins);
+    double total = 0.0;
+    for (const CurvatureSample& sample : samples) {
+        total += sample.area;
+    }
+
+    // 面积加权分位数作为直方图上限
+    std::sort(samples.begin(), samples.end(),
+              [](const CurvatureSample& a, const CurvatureSample& b) { return a.curvature < b.curvature; });
+    double upper = 0.0;
+    double accumulated = 0.0;
+    const double target = std::clamp(options.curvatureRangeQuantile, 0.0, 1.0) * total;
+    for (const CurvatureSample& sample : samples) {
+        accumulated += sample.area;
+        upper = sample.curvature;
+        if (accumulated >= target) {
+            break;
+        }
+    }
+
+    // 曲面都接近平面时退化为以flatLimit为宽度的等宽区间
+    const double binWidth = (bins > 1 && upper > flatLimit) ? (upper - flatLimit) / (bins - 1) : flatLimit;
+
+    std::vector<double> histogram(bins, 0.0);
+    for (const CurvatureSample& sample : samples) {
+        int bin = 0;
+        if (sample.curvature > 0.0 && sample.curvature >= flatLimit && binWidth > 0.0) {
+            bin = std::min(1 + static_cast<int>((sample.curvature - flatLimit) / binWidth), bins - 1);
+        }
+        histogram[bin] += sample.area;
+    }
+    for (double value : histogram) {
+        features.curvatureHistogram.append(total > 0.0 ? value / total : 0.0);
+    }
+    features.curvatureFlatLimit = flatLimit;
+    features.curvatureBinWidth = binWidth;
+}
+
+/**
+ * @brief 在面的UV网格上采样主曲率，每个样本代表面积的1/(n·n)
+ */
+void sampleFaceCurvature(const TopoDS_Face& face, double area,
+                         const WorkpieceFeatureExtractor::Options& options,
+                         std::vector<CurvatureSample>& samples)
+{
+    BRepAdaptor_Surface surface(face);
+    if (surface.GetType() == GeomAbs_Plane) {
+        samples.push_back({0.0, area});
+        return;
+    }
+
+    double umin, umax, vmin, vmax;
+    BRepTools::UVBounds(face, umin, umax, vmin, vmax);
+
+    const int n = std::max(1, options.curvatureSamplesPerFace);
+    const double weight = area / (n * n);
+    BRepLProp_SLProps props(surface, 2, Precision::Confusion());
+
+    for (int iu = 0; iu < n; ++iu) {
+        const double u = umin + (iu + 0.5) / n * (umax - umin);
+        for (int iv = 0; iv < n; ++iv) {
+            const double v = vmin + (iv + 0.5) / n * (vmax - vmin);
+            props.SetParameters(u, v);
+
+            double curvature = 0.0;
+            if (props.IsCurvatureDefined()) {
+                curvature = std::max(std::abs(props.MaxCurvature()), std::abs(props.MinCurvature()));
+            }
+            samples.push_back({curvature, weight});
+        }
+    }
+}
+
+using Vec3 = std::array<double, 3>;
+
+Vec3 subtract(const Vec3& a, const Vec3& b) { return {a[0] - b[0], a[1] - b[1], a[2] - b[2]}; }
+
+/**
+ * @brief 网格边拓扑：每条边相邻的三角形
+ */
+struct MeshEdge {
+    int triangles[2] = {-1, -1};
+    int count = 0;
+};
+
+std::unordered_map<uint64_t, MeshEdge> buildEdges(const std::vector<std::array<vtkIdType, 3>>& triangles)
+{
+    std::unordered_map<uint64_t, MeshEdge> edges;
+    edges.reserve(triangles.size() * 2);
+    for (size_t t = 0; t < triangles.size(); ++t) {
+        for (int k = 0; k < 3; ++k) {
+            const uint64_t a = static_cast<uint64_t>(triangles[t][k]);
+            const uint64_t b = static_cast<uint64_t>(triangles[t][(k + 1) % 3]);
+            MeshEdge& edge = edges[(std::min(a, b) << 32) | std::max(a, b)];
+            if (edge.count < 2) {
+                edge.triangles[edge.count] = static_cast<int>(t);
+            }
+            edge.count++;
+        }
+    }
+    return edges;
+}
+
+std::vector<std::array<vtkIdType, 3>> collectTriangles(vtkPolyData* polyData)
+{
+    std::vector<std::array<vtkIdType, 3>> triangles;
+    vtkCellArray* polys = polyData->GetPolys();
+    triangles.reserve(polys->GetNumberOfCells());
+
+    vtkIdType npts = 0;
+    const vtkIdType* pts = nullptr;
+    for (polys->InitTraversal(); polys->GetNextCell(npts, pts);) {
+        if (npts == 3) {
+            triangles.push_back({pts[0], pts[1], pts[2]});
+        }
+    }
+    return triangles;
+}
+
+} // namespace
+
+Data::WorkpieceGeometryFeatures WorkpieceFeatureExtractor::fromShape(const TopoDS_Shape& shape,
+                                                                     const Options& options)
+{
+    Data::WorkpieceGeometryFeatures features;
+    if (shape.IsNull()) {
+        return features;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    try {
+        TopTools_IndexedMapOfShape faceMap;
+        TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
+        const int faceCount = faceMap.Extent();
+        if (faceCount == 0) {
+            qWarning() << "WorkpieceFeatureExtractor: 形状中没有面";
+            return features;
+        }
+
+        // 1. 有向包围盒（平面曲率阈值依赖对角线长度，需先计算）
+        Bnd_OBB obb;
+        BRepBndLib::AddOBB(shape, obb, Standard_True, Standard_False, Standard_False);
+        if (!obb.IsVoid()) {
+            const gp_XYZ& c = obb.Center();
+            const double center[3] = {c.X(), c.Y(), c.Z()};
+            const gp_XYZ& dx = obb.XDirection();
+            const gp_XYZ& dy = obb.YDirection();
+            const gp_XYZ& dz = obb.ZDirection();
+            const double axes[3][3] = {{dx.X(), dx.Y(), dx.Z()},
+                                       {dy.X(), dy.Y(), dy.Z()},
+                                       {dz.X(), dz.Y(), dz.Z()}};
+            const double sizes[3] = {2.0 * obb.XHSize(), 2.0 * obb.YHSize(), 2.0 * obb.ZHSize()};
+            setOrientedBox(features, center, axes, sizes);
+        }
+
+        const double diagonal = features.obbSize.length();
+        const double flatLimit = diagonal > 0.0 ? 1.0 / diagonal : 0.0;
+
+        // 2. 逐面并行计算面积和曲率采样
+        std::vector<double> faceAreas(faceCount, 0.0);
+        std::vector<std::vector<CurvatureSample>> faceSamples(faceCount);
+        OSD_Parallel::For(0, faceCount, [&](int i) {
+            try {
+                const TopoDS_Face& face = TopoDS::Face(faceMap(i + 1));
+                GProp_GProps props;
+                BRepGProp::SurfaceProperties(face, props);
+                faceAreas[i] = std::abs(props.Mass());
+                sampleFaceCurvature(face, faceAreas[i], options, faceSamples[i]);
+            } catch (const Standard_Failure&) {
+                faceSamples[i].clear();
+            }
+        });
+
+        std::vector<CurvatureSample> curvatureSamples;
+        for (int i = 0; i < faceCount; ++i) {
+            features.surfaceArea += faceAreas[i];
+            curvatureSamples.insert(curvatureSamples.end(), faceSamples[i].begin(), faceSamples[i].end());
+        }
+
+        // 3. 体积：按实体并行（逐面积分需要统一的参考点，因此以实体为单位）
+        std::vector<TopoDS_Shape> solids;
+        for (TopExp_Explorer exp(shape, TopAbs_SOLID); exp.More(); exp.Next()) {
+            solids.push_back(exp.Current());
+        }
+        std::vector<double> solidVolumes(solids.size(), 0.0);
+        OSD_Parallel::For(0, static_cast<int>(solids.size()), [&](int i) {
+            try {
+                GProp_GProps props;
+                BRepGProp::VolumeProperties(solids[i], props);
+                solidVolumes[i] = std::abs(props.Mass());
+            } catch (const Standard_Failure&) {
+                solidVolumes[i] = 0.0;
+            }
+        });
+        features.volume = std::accumulate(solidVolumes.begin(), solidVolumes.end(), 0.0);
+        features.closed = !solids.empty();
+
+        // 4. 凹区域：由凹边相连的面归为同一区域
+        BRepOffset_Analyse analyse(shape, qDegreesToRadians(options.concaveAngleDeg));
+        TopTools_IndexedDataMapOfShapeListOfShape edgeFaces;
+        TopExp::MapShapesAndAncestors(shape, TopAbs_EDGE, TopAbs_FACE, edgeFaces);
+
+        UnionFind regions(faceCount);
+        std::vector<char> concaveFaces(faceCount, 0);
+        for (int e = 1; e <= edgeFaces.Extent(); ++e) {
+            const TopoDS_Edge& edge = TopoDS::Edge(edgeFaces.FindKey(e));
+            const TopTools_ListOfShape& faces = edgeFaces(e);
+            if (faces.Extent() != 2 || BRep_Tool::Degenerated(edge) || faces.First().IsSame(faces.Last())) {
+                continue;
+            }
+
+            bool concave = false;
+            try {
+                for (BRepOffset_ListOfInterval::Iterator it(analyse.Type(edge)); it.More(); it.Next()) {
+                    if (it.Value().Type() == ChFiDS_Concave) {
+                        concave = true;
+                        break;
+                    }
+                }
+            } catch (const Standard_Failure&) {
+                continue;
+            }
+
+            if (concave) {
+                const int f1 = faceMap.FindIndex(faces.First()) - 1;
+                const int f2 = faceMap.FindIndex(faces.Last()) - 1;
+                if (f1 >= 0 && f2 >= 0) {
+                    regions.unite(f1, f2);
+                    concaveFaces[f1] = concaveFaces[f2] = 1;
+                }
+            }
+        }
+        features.concaveRegionCount = countConcaveRegions(
+            regions, concaveFaces, faceAreas, options.minConcaveRegionAreaRatio * features.surfaceArea);
+
+        // 5. 曲率直方图
+        buildCurvatureHistogram(curvatureSamples, flatLimit, options, features);
+        features.faceCount = faceCount;
+        features.source = "step";
+        features.valid = features.surfaceArea > 0.0;
+
+    } catch (const Standard_Failure& e) {
+        qCritical() << "WorkpieceFeatureExtractor: 形状特征计算失败:" << e.GetMessageString();
+        return Data::WorkpieceGeometryFeatures();
+    } catch (const std::exception& e) {
+        qCritical() << "WorkpieceFeatureExtractor: 形状特征计算失败:" << e.what();
+        return Data::WorkpieceGeometryFeatures();
+    }
+
+    features.computedAt = QDateTime::currentDateTime();
+    features.computeTimeMs = timer.nsecsElapsed() / 1.0e6;
+    qDebug() << "WorkpieceFeatureExtractor: 形状特征计算完成，面数:" << features.faceCount
+             << "面积:" << features.surfaceArea << "体积:" << features.volume
+             << "凹区域:" << features.concaveRegionCount << "耗时(ms):" << features.computeTimeMs;
+    return features;
+}
+
+Data::WorkpieceGeometryFeatures WorkpieceFeatureExtractor::fromMesh(vtkPolyData* mesh, const Options& options)
+{
+    Data::WorkpieceGeometryFeatures features;
+    if (!mesh || mesh->GetNumberOfCells() == 0) {
+        return features;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    try {
+        // 1. 三角化并合并重复点，使相邻三角形共享顶点
+        vtkSmartPointer<vtkTriangleFilter> triangleFilter = vtkSmartPointer<vtkTriangleFilter>::New();
+        triangleFilter->SetInputData(mesh);
+        triangleFilter->PassVertsOff();
+        triangleFilter->PassLinesOff();
+
+        vtkSmartPointer<vtkCleanPolyData> cleaner = vtkSmartPointer<vtkCleanPolyData>::New();
+        cleaner->SetInputConnection(triangleFilter->GetOutputPort());
+        cleaner->Update();
+
+        // 2. 统一三角形朝向（封闭网格朝外），凹凸判断和体积依赖一致的朝向。
+        //    不封闭或非流形的网格无法确定哪一侧朝外，不统计凹区域
+        bool closed = false;
+        {
+            const auto edges = buildEdges(collectTriangles(cleaner->GetOutput()));
+            closed = !edges.empty() && std::all_of(edges.begin(), edges.end(),
+                                                   [](const auto& edge) { return edge.second.count == 2; });
+        }
+
+        vtkSmartPointer<vtkPolyDataNormals> orienter = vtkSmartPointer<vtkPolyDataNormals>::New();
+        orienter->SetInputConnection(cleaner->GetOutputPort());
+        orienter->SplittingOff();
+        orienter->ConsistencyOn();
+        orienter->SetAutoOrientNormals(closed);
+        orienter->ComputePointNormalsOff();
+        orienter->ComputeCellNormalsOff();
+        orienter->Update();
+
+        vtkPolyData* oriented = orienter->GetOutput();
+        const std::vector<std::array<vtkIdType, 3>> triangles = collectTriangles(oriented);
+        const int triangleCount = static_cast<int>(triangles.size());
+        vtkPoints* meshPoints = oriented->GetPoints();
+        if (triangleCount == 0 || !meshPoints) {
+            qWarning() << "WorkpieceFeatureExtractor: 网格中没有三角形";
+            return features;
+        }
+
+        std::vector<Vec3> points(meshPoints->GetNumberOfPoints());
+        for (vtkIdType i = 0; i < meshPoints->GetNumberOfPoints(); ++i) {
+            meshPoints->GetPoint(i, points[i].data());
+        }
+
+        // 3. 逐三角形并行计算面积、法向、重心和有向体积
+        std::vector<double> areas(triangleCount, 0.0);
+        std::vector<double> signedVolumes(triangleCount, 0.0);
+        std::vector<Vec3> normals(triangleCount);
+        std::vector<Vec3> centroids(triangleCount);
+        OSD_Parallel::For(0, triangleCount, [&](int t) {
+            const Vec3& p0 = points[triangles[t][0]];
+            const Vec3& p1 = points[triangles[t][1]];
+            const Vec3& p2 = points[triangles[t][2]];
+            Vec3 e1 = subtract(p1, p0);
+            Vec3 e2 = subtract(p2, p0);
+            Vec3 n;
+            vtkMath::Cross(e1.data(), e2.data(), n.data());
+            const double doubleArea = vtkMath::Norm(n.data());
+            areas[t] = 0.5 * doubleArea;
+            if (doubleArea > 0.0) {
+                for (double& c : n) {
+                    c /= doubleArea;
+                }
+            }
+            normals[t] = n;
+
+            Vec3 cross;
+            vtkMath::Cross(p1.data(), p2.data(), cross.data());
+            signedVolumes[t] = vtkMath::Dot(p0.data(), cross.data()) / 6.0;
+
+            for (int k = 0; k < 3; ++k) {
+                centroids[t][k] = (p0[k] + p1[k] + p2[k]) / 3.0;
+            }
+        });
+
+        features.surfaceArea = std::accumulate(areas.begin(), areas.end(), 0.0);
+        features.closed = closed;
+        features.volume = closed ? std::abs(std::accumulate(signedVolumes.begin(), signedVolumes.end(), 0.0)) : 0.0;
+
+        // 4. 主成分分析得到有向包围盒
+        double mean[3] = {0.0, 0.0, 0.0};
+        for (const Vec3& p : points) {
+            for (int k = 0; k < 3; ++k) {
+                mean[k] += p[k];
+            }
+        }
+        for (double& m : mean) {
+            m /= static_cast<double>(points.size());
+        }
+
+        double covariance[3][3] = {{0.0}};
+        for (const Vec3& p : points) {
+            const double d[3] = {p[0] - mean[0], p[1] - mean[1], p[2] - mean[2]};
+            for (int r = 0; r < 3; ++r) {
+                for (int c = 0; c < 3; ++c) {
+                    covariance[r][c] += d[r] * d[c];
+                }
+            }
+        }
+
+        double eigenvalues[3];
+        double eigenvectors[3][3];
+        vtkMath::Jacobi3x3(covariance, eigenvalues, eigenvectors);
+
+        double axes[3][3];
+        double minProj[3] = {VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, VTK_DOUBLE_MAX};
+        double maxProj[3] = {-VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX};
+        for (int a = 0; a < 3; ++a) {
+            // 特征向量按列存放
+            for (int k = 0; k < 3; ++k) {
+                axes[a][k] = eigenvectors[k][a];
+            }
+        }
+        for (const Vec3& p : points) {
+            const double d[3] = {p[0] - mean[0], p[1] - mean[1], p[2] - mean[2]};
+            for (int a = 0; a < 3; ++a) {
+                const double proj = vtkMath::Dot(d, axes[a]);
+                minProj[a] = std::min(minProj[a], proj);
+                maxProj[a] = std::max(maxProj[a], proj);
+            }
+        }
+
+        double center[3] = {mean[0], mean[1], mean[2]};
+        double sizes[3];
+        for (int a = 0; a < 3; ++a) {
+            sizes[a] = maxProj[a] - minProj[a];
+            const double offset = 0.5 * (maxProj[a] + minProj[a]);
+            for (int k = 0; k < 3; ++k) {
+                center[k] += offset * axes[a][k];
+            }
+        }
+        setOrientedBox(features, center, axes, sizes);
+
+        // 5. 逐边计算离散曲率（二面角/重心距离）并判断凹边
+        const auto edgeMap = buildEdges(triangles);
+        std::vector<const MeshEdge*> interiorEdges;
+        interiorEdges.reserve(edgeMap.size());
+        for (const auto& edge : edgeMap) {
+            if (edge.second.count == 2) {
+                interiorEdges.push_back(&edge.second);
+            }
+        }
+
+        const double concaveCos = std::cos(qDegreesToRadians(options.concaveAngleDeg));
+        const int edgeCount = static_cast<int>(interiorEdges.size());
+        std::vector<double> edgeCurvatures(edgeCount, 0.0);
+        std::vector<char> concaveEdges(edgeCount, 0);
+        OSD_Parallel::For(0, edgeCount, [&](int e) {
+            const int t1 = interiorEdges[e]->triangles[0];
+            const int t2 = interiorEdges[e]->triangles[1];
+            const double cosAngle = std::clamp(vtkMath::Dot(normals[t1].data(), normals[t2].data()), -1.0, 1.0);
+            const Vec3 d = subtract(centroids[t2], centroids[t1]);
+            const double distance = vtkMath::Norm(d.data());
+            if (distance > 0.0) {
+                edgeCurvatures[e] = std::acos(cosAngle) / distance;
+            }
+
+            // 朝外法向下，相邻三角形的重心互相位于对方平面之上即为凹边
+            if (closed && cosAngle < concaveCos &&
+                vtkMath::Dot(d.data(), normals[t1].data()) > 0.0 &&
+                vtkMath::Dot(d.data(), normals[t2].data()) < 0.0) {
+                concaveEdges[e] = 1;
+            }
+        });
+
+        std::vector<double> triangleCurvatures(triangleCount, 0.0);
+        UnionFind regions(triangleCount);
+        std::vector<char> concaveTriangles(triangleCount, 0);
+        for (int e = 0; e < edgeCount; ++e) {
+            const int t1 = interiorEdges[e]->triangles[0];
+            const int t2 = interiorEdges[e]->triangles[1];
+            triangleCurvatures[t1] = std::max(triangleCurvatures[t1], edgeCurvatures[e]);
+            triangleCurvatures[t2] = std::max(triangleCurvatures[t2], edgeCurvatures[e]);
+            if (concaveEdges[e]) {
+                regions.unite(t1, t2);
+                concaveTriangles[t1] = concaveTriangles[t2] = 1;
+            }
+        }
+
+        const double diagonal = features.obbSize.length();
+        std::vector<CurvatureSample> curvatureSamples(triangleCount);
+        for (int t = 0; t < triangleCount; ++t) {
+            curvatureSamples[t] = {triangleCurvatures[t], areas[t]};
+        }
+        buildCurvatureHistogram(curvatureSamples, diagonal > 0.0 ? 1.0 / diagonal : 0.0, options, features);
+
+        if (!closed) {
+            qDebug() << "WorkpieceFeatureExtractor: 网格不封闭或非流形，三角形朝向不确定，不统计凹区域";
+        }
+        features.concaveRegionCount = countConcaveRegions(
+            regions, concaveTriangles, areas, options.minConcaveRegionAreaRatio * features.surfaceArea);
+        features.faceCount = triangleCount;
+        features.source = "mesh";
+        features.valid = features.surfaceArea > 0.0;
+
+    } catch (const std::exception& e) {
+        qCritical() << "WorkpieceFeatureExtractor: 网格特征计算失败:" << e.what();
+        return Data::WorkpieceGeometryFeatures();
+    }
+
+    features.computedAt = QDateTime::currentDateTime();
+    features.computeTimeMs = timer.nsecsElapsed() / 1.0e6;
+    qDebug() << "WorkpieceFeatureExtractor: 网格特征计算完成，三角形数:" << features.faceCount
+             << "面积:" << features.surfaceArea << "体积:" << features.volume
+             << "凹区域:" << features.concaveRegionCount << "耗时(ms):" << features.computeTimeMs;
+    return features;
+}
+
+bool WorkpieceFeatureExtractor::extract(Data::WorkpieceData* workpiece, bool force, const Options& options)
+{
+    if (!workpiece) {
+        return false;
+    }
+
+    const QString filePath = workpiece->modelFilePath();
+    const QString key = sourceKey(filePath);
+    if (key.isEmpty()) {
+        qWarning() << "WorkpieceFeatureExtractor: 模型文件不存在:" << filePath;
+        return false;
+    }
+
+    if (!force && workpiece->hasGeometryFeatures() && workpiece->geometryFeatures().sourceKey == key) {
+        qDebug() << "WorkpieceFeatureExtractor: 使用缓存的几何特征:" << workpiece->getDisplayName();
+        return true;
+    }
+
+    Data::WorkpieceGeometryFeatures features;
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "step" || suffix == "stp") {
+        features = fromShape(readShape(filePath), options);
+    } else if (suffix == "stl" || suffix == "obj" || suffix == "ply") {
+        features = fromMesh(readMesh(filePath), options);
+    } else {
+        qWarning() << "WorkpieceFeatureExtractor: 不支持的模型格式:" << suffix;
+        return false;
+    }
+
+    if (!features.valid) {
+        qWarning() << "WorkpieceFeatureExtractor: 几何特征计算失败:" << filePath;
+        return false;
+    }
+
+    features.sourceKey = key;
+    workpiece->setGeometryFeatures(features);
+    return true;
+}
+
+QString WorkpieceFeatureExtractor::sourceKey(const QString& filePath)
+{
+    QFileInfo fileInfo(filePath);
+    if (filePath.isEmpty() || !fileInfo.exists()) {
+        return QString();
+    }
+    return QString("%1|%2|%3").arg(fileInfo.canonicalFilePath())
+                              .arg(fileInfo.size())
+                              .arg(fileInfo.lastModified().toMSecsSinceEpoch());
+}
+
+vtkSmartPointer<vtkPolyData> WorkpieceFeatureExtractor::readMesh(const QString& filePath)
+{
+    const QByteArray fileName = QFile::encodeName(filePath);
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+
+    vtkSmartPointer<vtkPolyDataAlgorithm> reader;
+    if (suffix == "stl") {
+        vtkSmartPointer<vtkSTLReader> stlReader = vtkSmartPointer<vtkSTLReader>::New();
+        stlReader->SetFileName(fileName.constData());
+        reader = stlReader;
+    } else if (suffix == "obj") {
+        vtkSmartPointer<vtkOBJReader> objReader = vtkSmartPointer<vtkOBJReader>::New();
+        objReader->SetFileName(fileName.constData());
+        reader = objReader;
+    } else if (suffix == "ply") {
+        vtkSmartPointer<vtkPLYReader> plyReader = vtkSmartPointer<vtkPLYReader>::New();
+        plyReader->SetFileName(fileName.constData());
+        reader = plyReader;
+    } else {
+        return nullptr;
+    }
+
+    reader->Update();
+    vtkPolyData* output = reader->GetOutput();
+    if (!output || output->GetNumberOfCells() == 0) {
+        qWarning() << "WorkpieceFeatureExtractor: 网格读取失败:" << filePath;
+        return nullptr;
+    }
+    return output;
+}
+
+TopoDS_Shape WorkpieceFeatureExtractor::readShape(const QString& filePath)
+{
+    QString errorMessage;
+    STEPImportResultPtr imported = STEPImportEngine::instance()->import(
+        filePath, Handle(STEPProgressIndicator)(), Message_ProgressRange(), &errorMessage);
+    if (!imported) {
+        qWarning() << "WorkpieceFeatureExtractor: STEP导入失败:" << errorMessage;
+        return TopoDS_Shape();
+    }
+
+    // 所有顶层形状组成一个复合体
+    BRep_Builder builder;
+    TopoDS_Compound compound;
+    builder.MakeCompound(compound);
+    for (Standard_Integer i = 1; i <= imported->freeShapes.Length(); ++i) {
+        TopoDS_Shape shape = imported->shapeTool->GetShape(imported->freeShapes.Value(i));
+        if (!shape.IsNull()) {
+            builder.Add(compound, shape);
+        }
+    }
+    return compound;
+}
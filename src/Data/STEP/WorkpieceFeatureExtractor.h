@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QString>
+
+#include "../Models/WorkpieceData.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+// OpenCASCADE includes
+#include <TopoDS_Shape.hxx>
+
+/**
+ * @brief 工件几何特征提取
+ *
+ * 从STEP形状或重建网格计算表面积、体积、有向包围盒、曲率直方图和凹区域数，
+ * 结果写入WorkpieceData并随工件缓存，供批次调度使用。
+ * 网格不封闭或有非流形边时三角形朝向无法确定内外，凹区域数记为0。
+ *
+ * fromShape/fromMesh 可在任意线程调用（逐面计算使用OSD_Parallel并行），
+ * extract 会修改工件对象，需在工件所属线程调用。
+ */
+class WorkpieceFeatureExtractor {
+public:
+    struct Options {
+        int curvatureBins = 32;                 // 曲率直方图区间数（第0个区间为平面，其余等分曲率分布范围）
+        double curvatureRangeQuantile = 0.99;   // 直方图上限取面积加权的曲率分位数，排除离群值
+        int curvatureSamplesPerFace = 5;        // 每个B-Rep面在UV方向上的采样数
+        double concaveAngleDeg = 10.0;          // 二面角超过此值的凹边才计入凹区域
+        double minConcaveRegionAreaRatio = 0.001; // 面积占比低于此值的凹区域视为噪声
+    };
+
+    /**
+     * @brief 从B-Rep形状计算特征
+     * @param shape 形状（装配体为所有顶层形状的复合体）
+     * @param options 计算参数
+     */
+    static Data::WorkpieceGeometryFeatures fromShape(const TopoDS_Shape& shape,
+                                                     const Options& options = Options());
+
+    /**
+     * @brief 从网格计算特征（扫描重建网格或STL/OBJ/PLY）
+     * @param mesh 多边形网格，非三角形面会先三角化
+     * @param options 计算参数
+     */
+    static Data::WorkpieceGeometryFeatures fromMesh(vtkPolyData* mesh,
+                                                    const Options& options = Options());
+
+    /**
+     * @brief 为工件提取特征
+     *
+     * 工件已有与模型文件一致的缓存特征时直接返回，否则读取模型文件重新计算。
+     * 支持 step/stp（经STEPImportEngine共享导入）和 stl/obj/ply。
+     * @param workpiece 工件
+     * @param force 忽略缓存强制重新计算
+     * @return 是否得到有效特征
+     */
+    static bool extract(Data::WorkpieceData* workpiece, bool force = false,
+                        const Options& options = Options());
+
+    /**
+     * @brief 模型文件标识（规范路径+大小+修改时间），用于判断缓存特征是否过期
+     */
+    static QString sourceKey(const QString& filePath);
+
+private:
+    static vtkSmartPointer<vtkPolyData> readMesh(const QString& filePath);
+    static TopoDS_Shape readShape(const QString& filePath);
+};
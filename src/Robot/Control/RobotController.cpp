@@ -9,6 +9,9 @@ RobotController::RobotController(QObject* parent)
     , m_kinematics(std::make_unique<RobotKinematics>(this))
     , m_tcpClient(std::make_unique<MotoTcpClient>(this))
     , m_stateUpdateTimer(new QTimer(this))
+    , m_motionTimer(new QTimer(this))
+    , m_motionStart{0, 0, 0, 0, 0, 0}
+    , m_motionTarget{0, 0, 0, 0, 0, 0}
     , m_robotPort(10040)
 {
     initConnections();
@@ -17,6 +20,10 @@ RobotController::RobotController(QObject* parent)
     m_stateUpdateTimer->setInterval(100);
     connect(m_stateUpdateTimer, &QTimer::timeout, this, &RobotController::updateRobotState);
     
+    // 仿真运动插补定时器 (20ms)
+    m_motionTimer->setInterval(20);
+    connect(m_motionTimer, &QTimer::timeout, this, &RobotController::updateMotion);
+    
     qDebug() << "RobotController: 初始化完成";
 }
 
@@ -28,10 +35,8 @@ RobotController::~RobotController()
 void RobotController::initConnections()
 {
     // 连接运动学信号
-    connect(m_kinematics.get(), &RobotKinematics::jointAngleChanged,
-            this, &RobotController::onKinematicsJointChanged);
-    connect(m_kinematics.get(), &RobotKinematics::endEffectorPoseChanged,
-            this, &RobotController::onKinematicsPoseChanged);
+    connect(m_kinematics.get(), &RobotKinematics::jointStateChanged,
+            this, &RobotController::onKinematicsStateChanged);
     
     // 连接TCP客户端信号
     connect(m_tcpClient.get(), &MotoTcpClient::connected,
@@ -97,6 +102,12 @@ void RobotController::setOperationMode(OperationMode mode)
         return;
     }
     
+    // 仿真插补不能延续到真实机器人
+    if (m_motionTimer->isActive()) {
+        m_motionTimer->stop();
+        m_state.isMoving = false;
+    }
+    
     m_state.operationMode = mode;
     emit operationModeChanged(mode);
     
@@ -175,15 +186,29 @@ void RobotController::moveToPose(const EndEffectorPose& pose, double speed)
 
 void RobotController::moveToJointAngles(const std::array<double, 6>& angles, double speed)
 {
-    Q_UNUSED(speed)
-    
     m_state.isMoving = true;
     
-    // 在仿真模式下直接设置角度
+    // 在仿真模式下按速度曲线插补
     if (isSimulationMode()) {
-        setJointAngles(angles);
-        m_state.isMoving = false;
-        emit motionCompleted();
+        TimeParameterization::Options options;
+        options.velocityScale = qBound(0.01, speed / 100.0, 1.0);
+        TimeParameterization timing(*m_kinematics);
+        timing.setOptions(options);
+        
+        m_motionStart = m_kinematics->getJointAngles();
+        m_motionTarget = angles;
+        m_motionProfile = timing.restToRest(m_motionStart.data(), m_motionTarget.data());
+        if (!m_motionProfile.success || m_motionProfile.duration <= 0.0) {
+            m_motionTimer->stop();
+            setJointAngles(angles);
+            m_state.isMoving = false;
+            emit motionCompleted();
+            return;
+        }
+        
+        qDebug() << "RobotController: 点到点运动，速度" << speed << "%，预计耗时" << m_motionProfile.duration << "秒";
+        m_motionClock.start();
+        m_motionTimer->start();
     } else {
         // 发送运动命令到真实机器人
         sendJointCommand(angles);
@@ -193,6 +218,7 @@ void RobotController::moveToJointAngles(const std::array<double, 6>& angles, dou
 void RobotController::stopMotion()
 {
     m_state.isMoving = false;
+    m_motionTimer->stop();
     
     if (isConnected() && !isSimulationMode()) {
         // 发送停止命令
@@ -311,15 +337,12 @@ void RobotController::onTcpDataReceived(const QByteArray& data)
     parseRobotResponse(data);
 }
 
-void RobotController::onKinematicsJointChanged(int jointIndex, double angle)
-{
-    m_state.jointAngles[jointIndex] = angle;
-    emit jointAnglesChanged(m_state.jointAngles);
-}
-
-void RobotController::onKinematicsPoseChanged(const EndEffectorPose& pose)
+void RobotController::onKinematicsStateChanged(const std::array<double, 6>& angles, const EndEffectorPose& pose)
 {
+    // 运动学模型每次状态更新只通知一次，这里各转发一次
+    m_state.jointAngles = angles;
     m_state.endEffectorPose = pose;
+    emit jointAnglesChanged(m_state.jointAngles);
     emit endEffectorPoseChanged(pose);
 }
 
@@ -335,6 +358,23 @@ void RobotController::updateRobotState()
     emit robotStateChanged(m_state);
 }
 
+void RobotController::updateMotion()
+{
+    const double t = m_motionClock.nsecsElapsed() * 1e-9;
+    const double f = m_motionProfile.fraction(t);
+    std::array<double, 6> angles;
+    for (int j = 0; j < 6; ++j) {
+        angles[j] = m_motionStart[j] + f * (m_motionTarget[j] - m_motionStart[j]);
+    }
+    setJointAngles(angles);
+    
+    if (t >= m_motionProfile.duration) {
+        m_motionTimer->stop();
+        m_state.isMoving = false;
+        emit motionCompleted();
+    }
+}
+
 // ========== 私有函数 ==========
 
 void RobotController::sendJointCommand(const std::array<double, 6>& angles)
@@ -363,12 +403,13 @@ void RobotController::parseRobotResponse(const QByteArray& data)
     if (response.startsWith("RPOSJ")) {
         QStringList parts = response.mid(6).split(',');
         if (parts.size() >= 6) {
+            std::array<double, 6> angles;
             for (int i = 0; i < 6; ++i) {
-                m_state.jointAngles[i] = parts[i].toDouble();
+                angles[i] = parts[i].toDouble();
             }
             
-            // 更新运动学模型
-            m_kinematics->setJointAngles(m_state.jointAngles);
+            // 更新运动学模型，状态经onKinematicsStateChanged同步（角度未变时不发信号）
+            m_kinematics->setJointAngles(angles);
         }
     }
     // 解析其他响应...
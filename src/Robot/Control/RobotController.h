@@ -3,8 +3,10 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <memory>
 #include "../Kinematics/RobotKinematics.h"
+#include "../Kinematics/TimeParameterization.h"
 
 namespace Robot {
 
@@ -144,6 +146,9 @@ public:
 
     /**
      * @brief 移动到目标关节角度
+     * 
+     * 仿真模式下按关节速度、加速度限位（乘以速度百分比）的梯形速度曲线插补，
+     * 到达后发出motionCompleted。
      * @param angles 目标关节角度
      * @param speed 速度百分比 (0-100)
      */
@@ -234,9 +239,9 @@ private slots:
     void onTcpDisconnected();
     void onTcpError(const QString& error);
     void onTcpDataReceived(const QByteArray& data);
-    void onKinematicsJointChanged(int jointIndex, double angle);
-    void onKinematicsPoseChanged(const EndEffectorPose& pose);
+    void onKinematicsStateChanged(const std::array<double, 6>& angles, const EndEffectorPose& pose);
     void updateRobotState();
+    void updateMotion();
 
 private:
     void initConnections();
@@ -250,6 +255,13 @@ private:
     RobotState m_state;
     QTimer* m_stateUpdateTimer;
     
+    // 仿真模式下的点到点运动
+    QTimer* m_motionTimer;
+    QElapsedTimer m_motionClock;
+    TimeParameterization::RestToRest m_motionProfile;
+    std::array<double, 6> m_motionStart;
+    std::array<double, 6> m_motionTarget;
+    
     QString m_robotIp;
     int m_robotPort;
 };
@@ -0,0 +1,243 @@
+#include "BatchForwardKinematics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace Robot {
+
+namespace {
+
+const size_t kParallelBlock = 2048;     // 每次领取的构型数（kLanes的整数倍）
+
+const double kDegToRad = M_PI / 180.0;
+
+/**
+ * @brief 同时求正弦和余弦
+ *
+ * 按π/2做Cody-Waite约化后用fdlibm的极小化多项式逼近，象限选择无分支，
+ * 在按构型展开的循环中可以向量化（std::sin/std::cos是库函数调用，无法向量化）。
+ * |x| < 1e5时误差在几个ulp以内，关节角远小于该范围。
+ */
+inline void sinCos(double x, double& s, double& c)
+{
+    const double kTwoOverPi = 6.36619772367581382433e-01;
+    const double kPiOver2Hi = 1.57079632673412561417e+00;
+    const double kPiOver2Lo = 6.07710050650619224932e-11;
+    const double kRoundMagic = 6755399441055744.0;      // 1.5·2^52，加减后按当前舍入模式取整
+
+    const double k = (x * kTwoOverPi + kRoundMagic) - kRoundMagic;
+    const int quadrant = static_cast<int>(k) & 3;
+    const double r = (x - k * kPiOver2Hi) - k * kPiOver2Lo;
+    const double z = r * r;
+
+    const double sinR = r + r * z * (-1.66666666666666324348e-01
+                      + z * (8.33333333332248946124e-03
+                      + z * (-1.98412698298579493134e-04
+                      + z * (2.75573137070700676789e-06
+                      + z * (-2.50507602534068634195e-08
+                      + z * 1.58969099521155010221e-10)))));
+    const double cosR = 1.0 - 0.5 * z + z * z * (4.16666666666666019037e-02
+                      + z * (-1.38888888888741095749e-03
+                      + z * (2.48015872894767294178e-05
+                      + z * (-2.75573143513906633035e-07
+                      + z * (2.08757232129817482790e-09
+                      + z * -1.13596475577881948265e-11)))));
+
+    // 象限: sin = {s, c, -s, -c}, cos = {c, -s, -c, s}
+    const double sinAbs = (quadrant & 1) ? cosR : sinR;
+    const double cosAbs = (quadrant & 1) ? sinR : cosR;
+    s = (quadrant & 2) ? -sinAbs : sinAbs;
+    c = ((quadrant + 1) & 2) ? -cosAbs : cosAbs;
+}
+
+inline void storeMatrix(const double t[12][BatchForwardKinematics::kLanes], size_t lane, LinkMatrix& out)
+{
+    for (int e = 0; e < 12; ++e) {
+        out[e] = t[e][lane];
+    }
+    out[12] = 0.0;
+    out[13] = 0.0;
+    out[14] = 0.0;
+    out[15] = 1.0;
+}
+
+} // namespace
+
+void JointBatch::resize(size_t count)
+{
+    for (auto& joint : angles) {
+        joint.resize(count);
+    }
+}
+
+void JointBatch::reserve(size_t count)
+{
+    for (auto& joint : angles) {
+        joint.reserve(count);
+    }
+}
+
+void JointBatch::set(size_t index, const std::array<double, RobotKinematics::NUM_JOINTS>& joints)
+{
+    for (int j = 0; j < RobotKinematics::NUM_JOINTS; ++j) {
+        angles[j][index] = joints[j];
+    }
+}
+
+void JointBatch::append(const std::array<double, RobotKinematics::NUM_JOINTS>& joints)
+{
+    for (int j = 0; j < RobotKinematics::NUM_JOINTS; ++j) {
+        angles[j].push_back(joints[j]);
+    }
+}
+
+std::array<double, RobotKinematics::NUM_JOINTS> JointBatch::get(size_t index) const
+{
+    std::array<double, RobotKinematics::NUM_JOINTS> joints;
+    for (int j = 0; j < RobotKinematics::NUM_JOINTS; ++j) {
+        joints[j] = angles[j][index];
+    }
+    return joints;
+}
+
+BatchForwardKinematics::BatchForwardKinematics(const RobotKinematics& robot)
+    : m_threadCount(0)
+{
+    const auto& dhParams = robot.getDHParameters();
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        m_a[i] = dhParams[i].a;
+        m_d[i] = dhParams[i].d;
+        m_thetaOffset[i] = dhParams[i].theta;
+        m_cosAlpha[i] = std::cos(dhParams[i].alpha);
+        m_sinAlpha[i] = std::sin(dhParams[i].alpha);
+    }
+}
+
+void BatchForwardKinematics::compute(const double* const angles[NUM_JOINTS], size_t count,
+                                     LinkMatrix* tcp, LinkPoses* links) const
+{
+    if (count == 0 || (!tcp && !links)) {
+        return;
+    }
+
+    int workers = m_threadCount > 0 ? m_threadCount : static_cast<int>(std::thread::hardware_concurrency());
+    const size_t blocks = (count + kParallelBlock - 1) / kParallelBlock;
+    workers = static_cast<int>(std::max<size_t>(1, std::min<size_t>(std::max(1, workers), blocks)));
+    if (workers == 1) {
+        computeRange(angles, 0, count, tcp, links);
+        return;
+    }
+
+    // 按块动态领取，各线程写互不重叠的输出区间
+    std::atomic<size_t> next(0);
+    auto run = [&]() {
+        for (;;) {
+            const size_t begin = next.fetch_add(kParallelBlock);
+            if (begin >= count) {
+                break;
+            }
+            computeRange(angles, begin, std::min(count, begin + kParallelBlock), tcp, links);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (int w = 1; w < workers; ++w) {
+        threads.emplace_back(run);
+    }
+    run();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void BatchForwardKinematics::compute(const JointBatch& batch, LinkMatrix* tcp, LinkPoses* links) const
+{
+    const double* angles[NUM_JOINTS];
+    for (int j = 0; j < NUM_JOINTS; ++j) {
+        angles[j] = batch.angles[j].data();
+    }
+    compute(angles, batch.size(), tcp, links);
+}
+
+void BatchForwardKinematics::compute(const JointBatch& batch, std::vector<LinkMatrix>& tcp) const
+{
+    tcp.resize(batch.size());
+    compute(batch, tcp.data(), nullptr);
+}
+
+void BatchForwardKinematics::compute(const JointBatch& batch, std::vector<LinkMatrix>& tcp,
+                                     std::vector<LinkPoses>& links) const
+{
+    tcp.resize(batch.size());
+    links.resize(batch.size());
+    compute(batch, tcp.data(), links.data());
+}
+
+void BatchForwardKinematics::computeRange(const double* const angles[NUM_JOINTS], size_t begin, size_t end,
+                                          LinkMatrix* tcp, LinkPoses* links) const
+{
+    // t[e][l]: 第l个构型累积变换的第e个元素（上三行，行主序）
+    double t[12][kLanes];
+    double ct[kLanes];
+    double st[kLanes];
+    double theta[kLanes];
+
+    for (size_t base = begin; base < end; base += kLanes) {
+        const size_t lanes = std::min(kLanes, end - base);
+
+        for (int e = 0; e < 12; ++e) {
+            const double value = (e == 0 || e == 5 || e == 10) ? 1.0 : 0.0;
+            for (size_t l = 0; l < kLanes; ++l) {
+                t[e][l] = value;
+            }
+        }
+
+        for (int j = 0; j < NUM_JOINTS; ++j) {
+            // 末组不足kLanes时补0，组内循环始终定长
+            std::fill(theta, theta + kLanes, 0.0);
+            std::copy(angles[j] + base, angles[j] + base + lanes, theta);
+            const double offset = m_thetaOffset[j];
+            for (size_t l = 0; l < kLanes; ++l) {
+                sinCos(offset + theta[l] * kDegToRad, st[l], ct[l]);
+            }
+
+            // T = T·DH(j)，DH的列为 (ct, st, 0), (-st·ca, ct·ca, sa), (st·sa, -ct·sa, ca), (a·ct, a·st, d)
+            const double a = m_a[j];
+            const double d = m_d[j];
+            const double ca = m_cosAlpha[j];
+            const double sa = m_sinAlpha[j];
+            for (int r = 0; r < 3; ++r) {
+                double* r0 = t[r * 4 + 0];
+                double* r1 = t[r * 4 + 1];
+                double* r2 = t[r * 4 + 2];
+                double* r3 = t[r * 4 + 3];
+                for (size_t l = 0; l < kLanes; ++l) {
+                    const double u = r0[l] * ct[l] + r1[l] * st[l];
+                    const double v = r1[l] * ct[l] - r0[l] * st[l];
+                    const double w = r2[l];
+                    r0[l] = u;
+                    r1[l] = ca * v + sa * w;
+                    r2[l] = ca * w - sa * v;
+                    r3[l] += a * u + d * w;
+                }
+            }
+
+            if (links) {
+                for (size_t l = 0; l < lanes; ++l) {
+                    storeMatrix(t, l, links[base + l][j]);
+                }
+            }
+        }
+
+        if (tcp) {
+            for (size_t l = 0; l < lanes; ++l) {
+                storeMatrix(t, l, tcp[base + l]);
+            }
+        }
+    }
+}
+
+} // namespace Robot
@@ -0,0 +1,90 @@
+#ifndef BATCHFORWARDKINEMATICS_H
+#define BATCHFORWARDKINEMATICS_H
+
+#include "RobotKinematics.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace Robot {
+
+/**
+ * @brief 结构体数组(SoA)布局的关节角度批
+ *
+ * angles[j][i]为第i个构型的关节j角度 (度)，同一关节的角度连续存放，便于按构型向量化。
+ */
+struct JointBatch {
+    std::array<std::vector<double>, RobotKinematics::NUM_JOINTS> angles;
+
+    size_t size() const { return angles[0].size(); }
+    void resize(size_t count);
+    void reserve(size_t count);
+    void set(size_t index, const std::array<double, RobotKinematics::NUM_JOINTS>& joints);
+    void append(const std::array<double, RobotKinematics::NUM_JOINTS>& joints);
+    std::array<double, RobotKinematics::NUM_JOINTS> get(size_t index) const;
+};
+
+/**
+ * @brief 批量正运动学
+ *
+ * 面向仿真、碰撞扫掠、可达性地图等需要百万次正解的场景：
+ * - 构造时缓存DH参数及alpha的正余弦，计算中只剩关节角的正余弦
+ * - 每kLanes个构型一组，组内按构型展开为定长无分支循环（含正余弦），由编译器向量化
+ * - 多线程按块动态分配构型
+ *
+ * 结果与RobotKinematics::computeLinkPoses一致（双精度，行主序）。
+ * 计算不分配内存（线程除外），可在任意线程中调用。
+ */
+class BatchForwardKinematics
+{
+public:
+    static constexpr int NUM_JOINTS = RobotKinematics::NUM_JOINTS;
+    static constexpr size_t kLanes = 8;     // 每组同时计算的构型数
+
+    explicit BatchForwardKinematics(const RobotKinematics& robot);
+
+    /**
+     * @brief 设置线程数，0表示使用全部硬件线程，1为单线程
+     */
+    void setThreadCount(int threadCount) { m_threadCount = threadCount; }
+    int threadCount() const { return m_threadCount; }
+
+    /**
+     * @brief 批量正解
+     * @param angles angles[j]指向count个关节j角度 (度)
+     * @param count 构型数量
+     * @param tcp 输出count个末端（法兰）位姿，可为nullptr
+     * @param links 输出count组连杆位姿（同computeLinkPoses），可为nullptr
+     */
+    void compute(const double* const angles[NUM_JOINTS], size_t count,
+                 LinkMatrix* tcp, LinkPoses* links = nullptr) const;
+
+    void compute(const JointBatch& batch, LinkMatrix* tcp, LinkPoses* links = nullptr) const;
+
+    /**
+     * @brief 批量正解，只输出末端位姿
+     */
+    void compute(const JointBatch& batch, std::vector<LinkMatrix>& tcp) const;
+
+    /**
+     * @brief 批量正解，输出末端位姿和全部连杆位姿
+     */
+    void compute(const JointBatch& batch, std::vector<LinkMatrix>& tcp, std::vector<LinkPoses>& links) const;
+
+private:
+    void computeRange(const double* const angles[NUM_JOINTS], size_t begin, size_t end,
+                      LinkMatrix* tcp, LinkPoses* links) const;
+
+private:
+    std::array<double, NUM_JOINTS> m_a;
+    std::array<double, NUM_JOINTS> m_d;
+    std::array<double, NUM_JOINTS> m_thetaOffset;
+    std::array<double, NUM_JOINTS> m_cosAlpha;
+    std::array<double, NUM_JOINTS> m_sinAlpha;
+    int m_threadCount;
+};
+
+} // namespace Robot
+
+#endif // BATCHFORWARDKINEMATICS_H
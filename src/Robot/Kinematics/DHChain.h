@@ -0,0 +1,237 @@
+#ifndef DHCHAIN_H
+#define DHCHAIN_H
+
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace Robot {
+
+/**
+ * @brief 机器人DH参数结构
+ */
+struct DHParameter {
+    double a;       // 连杆长度 (mm)
+    double alpha;   // 连杆扭角 (rad)
+    double d;       // 连杆偏距 (mm)
+    double theta;   // 关节角度 (rad)
+};
+
+/**
+ * @brief 4x4齐次变换矩阵，行主序（与vtkMatrix4x4::Element内存布局一致）
+ */
+using LinkMatrix = std::array<double, 16>;
+
+/**
+ * @brief 安川MPX3500的DH参数表（标准DH，theta为关节零位偏置）
+ *
+ * 仿真、逆解和显示共用此表，修改参数只需改这里。
+ */
+struct Mpx3500Model {
+    static constexpr int kJoints = 6;
+    static constexpr double kHalfPi = 1.57079632679489661923;
+
+    // 参数: a(mm), alpha(rad), d(mm), theta(rad)
+    static constexpr std::array<DHParameter, kJoints> kDH = {{
+        {0,   -kHalfPi, 330, 0},            // J1: 基座旋转
+        {680, 0,        0,   -kHalfPi},     // J2: 肩部
+        {0,   -kHalfPi, 0,   0},            // J3: 肘部
+        {0,   kHalfPi,  680, 0},            // J4: 手腕旋转
+        {0,   -kHalfPi, 0,   0},            // J5: 手腕俯仰
+        {0,   0,        100, 0},            // J6: 末端旋转
+    }};
+
+    static constexpr bool kHasFlange = false;
+    static constexpr DHParameter kFlange = {0, 0, 0, 0};
+};
+
+/**
+ * @brief Aubo i5H的DH参数表，末行为末端执行器的固定偏移
+ */
+struct AuboI5HModel {
+    static constexpr int kJoints = 6;
+    static constexpr double kHalfPi = 1.57079632679489661923;
+
+    static constexpr std::array<DHParameter, kJoints> kDH = {{
+        {0,   0,        330, 0},            // J1: 基座旋转
+        {0,   kHalfPi,  0,   0},            // J2: 肩部
+        {400, 0,        0,   0},            // J3: 上臂
+        {0,   kHalfPi,  400, 0},            // J4: 肘部
+        {0,   -kHalfPi, 0,   0},            // J5: 腕部1
+        {0,   kHalfPi,  100, 0},            // J6: 腕部2
+    }};
+
+    static constexpr bool kHasFlange = true;
+    static constexpr DHParameter kFlange = {0, 0, 100, 0};
+};
+
+/**
+ * @brief 编译期特化的DH运动学链
+ *
+ * Model提供kJoints、kDH、kHasFlange、kFlange。每个关节是一个模板实例，
+ * alpha的正余弦在编译期求出（0/±1精确取整），a、d为0或扭角为0/±90°时对应乘法在编译期消去，
+ * 矩阵运算全部展开，热路径无循环分支。
+ *
+ * 角度为弧度（含零位偏置之外的关节角），输出与RobotKinematics::computeLinkPoses格式一致。
+ */
+template <typename Model>
+class DHChain
+{
+public:
+    static constexpr int NUM_JOINTS = Model::kJoints;
+
+    /**
+     * @brief 各连杆相对基座的位姿
+     * @param radians NUM_JOINTS个关节角 (rad)
+     * @param poses 输出NUM_JOINTS个位姿，第i个为基座到连杆i+1的变换（不含末端偏移）
+     */
+    static void computeLinkPoses(const double* radians, LinkMatrix* poses)
+    {
+        double t[12];
+        setIdentity(t);
+        applyJoints<true>(t, radians, poses, std::make_integer_sequence<int, NUM_JOINTS>());
+    }
+
+    /**
+     * @brief 基座到末端的变换（含末端偏移）
+     */
+    static void computeForward(const double* radians, LinkMatrix& tcp)
+    {
+        double t[12];
+        setIdentity(t);
+        applyJoints<false>(t, radians, nullptr, std::make_integer_sequence<int, NUM_JOINTS>());
+        if constexpr (Model::kHasFlange) {
+            constexpr DHParameter flange = Model::kFlange;
+            applyDH(t, constCos(flange.alpha), constSin(flange.alpha),
+                    constCos(flange.theta), constSin(flange.theta), flange.a, flange.d);
+        }
+        store(t, tcp);
+    }
+
+    /**
+     * @brief 编译期余弦，结果接近0/±1时精确取整
+     */
+    static constexpr double constCos(double x)
+    {
+        return snap(taylorCos(reduce(x)));
+    }
+
+    static constexpr double constSin(double x)
+    {
+        return snap(taylorCos(reduce(x - kPi / 2)));
+    }
+
+private:
+    static constexpr double kPi = 3.14159265358979323846;
+
+    static constexpr double reduce(double x)
+    {
+        while (x > kPi) {
+            x -= 2 * kPi;
+        }
+        while (x < -kPi) {
+            x += 2 * kPi;
+        }
+        return x;
+    }
+
+    static constexpr double taylorCos(double x)
+    {
+        double term = 1.0;
+        double sum = 1.0;
+        for (int k = 1; k < 24; ++k) {
+            term *= -x * x / ((2 * k - 1) * (2 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    static constexpr double snap(double v)
+    {
+        const double eps = 1e-12;
+        if (v < eps && v > -eps) {
+            return 0.0;
+        }
+        if (v - 1.0 < eps && v - 1.0 > -eps) {
+            return 1.0;
+        }
+        if (v + 1.0 < eps && v + 1.0 > -eps) {
+            return -1.0;
+        }
+        return v;
+    }
+
+    /**
+     * @brief c·x，c为编译期常数0/±1时内联后不产生乘法
+     */
+    static inline double scale(double c, double x)
+    {
+        return c == 0.0 ? 0.0 : (c == 1.0 ? x : (c == -1.0 ? -x : c * x));
+    }
+
+    static inline void setIdentity(double t[12])
+    {
+        t[0] = 1; t[1] = 0; t[2] = 0;  t[3] = 0;
+        t[4] = 0; t[5] = 1; t[6] = 0;  t[7] = 0;
+        t[8] = 0; t[9] = 0; t[10] = 1; t[11] = 0;
+    }
+
+    static inline void store(const double t[12], LinkMatrix& out)
+    {
+        for (int e = 0; e < 12; ++e) {
+            out[e] = t[e];
+        }
+        out[12] = 0.0;
+        out[13] = 0.0;
+        out[14] = 0.0;
+        out[15] = 1.0;
+    }
+
+    static inline void applyRow(double* row, double ca, double sa, double ct, double st, double a, double d)
+    {
+        const double u = row[0] * ct + row[1] * st;
+        const double v = row[1] * ct - row[0] * st;
+        const double w = row[2];
+        row[0] = u;
+        row[1] = scale(ca, v) + scale(sa, w);
+        row[2] = scale(ca, w) - scale(sa, v);
+        row[3] += scale(a, u) + scale(d, w);
+    }
+
+    /**
+     * @brief T = T·DH，DH的列为 (ct, st, 0), (-st·ca, ct·ca, sa), (st·sa, -ct·sa, ca), (a·ct, a·st, d)
+     *
+     * ca、sa、a、d均为编译期常数，内联后只剩非零项；三行显式展开，局部矩阵可全部放在寄存器中。
+     */
+    static inline void applyDH(double t[12], double ca, double sa, double ct, double st, double a, double d)
+    {
+        applyRow(t, ca, sa, ct, st, a, d);
+        applyRow(t + 4, ca, sa, ct, st, a, d);
+        applyRow(t + 8, ca, sa, ct, st, a, d);
+    }
+
+    template <bool StorePoses, int I>
+    static inline void applyJoint(double t[12], double theta, LinkMatrix* poses)
+    {
+        constexpr DHParameter dh = Model::kDH[I];
+        constexpr double ca = constCos(dh.alpha);
+        constexpr double sa = constSin(dh.alpha);
+        const double angle = dh.theta + theta;
+        applyDH(t, ca, sa, std::cos(angle), std::sin(angle), dh.a, dh.d);
+        if constexpr (StorePoses) {
+            store(t, poses[I]);
+        }
+    }
+
+    template <bool StorePoses, int... I>
+    static inline void applyJoints(double t[12], const double* radians, LinkMatrix* poses,
+                                   std::integer_sequence<int, I...>)
+    {
+        // 折叠表达式按关节顺序展开
+        (applyJoint<StorePoses, I>(t, radians[I], poses), ...);
+    }
+};
+
+} // namespace Robot
+
+#endif // DHCHAIN_H
@@ -1,7 +1,25 @@
 #include "DHParameters.h"
+#include "DHChain.h"
 #include <QDebug>
 #include <cmath>
 
+namespace {
+
+using AuboChain = Robot::DHChain<Robot::AuboI5HModel>;
+
+Eigen::Matrix4d toEigen(const Robot::LinkMatrix& m)
+{
+    Eigen::Matrix4d T;
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            T(r, c) = m[r * 4 + c];
+        }
+    }
+    return T;
+}
+
+} // namespace
+
 AuboI5HDHParameters::AuboI5HDHParameters()
 {
     initializeAuboI5HParameters();
@@ -14,96 +32,23 @@ void AuboI5HDHParameters::initializeAuboI5HParameters()
     
     // 初始化Aubo i5H的DH参数
     // 注意: 这些是基于标准6轴协作机器人的典型参数
-    // 实际参数应该从官方文档获取
-    
-    // J1 - 基座旋转关节
-    m_parameters.append(DHParameter(
-        "J1", "NAUO1",
-        0,      // a (mm)
-        330,    // d (mm)
-        0,      // alpha (rad)
-        0,      // theta_offset (rad)
-        -M_PI,  // min_angle (rad)
-        M_PI,   // max_angle (rad)
-        M_PI,   // max_velocity (rad/s)
-        'R'     // joint_type
-    ));
-    
-    // J2 - 肩部关节
-    m_parameters.append(DHParameter(
-        "J2", "NAUO2",
-        0,
-        0,
-        M_PI / 2,
-        0,
-        -M_PI,
-        M_PI,
-        M_PI,
-        'R'
-    ));
-    
-    // J3 - 上臂关节
-    m_parameters.append(DHParameter(
-        "J3", "NAUO3",
-        400,
-        0,
-        0,
-        0,
-        -M_PI,
-        M_PI,
-        M_PI,
-        'R'
-    ));
-    
-    // J4 - 肘部关节
-    m_parameters.append(DHParameter(
-        "J4", "NAUO4",
-        0,
-        400,
-        M_PI / 2,
-        0,
-        -M_PI,
-        M_PI,
-        M_PI,
-        'R'
-    ));
-    
-    // J5 - 腕部关节1
-    m_parameters.append(DHParameter(
-        "J5", "NAUO5",
-        0,
-        0,
-        -M_PI / 2,
-        0,
-        -M_PI,
-        M_PI,
-        M_PI,
-        'R'
-    ));
-    
-    // J6 - 腕部关节2
-    m_parameters.append(DHParameter(
-        "J6", "NAUO6",
-        0,
-        100,
-        M_PI / 2,
-        0,
-        -M_PI,
-        M_PI,
-        M_PI,
-        'R'
-    ));
+    // 实际参数应该从官方文档获取，参数表在DHChain.h的AuboI5HModel中
+    for (int i = 0; i < Robot::AuboI5HModel::kJoints; ++i) {
+        const Robot::DHParameter& dh = Robot::AuboI5HModel::kDH[i];
+        m_parameters.append(DHParameter(
+            QString("J%1").arg(i + 1), QString("NAUO%1").arg(i + 1),
+            dh.a, dh.d, dh.alpha, dh.theta,
+            -M_PI, M_PI, M_PI,      // min_angle, max_angle, max_velocity
+            'R'
+        ));
+    }
     
     // 末端执行器 (不是关节，但用于计算)
+    const Robot::DHParameter& ee = Robot::AuboI5HModel::kFlange;
     m_parameters.append(DHParameter(
         "EE", "NAUO7",
-        0,
-        100,
-        0,
-        0,
-        0,
-        0,
-        0,
+        ee.a, ee.d, ee.alpha, ee.theta,
+        0, 0, 0,
         'R'
     ));
     
@@ -159,22 +104,14 @@ Eigen::Matrix4d AuboI5HDHParameters::computeForwardKinematics(const QVector<doub
         return Eigen::Matrix4d::Identity();
     }
     
-    // 从基座到末端执行器的变换矩阵
-    Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
-    
-    // 计算每个关节的变换矩阵并相乘
-    for (int i = 0; i < 6; ++i) {
-        Eigen::Matrix4d Ti = computeDHTransform(i, jointAngles[i]);
-        T = T * Ti;
+    // 从基座到末端执行器的变换矩阵（含末端执行器偏移），编译期展开的运动学链
+    double radians[Robot::AuboI5HModel::kJoints];
+    for (int i = 0; i < Robot::AuboI5HModel::kJoints; ++i) {
+        radians[i] = jointAngles[i];
     }
-    
-    // 加上末端执行器的偏移 (如果有的话)
-    if (m_parameters.size() > 6) {
-        Eigen::Matrix4d T_ee = computeDHTransform(6, 0);
-        T = T * T_ee;
-    }
-    
-    return T;
+    Robot::LinkMatrix T;
+    AuboChain::computeForward(radians, T);
+    return toEigen(T);
 }
 
 Eigen::Matrix4d AuboI5HDHParameters::computeTransformToJoint(int jointIndex, const QVector<double>& jointAngles) const
@@ -190,14 +127,13 @@ Eigen::Matrix4d AuboI5HDHParameters::computeTransformToJoint(int jointIndex, con
     }
     
     // 从基座到指定关节的变换矩阵
-    Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
-    
-    for (int i = 0; i <= jointIndex; ++i) {
-        Eigen::Matrix4d Ti = computeDHTransform(i, jointAngles[i]);
-        T = T * Ti;
+    double radians[Robot::AuboI5HModel::kJoints];
+    for (int i = 0; i < Robot::AuboI5HModel::kJoints; ++i) {
+        radians[i] = jointAngles[i];
     }
-    
-    return T;
+    Robot::LinkMatrix poses[Robot::AuboI5HModel::kJoints];
+    AuboChain::computeLinkPoses(radians, poses);
+    return toEigen(poses[jointIndex]);
 }
 
 bool AuboI5HDHParameters::isJointAngleValid(int jointIndex, double theta) const
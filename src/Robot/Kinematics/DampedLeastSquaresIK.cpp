@@ -0,0 +1,459 @@
+#include "DampedLeastSquaresIK.h"
+#include "DHParameters.h"
+#include "Models/TrajectoryData.h"
+
+#include <QDebug>
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace Robot {
+
+namespace {
+
+const double kDegToRad = M_PI / 180.0;
+const double kRadToDeg = 180.0 / M_PI;
+
+const size_t kMinSegmentPoints = 512;       // 分段并行时每段的最少点数
+const double kBranchTolerance = 1.0;        // 段起点与顺序求解结果相差超过该值 (度) 视为分支不连续
+
+const LinkMatrix kIdentity = {1, 0, 0, 0,
+                              0, 1, 0, 0,
+                              0, 0, 1, 0,
+                              0, 0, 0, 1};
+
+using JointVector = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, DampedLeastSquaresIK::MAX_JOINTS, 1>;
+using TaskVector = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 6, 1>;
+using TaskJacobian = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 6, DampedLeastSquaresIK::MAX_JOINTS>;
+using TaskMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6>;
+
+/**
+ * @brief 行主序齐次矩阵相乘 out = lhs·rhs（只计算上三行）
+ */
+LinkMatrix multiply(const LinkMatrix& lhs, const LinkMatrix& rhs)
+{
+    LinkMatrix out = kIdentity;
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            out[r * 4 + c] = lhs[r * 4] * rhs[c] + lhs[r * 4 + 1] * rhs[4 + c] + lhs[r * 4 + 2] * rhs[8 + c];
+        }
+        out[r * 4 + 3] += lhs[r * 4 + 3];
+    }
+    return out;
+}
+
+LinkMatrix dhMatrix(double a, double alpha, double d, double theta)
+{
+    const double ct = std::cos(theta);
+    const double st = std::sin(theta);
+    const double ca = std::cos(alpha);
+    const double sa = std::sin(alpha);
+    return {ct, -st * ca,  st * sa, a * ct,
+            st,  ct * ca, -ct * sa, a * st,
+            0.0,      sa,       ca,      d,
+            0.0,     0.0,      0.0,    1.0};
+}
+
+} // namespace
+
+/**
+ * @brief 一次正解得到的各关节转轴、原点和TCP位姿（基座坐标系）
+ */
+struct DampedLeastSquaresIK::Frames {
+    Eigen::Vector3d axis[MAX_JOINTS];       // 关节i绕z(i-1)转动
+    Eigen::Vector3d origin[MAX_JOINTS];
+    Eigen::Matrix3d rotation;
+    Eigen::Vector3d position;
+};
+
+DampedLeastSquaresIK::DampedLeastSquaresIK(const RobotKinematics& robot)
+    : m_flange(kIdentity)
+    , m_tool(kIdentity)
+    , m_threadCount(0)
+{
+    const auto& dhParams = robot.getDHParameters();
+    std::vector<SerialChainJoint> joints;
+    for (int i = 0; i < RobotKinematics::NUM_JOINTS; ++i) {
+        const JointLimit limit = robot.getJointLimit(i);
+        joints.push_back({dhParams[i].a, dhParams[i].alpha, dhParams[i].d, dhParams[i].theta,
+                          limit.min, limit.max});
+    }
+    setJoints(joints);
+}
+
+DampedLeastSquaresIK::DampedLeastSquaresIK(const AuboI5HDHParameters& parameters)
+    : m_flange(kIdentity)
+    , m_tool(kIdentity)
+    , m_threadCount(0)
+{
+    // 与computeForwardKinematics一致：限位为空的行是固定偏移，只允许出现在末尾
+    const QVector<::DHParameter>& rows = parameters.getParameters();
+    int jointRows = rows.size();
+    while (jointRows > 0 && rows[jointRows - 1].min_angle >= rows[jointRows - 1].max_angle) {
+        --jointRows;
+    }
+
+    std::vector<SerialChainJoint> joints;
+    for (int i = 0; i < jointRows; ++i) {
+        const ::DHParameter& row = rows[i];
+        joints.push_back({row.a, row.alpha, row.d, row.theta_offset,
+                          row.min_angle * kRadToDeg, row.max_angle * kRadToDeg});
+    }
+    for (int i = jointRows; i < rows.size(); ++i) {
+        const ::DHParameter& row = rows[i];
+        m_flange = multiply(m_flange, dhMatrix(row.a, row.alpha, row.d, row.theta_offset));
+    }
+    setJoints(joints);
+}
+
+DampedLeastSquaresIK::DampedLeastSquaresIK(const std::vector<SerialChainJoint>& joints)
+    : m_flange(kIdentity)
+    , m_tool(kIdentity)
+    , m_threadCount(0)
+{
+    setJoints(joints);
+}
+
+void DampedLeastSquaresIK::setJoints(const std::vector<SerialChainJoint>& joints)
+{
+    if (static_cast<int>(joints.size()) > MAX_JOINTS) {
+        qWarning() << "DampedLeastSquaresIK: 关节数超过上限" << MAX_JOINTS << "，多余关节被忽略:" << joints.size();
+    }
+    m_jointCount = std::min(static_cast<int>(joints.size()), static_cast<int>(MAX_JOINTS));
+
+    for (int i = 0; i < m_jointCount; ++i) {
+        const SerialChainJoint& joint = joints[i];
+        m_a[i] = joint.a;
+        m_d[i] = joint.d;
+        m_thetaOffset[i] = joint.thetaOffset;
+        m_cosAlpha[i] = std::cos(joint.alpha);
+        m_sinAlpha[i] = std::sin(joint.alpha);
+        m_minAngle[i] = joint.minAngle * kDegToRad;
+        m_maxAngle[i] = joint.maxAngle * kDegToRad;
+    }
+    updateEndTransform();
+}
+
+void DampedLeastSquaresIK::setToolFrame(const LinkMatrix& flangeToTool)
+{
+    m_tool = flangeToTool;
+    updateEndTransform();
+}
+
+void DampedLeastSquaresIK::updateEndTransform()
+{
+    m_endTransform = multiply(m_flange, m_tool);
+    const double toolReach = std::sqrt(m_endTransform[3] * m_endTransform[3]
+                                     + m_endTransform[7] * m_endTransform[7]
+                                     + m_endTransform[11] * m_endTransform[11]);
+    double reach = toolReach;
+    for (int i = 0; i < m_jointCount; ++i) {
+        reach += std::abs(m_a[i]) + std::abs(m_d[i]);
+    }
+    m_reach = std::max(reach, 1.0);
+}
+
+void DampedLeastSquaresIK::computeFrames(const double* radians, Frames& frames) const
+{
+    Eigen::Matrix3d rotation = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d position = Eigen::Vector3d::Zero();
+    for (int i = 0; i < m_jointCount; ++i) {
+        frames.axis[i] = rotation.col(2);
+        frames.origin[i] = position;
+
+        const double theta = m_thetaOffset[i] + radians[i];
+        const double ct = std::cos(theta);
+        const double st = std::sin(theta);
+        const double ca = m_cosAlpha[i];
+        const double sa = m_sinAlpha[i];
+
+        // T = T·DH(i)，DH的列为 (ct, st, 0), (-st·ca, ct·ca, sa), (st·sa, -ct·sa, ca), (a·ct, a·st, d)
+        const Eigen::Vector3d x = rotation.col(0) * ct + rotation.col(1) * st;
+        const Eigen::Vector3d y = rotation.col(1) * ct - rotation.col(0) * st;
+        const Eigen::Vector3d z = rotation.col(2);
+        position += m_a[i] * x + m_d[i] * z;
+        rotation.col(0) = x;
+        rotation.col(1) = ca * y + sa * z;
+        rotation.col(2) = ca * z - sa * y;
+    }
+
+    const LinkMatrix& e = m_endTransform;
+    Eigen::Matrix3d endRotation;
+    endRotation << e[0], e[1], e[2],
+                   e[4], e[5], e[6],
+                   e[8], e[9], e[10];
+    frames.position = position + rotation * Eigen::Vector3d(e[3], e[7], e[11]);
+    frames.rotation = rotation * endRotation;
+}
+
+void DampedLeastSquaresIK::forwardKinematics(const double* angles, LinkMatrix& tcp) const
+{
+    double radians[MAX_JOINTS];
+    for (int i = 0; i < m_jointCount; ++i) {
+        radians[i] = angles[i] * kDegToRad;
+    }
+    Frames frames;
+    computeFrames(radians, frames);
+
+    tcp = kIdentity;
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            tcp[r * 4 + c] = frames.rotation(r, c);
+        }
+        tcp[r * 4 + 3] = frames.position(r);
+    }
+}
+
+DampedLeastSquaresIK::Result DampedLeastSquaresIK::solve(const LinkMatrix& target, const double* seed,
+                                                         double* solution) const
+{
+    const Options& options = m_options;
+    const int n = m_jointCount;
+    const int m = options.freeToolRotation ? 5 : 6;
+    const bool redundant = n > m;
+
+    // 姿态行按链长加权，使1 rad的姿态误差与链长量级的位置误差相当
+    const double orientationWeight = m_reach;
+    const double maxStep = options.maxJointStep * kDegToRad;
+    const double dampingThreshold = options.singularityThreshold;
+    const double maxDamping2 = options.maxDamping * options.maxDamping;
+    const double reachPower = std::pow(m_reach, m);
+
+    Eigen::Matrix3d targetRotation;
+    targetRotation << target[0], target[1], target[2],
+                      target[4], target[5], target[6],
+                      target[8], target[9], target[10];
+    const Eigen::Vector3d targetPosition(target[3], target[7], target[11]);
+
+    JointVector q(n);
+    for (int i = 0; i < n; ++i) {
+        q(i) = std::clamp(seed[i] * kDegToRad, m_minAngle[i], m_maxAngle[i]);
+    }
+
+    Frames frames;
+    TaskJacobian jacobian(m, n);
+    TaskVector error(m);
+    TaskMatrix system(m, m);
+    Result result;
+
+    // 加权任务雅可比；freeToolRotation时姿态只取垂直于工具z轴的两个分量
+    auto buildJacobian = [&](const Frames& f, TaskJacobian& J) {
+        const Eigen::Vector3d toolX = f.rotation.col(0);
+        const Eigen::Vector3d toolY = f.rotation.col(1);
+        for (int i = 0; i < n; ++i) {
+            const Eigen::Vector3d linear = f.axis[i].cross(f.position - f.origin[i]);
+            J.block<3, 1>(0, i) = linear;
+            if (options.freeToolRotation) {
+                J(3, i) = orientationWeight * toolX.dot(f.axis[i]);
+                J(4, i) = orientationWeight * toolY.dot(f.axis[i]);
+            } else {
+                J.block<3, 1>(3, i) = orientationWeight * f.axis[i];
+            }
+        }
+    };
+
+    auto manipulability = [&](const TaskJacobian& J) {
+        system.noalias() = J * J.transpose();
+        return std::sqrt(std::max(0.0, system.determinant())) / reachPower;
+    };
+
+    for (int iteration = 0; iteration <= options.maxIterations; ++iteration) {
+        computeFrames(q.data(), frames);
+
+        // 任务误差
+        const Eigen::Vector3d positionError = targetPosition - frames.position;
+        Eigen::Vector3d rotationError;
+        double angleError;
+        if (options.freeToolRotation) {
+            const Eigen::Vector3d toolZ = frames.rotation.col(2);
+            const Eigen::Vector3d targetZ = targetRotation.col(2);
+            const Eigen::Vector3d axis = toolZ.cross(targetZ);
+            const double sinAngle = axis.norm();
+            angleError = std::atan2(sinAngle, toolZ.dot(targetZ));
+            rotationError = sinAngle > 1e-12 ? Eigen::Vector3d(axis * (angleError / sinAngle))
+                                             : Eigen::Vector3d::Zero();
+            error(3) = orientationWeight * frames.rotation.col(0).dot(rotationError);
+            error(4) = orientationWeight * frames.rotation.col(1).dot(rotationError);
+        } else {
+            const Eigen::AngleAxisd delta(targetRotation * frames.rotation.transpose());
+            angleError = std::abs(delta.angle());
+            rotationError = delta.axis() * delta.angle();
+            error.segment<3>(3) = orientationWeight * rotationError;
+        }
+        error.head<3>() = positionError;
+
+        result.iterations = iteration;
+        result.positionError = positionError.norm();
+        result.orientationError = angleError;
+        if (result.positionError <= options.positionTolerance && angleError <= options.orientationTolerance) {
+            result.converged = true;
+            break;
+        }
+        if (iteration == options.maxIterations) {
+            break;
+        }
+
+        // 自适应阻尼：λ² = λmax²·(1 - w/w0)²，w为归一化可操作度；
+        // 再按剩余误差缩小（LM），接近目标时阻尼消失，奇异附近也能收敛到容差
+        buildJacobian(frames, jacobian);
+        const double w = manipulability(jacobian);
+        double damping2 = 0.0;
+        if (w < dampingThreshold) {
+            const double ratio = 1.0 - w / dampingThreshold;
+            damping2 = maxDamping2 * ratio * ratio * std::min(1.0, error.norm() / options.maxDamping);
+        }
+        system.diagonal().array() += std::max(damping2, 1e-9);
+        const Eigen::LDLT<TaskMatrix> ldlt(system);
+
+        JointVector step = jacobian.transpose() * ldlt.solve(error);
+
+        // 零空间：远离关节限位（中点吸引）、增大可操作度，投影 (I - J⁺J) 后不影响任务。
+        // 只在第一次迭代加入，后续迭代只修正其二阶误差；沿路径热启动时逐点累积
+        if (redundant && iteration == 0 && (options.jointLimitGain > 0.0 || options.singularityGain > 0.0)) {
+            JointVector gradient = JointVector::Zero(n);
+            if (options.jointLimitGain > 0.0) {
+                for (int i = 0; i < n; ++i) {
+                    const double range = m_maxAngle[i] - m_minAngle[i];
+                    const double middle = 0.5 * (m_maxAngle[i] + m_minAngle[i]);
+                    gradient(i) -= options.jointLimitGain * (q(i) - middle) / (range * range);
+                }
+            }
+            if (options.singularityGain > 0.0 && w > 0.0) {
+                const double delta = 1e-6;
+                Frames probe;
+                TaskJacobian probeJacobian(m, n);
+                const double logW = std::log(w);
+                for (int i = 0; i < n; ++i) {
+                    JointVector shifted = q;
+                    shifted(i) += delta;
+                    computeFrames(shifted.data(), probe);
+                    buildJacobian(probe, probeJacobian);
+                    const double shiftedW = manipulability(probeJacobian);
+                    if (shiftedW > 0.0) {
+                        gradient(i) += options.singularityGain * (std::log(shiftedW) - logW) / delta;
+                    }
+                }
+            }
+            step += gradient - jacobian.transpose() * ldlt.solve(jacobian * gradient);
+        }
+
+        const double largest = step.cwiseAbs().maxCoeff();
+        if (largest > maxStep) {
+            step *= maxStep / largest;
+        }
+        for (int i = 0; i < n; ++i) {
+            q(i) = std::clamp(q(i) + step(i), m_minAngle[i], m_maxAngle[i]);
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        solution[i] = q(i) * kRadToDeg;
+    }
+    return result;
+}
+
+void DampedLeastSquaresIK::solveRange(const std::vector<LinkMatrix>& targets, size_t begin, size_t end,
+                                      const double* seed, PathResult& path) const
+{
+    const int n = m_jointCount;
+    const double* previous = seed;
+    for (size_t i = begin; i < end; ++i) {
+        double* joints = path.angles.data() + i * n;
+        path.results[i] = solve(targets[i], previous, joints);
+        previous = joints;
+    }
+}
+
+DampedLeastSquaresIK::PathResult DampedLeastSquaresIK::solvePath(const std::vector<LinkMatrix>& targets,
+                                                                 const double* seed) const
+{
+    PathResult path;
+    path.jointCount = m_jointCount;
+    path.angles.resize(targets.size() * m_jointCount);
+    path.results.resize(targets.size());
+    if (targets.empty()) {
+        return path;
+    }
+
+    int workers = m_threadCount > 0 ? m_threadCount : static_cast<int>(std::thread::hardware_concurrency());
+    workers = static_cast<int>(std::max<size_t>(1, std::min<size_t>(std::max(1, workers),
+                                                                    targets.size() / kMinSegmentPoints)));
+
+    if (workers == 1) {
+        solveRange(targets, 0, targets.size(), seed, path);
+    } else {
+        // 每段独立地从seed出发，沿段内逐点热启动
+        std::vector<size_t> bounds(workers + 1);
+        for (int s = 0; s <= workers; ++s) {
+            bounds[s] = targets.size() * s / workers;
+        }
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (int s = 1; s < workers; ++s) {
+            threads.emplace_back([&, s]() { solveRange(targets, bounds[s], bounds[s + 1], seed, path); });
+        }
+        solveRange(targets, bounds[0], bounds[1], seed, path);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        // 段起点应与从前一段终点热启动的结果一致，否则该段落在了另一个构型分支上，顺序重解
+        const int n = m_jointCount;
+        double check[MAX_JOINTS];
+        for (int s = 1; s < workers; ++s) {
+            const size_t first = bounds[s];
+            const double* previous = path.jointsAt(first - 1);
+            solve(targets[first], previous, check);
+            const double* parallel = path.jointsAt(first);
+            double jump = 0.0;
+            for (int j = 0; j < n; ++j) {
+                jump = std::max(jump, std::abs(check[j] - parallel[j]));
+            }
+            if (jump > kBranchTolerance) {
+                solveRange(targets, first, bounds[s + 1], previous, path);
+            }
+        }
+    }
+
+    for (const Result& result : path.results) {
+        if (!result.converged) {
+            ++path.failedCount;
+        }
+    }
+    return path;
+}
+
+DampedLeastSquaresIK::PathResult DampedLeastSquaresIK::solvePath(const QList<Data::TrajectoryPoint>& points,
+                                                                 const double* seed) const
+{
+    std::vector<LinkMatrix> targets;
+    targets.reserve(points.size());
+    for (const Data::TrajectoryPoint& point : points) {
+        targets.push_back(pointToMatrix(point));
+    }
+    return solvePath(targets, seed);
+}
+
+DampedLeastSquaresIK::PathResult DampedLeastSquaresIK::solvePath(const Data::TrajectoryData& trajectory,
+                                                                 const double* seed) const
+{
+    return solvePath(trajectory.points(), seed);
+}
+
+LinkMatrix DampedLeastSquaresIK::pointToMatrix(const Data::TrajectoryPoint& point)
+{
+    QQuaternion orientation = point.orientation;
+    orientation.normalize();
+    const double w = orientation.scalar();
+    const double x = orientation.x();
+    const double y = orientation.y();
+    const double z = orientation.z();
+
+    return {1 - 2 * (y * y + z * z), 2 * (x * y - w * z),     2 * (x * z + w * y),     point.position.x(),
+            2 * (x * y + w * z),     1 - 2 * (x * x + z * z), 2 * (y * z - w * x),     point.position.y(),
+            2 * (x * z - w * y),     2 * (y * z + w * x),     1 - 2 * (x * x + y * y), point.position.z(),
+            0.0,                     0.0,                     0.0,                     1.0};
+}
+
+} // namespace Robot
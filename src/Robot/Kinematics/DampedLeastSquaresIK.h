@@ -0,0 +1,174 @@
+#ifndef DAMPEDLEASTSQUARESIK_H
+#define DAMPEDLEASTSQUARESIK_H
+
+#include "RobotKinematics.h"
+
+#include <QList>
+#include <array>
+#include <vector>
+
+class AuboI5HDHParameters;
+
+namespace Data {
+struct TrajectoryPoint;
+class TrajectoryData;
+}
+
+namespace Robot {
+
+/**
+ * @brief 串联链的一个旋转关节（标准DH）
+ */
+struct SerialChainJoint {
+    double a;           // 连杆长度 (mm)
+    double alpha;       // 连杆扭角 (rad)
+    double d;           // 连杆偏距 (mm)
+    double thetaOffset; // 关节零位偏置 (rad)
+    double minAngle;    // 最小角度 (度)
+    double maxAngle;    // 最大角度 (度)
+};
+
+/**
+ * @brief 阻尼最小二乘(DLS)数值逆解
+ *
+ * 适用于任意标准DH串联链（MPX3500、Aubo i5H、非球形手腕等）和任意工具坐标系：
+ * - 解析几何雅可比，每次迭代一次正解
+ * - 阻尼随可操作度自适应：远离奇异时接近高斯-牛顿，靠近奇异时限制关节速度
+ * - 冗余时（7轴以上，或释放绕工具轴的转动）在零空间内远离关节限位和奇异构型
+ * - 沿路径逐点以上一点的解为初值，通常2-3次迭代收敛
+ *
+ * 角度接口均为度，与RobotKinematics一致。求解不分配内存、不输出日志，可在任意线程中调用。
+ */
+class DampedLeastSquaresIK
+{
+public:
+    static constexpr int MAX_JOINTS = 8;
+
+    struct Options {
+        int maxIterations = 100;
+        double positionTolerance = 1e-3;        // 位置收敛阈值 (mm)
+        double orientationTolerance = 1e-5;     // 姿态收敛阈值 (rad)
+        double maxDamping = 20.0;               // 奇异处的最大阻尼 (mm)
+        double singularityThreshold = 0.02;     // 按链长归一化的可操作度低于该值时加阻尼
+        double maxJointStep = 10.0;             // 单次迭代最大关节增量 (度)
+        bool freeToolRotation = false;          // 不约束绕工具z轴的转动（轴对称喷枪），多出1个冗余自由度
+        double jointLimitGain = 0.5;            // 零空间：远离关节限位的增益
+        double singularityGain = 0.0;           // 零空间：增大可操作度的增益（每次迭代多n次雅可比计算）
+    };
+
+    struct Result {
+        bool converged = false;
+        int iterations = 0;
+        double positionError = 0.0;             // mm
+        double orientationError = 0.0;          // rad
+    };
+
+    /**
+     * @brief 路径求解结果
+     */
+    struct PathResult {
+        int jointCount = 0;
+        std::vector<double> angles;             // 第i个点的关节j为angles[i * jointCount + j] (度)
+        std::vector<Result> results;
+        int failedCount = 0;                    // 未收敛的点数
+
+        size_t size() const { return results.size(); }
+        const double* jointsAt(size_t index) const { return angles.data() + index * jointCount; }
+    };
+
+    /**
+     * @brief 使用RobotKinematics的DH参数和关节限位
+     */
+    explicit DampedLeastSquaresIK(const RobotKinematics& robot);
+
+    /**
+     * @brief 使用Aubo i5H的DH参数，末尾限位为空的行（末端执行器偏移）并入法兰
+     */
+    explicit DampedLeastSquaresIK(const AuboI5HDHParameters& parameters);
+
+    /**
+     * @brief 使用自定义串联链（最多MAX_JOINTS个关节）
+     */
+    explicit DampedLeastSquaresIK(const std::vector<SerialChainJoint>& joints);
+
+    int jointCount() const { return m_jointCount; }
+
+    /**
+     * @brief 设置工具坐标系（法兰到TCP的变换），默认单位矩阵
+     */
+    void setToolFrame(const LinkMatrix& flangeToTool);
+    const LinkMatrix& toolFrame() const { return m_tool; }
+
+    void setOptions(const Options& options) { m_options = options; }
+    const Options& options() const { return m_options; }
+
+    /**
+     * @brief 设置路径求解的线程数，0表示使用全部硬件线程
+     */
+    void setThreadCount(int threadCount) { m_threadCount = threadCount; }
+
+    /**
+     * @brief 正解：基座到TCP的变换
+     * @param angles jointCount()个关节角度 (度)
+     */
+    void forwardKinematics(const double* angles, LinkMatrix& tcp) const;
+
+    /**
+     * @brief 单点逆解
+     * @param target 目标TCP位姿
+     * @param seed 初值 (度)
+     * @param solution 输出 (度)，未收敛时为最后一次迭代的结果
+     */
+    Result solve(const LinkMatrix& target, const double* seed, double* solution) const;
+
+    /**
+     * @brief 路径逆解：逐点以前一点的解为初值
+     *
+     * 路径按线程数分段并行求解，每段起点从seed求解；
+     * 若某段起点与前一段终点不连续（落在不同构型分支），该段以前一段终点为初值重新求解。
+     * @param targets 目标TCP位姿序列
+     * @param seed 第一个点的初值 (度)
+     */
+    PathResult solvePath(const std::vector<LinkMatrix>& targets, const double* seed) const;
+
+    /**
+     * @brief 轨迹点逆解，轨迹点的位置和姿态即TCP位姿
+     */
+    PathResult solvePath(const QList<Data::TrajectoryPoint>& points, const double* seed) const;
+    PathResult solvePath(const Data::TrajectoryData& trajectory, const double* seed) const;
+
+    /**
+     * @brief 轨迹点（位置 + 四元数姿态）转为齐次矩阵
+     */
+    static LinkMatrix pointToMatrix(const Data::TrajectoryPoint& point);
+
+private:
+    struct Frames;
+
+    void setJoints(const std::vector<SerialChainJoint>& joints);
+    void updateEndTransform();
+    void computeFrames(const double* radians, Frames& frames) const;
+    void solveRange(const std::vector<LinkMatrix>& targets, size_t begin, size_t end,
+                    const double* seed, PathResult& path) const;
+
+private:
+    int m_jointCount;
+    std::array<double, MAX_JOINTS> m_a;
+    std::array<double, MAX_JOINTS> m_d;
+    std::array<double, MAX_JOINTS> m_thetaOffset;
+    std::array<double, MAX_JOINTS> m_cosAlpha;
+    std::array<double, MAX_JOINTS> m_sinAlpha;
+    std::array<double, MAX_JOINTS> m_minAngle;      // rad
+    std::array<double, MAX_JOINTS> m_maxAngle;      // rad
+    LinkMatrix m_flange;                            // 末关节之后的固定变换（如Aubo末端偏移）
+    LinkMatrix m_tool;                              // 法兰到TCP
+    LinkMatrix m_endTransform;                      // m_flange·m_tool
+    double m_reach;                                 // 链长 (mm)，用于姿态误差加权和自动阈值
+
+    Options m_options;
+    int m_threadCount;
+};
+
+} // namespace Robot
+
+#endif // DAMPEDLEASTSQUARESIK_H
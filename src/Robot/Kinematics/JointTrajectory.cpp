@@ -0,0 +1,479 @@
+#include "JointTrajectory.h"
+#include "Models/TrajectoryData.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Robot {
+
+namespace {
+
+const int kJoints = JointTrajectory::NUM_JOINTS;
+const int kOrder = 6;                       // 每段每关节的系数个数（五次多项式）
+const double kTimeEpsilon = 1e-9;           // 重采样补齐末周期时的时间容差 (秒)
+
+/**
+ * @brief 三点差分：非均匀节点 t_{i-1}, t_i, t_{i+1} 处的一阶导数
+ */
+inline double threePointDerivative(double h0, double h1, double d0, double d1)
+{
+    return (h1 * d0 + h0 * d1) / (h0 + h1);
+}
+
+/**
+ * @brief 旋转矩阵（行主序齐次矩阵的左上3×3）转四元数
+ */
+QQuaternion matrixToQuaternion(const LinkMatrix& m)
+{
+    const double trace = m[0] + m[5] + m[10];
+    double w, x, y, z;
+    if (trace > 0.0) {
+        const double s = 2.0 * std::sqrt(trace + 1.0);
+        w = 0.25 * s;
+        x = (m[9] - m[6]) / s;
+        y = (m[2] - m[8]) / s;
+        z = (m[4] - m[1]) / s;
+    } else if (m[0] > m[5] && m[0] > m[10]) {
+        const double s = 2.0 * std::sqrt(1.0 + m[0] - m[5] - m[10]);
+        w = (m[9] - m[6]) / s;
+        x = 0.25 * s;
+        y = (m[1] + m[4]) / s;
+        z = (m[2] + m[8]) / s;
+    } else if (m[5] > m[10]) {
+        const double s = 2.0 * std::sqrt(1.0 + m[5] - m[0] - m[10]);
+        w = (m[2] - m[8]) / s;
+        x = (m[1] + m[4]) / s;
+        y = 0.25 * s;
+        z = (m[6] + m[9]) / s;
+    } else {
+        const double s = 2.0 * std::sqrt(1.0 + m[10] - m[0] - m[5]);
+        w = (m[4] - m[1]) / s;
+        x = (m[2] + m[8]) / s;
+        y = (m[6] + m[9]) / s;
+        z = 0.25 * s;
+    }
+    return QQuaternion(static_cast<float>(w), static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+}
+
+} // namespace
+
+JointTrajectory::JointTrajectory(Interpolation interpolation)
+    : m_interpolation(interpolation)
+    , m_velocitiesComplete(true)
+{
+}
+
+void JointTrajectory::clear()
+{
+    m_times.clear();
+    m_angles.clear();
+    m_velocities.clear();
+    m_velocitiesComplete = true;
+    m_coefficients.clear();
+}
+
+void JointTrajectory::reserve(size_t count)
+{
+    m_times.reserve(count);
+    m_angles.reserve(count * kJoints);
+    if (m_velocitiesComplete) {
+        m_velocities.reserve(count * kJoints);
+    }
+    m_coefficients.reserve(count * kJoints * kOrder);
+}
+
+bool JointTrajectory::append(double time, const double* angles, const double* velocities)
+{
+    if (!angles || (!m_times.empty() && !(time > m_times.back()))) {
+        return false;
+    }
+
+    m_times.push_back(time);
+    m_angles.insert(m_angles.end(), angles, angles + kJoints);
+    // 新节点改变前一节点的速度（不再是终点）和前两个节点的加速度，只影响最后三段；
+    // 丢弃速度时全部节点的速度改为由位置求得
+    size_t firstSegment = m_times.size() >= 4 ? m_times.size() - 4 : 0;
+    if (velocities && m_velocitiesComplete) {
+        m_velocities.insert(m_velocities.end(), velocities, velocities + kJoints);
+    } else if (m_velocitiesComplete) {
+        m_velocities.clear();
+        m_velocities.shrink_to_fit();
+        m_velocitiesComplete = false;
+        firstSegment = 0;
+    }
+    updateCoefficients(firstSegment);
+    return true;
+}
+
+bool JointTrajectory::append(double time, const Joints& angles)
+{
+    return append(time, angles.data());
+}
+
+const double* JointTrajectory::velocitiesAt(size_t index) const
+{
+    return m_velocities.empty() ? nullptr : m_velocities.data() + index * kJoints;
+}
+
+JointTrajectory::Joints JointTrajectory::get(size_t index) const
+{
+    Joints joints;
+    std::copy(jointsAt(index), jointsAt(index) + kJoints, joints.begin());
+    return joints;
+}
+
+void JointTrajectory::setInterpolation(Interpolation interpolation)
+{
+    if (m_interpolation != interpolation) {
+        m_interpolation = interpolation;
+        updateCoefficients(0);
+    }
+}
+
+bool JointTrajectory::evaluate(double time, double* angles, double* velocities, double* accelerations) const
+{
+    if (m_times.empty() || !angles) {
+        return false;
+    }
+
+    // 时间范围外停在首/末点
+    if (m_times.size() == 1 || time < m_times.front() || time > m_times.back()) {
+        const size_t index = (m_times.size() == 1 || time < m_times.front()) ? 0 : m_times.size() - 1;
+        std::copy(jointsAt(index), jointsAt(index) + kJoints, angles);
+        if (velocities) {
+            std::fill(velocities, velocities + kJoints, 0.0);
+        }
+        if (accelerations) {
+            std::fill(accelerations, accelerations + kJoints, 0.0);
+        }
+        return true;
+    }
+
+    const size_t segment = segmentAt(time);
+    evaluateSegment(segment, time - m_times[segment], angles, velocities, accelerations);
+    return true;
+}
+
+JointTrajectory::Joints JointTrajectory::positionAt(double time) const
+{
+    Joints joints{};
+    evaluate(time, joints.data());
+    return joints;
+}
+
+JointTrajectory JointTrajectory::resample(double cycleTime) const
+{
+    JointTrajectory result(m_interpolation);
+    if (m_times.empty() || !(cycleTime > 0.0)) {
+        return result;
+    }
+
+    // 周期数向上取整，末周期停在终点
+    const double start = m_times.front();
+    const size_t cycles = static_cast<size_t>(std::ceil(duration() / cycleTime - kTimeEpsilon));
+    result.reserve(cycles + 1);
+
+    Joints angles;
+    Joints velocities;
+    size_t segment = 0;
+    for (size_t k = 0; k <= cycles; ++k) {
+        const double time = start + k * cycleTime;
+        if (m_times.size() == 1 || time > m_times.back()) {
+            evaluate(time, angles.data(), velocities.data());
+        } else {
+            // 时刻单调递增，顺序推进段索引
+            while (segment + 2 < m_times.size() && time >= m_times[segment + 1]) {
+                ++segment;
+            }
+            evaluateSegment(segment, time - m_times[segment], angles.data(), velocities.data(), nullptr);
+        }
+        result.append(time, angles.data(), velocities.data());
+    }
+    return result;
+}
+
+JointBatch JointTrajectory::toBatch() const
+{
+    JointBatch batch;
+    batch.resize(m_times.size());
+    for (size_t i = 0; i < m_times.size(); ++i) {
+        const double* q = jointsAt(i);
+        for (int j = 0; j < kJoints; ++j) {
+            batch.angles[j][i] = q[j];
+        }
+    }
+    return batch;
+}
+
+JointTrajectory JointTrajectory::fromTiming(const double* angles, size_t count,
+                                            const TimeParameterization::Result& timing,
+                                            const double* dwellTimes, Interpolation interpolation)
+{
+    JointTrajectory result(interpolation);
+    if (!angles || !timing.success || timing.size() != count || timing.jointCount != kJoints) {
+        return result;
+    }
+
+    result.reserve(count);
+    const double zero[kJoints] = {};
+    size_t i = 0;
+    while (i < count) {
+        // 重复点的时刻相同，合并为一个采样点，停留时间累加
+        double dwell = 0.0;
+        size_t next = i;
+        while (next < count && timing.times[next] == timing.times[i]) {
+            if (dwellTimes && dwellTimes[next] > 0.0) {
+                dwell += dwellTimes[next];
+            }
+            ++next;
+        }
+
+        const double* q = angles + i * kJoints;
+        result.append(timing.times[i], q, timing.velocitiesAt(i));
+        if (dwell > 0.0) {
+            result.append(timing.times[i] + dwell, q, zero);
+        }
+        i = next;
+    }
+    return result;
+}
+
+bool JointTrajectory::fromCartesian(const Data::TrajectoryData& trajectory, const DampedLeastSquaresIK& ik,
+                                    const TimeParameterization& timing, const double* seed,
+                                    JointTrajectory& result, DampedLeastSquaresIK::PathResult* path)
+{
+    result.clear();
+    if (ik.jointCount() != kJoints || trajectory.points().isEmpty() || !seed) {
+        return false;
+    }
+
+    DampedLeastSquaresIK::PathResult joints = ik.solvePath(trajectory, seed);
+    bool success = joints.failedCount == 0;
+    if (success) {
+        const TimeParameterization::Result times = timing.compute(trajectory, joints);
+        success = times.success;
+        if (success) {
+            const QList<Data::TrajectoryPoint>& points = trajectory.points();
+            std::vector<double> dwellTimes(points.size());
+            for (int i = 0; i < points.size(); ++i) {
+                dwellTimes[i] = points[i].dwellTime;
+            }
+            result = fromTiming(joints.angles.data(), joints.size(), times, dwellTimes.data(),
+                                result.interpolation());
+        }
+    }
+
+    if (path) {
+        *path = std::move(joints);
+    }
+    return success;
+}
+
+QList<Data::TrajectoryPoint> JointTrajectory::toCartesian(const BatchForwardKinematics& forward,
+                                                          const LinkMatrix& flangeToTool) const
+{
+    QList<Data::TrajectoryPoint> points;
+    if (m_times.empty()) {
+        return points;
+    }
+
+    std::vector<LinkMatrix> flange;
+    forward.compute(toBatch(), flange);
+
+    const size_t count = m_times.size();
+    std::vector<LinkMatrix> tcp(count);
+    for (size_t i = 0; i < count; ++i) {
+        const LinkMatrix& f = flange[i];
+        LinkMatrix& t = tcp[i];
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                t[r * 4 + c] = f[r * 4] * flangeToTool[c] + f[r * 4 + 1] * flangeToTool[4 + c]
+                             + f[r * 4 + 2] * flangeToTool[8 + c] + (c == 3 ? f[r * 4 + 3] : 0.0);
+            }
+        }
+        t[12] = 0.0;
+        t[13] = 0.0;
+        t[14] = 0.0;
+        t[15] = 1.0;
+    }
+
+    points.reserve(static_cast<int>(count));
+    for (size_t i = 0; i < count; ++i) {
+        // TCP速度：相邻采样点的中心差分，首末点单侧差分
+        double speed = 0.0;
+        if (count > 1) {
+            const size_t a = i > 0 ? i - 1 : 0;
+            const size_t b = i + 1 < count ? i + 1 : count - 1;
+            const double dx = tcp[b][3] - tcp[a][3];
+            const double dy = tcp[b][7] - tcp[a][7];
+            const double dz = tcp[b][11] - tcp[a][11];
+            speed = std::sqrt(dx * dx + dy * dy + dz * dz) / (m_times[b] - m_times[a]);
+        }
+
+        Data::TrajectoryPoint point;
+        point.index = static_cast<int>(i);
+        point.position = QVector3D(static_cast<float>(tcp[i][3]), static_cast<float>(tcp[i][7]),
+                                   static_cast<float>(tcp[i][11]));
+        point.orientation = matrixToQuaternion(tcp[i]);
+        point.speed = speed;
+        points.append(point);
+    }
+    return points;
+}
+
+void JointTrajectory::updateCoefficients(size_t firstSegment)
+{
+    const size_t count = m_times.size();
+    m_coefficients.resize(count > 1 ? (count - 1) * kJoints * kOrder : 0, 0.0);
+    if (count < 2) {
+        return;
+    }
+    // 无速度的夹持三次样条是全局的，任一节点变化都影响全部段
+    if (m_interpolation == CubicSpline && !hasVelocities()) {
+        firstSegment = 0;
+    }
+    firstSegment = std::min(firstSegment, count - 2);
+
+    auto h = [&](size_t k) {
+        return m_times[k + 1] - m_times[k];
+    };
+    auto slope = [&](size_t k, int j) {
+        return (m_angles[(k + 1) * kJoints + j] - m_angles[k * kJoints + j]) / h(k);
+    };
+    auto coefficients = [&](size_t k, int j) {
+        double* c = m_coefficients.data() + (k * kJoints + j) * kOrder;
+        std::fill(c, c + kOrder, 0.0);
+        return c;
+    };
+
+    if (m_interpolation == Linear) {
+        for (size_t k = firstSegment; k + 1 < count; ++k) {
+            for (int j = 0; j < kJoints; ++j) {
+                double* c = coefficients(k, j);
+                c[0] = m_angles[k * kJoints + j];
+                c[1] = slope(k, j);
+            }
+        }
+        return;
+    }
+
+    // 段k由节点k、k+1的速度和加速度确定，节点加速度又由相邻节点速度求得，
+    // 因此从first = firstSegment - 1起求节点速度 v 和加速度 a（度/秒、度/秒²，下标相对first）
+    const size_t first = firstSegment > 0 ? firstSegment - 1 : 0;
+    const size_t nodeCount = count - first;
+    std::vector<double> v(nodeCount * kJoints, 0.0);
+    std::vector<double> a(nodeCount * kJoints, 0.0);
+    auto at = [&](std::vector<double>& values, size_t k, int j) -> double& {
+        return values[(k - first) * kJoints + j];
+    };
+
+    if (hasVelocities()) {
+        std::copy(m_velocities.begin() + first * kJoints, m_velocities.end(), v.begin());
+    } else if (m_interpolation == CubicSpline) {
+        // 夹持三次样条：h_k·v_{k-1} + 2(h_{k-1}+h_k)·v_k + h_{k-1}·v_{k+1} = 3(h_k·d_{k-1} + h_{k-1}·d_k)，
+        // 起止速度为0。三对角矩阵与关节无关，追赶法消元一次、6个右端项共用（此时first为0）
+        std::vector<double> upper(count, 0.0);
+        std::vector<double> pivot(count, 1.0);
+        for (size_t k = 1; k + 1 < count; ++k) {
+            const double lower = h(k);
+            const double diagonal = 2.0 * (h(k - 1) + h(k));
+            pivot[k] = diagonal - (k > 1 ? lower * upper[k - 1] : 0.0);
+            upper[k] = h(k - 1) / pivot[k];
+            for (int j = 0; j < kJoints; ++j) {
+                const double rhs = 3.0 * (h(k) * slope(k - 1, j) + h(k - 1) * slope(k, j));
+                const double previous = k > 1 ? v[(k - 1) * kJoints + j] : 0.0;
+                v[k * kJoints + j] = (rhs - lower * previous) / pivot[k];
+            }
+        }
+        for (size_t k = count - 2; k >= 1; --k) {
+            for (int j = 0; j < kJoints; ++j) {
+                v[k * kJoints + j] -= upper[k] * v[(k + 1) * kJoints + j];
+            }
+        }
+        // v[0]、v[count-1] 为0（夹持）；k + 1 == count - 1 时 upper[k] 乘以0
+    } else {
+        for (size_t k = std::max<size_t>(first, 1); k + 1 < count; ++k) {
+            for (int j = 0; j < kJoints; ++j) {
+                at(v, k, j) = threePointDerivative(h(k - 1), h(k), slope(k - 1, j), slope(k, j));
+            }
+        }
+    }
+
+    if (m_interpolation == QuinticSpline) {
+        // 静止段（停留点的到达、离开）两端速度和加速度为0，段内不摆动
+        auto still = [&](size_t k) {
+            return (k > 0 && std::equal(jointsAt(k - 1), jointsAt(k - 1) + kJoints, jointsAt(k))) ||
+                   (k + 1 < count && std::equal(jointsAt(k), jointsAt(k) + kJoints, jointsAt(k + 1)));
+        };
+        for (size_t k = std::max<size_t>(first, 1); k + 1 < count; ++k) {
+            if (still(k)) {
+                for (int j = 0; j < kJoints; ++j) {
+                    at(v, k, j) = 0.0;
+                }
+            }
+        }
+        for (size_t k = std::max<size_t>(firstSegment, 1); k + 1 < count; ++k) {
+            if (still(k)) {
+                continue;
+            }
+            for (int j = 0; j < kJoints; ++j) {
+                const double d0 = (at(v, k, j) - at(v, k - 1, j)) / h(k - 1);
+                const double d1 = (at(v, k + 1, j) - at(v, k, j)) / h(k);
+                at(a, k, j) = threePointDerivative(h(k - 1), h(k), d0, d1);
+            }
+        }
+    }
+
+    // 分段Hermite：三次由端点位置、速度确定，五次再加端点加速度
+    for (size_t k = firstSegment; k + 1 < count; ++k) {
+        const double t = h(k);
+        const double t2 = t * t;
+        const double t3 = t2 * t;
+        for (int j = 0; j < kJoints; ++j) {
+            double* c = coefficients(k, j);
+            const double p0 = m_angles[k * kJoints + j];
+            const double p1 = m_angles[(k + 1) * kJoints + j];
+            const double v0 = at(v, k, j);
+            const double v1 = at(v, k + 1, j);
+            c[0] = p0;
+            c[1] = v0;
+            if (m_interpolation == CubicSpline) {
+                c[2] = (3.0 * (p1 - p0) / t - 2.0 * v0 - v1) / t;
+                c[3] = (v0 + v1 - 2.0 * (p1 - p0) / t) / t2;
+            } else {
+                const double a0 = at(a, k, j);
+                const double a1 = at(a, k + 1, j);
+                c[2] = 0.5 * a0;
+                c[3] = (20.0 * (p1 - p0) - (8.0 * v1 + 12.0 * v0) * t - (3.0 * a0 - a1) * t2) / (2.0 * t3);
+                c[4] = (30.0 * (p0 - p1) + (14.0 * v1 + 16.0 * v0) * t + (3.0 * a0 - 2.0 * a1) * t2) / (2.0 * t3 * t);
+                c[5] = (12.0 * (p1 - p0) - 6.0 * (v1 + v0) * t + (a1 - a0) * t2) / (2.0 * t3 * t2);
+            }
+        }
+    }
+}
+
+size_t JointTrajectory::segmentAt(double time) const
+{
+    // 第一个大于time的节点之前一段
+    const auto it = std::upper_bound(m_times.begin(), m_times.end(), time);
+    const size_t index = static_cast<size_t>(it - m_times.begin());
+    return std::min(index > 0 ? index - 1 : 0, m_times.size() - 2);
+}
+
+void JointTrajectory::evaluateSegment(size_t segment, double tau, double* angles, double* velocities,
+                                      double* accelerations) const
+{
+    const double* coefficients = m_coefficients.data() + segment * kJoints * kOrder;
+    for (int j = 0; j < kJoints; ++j) {
+        const double* c = coefficients + j * kOrder;
+        angles[j] = c[0] + tau * (c[1] + tau * (c[2] + tau * (c[3] + tau * (c[4] + tau * c[5]))));
+        if (velocities) {
+            velocities[j] = c[1] + tau * (2.0 * c[2] + tau * (3.0 * c[3] + tau * (4.0 * c[4] + tau * 5.0 * c[5])));
+        }
+        if (accelerations) {
+            accelerations[j] = 2.0 * c[2] + tau * (6.0 * c[3] + tau * (12.0 * c[4] + tau * 20.0 * c[5]));
+        }
+    }
+}
+
+} // namespace Robot
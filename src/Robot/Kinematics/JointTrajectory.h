@@ -0,0 +1,150 @@
+#ifndef JOINTTRAJECTORY_H
+#define JOINTTRAJECTORY_H
+
+#include "BatchForwardKinematics.h"
+#include "DampedLeastSquaresIK.h"
+#include "RobotKinematics.h"
+#include "TimeParameterization.h"
+
+#include <QList>
+#include <array>
+#include <vector>
+
+namespace Data {
+struct TrajectoryPoint;
+class TrajectoryData;
+}
+
+namespace Robot {
+
+/**
+ * @brief 关节空间轨迹
+ *
+ * 按时刻稠密存储采样点，每点6个关节角度（连续存放），可选存储关节速度。样条插值：
+ * - Linear：分段线性
+ * - CubicSpline：有速度时为三次Hermite（C1），否则为夹持三次样条（C2，起止速度为0）
+ * - QuinticSpline：节点速度取存储值或三点差分，加速度由速度差分求得，分段五次Hermite（C2），
+ *   起止点加速度为0，适合下发给控制器
+ *
+ * resample按控制器周期等时间间隔重采样，用于流式下发；
+ * fromTiming / fromCartesian / toCartesian 与笛卡尔轨迹TrajectoryData相互转换（批量逆解、正解）。
+ *
+ * 插值系数在append、setInterpolation中即时更新：追加只重算末尾受影响的三段，
+ * 无速度的三次样条是全局样条，每次追加重解全部节点。求值只读，可多线程同时调用。
+ */
+class JointTrajectory
+{
+public:
+    static constexpr int NUM_JOINTS = RobotKinematics::NUM_JOINTS;
+    using Joints = std::array<double, NUM_JOINTS>;
+
+    enum Interpolation {
+        Linear = 0,
+        CubicSpline,
+        QuinticSpline
+    };
+
+    explicit JointTrajectory(Interpolation interpolation = QuinticSpline);
+
+    void clear();
+    void reserve(size_t count);
+
+    /**
+     * @brief 追加采样点，时刻需严格递增
+     * @param angles 6个关节角度 (度)
+     * @param velocities 可选，6个关节速度 (度/秒)；有点未提供速度时丢弃全部速度
+     * @return 时刻不递增时返回false
+     */
+    bool append(double time, const double* angles, const double* velocities = nullptr);
+    bool append(double time, const Joints& angles);
+
+    size_t size() const { return m_times.size(); }
+    bool isEmpty() const { return m_times.empty(); }
+    bool hasVelocities() const { return !m_velocities.empty(); }
+
+    double startTime() const { return m_times.empty() ? 0.0 : m_times.front(); }
+    double endTime() const { return m_times.empty() ? 0.0 : m_times.back(); }
+    double duration() const { return endTime() - startTime(); }
+
+    /**
+     * @brief 第i个采样点：时刻 (秒)、关节角度 (度)、关节速度 (度/秒，无速度时为nullptr)
+     */
+    double timeAt(size_t index) const { return m_times[index]; }
+    const double* jointsAt(size_t index) const { return m_angles.data() + index * NUM_JOINTS; }
+    const double* velocitiesAt(size_t index) const;
+    Joints get(size_t index) const;
+
+    const std::vector<double>& times() const { return m_times; }
+    const std::vector<double>& angles() const { return m_angles; }
+
+    void setInterpolation(Interpolation interpolation);
+    Interpolation interpolation() const { return m_interpolation; }
+
+    /**
+     * @brief 按插值求time时刻的关节状态，超出时间范围时停在首/末点（速度、加速度为0）
+     * @param angles 输出6个关节角度 (度)
+     * @param velocities 可选，输出关节速度 (度/秒)
+     * @param accelerations 可选，输出关节加速度 (度/秒²)
+     */
+    bool evaluate(double time, double* angles, double* velocities = nullptr, double* accelerations = nullptr) const;
+    Joints positionAt(double time) const;
+
+    /**
+     * @brief 按固定周期重采样（含速度），首点为startTime，最后不足一个周期时按周期补齐并停在终点
+     * @param cycleTime 控制器插补周期 (秒)
+     */
+    JointTrajectory resample(double cycleTime) const;
+
+    /**
+     * @brief 转为结构体数组布局，供BatchForwardKinematics使用
+     */
+    JointBatch toBatch() const;
+
+    /**
+     * @brief 由时间参数化结果构造，停留点拆为到达、离开两个采样点
+     * @param angles count个路径点，第i个点的关节j为angles[i * 6 + j] (度)，与timing逐点对应
+     * @param dwellTimes 可选，与TimeParameterization::compute使用的停留时间一致
+     */
+    static JointTrajectory fromTiming(const double* angles, size_t count, const TimeParameterization::Result& timing,
+                                      const double* dwellTimes = nullptr, Interpolation interpolation = QuinticSpline);
+
+    /**
+     * @brief 笛卡尔轨迹转关节轨迹：批量逆解（逐点以前一点为初值）后按TOPP-RA参数化时间
+     * @param seed 第一个点逆解的初值 (度)
+     * @param path 可选，输出逆解结果，用于定位未收敛的点
+     * @return 有点逆解未收敛或参数化失败时返回false
+     */
+    static bool fromCartesian(const Data::TrajectoryData& trajectory, const DampedLeastSquaresIK& ik,
+                              const TimeParameterization& timing, const double* seed, JointTrajectory& result,
+                              DampedLeastSquaresIK::PathResult* path = nullptr);
+
+    /**
+     * @brief 关节轨迹转笛卡尔轨迹点：批量正解，速度为相邻采样点求得的TCP速度 (mm/s)
+     * @param flangeToTool 法兰到TCP的变换
+     */
+    QList<Data::TrajectoryPoint> toCartesian(const BatchForwardKinematics& forward,
+                                             const LinkMatrix& flangeToTool) const;
+
+private:
+    /**
+     * @brief 重算从firstSegment起的段系数（与段数对齐）
+     */
+    void updateCoefficients(size_t firstSegment);
+    size_t segmentAt(double time) const;
+    void evaluateSegment(size_t segment, double tau, double* angles, double* velocities,
+                         double* accelerations) const;
+
+private:
+    std::vector<double> m_times;
+    std::vector<double> m_angles;
+    std::vector<double> m_velocities;
+    Interpolation m_interpolation;
+    bool m_velocitiesComplete;                      // 全部采样点都提供了速度
+
+    // 第k段关节j的多项式系数 c0..c5（τ = t - t_k），五次以下的高次项为0
+    std::vector<double> m_coefficients;
+};
+
+} // namespace Robot
+
+#endif // JOINTTRAJECTORY_H
@@ -0,0 +1,549 @@
+#include "ReachabilityMap.h"
+#include "Models/TrajectoryData.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSaveFile>
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace Robot {
+
+namespace {
+
+const quint32 kFileMagic = 0x524D4150;      // "RMAP"
+const quint32 kFileVersion = 1;
+
+const size_t kChunkSamples = 1 << 20;       // 每轮采样数，限制中间结果的内存
+const size_t kParallelBlock = 4096;         // 每次领取的采样数，每块独立的随机数种子
+
+const quint32 kOutside = std::numeric_limits<quint32>::max();
+
+/**
+ * @brief 单次采样的结果，汇总前暂存
+ */
+struct Sample {
+    quint32 voxel;          // 体素索引，网格外为kOutside
+    quint32 bin;            // 接近方向区间
+    float manipulability;
+};
+
+void multiply(const LinkMatrix& a, const LinkMatrix& b, LinkMatrix& out)
+{
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            out[r * 4 + c] = a[r * 4 + 0] * b[0 * 4 + c] + a[r * 4 + 1] * b[1 * 4 + c]
+                           + a[r * 4 + 2] * b[2 * 4 + c];
+        }
+        out[r * 4 + 3] += a[r * 4 + 3];
+    }
+    out[12] = 0.0;
+    out[13] = 0.0;
+    out[14] = 0.0;
+    out[15] = 1.0;
+}
+
+/**
+ * @brief 可操作度 |det J|，J为TCP处的几何雅可比，平移行除以链长
+ */
+double computeManipulability(const LinkPoses& poses, const LinkMatrix& tcp, double reach)
+{
+    Eigen::Matrix<double, 6, 6> J;
+    const double px = tcp[3];
+    const double py = tcp[7];
+    const double pz = tcp[11];
+    for (int i = 0; i < RobotKinematics::NUM_JOINTS; ++i) {
+        // 关节i绕坐标系i-1的z轴转动，坐标系0为基座
+        double zx = 0.0, zy = 0.0, zz = 1.0;
+        double ox = 0.0, oy = 0.0, oz = 0.0;
+        if (i > 0) {
+            const LinkMatrix& f = poses[i - 1];
+            zx = f[2];
+            zy = f[6];
+            zz = f[10];
+            ox = f[3];
+            oy = f[7];
+            oz = f[11];
+        }
+        const double dx = px - ox;
+        const double dy = py - oy;
+        const double dz = pz - oz;
+        J(0, i) = (zy * dz - zz * dy) / reach;
+        J(1, i) = (zz * dx - zx * dz) / reach;
+        J(2, i) = (zx * dy - zy * dx) / reach;
+        J(3, i) = zx;
+        J(4, i) = zy;
+        J(5, i) = zz;
+    }
+    return std::abs(J.determinant());
+}
+
+/**
+ * @brief 按块动态分配到各线程
+ */
+template <typename Body>
+void parallelBlocks(size_t count, int threadCount, const Body& body)
+{
+    const size_t blocks = (count + kParallelBlock - 1) / kParallelBlock;
+    int workers = threadCount > 0 ? threadCount : static_cast<int>(std::thread::hardware_concurrency());
+    workers = static_cast<int>(std::max<size_t>(1, std::min<size_t>(std::max(1, workers), blocks)));
+
+    std::atomic<size_t> next(0);
+    auto run = [&]() {
+        for (;;) {
+            const size_t block = next.fetch_add(1);
+            if (block >= blocks) {
+                break;
+            }
+            body(block, block * kParallelBlock, std::min(count, (block + 1) * kParallelBlock));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (int w = 1; w < workers; ++w) {
+        threads.emplace_back(run);
+    }
+    run();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace
+
+int ReachabilityMap::Voxel::orientationCount() const
+{
+    int count = 0;
+    for (quint64 mask = orientationMask; mask != 0; mask &= mask - 1) {
+        ++count;
+    }
+    return count;
+}
+
+ReachabilityMap::ReachabilityMap()
+    : m_voxelSize(0.0)
+    , m_dims{0, 0, 0}
+{
+}
+
+void ReachabilityMap::reset()
+{
+    m_key.clear();
+    m_robotName.clear();
+    m_toolName.clear();
+    m_origin = QVector3D();
+    m_voxelSize = 0.0;
+    m_dims[0] = m_dims[1] = m_dims[2] = 0;
+    m_voxels.clear();
+}
+
+bool ReachabilityMap::build(const RobotKinematics& robot, const QString& toolName,
+                            const LinkMatrix& flangeToTool, const Options& options)
+{
+    reset();
+    if (options.voxelSize <= 0.0 || options.sampleCount == 0) {
+        qWarning() << "ReachabilityMap: 无效的采样参数" << options.voxelSize << options.sampleCount;
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 网格覆盖以基座为中心、半径为链长的立方体
+    double reach = std::sqrt(flangeToTool[3] * flangeToTool[3] + flangeToTool[7] * flangeToTool[7]
+                             + flangeToTool[11] * flangeToTool[11]);
+    for (const DHParameter& dh : robot.getDHParameters()) {
+        reach += std::sqrt(dh.a * dh.a + dh.d * dh.d);
+    }
+    const int dim = static_cast<int>(std::ceil(2.0 * reach / options.voxelSize)) + 1;
+    const double originValue = -0.5 * dim * options.voxelSize;
+    const size_t voxelCount = static_cast<size_t>(dim) * dim * dim;
+    if (voxelCount >= kOutside) {
+        qWarning() << "ReachabilityMap: 体素过小，网格尺寸" << dim;
+        return false;
+    }
+
+    m_robotName = robot.getRobotName();
+    m_toolName = toolName;
+    m_key = computeKey(robot, toolName, flangeToTool, options);
+    m_origin = QVector3D(originValue, originValue, originValue);
+    m_voxelSize = options.voxelSize;
+    m_dims[0] = m_dims[1] = m_dims[2] = dim;
+
+    std::array<JointLimit, RobotKinematics::NUM_JOINTS> limits;
+    for (int j = 0; j < RobotKinematics::NUM_JOINTS; ++j) {
+        limits[j] = robot.getJointLimit(j);
+    }
+
+    // 体素汇总：先累加再求平均
+    std::vector<double> manipulabilitySum(voxelCount, 0.0);
+    m_voxels.assign(voxelCount, Voxel());
+
+    std::vector<Sample> samples(std::min(options.sampleCount, kChunkSamples));
+    for (size_t chunkBegin = 0; chunkBegin < options.sampleCount; chunkBegin += kChunkSamples) {
+        const size_t chunkSize = std::min(kChunkSamples, options.sampleCount - chunkBegin);
+
+        // 并行采样：每块的随机数种子只取决于全局块号，结果与线程数无关
+        parallelBlocks(chunkSize, options.threadCount, [&](size_t block, size_t begin, size_t end) {
+            const quint64 globalBlock = chunkBegin / kParallelBlock + block;
+            std::mt19937_64 rng(options.seed * 0x9E3779B97F4A7C15ULL + globalBlock);
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+            std::array<double, RobotKinematics::NUM_JOINTS> angles;
+            LinkPoses poses;
+            LinkMatrix tcp;
+            for (size_t s = begin; s < end; ++s) {
+                for (int j = 0; j < RobotKinematics::NUM_JOINTS; ++j) {
+                    angles[j] = limits[j].min + (limits[j].max - limits[j].min) * unit(rng);
+                }
+                robot.computeLinkPoses(angles, poses);
+                multiply(poses[RobotKinematics::NUM_JOINTS - 1], flangeToTool, tcp);
+
+                Sample& sample = samples[s];
+                const long long index = indexOf(tcp[3], tcp[7], tcp[11]);
+                sample.voxel = index < 0 ? kOutside : static_cast<quint32>(index);
+                sample.bin = static_cast<quint32>(orientationBin(tcp[2], tcp[6], tcp[10]));
+                sample.manipulability = static_cast<float>(computeManipulability(poses, tcp, reach));
+            }
+        });
+
+        for (size_t s = 0; s < chunkSize; ++s) {
+            const Sample& sample = samples[s];
+            if (sample.voxel == kOutside) {
+                continue;
+            }
+            Voxel& voxel = m_voxels[sample.voxel];
+            ++voxel.sampleCount;
+            voxel.orientationMask |= quint64(1) << sample.bin;
+            voxel.maxManipulability = std::max(voxel.maxManipulability, sample.manipulability);
+            manipulabilitySum[sample.voxel] += sample.manipulability;
+        }
+    }
+
+    size_t reachable = 0;
+    for (size_t v = 0; v < voxelCount; ++v) {
+        Voxel& voxel = m_voxels[v];
+        if (voxel.sampleCount > 0) {
+            voxel.meanManipulability = static_cast<float>(manipulabilitySum[v] / voxel.sampleCount);
+            ++reachable;
+        }
+    }
+
+    qDebug() << "ReachabilityMap: 构建完成" << m_robotName << m_toolName
+             << "采样" << options.sampleCount << "网格" << dim << "^3"
+             << "可达体素" << reachable << "耗时" << timer.elapsed() << "ms";
+    return true;
+}
+
+bool ReachabilityMap::loadOrBuild(const RobotKinematics& robot, const QString& toolName,
+                                  const LinkMatrix& flangeToTool, const Options& options,
+                                  const QString& cacheDir)
+{
+    const QString key = computeKey(robot, toolName, flangeToTool, options);
+    const QString path = cachePathFor(robot.getRobotName(), toolName, key, cacheDir);
+    if (QFile::exists(path) && load(path, key)) {
+        return true;
+    }
+
+    if (!build(robot, toolName, flangeToTool, options)) {
+        return false;
+    }
+    save(path);
+    return true;
+}
+
+bool ReachabilityMap::save(const QString& filePath) const
+{
+    if (!isValid()) {
+        qWarning() << "ReachabilityMap: 体素图为空，不保存";
+        return false;
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "ReachabilityMap: 无法写入" << filePath << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    out << kFileMagic << kFileVersion << m_key << m_robotName << m_toolName
+        << m_origin << m_voxelSize << qint32(m_dims[0]) << qint32(m_dims[1]) << qint32(m_dims[2]);
+
+    // 只写可达体素
+    quint32 reachable = 0;
+    for (const Voxel& voxel : m_voxels) {
+        reachable += voxel.isReachable() ? 1 : 0;
+    }
+    out << reachable;
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    for (size_t v = 0; v < m_voxels.size(); ++v) {
+        const Voxel& voxel = m_voxels[v];
+        if (voxel.isReachable()) {
+            out << quint32(v) << voxel.sampleCount << voxel.meanManipulability
+                << voxel.maxManipulability << voxel.orientationMask;
+        }
+    }
+
+    if (out.status() != QDataStream::Ok || !file.commit()) {
+        qWarning() << "ReachabilityMap: 写入失败" << filePath;
+        return false;
+    }
+    qDebug() << "ReachabilityMap: 已保存" << filePath << "可达体素" << reachable;
+    return true;
+}
+
+bool ReachabilityMap::load(const QString& filePath, const QString& expectedKey)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "ReachabilityMap: 无法打开" << filePath;
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    in.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != kFileMagic || version != kFileVersion) {
+        qWarning() << "ReachabilityMap: 文件格式不匹配" << filePath;
+        return false;
+    }
+
+    QString key, robotName, toolName;
+    QVector3D origin;
+    double voxelSize = 0.0;
+    qint32 dims[3] = {0, 0, 0};
+    quint32 reachable = 0;
+    in >> key >> robotName >> toolName >> origin >> voxelSize >> dims[0] >> dims[1] >> dims[2] >> reachable;
+    if (!expectedKey.isEmpty() && key != expectedKey) {
+        qDebug() << "ReachabilityMap: 缓存参数已变化，忽略" << filePath;
+        return false;
+    }
+    const qint64 voxelCount = qint64(dims[0]) * dims[1] * dims[2];
+    if (in.status() != QDataStream::Ok || voxelSize <= 0.0 || dims[0] <= 0 || dims[1] <= 0 || dims[2] <= 0
+        || voxelCount >= kOutside || reachable > voxelCount) {
+        qWarning() << "ReachabilityMap: 文件头损坏" << filePath;
+        return false;
+    }
+
+    std::vector<Voxel> voxels(static_cast<size_t>(voxelCount));
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    for (quint32 n = 0; n < reachable; ++n) {
+        quint32 index = 0;
+        Voxel voxel;
+        in >> index >> voxel.sampleCount >> voxel.meanManipulability >> voxel.maxManipulability
+           >> voxel.orientationMask;
+        if (in.status() != QDataStream::Ok || index >= voxelCount) {
+            qWarning() << "ReachabilityMap: 体素数据损坏" << filePath;
+            return false;
+        }
+        voxels[index] = voxel;
+    }
+
+    m_key = key;
+    m_robotName = robotName;
+    m_toolName = toolName;
+    m_origin = origin;
+    m_voxelSize = voxelSize;
+    for (int a = 0; a < 3; ++a) {
+        m_dims[a] = dims[a];
+    }
+    m_voxels.swap(voxels);
+    qDebug() << "ReachabilityMap: 已加载" << filePath << "可达体素" << reachable;
+    return true;
+}
+
+QString ReachabilityMap::computeKey(const RobotKinematics& robot, const QString& toolName,
+                                    const LinkMatrix& flangeToTool, const Options& options)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    stream << kFileVersion << robot.getRobotName() << toolName;
+    for (const DHParameter& dh : robot.getDHParameters()) {
+        stream << dh.a << dh.alpha << dh.d << dh.theta;
+    }
+    for (int j = 0; j < RobotKinematics::NUM_JOINTS; ++j) {
+        const JointLimit limit = robot.getJointLimit(j);
+        stream << limit.min << limit.max;
+    }
+    for (double value : flangeToTool) {
+        stream << value;
+    }
+    // 线程数不影响结果，不参与键值
+    stream << options.voxelSize << quint64(options.sampleCount) << options.seed;
+
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+}
+
+QString ReachabilityMap::defaultCacheDir()
+{
+    // 与STEP网格缓存相同：项目根目录下的 data/cache（Debug -> bin -> build -> 项目根）
+    QDir appDir(QCoreApplication::applicationDirPath());
+    appDir.cdUp();
+    appDir.cdUp();
+    appDir.cdUp();
+    return appDir.absolutePath() + "/data/cache";
+}
+
+QString ReachabilityMap::cachePathFor(const QString& robotName, const QString& toolName, const QString& key,
+                                      const QString& cacheDir)
+{
+    static const QRegularExpression unsafeChars("[^a-zA-Z0-9_-]");
+
+    const QString dirPath = cacheDir.isEmpty() ? defaultCacheDir() : cacheDir;
+    QDir dir;
+    if (!dir.exists(dirPath)) {
+        dir.mkpath(dirPath);
+        qDebug() << "ReachabilityMap: 创建缓存目录:" << dirPath;
+    }
+
+    QString robotPart = robotName;
+    QString toolPart = toolName.isEmpty() ? QString("flange") : toolName;
+    robotPart.replace(unsafeChars, "_");
+    toolPart.replace(unsafeChars, "_");
+    return QString("%1/reach_%2_%3_%4.rmap").arg(dirPath, robotPart, toolPart, key.left(12));
+}
+
+long long ReachabilityMap::indexOf(double x, double y, double z) const
+{
+    const double fx = (x - m_origin.x()) / m_voxelSize;
+    const double fy = (y - m_origin.y()) / m_voxelSize;
+    const double fz = (z - m_origin.z()) / m_voxelSize;
+    if (!(fx >= 0.0 && fy >= 0.0 && fz >= 0.0)) {
+        return -1;
+    }
+    const long long i = static_cast<long long>(fx);
+    const long long j = static_cast<long long>(fy);
+    const long long k = static_cast<long long>(fz);
+    if (i >= m_dims[0] || j >= m_dims[1] || k >= m_dims[2]) {
+        return -1;
+    }
+    return (k * m_dims[1] + j) * m_dims[0] + i;
+}
+
+QVector3D ReachabilityMap::voxelCenter(int i, int j, int k) const
+{
+    return m_origin + QVector3D((i + 0.5) * m_voxelSize, (j + 0.5) * m_voxelSize, (k + 0.5) * m_voxelSize);
+}
+
+const ReachabilityMap::Voxel* ReachabilityMap::voxelAt(const QVector3D& point) const
+{
+    if (!isValid()) {
+        return nullptr;
+    }
+    const long long index = indexOf(point.x(), point.y(), point.z());
+    return index < 0 ? nullptr : &m_voxels[static_cast<size_t>(index)];
+}
+
+bool ReachabilityMap::isReachable(const QVector3D& point) const
+{
+    const Voxel* voxel = voxelAt(point);
+    return voxel && voxel->isReachable();
+}
+
+bool ReachabilityMap::isReachable(const QVector3D& point, const QVector3D& approach) const
+{
+    const Voxel* voxel = voxelAt(point);
+    if (!voxel || !voxel->isReachable()) {
+        return false;
+    }
+    const int bin = orientationBin(approach.x(), approach.y(), approach.z());
+    return (voxel->orientationMask >> bin) & 1;
+}
+
+double ReachabilityMap::orientationCoverage(const QVector3D& point) const
+{
+    const Voxel* voxel = voxelAt(point);
+    return voxel ? voxel->orientationCoverage() : 0.0;
+}
+
+double ReachabilityMap::manipulability(const QVector3D& point) const
+{
+    const Voxel* voxel = voxelAt(point);
+    return voxel ? voxel->meanManipulability : 0.0;
+}
+
+ReachabilityMap::PlacementScore ReachabilityMap::evaluatePlacement(const QList<Data::TrajectoryPoint>& points,
+                                                                   const QVector3D& offset) const
+{
+    PlacementScore score;
+    score.pointCount = points.size();
+    double sum = 0.0;
+    for (const Data::TrajectoryPoint& point : points) {
+        const Voxel* voxel = voxelAt(point.position + offset);
+        if (!voxel || !voxel->isReachable()) {
+            continue;
+        }
+        const double w = voxel->meanManipulability;
+        score.minManipulability = score.reachableCount == 0 ? w : std::min(score.minManipulability, w);
+        sum += w;
+        ++score.reachableCount;
+
+        // 工具z轴即喷枪方向
+        const QVector3D approach = point.orientation.normalized().rotatedVector(QVector3D(0, 0, 1));
+        const int bin = orientationBin(approach.x(), approach.y(), approach.z());
+        if ((voxel->orientationMask >> bin) & 1) {
+            ++score.orientationCount;
+        }
+    }
+    if (score.reachableCount > 0) {
+        score.meanManipulability = sum / score.reachableCount;
+    }
+    return score;
+}
+
+int ReachabilityMap::orientationBin(double x, double y, double z)
+{
+    // 立方体贴图：主轴方向选面，另两个分量在面上分3×3格
+    const double ax = std::abs(x);
+    const double ay = std::abs(y);
+    const double az = std::abs(z);
+    int face;
+    double u, v, m;
+    if (ax >= ay && ax >= az) {
+        face = x >= 0.0 ? 0 : 1;
+        u = y;
+        v = z;
+        m = ax;
+    } else if (ay >= az) {
+        face = y >= 0.0 ? 2 : 3;
+        u = x;
+        v = z;
+        m = ay;
+    } else {
+        face = z >= 0.0 ? 4 : 5;
+        u = x;
+        v = y;
+        m = az;
+    }
+    if (m <= 0.0) {
+        return 0;
+    }
+    const int cu = std::min(2, static_cast<int>((u / m + 1.0) * 1.5));
+    const int cv = std::min(2, static_cast<int>((v / m + 1.0) * 1.5));
+    return face * 9 + cu * 3 + cv;
+}
+
+} // namespace Robot
@@ -0,0 +1,175 @@
+#ifndef REACHABILITYMAP_H
+#define REACHABILITYMAP_H
+
+#include "RobotKinematics.h"
+
+#include <QList>
+#include <QString>
+#include <QVector3D>
+#include <vector>
+
+namespace Data {
+struct TrajectoryPoint;
+}
+
+namespace Robot {
+
+/**
+ * @brief 可达性体素图的采样参数
+ */
+struct ReachabilityMapOptions {
+    double voxelSize = 50.0;            // 体素边长 (mm)
+    size_t sampleCount = 2000000;       // 关节空间采样数
+    quint32 seed = 1;                   // 随机种子，相同参数的结果可复现
+    int threadCount = 0;                // 0表示使用全部硬件线程
+};
+
+/**
+ * @brief 可达性与可操作度体素图
+ *
+ * 在关节限位内并行随机采样关节空间，将TCP位置落入基座坐标系下的体素网格，每个体素记录：
+ * - 采样数（可达性）
+ * - 接近方向（工具z轴）覆盖：方向按立方体贴图分为6×3×3=54个区间
+ * - 可操作度：|det J|，平移行按链长归一化，与机器人尺寸无关
+ *
+ * 结果按机器人、工具、DH参数、关节限位和采样参数生成键值并缓存到磁盘，
+ * 参数不变时直接加载。查询为O(1)，可在规划时逐点调用；工件在挂具上的摆放可用evaluatePlacement评估。
+ */
+class ReachabilityMap
+{
+public:
+    static constexpr int ORIENTATION_BINS = 54;
+
+    using Options = ReachabilityMapOptions;
+
+    /**
+     * @brief 单个体素的统计
+     */
+    struct Voxel {
+        quint32 sampleCount = 0;
+        float meanManipulability = 0.0f;
+        float maxManipulability = 0.0f;
+        quint64 orientationMask = 0;        // 第b位表示接近方向区间b可达
+
+        bool isReachable() const { return sampleCount > 0; }
+        int orientationCount() const;
+        double orientationCoverage() const { return orientationCount() / double(ORIENTATION_BINS); }
+    };
+
+    /**
+     * @brief 工件摆放评估结果
+     */
+    struct PlacementScore {
+        int pointCount = 0;
+        int reachableCount = 0;             // 位置可达的点数
+        int orientationCount = 0;           // 位置和接近方向都可达的点数
+        double minManipulability = 0.0;     // 可达点所在体素平均可操作度的最小值
+        double meanManipulability = 0.0;
+
+        double reachableRatio() const { return pointCount > 0 ? reachableCount / double(pointCount) : 0.0; }
+        double orientationRatio() const { return pointCount > 0 ? orientationCount / double(pointCount) : 0.0; }
+    };
+
+    ReachabilityMap();
+
+    /**
+     * @brief 采样构建体素图
+     * @param robot 机器人（DH参数和关节限位）
+     * @param toolName 工具名称，参与缓存键值
+     * @param flangeToTool 法兰到TCP的变换
+     */
+    bool build(const RobotKinematics& robot, const QString& toolName, const LinkMatrix& flangeToTool,
+               const Options& options = Options());
+
+    /**
+     * @brief 从缓存加载，不存在或键值不匹配时构建并写入缓存
+     * @param cacheDir 缓存目录，为空时使用默认目录
+     */
+    bool loadOrBuild(const RobotKinematics& robot, const QString& toolName, const LinkMatrix& flangeToTool,
+                     const Options& options = Options(), const QString& cacheDir = QString());
+
+    bool save(const QString& filePath) const;
+
+    /**
+     * @brief 读取体素图
+     * @param expectedKey 非空时键值不一致则拒绝加载
+     */
+    bool load(const QString& filePath, const QString& expectedKey = QString());
+
+    /**
+     * @brief 缓存键值：机器人名称、工具名称、DH参数、关节限位、工具坐标系和采样参数的SHA-1
+     */
+    static QString computeKey(const RobotKinematics& robot, const QString& toolName,
+                              const LinkMatrix& flangeToTool, const Options& options);
+
+    /**
+     * @brief 默认缓存目录（项目根目录下的 data/cache）
+     */
+    static QString defaultCacheDir();
+
+    static QString cachePathFor(const QString& robotName, const QString& toolName, const QString& key,
+                                const QString& cacheDir = QString());
+
+    bool isValid() const { return !m_voxels.empty(); }
+    const QString& key() const { return m_key; }
+    const QString& robotName() const { return m_robotName; }
+    const QString& toolName() const { return m_toolName; }
+
+    /**
+     * @brief 网格信息：体素(i, j, k)的最小角为 origin + (i, j, k)·voxelSize
+     */
+    const QVector3D& origin() const { return m_origin; }
+    double voxelSize() const { return m_voxelSize; }
+    int dimX() const { return m_dims[0]; }
+    int dimY() const { return m_dims[1]; }
+    int dimZ() const { return m_dims[2]; }
+    const std::vector<Voxel>& voxels() const { return m_voxels; }
+
+    /**
+     * @brief 按体素索引取中心点
+     */
+    QVector3D voxelCenter(int i, int j, int k) const;
+
+    /**
+     * @brief 基座坐标系下的点所在体素，网格外返回nullptr
+     */
+    const Voxel* voxelAt(const QVector3D& point) const;
+
+    bool isReachable(const QVector3D& point) const;
+
+    /**
+     * @brief 点可达且工具z轴可沿approach方向
+     */
+    bool isReachable(const QVector3D& point, const QVector3D& approach) const;
+
+    double orientationCoverage(const QVector3D& point) const;
+    double manipulability(const QVector3D& point) const;
+
+    /**
+     * @brief 评估轨迹平移offset后（工件放在挂具上的位置）的可达性
+     */
+    PlacementScore evaluatePlacement(const QList<Data::TrajectoryPoint>& points,
+                                     const QVector3D& offset = QVector3D()) const;
+
+    /**
+     * @brief 接近方向所在的区间 (0 - ORIENTATION_BINS-1)
+     */
+    static int orientationBin(double x, double y, double z);
+
+private:
+    void reset();
+    long long indexOf(double x, double y, double z) const;
+
+private:
+    QString m_key;
+    QString m_robotName;
+    QString m_toolName;
+    QVector3D m_origin;
+    double m_voxelSize;
+    int m_dims[3];
+    std::vector<Voxel> m_voxels;
+};
+
+} // namespace Robot
+
+#endif // REACHABILITYMAP_H
@@ -1,15 +1,49 @@
 #include "RobotKinematics.h"
 #include <QtMath>
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
 
 namespace Robot {
 
+namespace {
+
+/**
+ * @brief DH变换的旋转部分 Rz(theta)·Rx(alpha)，行主序3x3
+ */
+inline void dhRotation(double theta, double cosAlpha, double sinAlpha, double out[9])
+{
+    const double ct = std::cos(theta);
+    const double st = std::sin(theta);
+    out[0] = ct;  out[1] = -st * cosAlpha; out[2] = st * sinAlpha;
+    out[3] = st;  out[4] = ct * cosAlpha;  out[5] = -ct * sinAlpha;
+    out[6] = 0.0; out[7] = sinAlpha;       out[8] = cosAlpha;
+}
+
+/**
+ * @brief lhs = lhs·rhs（3x3行主序）
+ */
+inline void multiply3(double lhs[9], const double rhs[9])
+{
+    double product[9];
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            product[r * 3 + c] = lhs[r * 3] * rhs[c] + lhs[r * 3 + 1] * rhs[3 + c] + lhs[r * 3 + 2] * rhs[6 + c];
+        }
+    }
+    std::copy(product, product + 9, lhs);
+}
+
+} // namespace
+
 RobotKinematics::RobotKinematics(QObject* parent)
     : QObject(parent)
     , m_robotName("YASKAWA MPX3500")
 {
     initDHParameters();
     initJointLimits();
+    initLinkCache();
+    initInverseKinematics();
     resetToHome();
 }
 
@@ -20,40 +54,51 @@ RobotKinematics::~RobotKinematics()
 void RobotKinematics::initDHParameters()
 {
     // 安川MPX3500机器人DH参数 (近似值，实际需要根据机器人手册调整)
-    // 参数: a(mm), alpha(rad), d(mm), theta(rad)
-    
-    // J1: 基座旋转
-    m_dhParams[0] = {0, -M_PI/2, 330, 0};
-    
-    // J2: 肩部
-    m_dhParams[1] = {680, 0, 0, -M_PI/2};
-    
-    // J3: 肘部
-    m_dhParams[2] = {0, -M_PI/2, 0, 0};
-    
-    // J4: 手腕旋转
-    m_dhParams[3] = {0, M_PI/2, 680, 0};
-    
-    // J5: 手腕俯仰
-    m_dhParams[4] = {0, -M_PI/2, 0, 0};
-    
-    // J6: 末端旋转
-    m_dhParams[5] = {0, 0, 100, 0};
+    // 参数表在DHChain.h的Mpx3500Model中，与编译期特化的运动学链共用
+    m_dhParams = Mpx3500Model::kDH;
     
     qDebug() << "RobotKinematics: DH参数初始化完成 -" << m_robotName;
 }
 
+void RobotKinematics::initLinkCache()
+{
+    // 与DHChain相同的取整规则，±90°扭角的余弦精确为0
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        m_cosAlpha[i] = DHChain<Mpx3500Model>::constCos(m_dhParams[i].alpha);
+        m_sinAlpha[i] = DHChain<Mpx3500Model>::constSin(m_dhParams[i].alpha);
+    }
+
+    // 刚体变换求逆：[R t]⁻¹ = [Rᵀ -Rᵀt]
+    LinkPoses home;
+    computeLinkPoses(std::array<double, NUM_JOINTS>{}, home);
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        const LinkMatrix& m = home[i];
+        LinkMatrix& inv = m_homeInverse[i];
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 3; ++c) {
+                inv[r * 4 + c] = m[c * 4 + r];
+            }
+            inv[r * 4 + 3] = -(m[0 * 4 + r] * m[3] + m[1 * 4 + r] * m[7] + m[2 * 4 + r] * m[11]);
+        }
+        inv[12] = 0.0;
+        inv[13] = 0.0;
+        inv[14] = 0.0;
+        inv[15] = 1.0;
+    }
+}
+
 void RobotKinematics::initJointLimits()
 {
     // 安川MPX3500关节限位 (度)
-    // 参数: min, max, maxVel(度/秒)
+    // 参数: min, max, maxVel(度/秒), maxAcc(度/秒²)
+    // 加速度为保守估计值（约0.25秒加速到最大速度），以控制器实测为准
     
-    m_jointLimits[0] = {-180, 180, 180};   // J1
-    m_jointLimits[1] = {-90, 155, 180};    // J2
-    m_jointLimits[2] = {-175, 90, 180};    // J3
-    m_jointLimits[3] = {-200, 200, 400};   // J4
-    m_jointLimits[4] = {-150, 150, 400};   // J5
-    m_jointLimits[5] = {-455, 455, 600};   // J6
+    m_jointLimits[0] = {-180, 180, 180, 720};    // J1
+    m_jointLimits[1] = {-90, 155, 180, 720};     // J2
+    m_jointLimits[2] = {-175, 90, 180, 720};     // J3
+    m_jointLimits[3] = {-200, 200, 400, 1600};   // J4
+    m_jointLimits[4] = {-150, 150, 400, 1600};   // J5
+    m_jointLimits[5] = {-455, 455, 600, 2400};   // J6
     
     qDebug() << "RobotKinematics: 关节限位初始化完成";
 }
@@ -61,14 +106,11 @@ void RobotKinematics::initJointLimits()
 void RobotKinematics::resetToHome()
 {
     // 零位姿态
-    for (int i = 0; i < NUM_JOINTS; ++i) {
-        m_jointAngles[i] = 0.0;
-    }
+    m_jointAngles.fill(0.0);
     
     qDebug() << "RobotKinematics: 重置到零位";
     
-    EndEffectorPose pose = forwardKinematics();
-    emit endEffectorPoseChanged(pose);
+    emit jointStateChanged(m_jointAngles, forwardKinematics());
 }
 
 bool RobotKinematics::setJointAngle(int jointIndex, double angle)
@@ -78,45 +120,64 @@ bool RobotKinematics::setJointAngle(int jointIndex, double angle)
         return false;
     }
     
-    const JointLimit& limit = m_jointLimits[jointIndex];
+    const bool inLimit = clampToLimit(jointIndex, angle);
+    
+    std::array<double, NUM_JOINTS> angles = m_jointAngles;
+    angles[jointIndex] = angle;
+    commitJointAngles(angles);
     
-    // 检查限位
-    if (angle < limit.min || angle > limit.max) {
-        qWarning() << "RobotKinematics: 关节" << (jointIndex + 1) 
-                   << "角度超限:" << angle 
-                   << "范围:[" << limit.min << "," << limit.max << "]";
-        emit jointLimitWarning(jointIndex, angle);
-        
-        // 限制到有效范围
-        angle = qBound(limit.min, angle, limit.max);
+    return inLimit;
+}
+
+bool RobotKinematics::setJointAngles(const std::array<double, NUM_JOINTS>& angles)
+{
+    // 先检查全部关节，再整体更新
+    std::array<double, NUM_JOINTS> clamped = angles;
+    bool allValid = true;
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        if (!clampToLimit(i, clamped[i])) {
+            allValid = false;
+        }
     }
     
-    if (qFuzzyCompare(m_jointAngles[jointIndex], angle)) {
+    commitJointAngles(clamped);
+    return allValid;
+}
+
+bool RobotKinematics::clampToLimit(int jointIndex, double& angle)
+{
+    const JointLimit& limit = m_jointLimits[jointIndex];
+    if (angle >= limit.min && angle <= limit.max) {
         return true;
     }
     
-    m_jointAngles[jointIndex] = angle;
-    
-    emit jointAngleChanged(jointIndex, angle);
+    qWarning() << "RobotKinematics: 关节" << (jointIndex + 1) 
+               << "角度超限:" << angle 
+               << "范围:[" << limit.min << "," << limit.max << "]";
+    emit jointLimitWarning(jointIndex, angle);
     
-    // 计算并发送末端位姿
-    EndEffectorPose pose = forwardKinematics();
-    emit endEffectorPoseChanged(pose);
-    
-    return true;
+    // 限制到有效范围
+    angle = qBound(limit.min, angle, limit.max);
+    return false;
 }
 
-bool RobotKinematics::setJointAngles(const std::array<double, NUM_JOINTS>& angles)
+void RobotKinematics::commitJointAngles(const std::array<double, NUM_JOINTS>& angles)
 {
-    bool allValid = true;
-    
+    bool changed = false;
     for (int i = 0; i < NUM_JOINTS; ++i) {
-        if (!setJointAngle(i, angles[i])) {
-            allValid = false;
+        if (!qFuzzyCompare(m_jointAngles[i], angles[i])) {
+            changed = true;
+            break;
         }
     }
+    if (!changed) {
+        return;
+    }
     
-    return allValid;
+    m_jointAngles = angles;
+    
+    // 全部关节更新后只计算一次正解、发出一次通知
+    emit jointStateChanged(m_jointAngles, forwardKinematics());
 }
 
 double RobotKinematics::getJointAngle(int jointIndex) const
@@ -135,7 +196,7 @@ std::array<double, RobotKinematics::NUM_JOINTS> RobotKinematics::getJointAngles(
 JointLimit RobotKinematics::getJointLimit(int jointIndex) const
 {
     if (jointIndex < 0 || jointIndex >= NUM_JOINTS) {
-        return {0, 0, 0};
+        return {0, 0, 0, 0};
     }
     return m_jointLimits[jointIndex];
 }
@@ -150,40 +211,6 @@ double RobotKinematics::radToDeg(double rad) const
     return rad * 180.0 / M_PI;
 }
 
-QMatrix4x4 RobotKinematics::computeDHMatrix(const DHParameter& dh) const
-{
-    double ct = qCos(dh.theta);
-    double st = qSin(dh.theta);
-    double ca = qCos(dh.alpha);
-    double sa = qSin(dh.alpha);
-    
-    QMatrix4x4 T;
-    T.setToIdentity();
-    
-    // DH变换矩阵
-    T(0, 0) = ct;
-    T(0, 1) = -st * ca;
-    T(0, 2) = st * sa;
-    T(0, 3) = dh.a * ct;
-    
-    T(1, 0) = st;
-    T(1, 1) = ct * ca;
-    T(1, 2) = -ct * sa;
-    T(1, 3) = dh.a * st;
-    
-    T(2, 0) = 0;
-    T(2, 1) = sa;
-    T(2, 2) = ca;
-    T(2, 3) = dh.d;
-    
-    T(3, 0) = 0;
-    T(3, 1) = 0;
-    T(3, 2) = 0;
-    T(3, 3) = 1;
-    
-    return T;
-}
-
 std::vector<QMatrix4x4> RobotKinematics::getJointTransforms() const
 {
     std::vector<QMatrix4x4> transforms;
@@ -194,33 +221,69 @@ std::vector<QMatrix4x4> RobotKinematics::getJointTransforms() const
     T.setToIdentity();
     transforms.push_back(T);
     
-    // 各关节变换
-    for (int i = 0; i < NUM_JOINTS; ++i) {
-        DHParameter dh = m_dhParams[i];
-        dh.theta += degToRad(m_jointAngles[i]);  // 加上关节角度
-        
-        QMatrix4x4 Ti = computeDHMatrix(dh);
-        T = T * Ti;
-        transforms.push_back(T);
+    // 各关节变换，与computeLinkPoses同一计算路径
+    LinkPoses poses;
+    computeLinkPoses(m_jointAngles, poses);
+    for (const LinkMatrix& pose : poses) {
+        QMatrix4x4 Ti;
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                Ti(r, c) = static_cast<float>(pose[r * 4 + c]);
+            }
+        }
+        transforms.push_back(Ti);
     }
     
     return transforms;
 }
 
+void RobotKinematics::computeLinkPoses(const std::array<double, NUM_JOINTS>& angles, LinkPoses& poses) const
+{
+    // m_dhParams取自Mpx3500Model，使用编译期展开的运动学链
+    double radians[NUM_JOINTS];
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        radians[i] = degToRad(angles[i]);
+    }
+    DHChain<Mpx3500Model>::computeLinkPoses(radians, poses.data());
+}
+
+void RobotKinematics::computeLinkDisplacements(const std::array<double, NUM_JOINTS>& angles,
+                                               LinkPoses& displacements) const
+{
+    LinkPoses poses;
+    computeLinkPoses(angles, poses);
+    for (int i = 0; i < NUM_JOINTS; ++i) {
+        const LinkMatrix& a = poses[i];
+        const LinkMatrix& b = m_homeInverse[i];
+        LinkMatrix& out = displacements[i];
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                out[r * 4 + c] = a[r * 4 + 0] * b[c] + a[r * 4 + 1] * b[4 + c] + a[r * 4 + 2] * b[8 + c];
+            }
+            out[r * 4 + 3] += a[r * 4 + 3];
+        }
+        out[12] = 0.0;
+        out[13] = 0.0;
+        out[14] = 0.0;
+        out[15] = 1.0;
+    }
+}
+
 EndEffectorPose RobotKinematics::forwardKinematics() const
 {
-    std::vector<QMatrix4x4> transforms = getJointTransforms();
-    QMatrix4x4 T = transforms.back();
+    LinkPoses poses;
+    computeLinkPoses(m_jointAngles, poses);
+    const LinkMatrix& T = poses.back();
     
     EndEffectorPose pose;
     
     // 提取位置
-    pose.position = QVector3D(T(0, 3), T(1, 3), T(2, 3));
+    pose.position = QVector3D(T[3], T[7], T[11]);
     
     // 提取姿态 (从旋转矩阵计算RPY角)
-    double r11 = T(0, 0), r12 = T(0, 1), r13 = T(0, 2);
-    double r21 = T(1, 0), r22 = T(1, 1), r23 = T(1, 2);
-    double r31 = T(2, 0), r32 = T(2, 1), r33 = T(2, 2);
+    double r11 = T[0], r12 = T[1];
+    double r21 = T[4], r22 = T[5];
+    double r31 = T[8], r32 = T[9], r33 = T[10];
     
     double roll, pitch, yaw;
     
@@ -244,18 +307,274 @@ EndEffectorPose RobotKinematics::forwardKinematics() const
 bool RobotKinematics::inverseKinematics(const EndEffectorPose& targetPose,
                                         std::array<double, NUM_JOINTS>& solution) const
 {
-    // 逆运动学计算 - 简化版本
-    // 实际应用中需要使用更复杂的算法（如数值迭代法）
-    
-    // TODO: 实现完整的逆运动学算法
-    // 这里只是一个占位实现
-    
-    qWarning() << "RobotKinematics: 逆运动学尚未完全实现";
-    
+    if (inverseKinematics(targetPose, m_jointAngles, solution)) {
+        return true;
+    }
+
+    qWarning() << "RobotKinematics: 目标位姿无限位内的逆解 位置:" << targetPose.position
+               << "姿态:" << targetPose.orientation;
+
     // 返回当前角度作为默认解
     solution = m_jointAngles;
-    
     return false;
 }
 
+bool RobotKinematics::inverseKinematics(const EndEffectorPose& targetPose,
+                                        const std::array<double, NUM_JOINTS>& seed,
+                                        std::array<double, NUM_JOINTS>& solution) const
+{
+    return inverseKinematics(poseToMatrix(targetPose), seed, solution);
+}
+
+bool RobotKinematics::inverseKinematics(const LinkMatrix& target,
+                                        const std::array<double, NUM_JOINTS>& seed,
+                                        std::array<double, NUM_JOINTS>& solution) const
+{
+    std::array<std::array<double, NUM_JOINTS>, MAX_IK_SOLUTIONS> solutions;
+    if (inverseKinematicsAll(target, seed, solutions) == 0) {
+        return false;
+    }
+    solution = solutions[0];
+    return true;
+}
+
+void RobotKinematics::initInverseKinematics()
+{
+    const double eps = 1e-9;
+    const DHParameter* dh = m_dhParams.data();
+
+    // 解析解要求：J2、J3轴平行（alpha2 = 0），J1与J2轴相交或正交（alpha1 ≠ 0），
+    // J4-J6轴交于一点（a4 = a5 = d5 = 0，alpha4、alpha5 = ±90°）
+    m_analyticIk = m_cosAlpha[1] > 1.0 - eps
+                && std::abs(m_sinAlpha[0]) > eps
+                && std::abs(dh[3].a) < eps && std::abs(dh[4].a) < eps && std::abs(dh[4].d) < eps
+                && std::abs(m_cosAlpha[3]) < eps && std::abs(m_cosAlpha[4]) < eps;
+
+    // 关节3坐标系中腕心为 Rx(alpha3)·(0, 0, d4) + (a3, 0, 0)
+    m_forearmX = dh[2].a;
+    m_forearmY = -m_sinAlpha[2] * dh[3].d;
+    m_shoulderOffset = dh[1].d + dh[2].d + m_cosAlpha[2] * dh[3].d;
+
+    if (!m_analyticIk) {
+        qWarning() << "RobotKinematics: DH结构不满足球形手腕条件，解析逆解不可用";
+    }
+}
+
+bool RobotKinematics::wrapToLimit(int jointIndex, double angle, double seed, double& wrapped) const
+{
+    // 取angle + k·360中在限位内且离种子最近的一个
+    const JointLimit& limit = m_jointLimits[jointIndex];
+    const double base = angle + 360.0 * std::round((seed - angle) / 360.0);
+    bool found = false;
+    double bestDistance = 0.0;
+    for (int k = -2; k <= 2; ++k) {
+        const double candidate = base + 360.0 * k;
+        if (candidate < limit.min - 1e-9 || candidate > limit.max + 1e-9) {
+            continue;
+        }
+        const double distance = std::abs(candidate - seed);
+        if (!found || distance < bestDistance) {
+            wrapped = qBound(limit.min, candidate, limit.max);
+            bestDistance = distance;
+            found = true;
+        }
+    }
+    return found;
+}
+
+int RobotKinematics::inverseKinematicsAll(const LinkMatrix& target,
+                                          const std::array<double, NUM_JOINTS>& seed,
+                                          std::array<std::array<double, NUM_JOINTS>, MAX_IK_SOLUTIONS>& solutions) const
+{
+    if (!m_analyticIk) {
+        return 0;
+    }
+
+    const DHParameter* dh = m_dhParams.data();
+    const double eps = 1e-9;
+
+    // 腕心 = 法兰位置 - d6·z6（法兰z轴为目标矩阵第3列）
+    const double px = target[3] - dh[5].d * target[2];
+    const double py = target[7] - dh[5].d * target[6];
+    const double pz = target[11] - dh[5].d * target[10];
+
+    // J1：腕心在连杆1坐标系中的z坐标必须等于肩部偏移，
+    // 即 -sin(t1)·x + cos(t1)·y = k，两个解对应肩部朝前/朝后
+    const double k = (m_cosAlpha[0] * (pz - dh[0].d) - m_shoulderOffset) / m_sinAlpha[0];
+    const double rho = std::hypot(px, py);
+    if (rho < std::abs(k) - 1e-9) {
+        return 0;
+    }
+
+    double shoulder[2];
+    int shoulderCount = 2;
+    if (rho < eps) {
+        // 腕心在J1轴上（肩部奇异），J1任取，保持种子
+        shoulder[0] = degToRad(seed[0]) + dh[0].theta;
+        shoulderCount = 1;
+    } else {
+        const double phi = std::atan2(py, px);
+        const double delta = std::asin(qBound(-1.0, k / rho, 1.0));
+        shoulder[0] = phi - delta;
+        shoulder[1] = phi - M_PI + delta;
+    }
+
+    const double a2 = dh[1].a;
+    const double forearm = std::hypot(m_forearmX, m_forearmY);
+    const double beta = std::atan2(m_forearmY, m_forearmX);
+
+    std::array<double, NUM_JOINTS> raw;
+    std::array<double, NUM_JOINTS> wrapped;
+    LinkPoses check;
+    int count = 0;
+
+    for (int si = 0; si < shoulderCount; ++si) {
+        const double t1 = shoulder[si];
+        const double c1 = std::cos(t1);
+        const double s1 = std::sin(t1);
+
+        // 腕心转到连杆1坐标系：p1 = Rx(alpha1)ᵀ·(Rz(t1)ᵀ·(p - d1·z) - a1·x)
+        const double ux = c1 * px + s1 * py - dh[0].a;
+        const double uy = -s1 * px + c1 * py;
+        const double uz = pz - dh[0].d;
+        const double tx = ux;
+        const double ty = m_cosAlpha[0] * uy + m_sinAlpha[0] * uz;
+
+        // J3：平面两连杆的余弦定理，两个解对应肘部朝上/朝下
+        const double cosElbow = (tx * tx + ty * ty - a2 * a2 - forearm * forearm) / (2.0 * a2 * forearm);
+        if (std::abs(cosElbow) > 1.0 + 1e-9) {
+            continue;
+        }
+        const double elbowAngle = std::acos(qBound(-1.0, cosElbow, 1.0));
+
+        for (int ei = 0; ei < 2; ++ei) {
+            const double t3 = (ei == 0 ? elbowAngle : -elbowAngle) - beta;
+            const double c3 = std::cos(t3);
+            const double s3 = std::sin(t3);
+            const double mx = a2 + m_forearmX * c3 - m_forearmY * s3;
+            const double my = m_forearmX * s3 + m_forearmY * c3;
+            const double t2 = std::atan2(ty, tx) - std::atan2(my, mx);
+
+            raw[0] = t1;
+            raw[1] = t2;
+            raw[2] = t3;
+
+            // R03 = Rz(t1)Rx(alpha1)·Rz(t2)Rx(alpha2)·Rz(t3)Rx(alpha3)
+            double r03[9];
+            double a[9];
+            dhRotation(raw[0], m_cosAlpha[0], m_sinAlpha[0], r03);
+            for (int j = 1; j < 3; ++j) {
+                dhRotation(raw[j], m_cosAlpha[j], m_sinAlpha[j], a);
+                multiply3(r03, a);
+            }
+
+            // 手腕旋转 M = R03ᵀ·R·Rx(alpha6)ᵀ = Rz(t4)Rx(alpha4)Rz(t5)Rx(alpha5)Rz(t6)
+            double m[9];
+            for (int r = 0; r < 3; ++r) {
+                double row[3];
+                for (int c = 0; c < 3; ++c) {
+                    row[c] = r03[r] * target[c] + r03[3 + r] * target[4 + c] + r03[6 + r] * target[8 + c];
+                }
+                m[r * 3 + 0] = row[0];
+                m[r * 3 + 1] = m_cosAlpha[5] * row[1] + m_sinAlpha[5] * row[2];
+                m[r * 3 + 2] = -m_sinAlpha[5] * row[1] + m_cosAlpha[5] * row[2];
+            }
+
+            // 第3列 = (c4·sa5·s5, s4·sa5·s5, -sa4·sa5·c5)，第3行 = sa4·(s5·c6, -s5·s6, -sa5·c5)
+            const double sa4 = m_sinAlpha[3];
+            const double sa5 = m_sinAlpha[4];
+            const double c5 = qBound(-1.0, -m[8] / (sa4 * sa5), 1.0);
+            const double h = std::hypot(m[2], m[5]);
+            const bool wristSingular = h < 1e-9;
+
+            for (int wi = 0; wi < (wristSingular ? 1 : 2); ++wi) {
+                if (!wristSingular) {
+                    const double sigma = wi == 0 ? 1.0 : -1.0;
+                    const double s5 = sigma * sa5 * h;
+                    raw[3] = std::atan2(sigma * m[5], sigma * m[2]);
+                    raw[4] = std::atan2(s5, c5);
+                    const double sign = sa4 * s5 > 0.0 ? 1.0 : -1.0;
+                    raw[5] = std::atan2(-sign * m[7], sign * m[6]);
+                } else {
+                    // J5奇异：J4与J6共轴，J4保持种子，余下转角全部给J6：Rz(t6) = Pᵀ·M
+                    raw[3] = degToRad(seed[3]) + dh[3].theta;
+                    raw[4] = c5 > 0.0 ? 0.0 : M_PI;
+                    double p[9];
+                    double a5[9];
+                    dhRotation(raw[3], m_cosAlpha[3], m_sinAlpha[3], p);
+                    dhRotation(raw[4], m_cosAlpha[4], m_sinAlpha[4], a5);
+                    multiply3(p, a5);
+                    const double n00 = p[0] * m[0] + p[3] * m[3] + p[6] * m[6];
+                    const double n10 = p[1] * m[0] + p[4] * m[3] + p[7] * m[6];
+                    raw[5] = std::atan2(n10, n00);
+                }
+
+                // 转为关节角（去掉DH零位偏置），折算到限位内离种子最近的等价角
+                bool valid = true;
+                for (int j = 0; j < NUM_JOINTS && valid; ++j) {
+                    valid = wrapToLimit(j, radToDeg(raw[j] - dh[j].theta), seed[j], wrapped[j]);
+                }
+                if (!valid) {
+                    continue;
+                }
+
+                // 用正解校验（排除数值退化情况）
+                computeLinkPoses(wrapped, check);
+                const LinkMatrix& flange = check[NUM_JOINTS - 1];
+                double positionError = 0.0;
+                double rotationError = 0.0;
+                for (int r = 0; r < 3; ++r) {
+                    positionError = std::max(positionError, std::abs(flange[r * 4 + 3] - target[r * 4 + 3]));
+                    for (int c = 0; c < 3; ++c) {
+                        rotationError = std::max(rotationError, std::abs(flange[r * 4 + c] - target[r * 4 + c]));
+                    }
+                }
+                if (positionError > 1e-3 || rotationError > 1e-6) {
+                    continue;
+                }
+
+                // 按离种子的距离插入排序
+                double distance = 0.0;
+                for (int j = 0; j < NUM_JOINTS; ++j) {
+                    distance += (wrapped[j] - seed[j]) * (wrapped[j] - seed[j]);
+                }
+                int slot = count;
+                while (slot > 0) {
+                    double previous = 0.0;
+                    for (int j = 0; j < NUM_JOINTS; ++j) {
+                        previous += (solutions[slot - 1][j] - seed[j]) * (solutions[slot - 1][j] - seed[j]);
+                    }
+                    if (previous <= distance) {
+                        break;
+                    }
+                    solutions[slot] = solutions[slot - 1];
+                    --slot;
+                }
+                solutions[slot] = wrapped;
+                ++count;
+            }
+        }
+    }
+
+    return count;
+}
+
+LinkMatrix RobotKinematics::poseToMatrix(const EndEffectorPose& pose)
+{
+    // R = Rz(yaw)·Ry(pitch)·Rx(roll)，与forwardKinematics的RPY提取一致
+    const double roll = pose.orientation.x() * M_PI / 180.0;
+    const double pitch = pose.orientation.y() * M_PI / 180.0;
+    const double yaw = pose.orientation.z() * M_PI / 180.0;
+    const double cr = std::cos(roll), sr = std::sin(roll);
+    const double cp = std::cos(pitch), sp = std::sin(pitch);
+    const double cy = std::cos(yaw), sy = std::sin(yaw);
+
+    return LinkMatrix{
+        cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr, pose.position.x(),
+        sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr, pose.position.y(),
+        -sp,     cp * sr,                cp * cr,                pose.position.z(),
+        0.0,     0.0,                    0.0,                    1.0
+    };
+}
+
 } // namespace Robot
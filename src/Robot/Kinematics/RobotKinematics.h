@@ -7,17 +7,9 @@
 #include <array>
 #include <vector>
 
-namespace Robot {
+#include "DHChain.h"
 
-/**
- * @brief 机器人DH参数结构
- */
-struct DHParameter {
-    double a;       // 连杆长度 (mm)
-    double alpha;   // 连杆扭角 (rad)
-    double d;       // 连杆偏距 (mm)
-    double theta;   // 关节角度 (rad)
-};
+namespace Robot {
 
 /**
  * @brief 关节限位结构
@@ -26,6 +18,7 @@ struct JointLimit {
     double min;     // 最小角度 (度)
     double max;     // 最大角度 (度)
     double maxVel;  // 最大速度 (度/秒)
+    double maxAcc;  // 最大加速度 (度/秒²)
 };
 
 /**
@@ -36,6 +29,11 @@ struct EndEffectorPose {
     QVector3D orientation;  // 姿态 (RPY角度，度)
 };
 
+/**
+ * @brief 6个连杆的位姿
+ */
+using LinkPoses = std::array<LinkMatrix, 6>;
+
 /**
  * @brief 安川MPX3500机器人运动学类
  * 
@@ -49,6 +47,7 @@ class RobotKinematics : public QObject
 
 public:
     static constexpr int NUM_JOINTS = 6;
+    static constexpr int MAX_IK_SOLUTIONS = 8;
     
     explicit RobotKinematics(QObject* parent = nullptr);
     ~RobotKinematics();
@@ -56,13 +55,16 @@ public:
     /**
      * @brief 设置关节角度
      * @param jointIndex 关节索引 (0-5)
-     * @param angle 角度 (度)
+     * @param angle 角度 (度)，超限时限制到限位
      * @return 是否在限位范围内
      */
     bool setJointAngle(int jointIndex, double angle);
 
     /**
-     * @brief 设置所有关节角度
+     * @brief 原子地设置所有关节角度
+     * 
+     * 先检查全部关节（超限的限制到限位），再一次性更新状态、计算一次正解，
+     * 有变化时只发出一次jointStateChanged。用于控制器反馈等高频更新。
      * @param angles 6个关节角度 (度)
      * @return 是否全部在限位范围内
      */
@@ -88,6 +90,11 @@ public:
      */
     JointLimit getJointLimit(int jointIndex) const;
 
+    /**
+     * @brief 获取DH参数（theta为关节零位偏置）
+     */
+    const std::array<DHParameter, NUM_JOINTS>& getDHParameters() const { return m_dhParams; }
+
     /**
      * @brief 正运动学计算
      * @return 末端位姿
@@ -101,7 +108,27 @@ public:
     std::vector<QMatrix4x4> getJointTransforms() const;
 
     /**
-     * @brief 逆运动学计算
+     * @brief 计算各连杆相对基座的位姿
+     * 
+     * 不分配内存、不输出日志，可用于高频轨迹回放。
+     * @param angles 6个关节角度 (度)
+     * @param poses 输出，第i个为基座到连杆i+1的变换
+     */
+    void computeLinkPoses(const std::array<double, NUM_JOINTS>& angles, LinkPoses& poses) const;
+
+    /**
+     * @brief 计算各连杆相对零位的位移 T_i(q)·T_i(0)⁻¹
+     * 
+     * 模型文件中的连杆网格按零位姿态建模时，把该矩阵作为Actor的用户矩阵即可驱动连杆。
+     * 与computeLinkPoses一样不分配内存。
+     * @param angles 6个关节角度 (度)
+     * @param displacements 输出，基座坐标系下的连杆位移
+     */
+    void computeLinkDisplacements(const std::array<double, NUM_JOINTS>& angles,
+                                  LinkPoses& displacements) const;
+
+    /**
+     * @brief 逆运动学计算（以当前关节角度为种子）
      * @param targetPose 目标位姿
      * @param solution 输出的关节角度解
      * @return 是否找到有效解
@@ -109,6 +136,44 @@ public:
     bool inverseKinematics(const EndEffectorPose& targetPose, 
                           std::array<double, NUM_JOINTS>& solution) const;
 
+    /**
+     * @brief 逆运动学计算
+     * @param targetPose 目标位姿
+     * @param seed 种子关节角度 (度)，多解时选择离种子最近的解
+     * @param solution 输出的关节角度解
+     * @return 是否找到限位内的解
+     */
+    bool inverseKinematics(const EndEffectorPose& targetPose,
+                          const std::array<double, NUM_JOINTS>& seed,
+                          std::array<double, NUM_JOINTS>& solution) const;
+
+    /**
+     * @brief 逆运动学计算（齐次矩阵目标，基座到法兰的变换）
+     */
+    bool inverseKinematics(const LinkMatrix& target,
+                          const std::array<double, NUM_JOINTS>& seed,
+                          std::array<double, NUM_JOINTS>& solution) const;
+
+    /**
+     * @brief 解析逆解：枚举肩部前/后 × 肘部上/下 × 手腕翻转的全部构型
+     * 
+     * 球形手腕（J4-J6轴交于一点）先由腕心位置解出J1-J3，再由姿态解出J4-J6。
+     * J4、J6的行程超过360°，取限位内离种子最近的等价角；超出限位的构型被丢弃。
+     * 不分配内存、不输出日志，单次调用为微秒级。
+     * @param target 目标位姿（基座到法兰）
+     * @param seed 种子关节角度 (度)
+     * @param solutions 输出的有效解，按离种子的距离从近到远排列
+     * @return 有效解的数量 (0-8)
+     */
+    int inverseKinematicsAll(const LinkMatrix& target,
+                             const std::array<double, NUM_JOINTS>& seed,
+                             std::array<std::array<double, NUM_JOINTS>, MAX_IK_SOLUTIONS>& solutions) const;
+
+    /**
+     * @brief 位姿（位置 + ZYX顺序的RPY角）转为齐次矩阵
+     */
+    static LinkMatrix poseToMatrix(const EndEffectorPose& pose);
+
     /**
      * @brief 重置到零位
      */
@@ -121,17 +186,11 @@ public:
 
 signals:
     /**
-     * @brief 关节角度变化信号
-     * @param jointIndex 关节索引
-     * @param angle 新角度 (度)
-     */
-    void jointAngleChanged(int jointIndex, double angle);
-
-    /**
-     * @brief 末端位姿变化信号
-     * @param pose 新位姿
+     * @brief 关节状态变化信号，每次状态更新（单关节、多关节或回零）只发出一次
+     * @param angles 全部关节角度 (度)
+     * @param pose 对应的末端位姿
      */
-    void endEffectorPoseChanged(const EndEffectorPose& pose);
+    void jointStateChanged(const std::array<double, NUM_JOINTS>& angles, const EndEffectorPose& pose);
 
     /**
      * @brief 关节超限警告
@@ -143,15 +202,30 @@ signals:
 private:
     void initDHParameters();
     void initJointLimits();
-    QMatrix4x4 computeDHMatrix(const DHParameter& dh) const;
     double degToRad(double deg) const;
     double radToDeg(double rad) const;
+    void initLinkCache();
+    void initInverseKinematics();
+    bool wrapToLimit(int jointIndex, double angle, double seed, double& wrapped) const;
+    bool clampToLimit(int jointIndex, double& angle);
+    void commitJointAngles(const std::array<double, NUM_JOINTS>& angles);
 
 private:
     QString m_robotName;
     std::array<DHParameter, NUM_JOINTS> m_dhParams;
     std::array<JointLimit, NUM_JOINTS> m_jointLimits;
     std::array<double, NUM_JOINTS> m_jointAngles;  // 当前关节角度 (度)
+    
+    // 连杆位姿计算缓存
+    std::array<double, NUM_JOINTS> m_cosAlpha;
+    std::array<double, NUM_JOINTS> m_sinAlpha;
+    LinkPoses m_homeInverse;                       // 零位连杆位姿的逆
+    
+    // 解析逆解的结构常数（由DH参数推出）
+    bool m_analyticIk;                             // DH结构满足球形手腕且J2、J3平行
+    double m_shoulderOffset;                       // 腕心在连杆1坐标系中的z偏移 (mm)
+    double m_forearmX;                             // 腕心在关节3平面内的坐标 (mm)
+    double m_forearmY;
 };
 
 } // namespace Robot
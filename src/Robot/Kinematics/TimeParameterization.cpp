@@ -0,0 +1,462 @@
+#include "TimeParameterization.h"
+#include "Models/TrajectoryData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Robot {
+
+namespace {
+
+const int kJoints = RobotKinematics::NUM_JOINTS;
+const double kDegToRad = M_PI / 180.0;
+const double kRadToDeg = 180.0 / M_PI;
+
+const double kDuplicateDistance = 1e-9;    // 关节空间距离小于该值的相邻点视为同一点 (rad)
+const double kTiny = 1e-12;
+const double kInfinity = std::numeric_limits<double>::infinity();
+
+/**
+ * @brief u的线性界 u ≤ alpha + beta·x（上界）或 u ≥ alpha + beta·x（下界）
+ */
+struct LinearBound {
+    double alpha;
+    double beta;
+};
+
+/**
+ * @brief 一个路径点上关于(x, u)的全部约束，x = ṡ²，u = s̈
+ */
+struct GridConstraints {
+    LinearBound upper[kJoints + 1];
+    LinearBound lower[kJoints + 1];
+    int boundCount = 0;
+    double xMax = kInfinity;
+
+    /**
+     * @brief 加入关节加速度约束 |q'·u + q''·x| ≤ a 和速度上限
+     */
+    GridConstraints(const double* dq, const double* ddq, const std::array<double, kJoints>& maxAcceleration,
+                    double xLimit)
+        : xMax(xLimit)
+    {
+        for (int j = 0; j < kJoints; ++j) {
+            const double a = maxAcceleration[j];
+            if (std::abs(dq[j]) > kTiny) {
+                const double beta = -ddq[j] / dq[j];
+                upper[boundCount] = {a / std::abs(dq[j]), beta};
+                lower[boundCount] = {-a / std::abs(dq[j]), beta};
+                ++boundCount;
+            } else if (std::abs(ddq[j]) > kTiny) {
+                xMax = std::min(xMax, a / std::abs(ddq[j]));
+            }
+        }
+    }
+
+    /**
+     * @brief 加入下一个点的可达集合 lo ≤ x + 2Δ·u ≤ hi
+     */
+    void addNext(double delta, double lo, double hi)
+    {
+        const double scale = 1.0 / (2.0 * delta);
+        upper[boundCount] = {hi * scale, -scale};
+        lower[boundCount] = {lo * scale, -scale};
+        ++boundCount;
+    }
+
+    /**
+     * @brief 存在可行u的x区间（Fourier-Motzkin消去u）
+     */
+    bool projectX(double& xLo, double& xHi) const
+    {
+        xLo = 0.0;
+        xHi = xMax;
+        for (int l = 0; l < boundCount; ++l) {
+            for (int h = 0; h < boundCount; ++h) {
+                // lower_l(x) ≤ upper_h(x)  ⇔  (βl - βh)·x ≤ αh - αl
+                const double slope = lower[l].beta - upper[h].beta;
+                const double rhs = upper[h].alpha - lower[l].alpha;
+                if (slope > kTiny) {
+                    xHi = std::min(xHi, rhs / slope);
+                } else if (slope < -kTiny) {
+                    xLo = std::max(xLo, rhs / slope);
+                } else if (rhs < -kTiny * (1.0 + std::abs(upper[h].alpha))) {
+                    return false;
+                }
+            }
+        }
+        return xLo <= xHi * (1.0 + 1e-9) + kTiny;
+    }
+
+    /**
+     * @brief 给定x时u的最大可行值
+     */
+    double maxU(double x) const
+    {
+        double u = kInfinity;
+        for (int h = 0; h < boundCount; ++h) {
+            u = std::min(u, upper[h].alpha + upper[h].beta * x);
+        }
+        return u;
+    }
+};
+
+/**
+ * @brief 非均匀网格上的一阶、二阶导数（内点三点中心差分，端点取相邻值）
+ */
+void differentiate(const double* values, int stride, const std::vector<double>& s, double* first, double* second)
+{
+    const size_t count = s.size();
+    for (int c = 0; c < stride; ++c) {
+        if (count == 2) {
+            first[c] = first[stride + c] = (values[stride + c] - values[c]) / (s[1] - s[0]);
+            second[c] = second[stride + c] = 0.0;
+            continue;
+        }
+        for (size_t k = 1; k + 1 < count; ++k) {
+            const double h0 = s[k] - s[k - 1];
+            const double h1 = s[k + 1] - s[k];
+            const double prev = values[(k - 1) * stride + c];
+            const double curr = values[k * stride + c];
+            const double next = values[(k + 1) * stride + c];
+            first[k * stride + c] = -h1 / (h0 * (h0 + h1)) * prev + (h1 - h0) / (h0 * h1) * curr
+                                  + h0 / (h1 * (h0 + h1)) * next;
+            second[k * stride + c] = 2.0 * (prev / (h0 * (h0 + h1)) - curr / (h0 * h1) + next / (h1 * (h0 + h1)));
+        }
+        const size_t last = count - 1;
+        first[c] = (values[stride + c] - values[c]) / (s[1] - s[0]);
+        first[last * stride + c] = (values[last * stride + c] - values[(last - 1) * stride + c]) / (s[last] - s[last - 1]);
+        second[c] = second[stride + c];
+        second[last * stride + c] = second[(last - 1) * stride + c];
+    }
+}
+
+} // namespace
+
+TimeParameterization::TimeParameterization(const RobotKinematics& robot)
+    : m_forward(robot)
+    , m_tool{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}
+{
+    for (int j = 0; j < kJoints; ++j) {
+        const JointLimit limit = robot.getJointLimit(j);
+        m_maxVelocity[j] = limit.maxVel * kDegToRad;
+        m_maxAcceleration[j] = limit.maxAcc * kDegToRad;
+    }
+    m_forward.setThreadCount(1);
+}
+
+TimeParameterization::Result TimeParameterization::compute(const double* angles, size_t count,
+                                                           const double* speedLimits,
+                                                           const double* dwellTimes) const
+{
+    Result result;
+    result.jointCount = kJoints;
+    if (count == 0 || m_options.velocityScale <= 0.0 || m_options.accelerationScale <= 0.0) {
+        return result;
+    }
+
+    // 合并重复点，网格点k对应原始点grid[k]
+    std::vector<size_t> grid;
+    std::vector<size_t> gridOf(count);
+    std::vector<double> s;
+    grid.reserve(count);
+    s.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!grid.empty()) {
+            const double* prev = angles + grid.back() * kJoints;
+            const double* curr = angles + i * kJoints;
+            double dist2 = 0.0;
+            for (int j = 0; j < kJoints; ++j) {
+                const double d = (curr[j] - prev[j]) * kDegToRad;
+                dist2 += d * d;
+            }
+            const double dist = std::sqrt(dist2);
+            if (dist < kDuplicateDistance) {
+                gridOf[i] = grid.size() - 1;
+                continue;
+            }
+            s.push_back(s.back() + dist);
+        } else {
+            s.push_back(0.0);
+        }
+        gridOf[i] = grid.size();
+        grid.push_back(i);
+    }
+    const size_t gridCount = grid.size();
+
+    // 每个网格点的速度上限、停留时间（重复点取最严格的上限，停留时间累加）
+    std::vector<double> speedCap(gridCount, m_options.cartesianSpeed > 0.0 ? m_options.cartesianSpeed : kInfinity);
+    std::vector<double> dwell(gridCount, 0.0);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t k = gridOf[i];
+        if (speedLimits && speedLimits[i] > 0.0) {
+            speedCap[k] = std::min(speedCap[k], speedLimits[i]);
+        }
+        if (dwellTimes && dwellTimes[i] > 0.0) {
+            dwell[k] += dwellTimes[i];
+        }
+    }
+
+    std::vector<double> x(gridCount, 0.0);
+    std::vector<double> dq(gridCount * kJoints, 0.0);
+    std::vector<double> tcpRate(gridCount, 0.0);    // |p'(s)|
+
+    if (gridCount > 1) {
+        // 关节路径 (rad) 及其导数
+        std::vector<double> q(gridCount * kJoints);
+        JointBatch batch;
+        batch.resize(gridCount);
+        for (size_t k = 0; k < gridCount; ++k) {
+            for (int j = 0; j < kJoints; ++j) {
+                const double degrees = angles[grid[k] * kJoints + j];
+                q[k * kJoints + j] = degrees * kDegToRad;
+                batch.angles[j][k] = degrees;
+            }
+        }
+        std::vector<double> ddq(gridCount * kJoints, 0.0);
+        differentiate(q.data(), kJoints, s, dq.data(), ddq.data());
+
+        // TCP位置的导数，用于TCP速度约束
+        std::vector<LinkMatrix> flange;
+        m_forward.compute(batch, flange);
+        std::vector<double> p(gridCount * 3);
+        for (size_t k = 0; k < gridCount; ++k) {
+            tcpPosition(flange[k], &p[k * 3]);
+        }
+        std::vector<double> dp(gridCount * 3, 0.0);
+        std::vector<double> ddp(gridCount * 3, 0.0);
+        differentiate(p.data(), 3, s, dp.data(), ddp.data());
+
+        std::array<double, kJoints> maxVelocity;
+        std::array<double, kJoints> maxAcceleration;
+        for (int j = 0; j < kJoints; ++j) {
+            maxVelocity[j] = m_maxVelocity[j] * m_options.velocityScale;
+            maxAcceleration[j] = m_maxAcceleration[j] * m_options.accelerationScale;
+        }
+
+        // 各点的x上限：关节速度、TCP速度；起点、终点、停留点为0
+        std::vector<double> xLimit(gridCount, kInfinity);
+        for (size_t k = 0; k < gridCount; ++k) {
+            double limit = kInfinity;
+            for (int j = 0; j < kJoints; ++j) {
+                const double rate = std::abs(dq[k * kJoints + j]);
+                if (rate > kTiny) {
+                    const double v = maxVelocity[j] / rate;
+                    limit = std::min(limit, v * v);
+                }
+            }
+            tcpRate[k] = std::sqrt(dp[k * 3] * dp[k * 3] + dp[k * 3 + 1] * dp[k * 3 + 1] + dp[k * 3 + 2] * dp[k * 3 + 2]);
+            if (speedCap[k] < kInfinity && tcpRate[k] > kTiny) {
+                const double v = speedCap[k] / tcpRate[k];
+                limit = std::min(limit, v * v);
+            }
+            if (k == 0 || k + 1 == gridCount || dwell[k] > 0.0) {
+                limit = 0.0;
+            }
+            xLimit[k] = limit;
+        }
+
+        // 反向：可控集合 [lo_k, hi_k]
+        std::vector<double> lo(gridCount, 0.0);
+        std::vector<double> hi(gridCount, 0.0);
+        for (size_t k = gridCount - 1; k-- > 0;) {
+            GridConstraints constraints(dq.data() + k * kJoints, ddq.data() + k * kJoints, maxAcceleration, xLimit[k]);
+            constraints.addNext(s[k + 1] - s[k], lo[k + 1], hi[k + 1]);
+            if (!constraints.projectX(lo[k], hi[k])) {
+                return result;
+            }
+            hi[k] = std::max(hi[k], lo[k]);
+        }
+
+        // 正向：在可控集合内每段取最大加速度
+        for (size_t k = 0; k + 1 < gridCount; ++k) {
+            GridConstraints constraints(dq.data() + k * kJoints, ddq.data() + k * kJoints, maxAcceleration, xLimit[k]);
+            const double delta = s[k + 1] - s[k];
+            constraints.addNext(delta, lo[k + 1], hi[k + 1]);
+            const double u = constraints.maxU(x[k]);
+            x[k + 1] = std::min(std::max(x[k] + 2.0 * delta * u, lo[k + 1]), hi[k + 1]);
+        }
+
+        // 各段时间：匀加速段 Δt = 2Δs / (ṡ_k + ṡ_k+1)
+        std::vector<double> gridTimes(gridCount, 0.0);
+        double t = dwell[0];
+        for (size_t k = 0; k + 1 < gridCount; ++k) {
+            const double delta = s[k + 1] - s[k];
+            const double speedSum = std::sqrt(x[k]) + std::sqrt(x[k + 1]);
+            if (speedSum > kTiny) {
+                t += 2.0 * delta / speedSum;
+            } else {
+                // 两端都静止（相邻停留点）：梯形速度曲线，受关节速度和加速度限位
+                const RestToRest segment = restToRestSegment(&q[k * kJoints], &q[(k + 1) * kJoints],
+                                                             &p[k * 3], &p[(k + 1) * 3],
+                                                             std::min(speedCap[k], speedCap[k + 1]));
+                if (!segment.success) {
+                    return result;
+                }
+                t += segment.duration;
+            }
+            gridTimes[k + 1] = t;
+            t += dwell[k + 1];
+        }
+
+        result.times.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            result.times[i] = gridTimes[gridOf[i]];
+        }
+        result.duration = t;
+    } else {
+        result.times.assign(count, 0.0);
+        result.duration = dwell[0];
+    }
+
+    // 各点关节速度 q'·ṡ 和TCP速度 |p'|·ṡ
+    result.velocities.resize(count * kJoints);
+    result.tcpSpeeds.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t k = gridOf[i];
+        const double sDot = std::sqrt(x[k]);
+        for (int j = 0; j < kJoints; ++j) {
+            result.velocities[i * kJoints + j] = dq[k * kJoints + j] * sDot * kRadToDeg;
+        }
+        result.tcpSpeeds[i] = tcpRate[k] * sDot;
+    }
+    result.success = true;
+    return result;
+}
+
+TimeParameterization::Result TimeParameterization::compute(
+    const std::vector<std::array<double, RobotKinematics::NUM_JOINTS>>& path) const
+{
+    return compute(path.empty() ? nullptr : path.front().data(), path.size());
+}
+
+TimeParameterization::Result TimeParameterization::compute(const DampedLeastSquaresIK::PathResult& path) const
+{
+    if (path.jointCount != kJoints) {
+        return Result();
+    }
+    return compute(path.angles.data(), path.size());
+}
+
+TimeParameterization::Result TimeParameterization::compute(const Data::TrajectoryData& trajectory,
+                                                           const DampedLeastSquaresIK::PathResult& joints) const
+{
+    const QList<Data::TrajectoryPoint>& points = trajectory.points();
+    if (joints.jointCount != kJoints || joints.size() != static_cast<size_t>(points.size())) {
+        return Result();
+    }
+
+    std::vector<double> speeds(points.size());
+    std::vector<double> dwellTimes(points.size());
+    for (int i = 0; i < points.size(); ++i) {
+        speeds[i] = points[i].speed;
+        dwellTimes[i] = points[i].dwellTime;
+    }
+    return compute(joints.angles.data(), joints.size(), speeds.data(), dwellTimes.data());
+}
+
+TimeParameterization::RestToRest TimeParameterization::restToRest(const double* from, const double* to) const
+{
+    if (m_options.velocityScale <= 0.0 || m_options.accelerationScale <= 0.0) {
+        return RestToRest();
+    }
+
+    double q[2 * kJoints];
+    JointBatch batch;
+    batch.resize(2);
+    for (int j = 0; j < kJoints; ++j) {
+        q[j] = from[j] * kDegToRad;
+        q[kJoints + j] = to[j] * kDegToRad;
+        batch.angles[j][0] = from[j];
+        batch.angles[j][1] = to[j];
+    }
+
+    double p[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    const double speedCap = m_options.cartesianSpeed > 0.0 ? m_options.cartesianSpeed : kInfinity;
+    if (speedCap < kInfinity) {
+        std::vector<LinkMatrix> flange;
+        m_forward.compute(batch, flange);
+        tcpPosition(flange[0], p);
+        tcpPosition(flange[1], p + 3);
+    }
+    return restToRestSegment(q, q + kJoints, p, p + 3, speedCap);
+}
+
+TimeParameterization::RestToRest TimeParameterization::restToRestSegment(const double* q0, const double* q1,
+                                                                         const double* p0, const double* p1,
+                                                                         double speedCap) const
+{
+    RestToRest segment;
+    double length2 = 0.0;
+    for (int j = 0; j < kJoints; ++j) {
+        length2 += (q1[j] - q0[j]) * (q1[j] - q0[j]);
+    }
+    const double length = std::sqrt(length2);
+    if (length < kDuplicateDistance) {
+        segment.success = true;
+        return segment;
+    }
+
+    // 直线上q'为常数、q''为0：ṡ和s̈的上限分别是各关节速度、加速度限位除以|q'|的最小值
+    double sDotMax = kInfinity;
+    double sDDotMax = kInfinity;
+    for (int j = 0; j < kJoints; ++j) {
+        const double rate = std::abs(q1[j] - q0[j]) / length;
+        if (rate > kTiny) {
+            sDotMax = std::min(sDotMax, m_maxVelocity[j] * m_options.velocityScale / rate);
+            sDDotMax = std::min(sDDotMax, m_maxAcceleration[j] * m_options.accelerationScale / rate);
+        }
+    }
+    const double tcpRate = std::sqrt((p1[0] - p0[0]) * (p1[0] - p0[0]) + (p1[1] - p0[1]) * (p1[1] - p0[1]) +
+                                     (p1[2] - p0[2]) * (p1[2] - p0[2])) / length;
+    if (speedCap < kInfinity && tcpRate > kTiny) {
+        sDotMax = std::min(sDotMax, speedCap / tcpRate);
+    }
+    if (!(sDotMax > kTiny) || !(sDDotMax > kTiny)) {
+        return segment;
+    }
+
+    // 三角形曲线的峰值速度超过上限时改为梯形
+    segment.rampTime = std::sqrt(length / sDDotMax);
+    if (sDDotMax * segment.rampTime <= sDotMax) {
+        segment.duration = 2.0 * segment.rampTime;
+    } else {
+        segment.rampTime = sDotMax / sDDotMax;
+        segment.duration = length / sDotMax + segment.rampTime;
+    }
+    segment.success = true;
+    return segment;
+}
+
+void TimeParameterization::tcpPosition(const LinkMatrix& flange, double position[3]) const
+{
+    for (int r = 0; r < 3; ++r) {
+        position[r] = flange[r * 4] * m_tool[3] + flange[r * 4 + 1] * m_tool[7] + flange[r * 4 + 2] * m_tool[11]
+                    + flange[r * 4 + 3];
+    }
+}
+
+double TimeParameterization::RestToRest::fraction(double t) const
+{
+    if (duration <= 0.0 || t >= duration) {
+        return 1.0;
+    }
+    if (t <= 0.0) {
+        return 0.0;
+    }
+
+    // 匀速段速度v = 1 / (T - tr)，加速度 v / tr
+    const double cruise = 1.0 / (duration - rampTime);
+    const double acceleration = cruise / rampTime;
+    if (t < rampTime) {
+        return 0.5 * acceleration * t * t;
+    }
+    if (t < duration - rampTime) {
+        return 0.5 * cruise * rampTime + cruise * (t - rampTime);
+    }
+    const double remaining = duration - t;
+    return 1.0 - 0.5 * acceleration * remaining * remaining;
+}
+
+} // namespace Robot
@@ -0,0 +1,132 @@
+#ifndef TIMEPARAMETERIZATION_H
+#define TIMEPARAMETERIZATION_H
+
+#include "BatchForwardKinematics.h"
+#include "DampedLeastSquaresIK.h"
+#include "RobotKinematics.h"
+
+#include <array>
+#include <vector>
+
+namespace Data {
+class TrajectoryData;
+}
+
+namespace Robot {
+
+/**
+ * @brief 关节空间路径的时间最优参数化（TOPP-RA）
+ *
+ * 路径点之间按关节空间弧长s参数化，q'(s)、q''(s)由非均匀中心差分求得。
+ * 以x = ṡ²、u = s̈为变量，关节速度、关节加速度和TCP速度约束在每个路径点上都是(x, u)的线性不等式：
+ * - 反向一遍求各点的可控集合 [x_min, x_max]（二维线性规划，用Fourier-Motzkin消元投影到x）
+ * - 正向一遍在可控集合内逐段取最大加速度
+ * 两遍均为O(N)，2万点的路径在毫秒级完成。路径起点和终点速度为0，有停留时间的点也停下。
+ *
+ * 路径点之间为直线（关节空间），拐角处q''很大，速度会降到接近0；
+ * 稀疏路径应先插值平滑，IK逐点求出的密集路径可直接使用。
+ */
+class TimeParameterization
+{
+public:
+    struct Options {
+        double velocityScale = 1.0;         // 关节速度限位的比例 (0, 1]
+        double accelerationScale = 1.0;     // 关节加速度限位的比例 (0, 1]
+        double cartesianSpeed = 0.0;        // TCP速度上限 (mm/s)，不大于0时不限制
+    };
+
+    struct Result {
+        bool success = false;
+        double duration = 0.0;              // 总时间，含停留时间 (秒)
+        int jointCount = 0;
+        std::vector<double> times;          // 到达每个路径点的时刻 (秒)
+        std::vector<double> velocities;     // 第i个点的关节j速度为velocities[i * jointCount + j] (度/秒)
+        std::vector<double> tcpSpeeds;      // 每个路径点的TCP速度 (mm/s)
+
+        size_t size() const { return times.size(); }
+        const double* velocitiesAt(size_t index) const { return velocities.data() + index * jointCount; }
+    };
+
+    /**
+     * @brief 两个静止点之间的关节直线运动：梯形速度曲线，距离不足以达到最高速度时为三角形
+     *
+     * 最高速度和加速度分别取各关节 maxVel/|q'|、maxAcc/|q'| 的最小值（及TCP速度上限）。
+     */
+    struct RestToRest {
+        bool success = false;
+        double duration = 0.0;              // 秒
+        double rampTime = 0.0;              // 加速段时间，减速段相同 (秒)
+
+        /**
+         * @brief 时刻t已走过的路程比例 [0, 1]
+         */
+        double fraction(double t) const;
+    };
+
+    /**
+     * @brief 使用RobotKinematics的关节限位（maxVel、maxAcc）和正解
+     */
+    explicit TimeParameterization(const RobotKinematics& robot);
+
+    /**
+     * @brief 设置工具坐标系（法兰到TCP），用于TCP速度约束，默认单位矩阵
+     */
+    void setToolFrame(const LinkMatrix& flangeToTool) { m_tool = flangeToTool; }
+    const LinkMatrix& toolFrame() const { return m_tool; }
+
+    void setOptions(const Options& options) { m_options = options; }
+    const Options& options() const { return m_options; }
+
+    /**
+     * @brief 参数化关节路径
+     * @param angles count个路径点，第i个点的关节j为angles[i * 6 + j] (度)
+     * @param count 路径点数
+     * @param speedLimits 可选，每个路径点的TCP速度上限 (mm/s)，不大于0表示不限制；与Options::cartesianSpeed取较小值
+     * @param dwellTimes 可选，每个路径点的停留时间 (秒)，大于0的点速度降为0
+     */
+    Result compute(const double* angles, size_t count,
+                   const double* speedLimits = nullptr, const double* dwellTimes = nullptr) const;
+
+    Result compute(const std::vector<std::array<double, RobotKinematics::NUM_JOINTS>>& path) const;
+
+    /**
+     * @brief 参数化DampedLeastSquaresIK::solvePath的结果
+     */
+    Result compute(const DampedLeastSquaresIK::PathResult& path) const;
+
+    /**
+     * @brief 喷涂轨迹：轨迹点的speed作为TCP速度上限，dwellTime作为停留时间
+     * @param joints 对轨迹逐点求出的关节路径，点数与轨迹一致
+     */
+    Result compute(const Data::TrajectoryData& trajectory, const DampedLeastSquaresIK::PathResult& joints) const;
+
+    /**
+     * @brief 点到点运动（起点和终点速度为0）
+     * @param from 起点6个关节角度 (度)
+     * @param to 终点6个关节角度 (度)
+     */
+    RestToRest restToRest(const double* from, const double* to) const;
+
+private:
+    /**
+     * @brief 两端静止的直线段
+     * @param q0 起点关节角度 (rad)
+     * @param q1 终点关节角度 (rad)
+     * @param p0 起点TCP位置 (mm)
+     * @param p1 终点TCP位置 (mm)
+     * @param speedCap TCP速度上限 (mm/s)，无穷大表示不限制
+     */
+    RestToRest restToRestSegment(const double* q0, const double* q1, const double* p0, const double* p1,
+                                 double speedCap) const;
+    void tcpPosition(const LinkMatrix& flange, double position[3]) const;
+
+    std::array<double, RobotKinematics::NUM_JOINTS> m_maxVelocity;      // rad/s
+    std::array<double, RobotKinematics::NUM_JOINTS> m_maxAcceleration;  // rad/s²
+    BatchForwardKinematics m_forward;
+    LinkMatrix m_tool;
+    Options m_options;
+};
+
+} // namespace Robot
+
+#endif // TIMEPARAMETERIZATION_H
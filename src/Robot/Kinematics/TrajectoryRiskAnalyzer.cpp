@@ -0,0 +1,408 @@
+#include "TrajectoryRiskAnalyzer.h"
+#include "Models/TrajectoryData.h"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+
+namespace Robot {
+
+namespace {
+
+const int kJoints = RobotKinematics::NUM_JOINTS;
+const double kRadToDeg = 180.0 / M_PI;
+const double kDegToRad = M_PI / 180.0;
+
+const size_t kParallelBlock = 256;          // 每次领取的点数
+const int kRollSamples = 16;                // 每个区段用于搜索工具转角的抽样点数
+const double kMaxCondition = 1e6;
+const double kMinRiskGain = 0.05;           // 转角建议至少降低的风险
+
+void multiply(const LinkMatrix& a, const LinkMatrix& b, LinkMatrix& out)
+{
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            out[r * 4 + c] = a[r * 4 + 0] * b[0 * 4 + c] + a[r * 4 + 1] * b[1 * 4 + c]
+                           + a[r * 4 + 2] * b[2 * 4 + c];
+        }
+        out[r * 4 + 3] += a[r * 4 + 3];
+    }
+    out[12] = 0.0;
+    out[13] = 0.0;
+    out[14] = 0.0;
+    out[15] = 1.0;
+}
+
+LinkMatrix rotationZ(double degrees)
+{
+    const double c = std::cos(degrees * kDegToRad);
+    const double s = std::sin(degrees * kDegToRad);
+    return {c, -s, 0, 0,
+            s, c,  0, 0,
+            0, 0,  1, 0,
+            0, 0,  0, 1};
+}
+
+/**
+ * @brief 两个向量的夹角 (度, 0-180)
+ */
+double angleBetween(const double* u, const double* v)
+{
+    const double cx = u[1] * v[2] - u[2] * v[1];
+    const double cy = u[2] * v[0] - u[0] * v[2];
+    const double cz = u[0] * v[1] - u[1] * v[0];
+    const double dot = u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+    return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), dot) * kRadToDeg;
+}
+
+void column(const LinkMatrix& m, int c, double* out)
+{
+    out[0] = m[c];
+    out[1] = m[4 + c];
+    out[2] = m[8 + c];
+}
+
+/**
+ * @brief 按块动态分配到各线程
+ */
+template <typename Body>
+void parallelFor(size_t count, size_t blockSize, int threadCount, const Body& body)
+{
+    const size_t blocks = (count + blockSize - 1) / blockSize;
+    int workers = threadCount > 0 ? threadCount : static_cast<int>(std::thread::hardware_concurrency());
+    workers = static_cast<int>(std::max<size_t>(1, std::min<size_t>(std::max(1, workers), blocks)));
+
+    std::atomic<size_t> next(0);
+    auto run = [&]() {
+        for (;;) {
+            const size_t begin = next.fetch_add(blockSize);
+            if (begin >= count) {
+                break;
+            }
+            const size_t end = std::min(count, begin + blockSize);
+            for (size_t i = begin; i < end; ++i) {
+                body(i);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (int w = 1; w < workers; ++w) {
+        threads.emplace_back(run);
+    }
+    run();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace
+
+std::vector<float> TrajectoryRiskAnalyzer::Report::riskValues() const
+{
+    std::vector<float> values(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        values[i] = points[i].risk;
+    }
+    return values;
+}
+
+TrajectoryRiskAnalyzer::TrajectoryRiskAnalyzer(const RobotKinematics& robot)
+    : m_robot(robot)
+    , m_reach(0.0)
+    , m_threadCount(0)
+{
+    for (int j = 0; j < kJoints; ++j) {
+        m_limits[j] = robot.getJointLimit(j);
+    }
+    setToolFrame({1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1});
+}
+
+void TrajectoryRiskAnalyzer::setToolFrame(const LinkMatrix& flangeToTool)
+{
+    m_tool = flangeToTool;
+
+    // 刚体变换的逆：R^T, -R^T·p
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            m_toolInverse[r * 4 + c] = m_tool[c * 4 + r];
+        }
+        m_toolInverse[r * 4 + 3] = -(m_tool[r] * m_tool[3] + m_tool[4 + r] * m_tool[7] + m_tool[8 + r] * m_tool[11]);
+    }
+    m_toolInverse[12] = 0.0;
+    m_toolInverse[13] = 0.0;
+    m_toolInverse[14] = 0.0;
+    m_toolInverse[15] = 1.0;
+
+    m_reach = std::sqrt(m_tool[3] * m_tool[3] + m_tool[7] * m_tool[7] + m_tool[11] * m_tool[11]);
+    for (const DHParameter& dh : m_robot.getDHParameters()) {
+        m_reach += std::sqrt(dh.a * dh.a + dh.d * dh.d);
+    }
+}
+
+TrajectoryRiskAnalyzer::Report TrajectoryRiskAnalyzer::analyze(const double* angles, size_t count,
+                                                               const double* times, const bool* reachable) const
+{
+    Report report;
+    report.points.resize(count);
+    if (count == 0) {
+        return report;
+    }
+
+    // 逐点的几何量与限位余量
+    parallelFor(count, kParallelBlock, m_threadCount, [&](size_t i) {
+        evaluatePoint(angles + i * kJoints, report.points[i]);
+    });
+
+    // 相邻点之间的关节速度
+    if (times) {
+        for (size_t i = 0; i + 1 < count; ++i) {
+            const double dt = times[i + 1] - times[i];
+            if (!(dt > 0.0)) {
+                continue;
+            }
+            float ratio = 0.0f;
+            for (int j = 0; j < kJoints; ++j) {
+                const double velocity = std::abs(angles[(i + 1) * kJoints + j] - angles[i * kJoints + j]) / dt;
+                ratio = std::max(ratio, static_cast<float>(velocity / m_limits[j].maxVel));
+            }
+            report.points[i].speedRatio = std::max(report.points[i].speedRatio, ratio);
+            report.points[i + 1].speedRatio = std::max(report.points[i + 1].speedRatio, ratio);
+        }
+    }
+
+    // 标志、风险，合并为区段
+    for (size_t i = 0; i < count; ++i) {
+        PointReport& point = report.points[i];
+        if (point.speedRatio > 1.0f) {
+            point.flags |= JointSpeedExceeded;
+        }
+        if (reachable && !reachable[i]) {
+            point.flags |= Unreachable;
+        }
+        point.risk = computeRisk(point);
+
+        if (point.flags == 0) {
+            continue;
+        }
+        ++report.flaggedCount;
+        if (report.segments.empty() || report.segments.back().end + 1 != static_cast<int>(i)) {
+            Segment segment;
+            segment.begin = static_cast<int>(i);
+            segment.end = static_cast<int>(i);
+            report.segments.push_back(segment);
+        }
+        Segment& segment = report.segments.back();
+        segment.end = static_cast<int>(i);
+        segment.flags |= point.flags;
+        segment.maxRisk = std::max(segment.maxRisk, point.risk);
+    }
+
+    // 各区段的工具转角建议
+    if (m_options.rollStep > 0.0) {
+        parallelFor(report.segments.size(), 1, m_threadCount, [&](size_t s) {
+            suggestRoll(angles, report.segments[s]);
+        });
+    }
+
+    return report;
+}
+
+TrajectoryRiskAnalyzer::Report TrajectoryRiskAnalyzer::analyze(const Data::TrajectoryData& trajectory,
+                                                               const DampedLeastSquaresIK::PathResult& joints) const
+{
+    const QList<Data::TrajectoryPoint>& points = trajectory.points();
+    if (joints.jointCount != kJoints || joints.size() != static_cast<size_t>(points.size())) {
+        return Report();
+    }
+
+    // 各点时刻：相邻点距离 / 平均喷涂速度，速度未设置的段不检查关节速度
+    std::vector<double> times(points.size(), 0.0);
+    std::unique_ptr<bool[]> reachable(new bool[points.size()]);
+    for (int i = 0; i < points.size(); ++i) {
+        reachable[i] = joints.results[i].converged;
+        if (i == 0) {
+            continue;
+        }
+        const double distance = (points[i].position - points[i - 1].position).length();
+        const double speed = (points[i].speed + points[i - 1].speed) / 2.0;
+        times[i] = times[i - 1] + (speed > 0.0 ? distance / speed : 0.0);
+    }
+    return analyze(joints.angles.data(), joints.size(), times.data(), reachable.get());
+}
+
+void TrajectoryRiskAnalyzer::evaluatePoint(const double* angles, PointReport& report) const
+{
+    std::array<double, kJoints> q;
+    std::copy(angles, angles + kJoints, q.begin());
+    LinkPoses poses;
+    m_robot.computeLinkPoses(q, poses);
+    LinkMatrix tcp;
+    multiply(poses[kJoints - 1], m_tool, tcp);
+
+    // TCP处的几何雅可比：关节i绕坐标系i-1的z轴转动，坐标系0为基座
+    Eigen::Matrix<double, 6, 6> J;
+    for (int i = 0; i < kJoints; ++i) {
+        double z[3] = {0.0, 0.0, 1.0};
+        double o[3] = {0.0, 0.0, 0.0};
+        if (i > 0) {
+            column(poses[i - 1], 2, z);
+            column(poses[i - 1], 3, o);
+        }
+        const double dx = tcp[3] - o[0];
+        const double dy = tcp[7] - o[1];
+        const double dz = tcp[11] - o[2];
+        J(0, i) = (z[1] * dz - z[2] * dy) / m_reach;
+        J(1, i) = (z[2] * dx - z[0] * dz) / m_reach;
+        J(2, i) = (z[0] * dy - z[1] * dx) / m_reach;
+        J(3, i) = z[0];
+        J(4, i) = z[1];
+        J(5, i) = z[2];
+    }
+    // 条件数 σmax/σmin，由JᵀJ的特征值求得（比SVD快数倍）
+    const Eigen::Matrix<double, 6, 6> JtJ = J.transpose() * J;
+    const Eigen::Matrix<double, 6, 1> lambda =
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, 6, 6>>(JtJ, Eigen::EigenvaluesOnly).eigenvalues();
+    const double lambdaMin = std::max(lambda(0), 0.0);
+    const double condition = lambdaMin * kMaxCondition * kMaxCondition > lambda(5)
+                           ? std::sqrt(lambda(5) / lambdaMin) : kMaxCondition;
+    report.conditionNumber = static_cast<float>(condition);
+
+    // 腕部：J4（坐标系3的z轴）与J6（坐标系5的z轴）的夹角
+    double z3[3], z5[3];
+    column(poses[2], 2, z3);
+    column(poses[4], 2, z5);
+    const double wrist = angleBetween(z3, z5);
+    report.wristAngle = static_cast<float>(std::min(wrist, 180.0 - wrist));
+
+    // 肘部：J2轴位置 -> J3轴位置 -> 腕心
+    double o1[3], o2[3], wc[3];
+    column(poses[0], 3, o1);
+    column(poses[1], 3, o2);
+    column(poses[3], 3, wc);
+    const double upper[3] = {o2[0] - o1[0], o2[1] - o1[1], o2[2] - o1[2]};
+    const double fore[3] = {wc[0] - o2[0], wc[1] - o2[1], wc[2] - o2[2]};
+    const double elbow = angleBetween(upper, fore);
+    report.elbowAngle = static_cast<float>(std::min(elbow, 180.0 - elbow));
+
+    // 肩部：腕心到J1轴的距离
+    report.shoulderDistance = static_cast<float>(std::sqrt(wc[0] * wc[0] + wc[1] * wc[1]));
+
+    // 限位余量
+    report.limitMargin = 0.0f;
+    report.limitJoint = -1;
+    for (int j = 0; j < kJoints; ++j) {
+        const double margin = std::min(angles[j] - m_limits[j].min, m_limits[j].max - angles[j]);
+        if (report.limitJoint < 0 || margin < report.limitMargin) {
+            report.limitMargin = static_cast<float>(margin);
+            report.limitJoint = static_cast<qint8>(j);
+        }
+    }
+
+    report.flags = 0;
+    if (report.wristAngle < m_options.wristThreshold) {
+        report.flags |= WristSingularity;
+    }
+    if (report.elbowAngle < m_options.elbowThreshold) {
+        report.flags |= ElbowSingularity;
+    }
+    if (report.shoulderDistance < m_options.shoulderThreshold) {
+        report.flags |= ShoulderSingularity;
+    }
+    if (report.conditionNumber > m_options.conditionThreshold) {
+        report.flags |= IllConditioned;
+    }
+    if (report.limitMargin < m_options.limitThreshold) {
+        report.flags |= NearJointLimit;
+    }
+}
+
+float TrajectoryRiskAnalyzer::computeRisk(const PointReport& report) const
+{
+    if (report.flags & Unreachable) {
+        return 1.0f;
+    }
+
+    // 各项相对阈值的比例，1为恰好在阈值上
+    const double eps = 1e-6;
+    double ratio = report.conditionNumber / m_options.conditionThreshold;
+    ratio = std::max(ratio, m_options.wristThreshold / std::max<double>(report.wristAngle, eps));
+    ratio = std::max(ratio, m_options.elbowThreshold / std::max<double>(report.elbowAngle, eps));
+    ratio = std::max(ratio, m_options.shoulderThreshold / std::max<double>(report.shoulderDistance, eps));
+    ratio = std::max(ratio, m_options.limitThreshold / std::max<double>(report.limitMargin, eps));
+    ratio = std::max<double>(ratio, report.speedRatio);
+    return static_cast<float>(std::min(1.0, 0.5 * ratio));
+}
+
+void TrajectoryRiskAnalyzer::suggestRoll(const double* angles, Segment& segment) const
+{
+    // 区段内均匀抽样
+    const int length = segment.end - segment.begin + 1;
+    const int sampleCount = std::min(length, kRollSamples);
+    std::array<int, kRollSamples> samples;
+    std::array<LinkMatrix, kRollSamples> targets;
+    float baseline = 0.0f;
+    for (int n = 0; n < sampleCount; ++n) {
+        samples[n] = segment.begin + (sampleCount > 1 ? n * (length - 1) / (sampleCount - 1) : 0);
+        const double* q = angles + samples[n] * kJoints;
+
+        std::array<double, kJoints> joints;
+        std::copy(q, q + kJoints, joints.begin());
+        LinkPoses poses;
+        m_robot.computeLinkPoses(joints, poses);
+        multiply(poses[kJoints - 1], m_tool, targets[n]);
+
+        PointReport report;
+        evaluatePoint(q, report);
+        baseline = std::max(baseline, computeRisk(report));
+    }
+
+    // 对称地由小到大搜索转角，风险相同时取转角小的
+    float bestRisk = baseline;
+    float bestRoll = 0.0f;
+    const int steps = static_cast<int>(std::floor(180.0 / m_options.rollStep));
+    for (int k = 1; k <= steps; ++k) {
+        for (int sign = 1; sign >= -1; sign -= 2) {
+            const double roll = sign * k * m_options.rollStep;
+            if (sign < 0 && roll <= -180.0) {
+                continue;
+            }
+            const LinkMatrix rotation = rotationZ(roll);
+            float risk = 0.0f;
+            for (int n = 0; n < sampleCount && risk < bestRisk; ++n) {
+                // 新的TCP位姿 -> 法兰目标 -> 离原解最近的逆解
+                LinkMatrix tcp;
+                LinkMatrix flange;
+                multiply(targets[n], rotation, tcp);
+                multiply(tcp, m_toolInverse, flange);
+
+                const double* q = angles + samples[n] * kJoints;
+                std::array<double, kJoints> seed;
+                std::array<double, kJoints> solution;
+                std::copy(q, q + kJoints, seed.begin());
+                if (!m_robot.inverseKinematics(flange, seed, solution)) {
+                    risk = 1.0f;
+                    break;
+                }
+                PointReport report;
+                evaluatePoint(solution.data(), report);
+                risk = std::max(risk, computeRisk(report));
+            }
+            if (risk < bestRisk) {
+                bestRisk = risk;
+                bestRoll = static_cast<float>(roll);
+            }
+        }
+    }
+
+    segment.hasRollSuggestion = bestRisk < baseline - kMinRiskGain;
+    segment.suggestedRoll = segment.hasRollSuggestion ? bestRoll : 0.0f;
+    segment.riskAfterRoll = segment.hasRollSuggestion ? bestRisk : baseline;
+}
+
+} // namespace Robot
@@ -0,0 +1,143 @@
+#ifndef TRAJECTORYRISKANALYZER_H
+#define TRAJECTORYRISKANALYZER_H
+
+#include "DampedLeastSquaresIK.h"
+#include "RobotKinematics.h"
+
+#include <array>
+#include <vector>
+
+namespace Data {
+class TrajectoryData;
+}
+
+namespace Robot {
+
+/**
+ * @brief 轨迹的奇异与限位风险分析
+ *
+ * 对关节路径逐点（多线程）计算：
+ * - TCP处雅可比的条件数（平移行按链长归一化）
+ * - 腕部（J4、J6轴平行）、肘部（J2、J3、腕心共线）、肩部（腕心在J1轴上）奇异的几何距离
+ * - 各关节离限位的最小余量
+ * - 按给定时刻求出的关节速度与限位之比（靠近奇异时关节速度激增）
+ *
+ * 连续的风险点合并为区段，对每个区段搜索绕工具z轴的转角（喷枪轴对称，转动不影响喷涂），
+ * 给出使区段最大风险最小的转角建议。每点的risk (0-1) 可直接作为视图的着色标量，0.5为阈值。
+ */
+class TrajectoryRiskAnalyzer
+{
+public:
+    /**
+     * @brief 风险标志
+     */
+    enum Flag {
+        WristSingularity    = 0x01,
+        ElbowSingularity    = 0x02,
+        ShoulderSingularity = 0x04,
+        IllConditioned      = 0x08,     // 条件数超过阈值
+        NearJointLimit      = 0x10,
+        JointSpeedExceeded  = 0x20,
+        Unreachable         = 0x40      // 逆解未收敛
+    };
+
+    struct Options {
+        double conditionThreshold = 60.0;       // 条件数阈值
+        double wristThreshold = 10.0;           // J4、J6轴夹角阈值 (度)
+        double elbowThreshold = 5.0;            // 上臂与前臂偏离共线的角度阈值 (度)
+        double shoulderThreshold = 150.0;       // 腕心到J1轴的距离阈值 (mm)
+        double limitThreshold = 10.0;           // 离关节限位的余量阈值 (度)
+        double rollStep = 15.0;                 // 工具转角搜索步长 (度)，不大于0时不搜索
+    };
+
+    /**
+     * @brief 单点报告
+     */
+    struct PointReport {
+        float conditionNumber = 1.0f;
+        float wristAngle = 90.0f;               // J4、J6轴夹角 (度)
+        float elbowAngle = 90.0f;               // 上臂与前臂偏离共线的角度 (度)
+        float shoulderDistance = 0.0f;          // 腕心到J1轴的距离 (mm)
+        float limitMargin = 0.0f;               // 离限位的最小余量 (度)
+        float speedRatio = 0.0f;                // 关节速度与限位之比的最大值
+        float risk = 0.0f;                      // 综合风险 0-1，0.5为阈值
+        qint8 limitJoint = -1;                  // 余量最小的关节
+        quint8 flags = 0;
+    };
+
+    /**
+     * @brief 连续的风险区段
+     */
+    struct Segment {
+        int begin = 0;                          // 首点索引
+        int end = 0;                            // 末点索引（含）
+        quint8 flags = 0;                       // 区段内各点标志的并集
+        float maxRisk = 0.0f;
+        bool hasRollSuggestion = false;
+        float suggestedRoll = 0.0f;             // 建议的工具转角 (度)
+        float riskAfterRoll = 0.0f;             // 采用建议转角后区段的最大风险（按抽样点估计）
+    };
+
+    struct Report {
+        std::vector<PointReport> points;
+        std::vector<Segment> segments;
+        int flaggedCount = 0;
+
+        /**
+         * @brief 每点的risk，用于视图着色
+         */
+        std::vector<float> riskValues() const;
+    };
+
+    /**
+     * @brief 使用RobotKinematics的DH参数、关节限位和解析逆解
+     */
+    explicit TrajectoryRiskAnalyzer(const RobotKinematics& robot);
+
+    /**
+     * @brief 设置工具坐标系（法兰到TCP），默认单位矩阵
+     */
+    void setToolFrame(const LinkMatrix& flangeToTool);
+    const LinkMatrix& toolFrame() const { return m_tool; }
+
+    void setOptions(const Options& options) { m_options = options; }
+    const Options& options() const { return m_options; }
+
+    /**
+     * @brief 设置线程数，0表示使用全部硬件线程
+     */
+    void setThreadCount(int threadCount) { m_threadCount = threadCount; }
+
+    /**
+     * @brief 分析关节路径
+     * @param angles count个路径点，第i个点的关节j为angles[i * 6 + j] (度)
+     * @param times 可选，到达每个点的时刻 (秒)，用于关节速度检查
+     * @param reachable 可选，每个点的逆解是否收敛
+     */
+    Report analyze(const double* angles, size_t count, const double* times = nullptr,
+                   const bool* reachable = nullptr) const;
+
+    /**
+     * @brief 分析喷涂轨迹：按轨迹点的speed推算各点时刻，逆解未收敛的点标记为Unreachable
+     * @param joints 对轨迹逐点求出的关节路径，点数与轨迹一致
+     */
+    Report analyze(const Data::TrajectoryData& trajectory, const DampedLeastSquaresIK::PathResult& joints) const;
+
+private:
+    void evaluatePoint(const double* angles, PointReport& report) const;
+    float computeRisk(const PointReport& report) const;
+    void suggestRoll(const double* angles, Segment& segment) const;
+
+private:
+    const RobotKinematics& m_robot;
+    std::array<JointLimit, RobotKinematics::NUM_JOINTS> m_limits;
+    LinkMatrix m_tool;
+    LinkMatrix m_toolInverse;
+    double m_reach;                             // 链长 (mm)，用于雅可比归一化
+    Options m_options;
+    int m_threadCount;
+};
+
+} // namespace Robot
+
+#endif // TRAJECTORYRISKANALYZER_H
@@ -0,0 +1,590 @@
+#include "DeviationAnalyzer.h"
+#include "TriangleBVH.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+
+namespace Simulation {
+
+namespace {
+
+const size_t kParallelBlock = 4096;     // 每次领取的点数
+const int kCoarseSamples = 2000;        // 粗配准评估使用的点数
+
+int workerCount(size_t count, int threadCount)
+{
+    int threads = threadCount > 0 ? threadCount : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, threads);
+    const size_t blocks = (count + kParallelBlock - 1) / kParallelBlock;
+    return static_cast<int>(std::max<size_t>(1, std::min<size_t>(threads, blocks)));
+}
+
+/**
+ * @brief 按块动态分配的并行循环
+ * @param fn 回调 fn(begin, end, worker)，同一worker的调用串行执行
+ */
+template <typename Fn>
+void parallelFor(size_t count, int workers, const Fn& fn)
+{
+    std::atomic<size_t> next(0);
+    auto run = [&](int worker) {
+        for (;;) {
+            const size_t begin = next.fetch_add(kParallelBlock);
+            if (begin >= count) {
+                break;
+            }
+            fn(begin, std::min(count, begin + kParallelBlock), worker);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers > 1 ? workers - 1 : 0);
+    for (int w = 1; w < workers; ++w) {
+        threads.emplace_back(run, w);
+    }
+    run(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+inline Eigen::Vector3d transformPoint(const Eigen::Matrix3d& rotation, const Eigen::Vector3d& translation,
+                                      const float* p)
+{
+    return rotation * Eigen::Vector3d(p[0], p[1], p[2]) + translation;
+}
+
+std::vector<size_t> strideSamples(size_t count, size_t sampleCount)
+{
+    std::vector<size_t> samples;
+    if (count == 0 || sampleCount == 0) {
+        return samples;
+    }
+    const size_t stride = std::max<size_t>(1, count / sampleCount);
+    samples.reserve(count / stride + 1);
+    for (size_t i = 0; i < count; i += stride) {
+        samples.push_back(i);
+    }
+    return samples;
+}
+
+/**
+ * @brief 体素坐标打包为64位键（每轴21位）
+ */
+inline int64_t voxelKey(int64_t x, int64_t y, int64_t z)
+{
+    const int64_t mask = (int64_t(1) << 21) - 1;
+    return ((x & mask) << 42) | ((y & mask) << 21) | (z & mask);
+}
+
+int findRoot(std::vector<int>& parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+QJsonArray vectorToJson(const Eigen::Vector3d& v)
+{
+    return QJsonArray{v.x(), v.y(), v.z()};
+}
+
+} // namespace
+
+QJsonObject DeviationRegion::toJson() const
+{
+    QJsonObject json;
+    json["point_count"] = pointCount;
+    json["max_deviation"] = maxDeviation;
+    json["mean_deviation"] = meanDeviation;
+    json["center"] = vectorToJson(center);
+    json["bounds_min"] = vectorToJson(boundsMin);
+    json["bounds_max"] = vectorToJson(boundsMax);
+    json["part"] = partName;
+    json["excess"] = excess;
+    return json;
+}
+
+double DeviationReport::outOfToleranceRatio() const
+{
+    return measuredCount > 0 ? static_cast<double>(outOfToleranceCount) / measuredCount : 0.0;
+}
+
+QJsonObject DeviationReport::toJson() const
+{
+    QJsonObject json;
+    json["valid"] = valid;
+    if (!errorMessage.isEmpty()) {
+        json["error"] = errorMessage;
+    }
+
+    QJsonArray matrix;
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            matrix.append(registration(r, c));
+        }
+    }
+    json["registration"] = matrix;
+    json["registration_rms"] = registrationRms;
+    json["icp_iterations"] = icpIterations;
+
+    json["point_count"] = static_cast<qint64>(pointCount);
+    json["measured_count"] = static_cast<qint64>(measuredCount);
+    json["out_of_tolerance_count"] = static_cast<qint64>(outOfToleranceCount);
+    json["out_of_tolerance_ratio"] = outOfToleranceRatio();
+    json["tolerance"] = tolerance;
+    json["min_deviation"] = minDeviation;
+    json["max_deviation"] = maxDeviation;
+    json["mean_abs_deviation"] = meanAbsDeviation;
+    json["rms_deviation"] = rmsDeviation;
+    json["within_tolerance"] = withinTolerance();
+
+    QJsonArray regionArray;
+    for (const DeviationRegion& region : regions) {
+        regionArray.append(region.toJson());
+    }
+    json["regions"] = regionArray;
+
+    QJsonObject timing;
+    timing["registration_ms"] = registrationMs;
+    timing["distance_ms"] = distanceMs;
+    timing["region_ms"] = regionMs;
+    timing["total_ms"] = totalMs;
+    json["timing"] = timing;
+    return json;
+}
+
+DeviationReport DeviationAnalyzer::analyze(const TriangleBVH& cad, const float* xyz, size_t count,
+                                           const DeviationOptions& options)
+{
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    DeviationReport report;
+    report.pointCount = count;
+    report.tolerance = options.tolerance;
+
+    double bounds[6];
+    if (!cad.isBuilt() || !cad.bounds(bounds)) {
+        report.errorMessage = "CAD模型未就绪";
+        qWarning() << "DeviationAnalyzer:" << report.errorMessage;
+        return report;
+    }
+    if (!xyz || count == 0) {
+        report.errorMessage = "点云为空";
+        qWarning() << "DeviationAnalyzer:" << report.errorMessage;
+        return report;
+    }
+
+    const double diagonal = Eigen::Vector3d(bounds[1] - bounds[0], bounds[3] - bounds[2],
+                                            bounds[5] - bounds[4]).norm();
+    const double maxDistance = options.maxDistance > 0.0 ? options.maxDistance : diagonal * 0.1;
+    const double voxelSize = options.regionVoxelSize > 0.0 ? options.regionVoxelSize : diagonal * 0.01;
+
+    // 1-2. 配准
+    QElapsedTimer stageTimer;
+    stageTimer.start();
+    Eigen::Matrix4d transform = Eigen::Matrix4d::Identity();
+    if (!options.skipRegistration) {
+        const std::vector<size_t> coarseSamples = strideSamples(count, kCoarseSamples);
+        transform = coarseAlign(cad, xyz, coarseSamples, maxDistance);
+
+        const std::vector<size_t> icpSamples = strideSamples(count, std::max(1, options.icpSampleCount));
+        report.icpIterations = refineICP(cad, xyz, icpSamples, options, maxDistance,
+                                         options.threadCount, transform, report.registrationRms);
+    }
+    report.registration = transform;
+    report.registrationMs = stageTimer.restart();
+
+    // 3. 全部点的有符号距离
+    const Eigen::Matrix3d rotation = transform.topLeftCorner<3, 3>();
+    const Eigen::Vector3d translation = transform.topRightCorner<3, 1>();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    report.deviations.assign(count, nan);
+    std::vector<int> parts(count, -1);
+
+    struct Stats {
+        size_t measured = 0;
+        size_t outOfTolerance = 0;
+        double minValue = std::numeric_limits<double>::max();
+        double maxValue = -std::numeric_limits<double>::max();
+        double sumAbs = 0.0;
+        double sumSquared = 0.0;
+    };
+    const int workers = workerCount(count, options.threadCount);
+    std::vector<Stats> stats(workers);
+
+    parallelFor(count, workers, [&](size_t begin, size_t end, int worker) {
+        Stats& local = stats[worker];
+        TriangleBVH::ClosestPoint closest;
+        for (size_t i = begin; i < end; ++i) {
+            const Eigen::Vector3d q = transformPoint(rotation, translation, xyz + i * 3);
+            const double point[3] = {q.x(), q.y(), q.z()};
+            closest.triangle = -1;
+            const double deviation = cad.signedDistance(point, &closest, maxDistance);
+            if (closest.triangle < 0) {
+                continue;
+            }
+
+            report.deviations[i] = static_cast<float>(deviation);
+            parts[i] = closest.part;
+            ++local.measured;
+            if (std::abs(deviation) > options.tolerance) {
+                ++local.outOfTolerance;
+            }
+            local.minValue = std::min(local.minValue, deviation);
+            local.maxValue = std::max(local.maxValue, deviation);
+            local.sumAbs += std::abs(deviation);
+            local.sumSquared += deviation * deviation;
+        }
+    });
+
+    Stats total;
+    for (const Stats& local : stats) {
+        total.measured += local.measured;
+        total.outOfTolerance += local.outOfTolerance;
+        total.minValue = std::min(total.minValue, local.minValue);
+        total.maxValue = std::max(total.maxValue, local.maxValue);
+        total.sumAbs += local.sumAbs;
+        total.sumSquared += local.sumSquared;
+    }
+    report.distanceMs = stageTimer.restart();
+
+    if (total.measured == 0) {
+        report.errorMessage = QString("没有点落在CAD模型 %1 距离范围内，配准可能失败").arg(maxDistance);
+        qWarning() << "DeviationAnalyzer:" << report.errorMessage;
+        report.totalMs = totalTimer.elapsed();
+        return report;
+    }
+
+    report.measuredCount = total.measured;
+    report.outOfToleranceCount = total.outOfTolerance;
+    report.minDeviation = total.minValue;
+    report.maxDeviation = total.maxValue;
+    report.meanAbsDeviation = total.sumAbs / total.measured;
+    report.rmsDeviation = std::sqrt(total.sumSquared / total.measured);
+
+    // 4. 超差区域
+    buildRegions(cad, xyz, parts, options, voxelSize, report);
+    report.regionMs = stageTimer.elapsed();
+
+    report.valid = true;
+    report.totalMs = totalTimer.elapsed();
+
+    qDebug() << "DeviationAnalyzer: 点数" << count << "已测量" << report.measuredCount
+             << "超差" << report.outOfToleranceCount << "区域" << report.regions.size()
+             << "RMS" << report.rmsDeviation << "配准RMS" << report.registrationRms
+             << "耗时(ms) 配准/距离/区域" << report.registrationMs << "/" << report.distanceMs
+             << "/" << report.regionMs;
+    return report;
+}
+
+Eigen::Matrix4d DeviationAnalyzer::coarseAlign(const TriangleBVH& cad, const float* xyz,
+                                               const std::vector<size_t>& samples, double maxDistance)
+{
+    Eigen::Matrix4d best = Eigen::Matrix4d::Identity();
+    double bestScore = meanClampedDistance(cad, xyz, samples, best, maxDistance);
+
+    double cadCentroid[3];
+    double cadCovariance[3][3];
+    if (!cad.surfaceMoments(cadCentroid, cadCovariance) || samples.size() < 3) {
+        return best;
+    }
+
+    Eigen::Vector3d scanCentroid = Eigen::Vector3d::Zero();
+    for (size_t i : samples) {
+        scanCentroid += Eigen::Vector3d(xyz[i * 3], xyz[i * 3 + 1], xyz[i * 3 + 2]);
+    }
+    scanCentroid /= static_cast<double>(samples.size());
+
+    Eigen::Matrix3d scanCovariance = Eigen::Matrix3d::Zero();
+    for (size_t i : samples) {
+        const Eigen::Vector3d d = Eigen::Vector3d(xyz[i * 3], xyz[i * 3 + 1], xyz[i * 3 + 2]) - scanCentroid;
+        scanCovariance += d * d.transpose();
+    }
+    scanCovariance /= static_cast<double>(samples.size());
+
+    Eigen::Matrix3d cadMatrix;
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            cadMatrix(r, c) = cadCovariance[r][c];
+        }
+    }
+
+    const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> scanSolver(scanCovariance);
+    const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> cadSolver(cadMatrix);
+    if (scanSolver.info() != Eigen::Success || cadSolver.info() != Eigen::Success) {
+        return best;
+    }
+
+    const Eigen::Matrix3d scanAxes = scanSolver.eigenvectors();
+    const Eigen::Matrix3d cadAxes = cadSolver.eigenvectors();
+    const Eigen::Vector3d cadCenter(cadCentroid[0], cadCentroid[1], cadCentroid[2]);
+    const double handedness = cadAxes.determinant() * scanAxes.determinant();
+
+    // 主轴方向有符号二义性，枚举行列式为+1的4种组合
+    for (int s1 = -1; s1 <= 1; s1 += 2) {
+        for (int s2 = -1; s2 <= 1; s2 += 2) {
+            const Eigen::Vector3d signs(s1, s2, s1 * s2 * handedness);
+            const Eigen::Matrix3d rotation = cadAxes * signs.asDiagonal() * scanAxes.transpose();
+
+            Eigen::Matrix4d candidate = Eigen::Matrix4d::Identity();
+            candidate.topLeftCorner<3, 3>() = rotation;
+            candidate.topRightCorner<3, 1>() = cadCenter - rotation * scanCentroid;
+
+            const double score = meanClampedDistance(cad, xyz, samples, candidate, maxDistance);
+            if (score < bestScore) {
+                bestScore = score;
+                best = candidate;
+            }
+        }
+    }
+
+    qDebug() << "DeviationAnalyzer: 粗配准平均距离" << bestScore;
+    return best;
+}
+
+double DeviationAnalyzer::meanClampedDistance(const TriangleBVH& cad, const float* xyz,
+                                              const std::vector<size_t>& samples,
+                                              const Eigen::Matrix4d& transform, double maxDistance)
+{
+    if (samples.empty()) {
+        return maxDistance;
+    }
+
+    const Eigen::Matrix3d rotation = transform.topLeftCorner<3, 3>();
+    const Eigen::Vector3d translation = transform.topRightCorner<3, 1>();
+    TriangleBVH::ClosestPoint closest;
+    double sum = 0.0;
+    for (size_t i : samples) {
+        const Eigen::Vector3d q = transformPoint(rotation, translation, xyz + i * 3);
+        const double point[3] = {q.x(), q.y(), q.z()};
+        sum += cad.closestPoint(point, closest, maxDistance) ? closest.distance : maxDistance;
+    }
+    return sum / samples.size();
+}
+
+int DeviationAnalyzer::refineICP(const TriangleBVH& cad, const float* xyz,
+                                 const std::vector<size_t>& samples, const DeviationOptions& options,
+                                 double maxDistance, int threadCount, Eigen::Matrix4d& transform, double& rms)
+{
+    typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+    typedef Eigen::Matrix<double, 6, 1> Vector6d;
+
+    struct Accumulator {
+        Matrix6d ata = Matrix6d::Zero();
+        Vector6d atb = Vector6d::Zero();
+        double sumSquared = 0.0;
+        size_t count = 0;
+    };
+
+    const int workers = workerCount(samples.size(), threadCount);
+    double rejectDistance = maxDistance;
+    rms = 0.0;
+
+    int iteration = 0;
+    for (; iteration < options.icpMaxIterations; ++iteration) {
+        const Eigen::Matrix3d rotation = transform.topLeftCorner<3, 3>();
+        const Eigen::Vector3d translation = transform.topRightCorner<3, 1>();
+        std::vector<Accumulator> accumulators(workers);
+
+        // 点到面线性化：r + (q×n)·ω + n·δ，最小化 Σr²
+        parallelFor(samples.size(), workers, [&](size_t begin, size_t end, int worker) {
+            Accumulator& local = accumulators[worker];
+            TriangleBVH::ClosestPoint closest;
+            for (size_t s = begin; s < end; ++s) {
+                const Eigen::Vector3d q = transformPoint(rotation, translation, xyz + samples[s] * 3);
+                const double point[3] = {q.x(), q.y(), q.z()};
+                if (!cad.closestPoint(point, closest, rejectDistance)) {
+                    continue;
+                }
+
+                const Eigen::Vector3d n(closest.normal[0], closest.normal[1], closest.normal[2]);
+                const Eigen::Vector3d c(closest.point[0], closest.point[1], closest.point[2]);
+                const double residual = (q - c).dot(n);
+                Vector6d jacobian;
+                jacobian << q.cross(n), n;
+                local.ata.noalias() += jacobian * jacobian.transpose();
+                local.atb.noalias() -= jacobian * residual;
+                local.sumSquared += residual * residual;
+                ++local.count;
+            }
+        });
+
+        Accumulator total;
+        for (const Accumulator& local : accumulators) {
+            total.ata += local.ata;
+            total.atb += local.atb;
+            total.sumSquared += local.sumSquared;
+            total.count += local.count;
+        }
+        if (total.count < 6) {
+            qWarning() << "DeviationAnalyzer: ICP对应点不足" << total.count;
+            break;
+        }
+        rms = std::sqrt(total.sumSquared / total.count);
+
+        const Vector6d x = total.ata.ldlt().solve(total.atb);
+        if (!x.allFinite()) {
+            qWarning() << "DeviationAnalyzer: ICP求解失败";
+            break;
+        }
+
+        const Eigen::Vector3d omega = x.head<3>();
+        const double angle = omega.norm();
+        Eigen::Matrix4d increment = Eigen::Matrix4d::Identity();
+        if (angle > 0.0) {
+            increment.topLeftCorner<3, 3>() = Eigen::AngleAxisd(angle, omega / angle).toRotationMatrix();
+        }
+        increment.topRightCorner<3, 1>() = x.tail<3>();
+        transform = increment * transform;
+
+        // 截断剔除：对应距离阈值随残差收紧，但不小于公差带
+        rejectDistance = std::min(maxDistance, std::max(3.0 * rms, 2.0 * options.tolerance));
+
+        if (angle < options.icpConvergence && x.tail<3>().norm() < options.icpConvergence) {
+            ++iteration;
+            break;
+        }
+    }
+
+    qDebug() << "DeviationAnalyzer: ICP迭代" << iteration << "次, RMS" << rms;
+    return iteration;
+}
+
+void DeviationAnalyzer::buildRegions(const TriangleBVH& cad, const float* xyz, const std::vector<int>& parts,
+                                     const DeviationOptions& options, double voxelSize, DeviationReport& report)
+{
+    if (report.outOfToleranceCount == 0 || voxelSize <= 0.0) {
+        return;
+    }
+
+    const Eigen::Matrix3d rotation = report.registration.topLeftCorner<3, 3>();
+    const Eigen::Vector3d translation = report.registration.topRightCorner<3, 1>();
+    const double invVoxel = 1.0 / voxelSize;
+
+    // 超差点按体素归并，正负偏差分别建表，邻接只在同号体素间建立
+    std::unordered_map<int64_t, int> voxelMaps[2];
+    std::vector<Eigen::Vector3i> voxelCoords;
+    std::vector<int> voxelSign;
+    std::vector<std::pair<size_t, int>> pointVoxels;
+    pointVoxels.reserve(report.outOfToleranceCount);
+
+    for (size_t i = 0; i < report.deviations.size(); ++i) {
+        const float deviation = report.deviations[i];
+        if (!(std::abs(deviation) > options.tolerance)) {
+            continue;
+        }
+
+        const Eigen::Vector3d q = transformPoint(rotation, translation, xyz + i * 3);
+        const Eigen::Vector3i cell(static_cast<int>(std::floor(q.x() * invVoxel)),
+                                   static_cast<int>(std::floor(q.y() * invVoxel)),
+                                   static_cast<int>(std::floor(q.z() * invVoxel)));
+        const int sign = deviation > 0.0f ? 1 : 0;
+        auto inserted = voxelMaps[sign].emplace(voxelKey(cell.x(), cell.y(), cell.z()),
+                                                static_cast<int>(voxelCoords.size()));
+        if (inserted.second) {
+            voxelCoords.push_back(cell);
+            voxelSign.push_back(sign);
+        }
+        pointVoxels.emplace_back(i, inserted.first->second);
+    }
+
+    // 26邻域并查集
+    std::vector<int> parent(voxelCoords.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    for (size_t v = 0; v < voxelCoords.size(); ++v) {
+        const Eigen::Vector3i& cell = voxelCoords[v];
+        const std::unordered_map<int64_t, int>& voxels = voxelMaps[voxelSign[v]];
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dz = -1; dz <= 1; ++dz) {
+                    auto it = voxels.find(voxelKey(cell.x() + dx, cell.y() + dy, cell.z() + dz));
+                    if (it == voxels.end()) {
+                        continue;
+                    }
+                    const int a = findRoot(parent, static_cast<int>(v));
+                    const int b = findRoot(parent, it->second);
+                    if (a != b) {
+                        parent[std::max(a, b)] = std::min(a, b);
+                    }
+                }
+            }
+        }
+    }
+
+    struct RegionAccumulator {
+        DeviationRegion region;
+        double sum = 0.0;
+        Eigen::Vector3d positionSum = Eigen::Vector3d::Zero();
+        QHash<int, int> partVotes;
+    };
+    std::unordered_map<int, RegionAccumulator> accumulators;
+
+    for (const auto& pointVoxel : pointVoxels) {
+        const size_t i = pointVoxel.first;
+        const int root = findRoot(parent, pointVoxel.second);
+        const double deviation = report.deviations[i];
+        const Eigen::Vector3d q = transformPoint(rotation, translation, xyz + i * 3);
+
+        RegionAccumulator& acc = accumulators[root];
+        DeviationRegion& region = acc.region;
+        if (region.pointCount == 0) {
+            region.boundsMin = q;
+            region.boundsMax = q;
+            region.excess = deviation > 0.0;
+        } else {
+            region.boundsMin = region.boundsMin.cwiseMin(q);
+            region.boundsMax = region.boundsMax.cwiseMax(q);
+        }
+        ++region.pointCount;
+        if (std::abs(deviation) > std::abs(region.maxDeviation)) {
+            region.maxDeviation = deviation;
+        }
+        acc.sum += deviation;
+        acc.positionSum += q;
+        ++acc.partVotes[parts[i]];
+    }
+
+    for (auto& entry : accumulators) {
+        RegionAccumulator& acc = entry.second;
+        DeviationRegion& region = acc.region;
+        if (region.pointCount < options.minRegionPoints) {
+            continue;
+        }
+        region.meanDeviation = acc.sum / region.pointCount;
+        region.center = acc.positionSum / region.pointCount;
+
+        int bestPart = -1;
+        int bestVotes = 0;
+        for (auto it = acc.partVotes.constBegin(); it != acc.partVotes.constEnd(); ++it) {
+            if (it.value() > bestVotes) {
+                bestVotes = it.value();
+                bestPart = it.key();
+            }
+        }
+        region.partName = cad.partName(bestPart);
+        report.regions.append(region);
+    }
+
+    std::sort(report.regions.begin(), report.regions.end(),
+              [](const DeviationRegion& a, const DeviationRegion& b) {
+                  return std::abs(a.maxDeviation) > std::abs(b.maxDeviation);
+              });
+    if (options.maxRegions > 0 && report.regions.size() > options.maxRegions) {
+        report.regions.resize(options.maxRegions);
+    }
+}
+
+} // namespace Simulation
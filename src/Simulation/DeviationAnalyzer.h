@@ -0,0 +1,134 @@
+#ifndef DEVIATIONANALYZER_H
+#define DEVIATIONANALYZER_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <Eigen/Dense>
+#include <cstddef>
+#include <vector>
+
+namespace Simulation {
+
+class TriangleBVH;
+
+/**
+ * @brief 偏差分析参数（长度单位与CAD一致，通常为mm）
+ */
+struct DeviationOptions {
+    double tolerance = 0.5;             // 公差带，|偏差| 超过此值的点计为超差
+    double maxDistance = 0.0;           // 最大对应距离，超出的点不参与统计；0表示取CAD包围盒对角线的10%
+    bool skipRegistration = false;      // 点云已在CAD坐标系中时跳过配准
+    int icpMaxIterations = 30;
+    int icpSampleCount = 20000;         // ICP使用的采样点数
+    double icpConvergence = 1e-4;       // 平移增量(同长度单位)和旋转增量(弧度)均小于此值时收敛
+    double regionVoxelSize = 0.0;       // 超差区域聚类的体素边长；0表示取CAD包围盒对角线的1%
+    int minRegionPoints = 50;           // 点数少于此值的超差区域视为噪声
+    int maxRegions = 100;               // 报告中最多保留的区域数（按最大偏差排序）
+    int threadCount = 0;                // 0表示使用全部硬件线程
+};
+
+/**
+ * @brief 超差区域（同号偏差的连通点集，坐标为CAD坐标系）
+ */
+struct DeviationRegion {
+    int pointCount = 0;
+    double maxDeviation = 0.0;          // 绝对值最大的有符号偏差
+    double meanDeviation = 0.0;
+    Eigen::Vector3d center = Eigen::Vector3d::Zero();
+    Eigen::Vector3d boundsMin = Eigen::Vector3d::Zero();
+    Eigen::Vector3d boundsMax = Eigen::Vector3d::Zero();
+    QString partName;                   // 区域内多数点最近的部件
+    bool excess = false;                // true为材料多余（法向外侧），false为材料不足
+
+    QJsonObject toJson() const;
+};
+
+/**
+ * @brief 偏差分析结果
+ */
+struct DeviationReport {
+    bool valid = false;
+    QString errorMessage;
+
+    // 配准：扫描点云 -> CAD 的刚体变换
+    Eigen::Matrix4d registration = Eigen::Matrix4d::Identity();
+    double registrationRms = 0.0;
+    int icpIterations = 0;
+
+    // 逐点有符号偏差，与输入点一一对应；超出最大对应距离的点为NaN
+    std::vector<float> deviations;
+
+    size_t pointCount = 0;
+    size_t measuredCount = 0;           // 找到对应点的点数
+    size_t outOfToleranceCount = 0;
+    double tolerance = 0.0;
+    double minDeviation = 0.0;
+    double maxDeviation = 0.0;
+    double meanAbsDeviation = 0.0;
+    double rmsDeviation = 0.0;
+
+    QVector<DeviationRegion> regions;
+
+    qint64 registrationMs = 0;
+    qint64 distanceMs = 0;
+    qint64 regionMs = 0;
+    qint64 totalMs = 0;
+
+    /**
+     * @brief 超差点占已测量点的比例
+     */
+    double outOfToleranceRatio() const;
+
+    /**
+     * @brief 是否没有超差区域（已存储的轨迹可以复用）
+     */
+    bool withinTolerance() const { return valid && regions.isEmpty(); }
+
+    /**
+     * @brief 报告摘要（不含逐点偏差），用于日志和数据库存档
+     */
+    QJsonObject toJson() const;
+};
+
+/**
+ * @brief 扫描-CAD偏差分析
+ *
+ * 将扫描点云配准到CAD三角网格并计算逐点有符号偏差：
+ * 1. 主成分粗配准：比较点云与CAD表面的主轴，在恒等变换和4种右手主轴对应中取平均距离最小者
+ * 2. 点到面ICP精配准：采样点在BVH中找最近点，按残差截断剔除离群对应
+ * 3. 全部点并行计算有符号距离（沿CAD面法向外侧为正）
+ * 4. 超差点按体素做26邻域同号聚类，得到超差区域
+ *
+ * 所有步骤只读访问BVH，可在后台线程中调用。
+ * 符号由最近特征（面、边或顶点）的伪法向决定（TriangleBVH::signedDistance），要求CAD网格封闭且朝向一致。
+ */
+class DeviationAnalyzer
+{
+public:
+    /**
+     * @brief 执行偏差分析
+     * @param cad CAD场景BVH（已构建）
+     * @param xyz 点云坐标，xyz连续存放
+     * @param count 点数
+     * @param options 分析参数
+     */
+    static DeviationReport analyze(const TriangleBVH& cad, const float* xyz, size_t count,
+                                   const DeviationOptions& options = DeviationOptions());
+
+private:
+    static Eigen::Matrix4d coarseAlign(const TriangleBVH& cad, const float* xyz,
+                                       const std::vector<size_t>& samples, double maxDistance);
+    static double meanClampedDistance(const TriangleBVH& cad, const float* xyz,
+                                      const std::vector<size_t>& samples,
+                                      const Eigen::Matrix4d& transform, double maxDistance);
+    static int refineICP(const TriangleBVH& cad, const float* xyz,
+                         const std::vector<size_t>& samples, const DeviationOptions& options,
+                         double maxDistance, int threadCount, Eigen::Matrix4d& transform, double& rms);
+    static void buildRegions(const TriangleBVH& cad, const float* xyz, const std::vector<int>& parts,
+                             const DeviationOptions& options, double voxelSize, DeviationReport& report);
+};
+
+} // namespace Simulation
+
+#endif // DEVIATIONANALYZER_H
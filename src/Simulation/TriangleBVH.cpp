@@ -0,0 +1,812 @@
+#include "TriangleBVH.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRIANGLEBVH_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Simulation {
+
+namespace {
+
+const int kSahBins = 16;           // SAH分箱数
+const int kMaxLeafSize = 4;        // 不再尝试划分的叶子大小
+const int kMaxForcedLeafSize = 16; // SAH认为不值得划分时允许的最大叶子
+const int kStackSize = 64;         // 遍历栈深度，同时也是构建时的最大树深
+
+inline float dot3(const float a[3], const float b[3])
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+inline void sub3(const float a[3], const float b[3], float out[3])
+{
+    out[0] = a[0] - b[0];
+    out[1] = a[1] - b[1];
+    out[2] = a[2] - b[2];
+}
+
+inline void cross3(const float a[3], const float b[3], float out[3])
+{
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+inline void triangleNormal(const float* v, float normal[3])
+{
+    float e1[3], e2[3];
+    sub3(v + 3, v, e1);
+    sub3(v + 6, v, e2);
+    cross3(e1, e2, normal);
+    const float length = std::sqrt(dot3(normal, normal));
+    if (length > 0.0f) {
+        normal[0] /= length;
+        normal[1] /= length;
+        normal[2] /= length;
+    }
+}
+
+inline float boxArea(const float bmin[3], const float bmax[3])
+{
+    const float dx = bmax[0] - bmin[0];
+    const float dy = bmax[1] - bmin[1];
+    const float dz = bmax[2] - bmin[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+inline void growBox(float bmin[3], float bmax[3], const float* otherMin, const float* otherMax)
+{
+    for (int k = 0; k < 3; ++k) {
+        bmin[k] = std::min(bmin[k], otherMin[k]);
+        bmax[k] = std::max(bmax[k], otherMax[k]);
+    }
+}
+
+/**
+ * @brief Möller–Trumbore射线三角形求交
+ * @return 交点距离，不相交时返回FLT_MAX
+ */
+inline float intersectTriangle(const float origin[3], const float direction[3], const float* v)
+{
+    float e1[3], e2[3], p[3], t[3], q[3];
+    sub3(v + 3, v, e1);
+    sub3(v + 6, v, e2);
+    cross3(direction, e2, p);
+    const float det = dot3(e1, p);
+    if (std::abs(det) < 1e-12f) {
+        return FLT_MAX;
+    }
+
+    const float invDet = 1.0f / det;
+    sub3(origin, v, t);
+    const float u = dot3(t, p) * invDet;
+    if (u < 0.0f || u > 1.0f) {
+        return FLT_MAX;
+    }
+
+    cross3(t, e1, q);
+    const float w = dot3(direction, q) * invDet;
+    if (w < 0.0f || u + w > 1.0f) {
+        return FLT_MAX;
+    }
+
+    const float distance = dot3(e2, q) * invDet;
+    return distance > 0.0f ? distance : FLT_MAX;
+}
+
+/**
+ * @brief 点到三角形的最近点（Ericson, Real-Time Collision Detection 5.1.5）
+ * @return 最近点所在的特征（TriangleBVH::Feature）
+ */
+inline int closestPointOnTriangle(const float p[3], const float* v, float out[3])
+{
+    const float* a = v;
+    const float* b = v + 3;
+    const float* c = v + 6;
+    float ab[3], ac[3], ap[3];
+    sub3(b, a, ab);
+    sub3(c, a, ac);
+    sub3(p, a, ap);
+
+    auto assign = [&](const float* base, float s, const float* dir1, float t, const float* dir2) {
+        for (int k = 0; k < 3; ++k) {
+            out[k] = base[k] + s * (dir1 ? dir1[k] : 0.0f) + t * (dir2 ? dir2[k] : 0.0f);
+        }
+    };
+
+    const float d1 = dot3(ab, ap);
+    const float d2 = dot3(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        assign(a, 0.0f, nullptr, 0.0f, nullptr);
+        return TriangleBVH::Vertex0;
+    }
+
+    float bp[3];
+    sub3(p, b, bp);
+    const float d3 = dot3(ab, bp);
+    const float d4 = dot3(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        assign(b, 0.0f, nullptr, 0.0f, nullptr);
+        return TriangleBVH::Vertex1;
+    }
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        assign(a, d1 / (d1 - d3), ab, 0.0f, nullptr);
+        return TriangleBVH::Edge01;
+    }
+
+    float cp[3];
+    sub3(p, c, cp);
+    const float d5 = dot3(ab, cp);
+    const float d6 = dot3(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        assign(c, 0.0f, nullptr, 0.0f, nullptr);
+        return TriangleBVH::Vertex2;
+    }
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        assign(a, 0.0f, nullptr, d2 / (d2 - d6), ac);
+        return TriangleBVH::Edge20;
+    }
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        float bc[3];
+        sub3(c, b, bc);
+        assign(b, (d4 - d3) / ((d4 - d3) + (d5 - d6)), bc, 0.0f, nullptr);
+        return TriangleBVH::Edge12;
+    }
+
+    const float denom = 1.0f / (va + vb + vc);
+    assign(a, vb * denom, ab, vc * denom, ac);
+    return TriangleBVH::Face;
+}
+
+/**
+ * @brief 三角形在顶点处的内角
+ */
+inline double cornerAngle(const double* corner, const double* next, const double* previous)
+{
+    double e1[3], e2[3];
+    for (int k = 0; k < 3; ++k) {
+        e1[k] = next[k] - corner[k];
+        e2[k] = previous[k] - corner[k];
+    }
+    const double cross[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                             e1[2] * e2[0] - e1[0] * e2[2],
+                             e1[0] * e2[1] - e1[1] * e2[0]};
+    const double sine = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+    const double cosine = e1[0] * e2[0] + e1[1] * e2[1] + e1[2] * e2[2];
+    return std::atan2(sine, cosine);
+}
+
+inline void normalizeInto(const double in[3], float* out)
+{
+    const double length = std::sqrt(in[0] * in[0] + in[1] * in[1] + in[2] * in[2]);
+    for (int k = 0; k < 3; ++k) {
+        out[k] = length > 0.0 ? static_cast<float>(in[k] / length) : 0.0f;
+    }
+}
+
+/**
+ * @brief 射线预计算数据
+ */
+struct Ray {
+    float origin[3];
+    float direction[3];
+    float invDirection[3];
+#ifdef TRIANGLEBVH_USE_SSE
+    __m128 origin4;
+    __m128 invDirection4;
+#endif
+};
+
+} // namespace
+
+/**
+ * @brief 射线与节点包围盒的slab测试
+ * @return 进入距离，不相交或超过tMax时返回FLT_MAX
+ */
+template <typename NodeT>
+inline float intersectBox(const NodeT& node, const Ray& ray, float tMax)
+{
+#ifdef TRIANGLEBVH_USE_SSE
+    // 第4个分量为整数字段，只取前三个分量的结果
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.bmin), ray.origin4), ray.invDirection4);
+    const __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.bmax), ray.origin4), ray.invDirection4);
+    const __m128 vmin = _mm_min_ps(t1, t2);
+    const __m128 vmax = _mm_max_ps(t1, t2);
+    const float tNear = _mm_cvtss_f32(_mm_max_ss(_mm_max_ss(vmin, _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(1, 1, 1, 1))),
+                                                 _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(2, 2, 2, 2))));
+    const float tFar = _mm_cvtss_f32(_mm_min_ss(_mm_min_ss(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(1, 1, 1, 1))),
+                                                _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(2, 2, 2, 2))));
+#else
+    float tNear = 0.0f;
+    float tFar = FLT_MAX;
+    for (int k = 0; k < 3; ++k) {
+        const float t1 = (node.bmin[k] - ray.origin[k]) * ray.invDirection[k];
+        const float t2 = (node.bmax[k] - ray.origin[k]) * ray.invDirection[k];
+        tNear = std::max(tNear, std::min(t1, t2));
+        tFar = std::min(tFar, std::max(t1, t2));
+    }
+#endif
+    const float entry = std::max(tNear, 0.0f);
+    return (tFar >= entry && entry < tMax) ? entry : FLT_MAX;
+}
+
+/**
+ * @brief 点到节点包围盒距离的平方
+ */
+template <typename NodeT>
+inline float boxDistanceSquared(const NodeT& node, const float p[3])
+{
+    float distance = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        const float d = std::max(std::max(node.bmin[k] - p[k], p[k] - node.bmax[k]), 0.0f);
+        distance += d * d;
+    }
+    return distance;
+}
+
+TriangleBVH::TriangleBVH()
+    : m_built(false)
+{
+}
+
+int TriangleBVH::addMesh(const QString& partName, const double* vertices, int vertexCount,
+                         const int* indices, int triangleCount)
+{
+    if (m_built) {
+        qWarning() << "TriangleBVH: 构建后不能再添加网格:" << partName;
+        return -1;
+    }
+
+    int part = m_partNames.indexOf(partName);
+    if (part < 0) {
+        part = m_partNames.size();
+        m_partNames.append(partName);
+    }
+
+    // 坐标相同的顶点合并为同一顶点（CAD网格按面离散，面与面之间的顶点是重复的）
+    std::vector<int> welded(vertexCount);
+    std::map<std::array<double, 3>, int> positions;
+    for (int i = 0; i < vertexCount; ++i) {
+        const double* v = vertices + i * 3;
+        welded[i] = positions.emplace(std::array<double, 3>{v[0], v[1], v[2]}, static_cast<int>(positions.size()))
+                        .first->second;
+    }
+
+    // 伪法向：顶点为相邻面法向按顶角加权之和，边为相邻面法向之和
+    std::vector<std::array<double, 3>> vertexNormals(positions.size(), std::array<double, 3>{0.0, 0.0, 0.0});
+    std::map<std::pair<int, int>, std::array<double, 3>> edgeNormals;
+    std::vector<int> valid;
+    valid.reserve(triangleCount);
+    for (int t = 0; t < triangleCount; ++t) {
+        const int* tri = indices + t * 3;
+        if (tri[0] < 0 || tri[1] < 0 || tri[2] < 0 ||
+            tri[0] >= vertexCount || tri[1] >= vertexCount || tri[2] >= vertexCount) {
+            continue;
+        }
+        valid.push_back(t);
+
+        const double* v[3] = {vertices + tri[0] * 3, vertices + tri[1] * 3, vertices + tri[2] * 3};
+        double normal[3] = {(v[1][1] - v[0][1]) * (v[2][2] - v[0][2]) - (v[1][2] - v[0][2]) * (v[2][1] - v[0][1]),
+                            (v[1][2] - v[0][2]) * (v[2][0] - v[0][0]) - (v[1][0] - v[0][0]) * (v[2][2] - v[0][2]),
+                            (v[1][0] - v[0][0]) * (v[2][1] - v[0][1]) - (v[1][1] - v[0][1]) * (v[2][0] - v[0][0])};
+        const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length <= 0.0) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            normal[k] /= length;
+        }
+
+        for (int corner = 0; corner < 3; ++corner) {
+            const double angle = cornerAngle(v[corner], v[(corner + 1) % 3], v[(corner + 2) % 3]);
+            auto& vertexNormal = vertexNormals[welded[tri[corner]]];
+            const int a = welded[tri[corner]];
+            const int b = welded[tri[(corner + 1) % 3]];
+            auto& edgeNormal = edgeNormals.emplace(std::make_pair(std::min(a, b), std::max(a, b)),
+                                                   std::array<double, 3>{0.0, 0.0, 0.0}).first->second;
+            for (int k = 0; k < 3; ++k) {
+                vertexNormal[k] += angle * normal[k];
+                edgeNormal[k] += normal[k];
+            }
+        }
+    }
+
+    m_vertices.reserve(m_vertices.size() + valid.size() * 9);
+    m_featureNormals.reserve(m_featureNormals.size() + valid.size() * 18);
+    m_triangleParts.reserve(m_triangleParts.size() + valid.size());
+    for (int t : valid) {
+        const int* tri = indices + t * 3;
+        for (int k = 0; k < 3; ++k) {
+            const double* v = vertices + tri[k] * 3;
+            m_vertices.push_back(static_cast<float>(v[0]));
+            m_vertices.push_back(static_cast<float>(v[1]));
+            m_vertices.push_back(static_cast<float>(v[2]));
+        }
+
+        // 顺序与Feature一致：Vertex0, Vertex1, Vertex2, Edge01, Edge12, Edge20
+        const size_t offset = m_featureNormals.size();
+        m_featureNormals.resize(offset + 18);
+        for (int corner = 0; corner < 3; ++corner) {
+            const int a = welded[tri[corner]];
+            const int b = welded[tri[(corner + 1) % 3]];
+            normalizeInto(vertexNormals[a].data(), &m_featureNormals[offset + corner * 3]);
+            normalizeInto(edgeNormals[std::make_pair(std::min(a, b), std::max(a, b))].data(),
+                          &m_featureNormals[offset + 9 + corner * 3]);
+        }
+        m_triangleParts.push_back(part);
+    }
+    return part;
+}
+
+void TriangleBVH::clear()
+{
+    m_nodes.clear();
+    m_vertices.clear();
+    m_featureNormals.clear();
+    m_triangleParts.clear();
+    m_partNames.clear();
+    m_built = false;
+}
+
+void TriangleBVH::build()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_nodes.clear();
+    m_built = true;
+    const int count = triangleCount();
+    if (count == 0) {
+        return;
+    }
+
+    // 预计算每个三角形的包围盒和重心
+    std::vector<float> boxes(static_cast<size_t>(count) * 6);
+    std::vector<float> centroids(static_cast<size_t>(count) * 3);
+    for (int t = 0; t < count; ++t) {
+        const float* v = triangleVertices(t);
+        for (int k = 0; k < 3; ++k) {
+            boxes[t * 6 + k] = std::min({v[k], v[3 + k], v[6 + k]});
+            boxes[t * 6 + 3 + k] = std::max({v[k], v[3 + k], v[6 + k]});
+            centroids[t * 3 + k] = (v[k] + v[3 + k] + v[6 + k]) / 3.0f;
+        }
+    }
+
+    std::vector<int> order(count);
+    for (int t = 0; t < count; ++t) {
+        order[t] = t;
+    }
+
+    m_nodes.reserve(static_cast<size_t>(count) * 2);
+    m_nodes.push_back(Node());
+    subdivide(0, 0, count, order, centroids, boxes);
+    m_nodes.shrink_to_fit();
+
+    // 三角形按叶子顺序重排，叶子内的三角形在内存中连续
+    std::vector<float> vertices(m_vertices.size());
+    std::vector<float> featureNormals(m_featureNormals.size());
+    std::vector<int> parts(m_triangleParts.size());
+    for (int i = 0; i < count; ++i) {
+        std::copy_n(triangleVertices(order[i]), 9, &vertices[static_cast<size_t>(i) * 9]);
+        std::copy_n(featureNormal(order[i], 0), 18, &featureNormals[static_cast<size_t>(i) * 18]);
+        parts[i] = m_triangleParts[order[i]];
+    }
+    m_vertices.swap(vertices);
+    m_featureNormals.swap(featureNormals);
+    m_triangleParts.swap(parts);
+
+    qDebug() << "TriangleBVH: 构建完成," << count << "个三角形," << m_nodes.size() << "个节点,"
+             << m_partNames.size() << "个部件，耗时" << timer.elapsed() << "ms";
+}
+
+void TriangleBVH::subdivide(int nodeIndex, int first, int count, std::vector<int>& order,
+                            const std::vector<float>& centroids, const std::vector<float>& boxes)
+{
+    struct Task {
+        int node;
+        int first;
+        int count;
+        int depth;
+    };
+    std::vector<Task> tasks;
+    tasks.push_back({nodeIndex, first, count, 0});
+    int depthLimitedLeaves = 0;
+
+    while (!tasks.empty()) {
+        const Task task = tasks.back();
+        tasks.pop_back();
+
+        // 节点包围盒和重心范围
+        float bmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+        float bmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+        float cmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+        float cmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+        for (int i = task.first; i < task.first + task.count; ++i) {
+            const int t = order[i];
+            growBox(bmin, bmax, &boxes[t * 6], &boxes[t * 6 + 3]);
+            growBox(cmin, cmax, &centroids[t * 3], &centroids[t * 3]);
+        }
+
+        Node& node = m_nodes[task.node];
+        std::copy_n(bmin, 3, node.bmin);
+        std::copy_n(bmax, 3, node.bmax);
+        node.leftFirst = task.first;
+        node.count = task.count;
+        if (task.count <= kMaxLeafSize) {
+            continue;
+        }
+        // 深度为d的内部节点遍历时栈中最多有d+1个元素，超过栈深度的节点强制作为叶子
+        if (task.depth >= kStackSize - 1) {
+            ++depthLimitedLeaves;
+            continue;
+        }
+
+        // 分箱SAH：在三个轴上寻找代价最小的划分
+        int bestAxis = -1;
+        int bestSplit = 0;
+        float bestCost = FLT_MAX;
+        for (int axis = 0; axis < 3; ++axis) {
+            const float extent = cmax[axis] - cmin[axis];
+            if (extent <= 0.0f) {
+                continue;
+            }
+
+            struct Bin {
+                float bmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+                float bmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+                int count = 0;
+            } bins[kSahBins];
+
+            const float scale = kSahBins / extent;
+            for (int i = task.first; i < task.first + task.count; ++i) {
+                const int t = order[i];
+                const int b = std::min(kSahBins - 1, static_cast<int>((centroids[t * 3 + axis] - cmin[axis]) * scale));
+                bins[b].count++;
+                growBox(bins[b].bmin, bins[b].bmax, &boxes[t * 6], &boxes[t * 6 + 3]);
+            }
+
+            // 从两侧扫描累计面积和数量
+            float leftArea[kSahBins - 1];
+            int leftCount[kSahBins - 1];
+            float lmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+            float lmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+            int lcount = 0;
+            for (int b = 0; b < kSahBins - 1; ++b) {
+                lcount += bins[b].count;
+                if (bins[b].count > 0) {
+                    growBox(lmin, lmax, bins[b].bmin, bins[b].bmax);
+                }
+                leftCount[b] = lcount;
+                leftArea[b] = lcount > 0 ? boxArea(lmin, lmax) : 0.0f;
+            }
+
+            float rmin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+            float rmax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+            int rcount = 0;
+            for (int b = kSahBins - 1; b > 0; --b) {
+                rcount += bins[b].count;
+                if (bins[b].count > 0) {
+                    growBox(rmin, rmax, bins[b].bmin, bins[b].bmax);
+                }
+                if (leftCount[b - 1] == 0 || rcount == 0) {
+                    continue;
+                }
+                const float cost = leftCount[b - 1] * leftArea[b - 1] + rcount * boxArea(rmin, rmax);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        // 划分代价不低于叶子代价时保留为叶子（叶子不超过上限）
+        const float leafCost = task.count * boxArea(bmin, bmax);
+        if (bestAxis < 0 || (bestCost >= leafCost && task.count <= kMaxForcedLeafSize)) {
+            continue;
+        }
+
+        const float splitMin = cmin[bestAxis];
+        const float scale = kSahBins / (cmax[bestAxis] - cmin[bestAxis]);
+        auto middle = std::partition(order.begin() + task.first, order.begin() + task.first + task.count,
+                                     [&](int t) {
+                                         const int b = std::min(kSahBins - 1,
+                                             static_cast<int>((centroids[t * 3 + bestAxis] - splitMin) * scale));
+                                         return b < bestSplit;
+                                     });
+        const int leftCount = static_cast<int>(middle - (order.begin() + task.first));
+        if (leftCount == 0 || leftCount == task.count) {
+            continue;
+        }
+
+        // 左右子节点相邻存放，m_nodes扩容后不能再使用node引用
+        const int leftIndex = static_cast<int>(m_nodes.size());
+        m_nodes[task.node].leftFirst = leftIndex;
+        m_nodes[task.node].count = 0;
+        m_nodes.push_back(Node());
+        m_nodes.push_back(Node());
+
+        tasks.push_back({leftIndex + 1, task.first + leftCount, task.count - leftCount, task.depth + 1});
+        tasks.push_back({leftIndex, task.first, leftCount, task.depth + 1});
+    }
+
+    if (depthLimitedLeaves > 0) {
+        qWarning() << "TriangleBVH: 树深达到上限" << kStackSize << "，" << depthLimitedLeaves
+                   << "个节点被强制作为叶子，查询性能可能下降";
+    }
+}
+
+bool TriangleBVH::bounds(double bounds[6]) const
+{
+    if (!m_built || m_nodes.empty()) {
+        return false;
+    }
+    for (int k = 0; k < 3; ++k) {
+        bounds[2 * k] = m_nodes[0].bmin[k];
+        bounds[2 * k + 1] = m_nodes[0].bmax[k];
+    }
+    return true;
+}
+
+bool TriangleBVH::surfaceMoments(double centroid[3], double covariance[3][3]) const
+{
+    const int count = triangleCount();
+    double totalArea = 0.0;
+    double sum[3] = {0.0, 0.0, 0.0};
+    double second[3][3] = {{0.0}};
+    for (int t = 0; t < count; ++t) {
+        const float* v = triangleVertices(t);
+        float normal[3], e1[3], e2[3];
+        sub3(v + 3, v, e1);
+        sub3(v + 6, v, e2);
+        cross3(e1, e2, normal);
+        const double area = 0.5 * std::sqrt(dot3(normal, normal));
+        if (area <= 0.0) {
+            continue;
+        }
+
+        // 三角形上均匀分布的一阶矩和二阶矩（Σ vi vj 项 = (Σ_k vk)(Σ_k vk) + Σ_k vk vk，再除以12）
+        totalArea += area;
+        for (int r = 0; r < 3; ++r) {
+            const double sr = v[r] + v[3 + r] + v[6 + r];
+            sum[r] += area * sr / 3.0;
+            for (int c = 0; c < 3; ++c) {
+                const double sc = v[c] + v[3 + c] + v[6 + c];
+                const double diag = v[r] * v[c] + v[3 + r] * v[3 + c] + v[6 + r] * v[6 + c];
+                second[r][c] += area * (sr * sc + diag) / 12.0;
+            }
+        }
+    }
+
+    if (totalArea <= 0.0) {
+        return false;
+    }
+
+    for (int r = 0; r < 3; ++r) {
+        centroid[r] = sum[r] / totalArea;
+    }
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            covariance[r][c] = second[r][c] / totalArea - centroid[r] * centroid[c];
+        }
+    }
+    return true;
+}
+
+bool TriangleBVH::intersectRay(const double origin[3], const double direction[3], RayHit& hit,
+                               double maxDistance) const
+{
+    if (!m_built || m_nodes.empty()) {
+        return false;
+    }
+
+    const double length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] +
+                                    direction[2] * direction[2]);
+    if (length <= 0.0) {
+        return false;
+    }
+
+    Ray ray;
+    for (int k = 0; k < 3; ++k) {
+        ray.origin[k] = static_cast<float>(origin[k]);
+        ray.direction[k] = static_cast<float>(direction[k] / length);
+        // 避免方向分量为0时出现NaN
+        const float d = std::abs(ray.direction[k]) > 1e-20f ? ray.direction[k]
+                                                             : std::copysign(1e-20f, ray.direction[k]);
+        ray.invDirection[k] = 1.0f / d;
+    }
+#ifdef TRIANGLEBVH_USE_SSE
+    ray.origin4 = _mm_set_ps(0.0f, ray.origin[2], ray.origin[1], ray.origin[0]);
+    ray.invDirection4 = _mm_set_ps(0.0f, ray.invDirection[2], ray.invDirection[1], ray.invDirection[0]);
+#endif
+
+    float best = static_cast<float>(std::min(maxDistance, static_cast<double>(FLT_MAX)));
+    int bestTriangle = -1;
+
+    if (intersectBox(m_nodes[0], ray, best) == FLT_MAX) {
+        return false;
+    }
+
+    int stack[kStackSize];
+    int stackSize = 0;
+    int current = 0;
+    while (true) {
+        const Node& node = m_nodes[current];
+        if (node.count > 0) {
+            for (int t = node.leftFirst; t < node.leftFirst + node.count; ++t) {
+                const float distance = intersectTriangle(ray.origin, ray.direction, triangleVertices(t));
+                if (distance < best) {
+                    best = distance;
+                    bestTriangle = t;
+                }
+            }
+        } else {
+            // 先访问较近的子节点，较远的入栈
+            int nearChild = node.leftFirst;
+            int farChild = node.leftFirst + 1;
+            float nearDistance = intersectBox(m_nodes[nearChild], ray, best);
+            float farDistance = intersectBox(m_nodes[farChild], ray, best);
+            if (farDistance < nearDistance) {
+                std::swap(nearChild, farChild);
+                std::swap(nearDistance, farDistance);
+            }
+
+            if (nearDistance != FLT_MAX) {
+                if (farDistance != FLT_MAX) {
+                    Q_ASSERT(stackSize < kStackSize);
+                    stack[stackSize++] = farChild;
+                }
+                current = nearChild;
+                continue;
+            }
+        }
+
+        // 出栈时重新检查是否仍可能比当前最近交点更近
+        bool found = false;
+        while (stackSize > 0) {
+            current = stack[--stackSize];
+            if (intersectBox(m_nodes[current], ray, best) != FLT_MAX) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            break;
+        }
+    }
+
+    if (bestTriangle < 0) {
+        return false;
+    }
+
+    hit.distance = best;
+    for (int k = 0; k < 3; ++k) {
+        hit.point[k] = ray.origin[k] + ray.direction[k] * best;
+    }
+    triangleNormal(triangleVertices(bestTriangle), hit.normal);
+    hit.triangle = bestTriangle;
+    hit.part = m_triangleParts[bestTriangle];
+    return true;
+}
+
+bool TriangleBVH::closestPoint(const double point[3], ClosestPoint& result, double maxDistance) const
+{
+    if (!m_built || m_nodes.empty()) {
+        return false;
+    }
+
+    const float p[3] = {static_cast<float>(point[0]), static_cast<float>(point[1]), static_cast<float>(point[2])};
+    const float maxDist = static_cast<float>(std::min(maxDistance, static_cast<double>(FLT_MAX) / 2.0));
+    float bestSquared = maxDist * maxDist;
+    if (!std::isfinite(bestSquared)) {
+        bestSquared = FLT_MAX;
+    }
+    int bestTriangle = -1;
+    int bestFeature = -1;
+    float bestPoint[3] = {0.0f, 0.0f, 0.0f};
+
+    if (boxDistanceSquared(m_nodes[0], p) > bestSquared) {
+        return false;
+    }
+
+    int stack[kStackSize];
+    int stackSize = 0;
+    int current = 0;
+    while (true) {
+        const Node& node = m_nodes[current];
+        if (node.count > 0) {
+            for (int t = node.leftFirst; t < node.leftFirst + node.count; ++t) {
+                float candidate[3];
+                const int feature = closestPointOnTriangle(p, triangleVertices(t), candidate);
+                float d[3];
+                sub3(candidate, p, d);
+                const float distanceSquared = dot3(d, d);
+                if (distanceSquared < bestSquared) {
+                    bestSquared = distanceSquared;
+                    bestTriangle = t;
+                    bestFeature = feature;
+                    std::copy_n(candidate, 3, bestPoint);
+                }
+            }
+        } else {
+            int nearChild = node.leftFirst;
+            int farChild = node.leftFirst + 1;
+            float nearDistance = boxDistanceSquared(m_nodes[nearChild], p);
+            float farDistance = boxDistanceSquared(m_nodes[farChild], p);
+            if (farDistance < nearDistance) {
+                std::swap(nearChild, farChild);
+                std::swap(nearDistance, farDistance);
+            }
+
+            if (nearDistance < bestSquared) {
+                if (farDistance < bestSquared) {
+                    Q_ASSERT(stackSize < kStackSize);
+                    stack[stackSize++] = farChild;
+                }
+                current = nearChild;
+                continue;
+            }
+        }
+
+        bool found = false;
+        while (stackSize > 0) {
+            current = stack[--stackSize];
+            if (boxDistanceSquared(m_nodes[current], p) < bestSquared) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            break;
+        }
+    }
+
+    if (bestTriangle < 0) {
+        return false;
+    }
+
+    result.distance = std::sqrt(bestSquared);
+    std::copy_n(bestPoint, 3, result.point);
+    triangleNormal(triangleVertices(bestTriangle), result.normal);
+    result.triangle = bestTriangle;
+    result.part = m_triangleParts[bestTriangle];
+    result.feature = bestFeature;
+    return true;
+}
+
+double TriangleBVH::signedDistance(const double point[3], ClosestPoint* result, double maxDistance) const
+{
+    ClosestPoint closest;
+    if (!closestPoint(point, closest, maxDistance)) {
+        return maxDistance;
+    }
+
+    if (result) {
+        *result = closest;
+    }
+
+    const float offset[3] = {static_cast<float>(point[0]) - closest.point[0],
+                             static_cast<float>(point[1]) - closest.point[1],
+                             static_cast<float>(point[2]) - closest.point[2]};
+    // 最近点在边或顶点上时，单个面的法向不能区分内外，改用该特征的伪法向
+    const float* normal = closest.feature == Face ? closest.normal : featureNormal(closest.triangle, closest.feature);
+    return dot3(offset, normal) >= 0.0f ? closest.distance : -closest.distance;
+}
+
+} // namespace Simulation
@@ -0,0 +1,168 @@
+#ifndef TRIANGLEBVH_H
+#define TRIANGLEBVH_H
+
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Simulation {
+
+/**
+ * @brief 三角形层次包围盒（BVH）
+ *
+ * 对细分后的场景几何建立面级BVH，用于射线拾取、最近点和有符号距离查询（如喷枪与车间的间隙检查）：
+ * - 按表面积启发式（SAH）分箱构建，节点展平为连续数组（每个节点32字节）
+ * - 三角形按叶子顺序重排，遍历时内存访问连续
+ * - 射线与包围盒的slab测试使用SSE一次计算三个轴
+ * - 每个三角形带部件编号，查询结果可直接得到部件名称
+ * - 每个三角形保存顶点和边的角度加权伪法向，有符号距离在边和顶点附近也能得到正确的内外
+ *
+ * build()之后对象只读，所有查询都是const且不修改内部状态，可在任意线程并发调用。
+ * 坐标使用单精度存储，适用于mm级的车间坐标。
+ */
+class TriangleBVH
+{
+public:
+    /**
+     * @brief 射线拾取结果
+     */
+    struct RayHit {
+        float distance = 0.0f;   // 沿射线方向的距离（方向已归一化）
+        float point[3] = {0.0f, 0.0f, 0.0f};
+        float normal[3] = {0.0f, 0.0f, 0.0f};  // 三角形法向（按顶点顺序）
+        int triangle = -1;
+        int part = -1;
+    };
+
+    /**
+     * @brief 最近点所在的三角形特征（顶点、边或面内）
+     */
+    enum Feature {
+        Vertex0,
+        Vertex1,
+        Vertex2,
+        Edge01,
+        Edge12,
+        Edge20,
+        Face
+    };
+
+    /**
+     * @brief 最近点查询结果
+     */
+    struct ClosestPoint {
+        float distance = 0.0f;   // 无符号距离
+        float point[3] = {0.0f, 0.0f, 0.0f};
+        float normal[3] = {0.0f, 0.0f, 0.0f};  // 三角形法向（按顶点顺序）
+        int triangle = -1;
+        int part = -1;
+        int feature = -1;        // 最近点所在的特征（Feature）
+    };
+
+    TriangleBVH();
+
+    /**
+     * @brief 添加一个部件的三角网格（世界坐标）
+     *
+     * 同一部件内坐标相同的顶点视为同一顶点，用于计算顶点和边的伪法向。
+     * @param partName 部件名称
+     * @param vertices 顶点坐标 xyz 连续存放
+     * @param vertexCount 顶点数
+     * @param indices 三角形顶点索引，每三个一组
+     * @param triangleCount 三角形数
+     * @return 部件编号
+     */
+    int addMesh(const QString& partName, const double* vertices, int vertexCount,
+                const int* indices, int triangleCount);
+
+    /**
+     * @brief 构建BVH，之后不能再添加网格
+     */
+    void build();
+
+    void clear();
+    bool isBuilt() const { return m_built; }
+    bool isEmpty() const { return m_triangleParts.empty(); }
+    int triangleCount() const { return static_cast<int>(m_triangleParts.size()); }
+    int nodeCount() const { return static_cast<int>(m_nodes.size()); }
+    int partCount() const { return m_partNames.size(); }
+    QString partName(int part) const { return m_partNames.value(part); }
+
+    /**
+     * @brief 场景包围盒 {xmin, xmax, ymin, ymax, zmin, zmax}
+     * @return BVH为空时返回false
+     */
+    bool bounds(double bounds[6]) const;
+
+    /**
+     * @brief 按面积加权的表面重心和协方差（用于主成分配准）
+     * @return BVH为空时返回false
+     */
+    bool surfaceMoments(double centroid[3], double covariance[3][3]) const;
+
+    /**
+     * @brief 射线求交，返回最近的交点
+     * @param origin 射线起点
+     * @param direction 射线方向（无需归一化）
+     * @param hit 交点信息
+     * @param maxDistance 最大距离
+     */
+    bool intersectRay(const double origin[3], const double direction[3], RayHit& hit,
+                      double maxDistance = std::numeric_limits<double>::max()) const;
+
+    /**
+     * @brief 查询最近点
+     * @param point 查询点
+     * @param result 最近点信息
+     * @param maxDistance 搜索半径，超出时返回false
+     */
+    bool closestPoint(const double point[3], ClosestPoint& result,
+                      double maxDistance = std::numeric_limits<double>::max()) const;
+
+    /**
+     * @brief 有符号距离（沿法向一侧为正）
+     *
+     * 符号由最近特征的角度加权伪法向决定（Bærentzen & Aanæs）：最近点在面内时为面法向，
+     * 在边上时为相邻面法向之和，在顶点上时为按顶角加权的相邻面法向之和。
+     * 对封闭且朝向一致（朝外）的网格，边和顶点附近的符号同样正确。
+     * @param point 查询点
+     * @param result 可选，最近点信息
+     * @param maxDistance 搜索半径，超出时返回maxDistance
+     */
+    double signedDistance(const double point[3], ClosestPoint* result = nullptr,
+                          double maxDistance = std::numeric_limits<double>::max()) const;
+
+private:
+    /**
+     * @brief 展平的BVH节点
+     *
+     * count > 0 为叶子，leftFirst为第一个三角形；否则leftFirst为左子节点，右子节点紧随其后。
+     * 包围盒与整数字段交错存放，SSE按4个float加载时第4个分量被忽略。
+     */
+    struct alignas(32) Node {
+        float bmin[3];
+        int32_t leftFirst;
+        float bmax[3];
+        int32_t count;
+    };
+    static_assert(sizeof(Node) == 32, "BVH节点应为32字节");
+
+    void subdivide(int nodeIndex, int first, int count,
+                   std::vector<int>& order, const std::vector<float>& centroids,
+                   const std::vector<float>& boxes);
+    const float* triangleVertices(int triangle) const { return &m_vertices[triangle * 9]; }
+    const float* featureNormal(int triangle, int feature) const { return &m_featureNormals[triangle * 18 + feature * 3]; }
+
+    std::vector<Node> m_nodes;
+    std::vector<float> m_vertices;        // 每个三角形9个float，构建后按叶子顺序排列
+    std::vector<float> m_featureNormals;  // 每个三角形6个伪法向（Vertex0..Edge20），与m_vertices同序
+    std::vector<int> m_triangleParts;     // 每个三角形所属部件
+    QStringList m_partNames;
+    bool m_built;
+};
+
+} // namespace Simulation
+
+#endif // TRIANGLEBVH_H
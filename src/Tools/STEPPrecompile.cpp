@@ -0,0 +1,266 @@
+/**
+ * @file STEPPrecompile.cpp
+ * @brief STEP网格缓存预编译工具（命令行，无需显示器）
+ * 
+ * 用法: STEPPrecompile [选项] <STEP文件或目录>...
+ *   -o, --cache-dir <dir>  缓存输出目录（默认与主程序相同的 data/cache）
+ *   -j, --jobs <n>         同时处理的文件数（默认为CPU核心数）
+ *   -f, --force            忽略已有的有效缓存，强制重新生成
+ * 
+ * 生成的缓存与 STEPModelTreeWidget::loadSTEPFileFast 使用的格式一致，
+ * 部件网格按细网格精度生成，文件之间和部件之间均并行处理。
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#include "ModelTree/STEPMeshCache.h"
+#include "ModelTree/ShapeTessellator.h"
+#include "STEP/STEPImportEngine.h"
+
+// OpenCASCADE
+#include <OSD_Parallel.hxx>
+
+namespace {
+
+// 无显示器时按此屏幕尺寸计算目标弦高误差
+const double kReferenceScreenPixels = 1000.0;
+
+QMutex g_outputMutex;
+
+/**
+ * @brief 单个文件的处理结果
+ */
+struct PrecompileResult {
+    bool success = false;
+    bool skipped = false;
+    QString message;
+    int parts = 0;
+    qint64 importMs = 0;
+    qint64 meshMs = 0;
+    qint64 writeMs = 0;
+    qint64 totalMs = 0;
+};
+
+void printLine(const QString& line)
+{
+    QMutexLocker locker(&g_outputMutex);
+    QTextStream out(stdout);
+    out << line << Qt::endl;
+}
+
+PrecompileResult precompileFile(const QString& stepPath, const QString& cacheDir, bool force)
+{
+    PrecompileResult result;
+    QElapsedTimer total;
+    total.start();
+    
+    QString cachePath = STEPMeshCache::cachePathFor(stepPath, cacheDir);
+    if (!force && STEPMeshCache::isValid(cachePath, stepPath)) {
+        result.success = true;
+        result.skipped = true;
+        result.message = "缓存有效，跳过";
+        return result;
+    }
+    
+    try {
+        // 1. 读取和转换（统一导入引擎，解析结构与主程序完全一致）
+        QElapsedTimer timer;
+        timer.start();
+        QString errorMessage;
+        STEPImportResultPtr imported = STEPImportEngine::instance()->import(
+            stepPath, Handle(STEPProgressIndicator)(), Message_ProgressRange(), &errorMessage);
+        // 批处理不需要在内存中保留文档，由本函数持有的引用决定其生命周期
+        STEPImportEngine::instance()->release(stepPath);
+        if (!imported) {
+            result.message = errorMessage;
+            return result;
+        }
+        result.importMs = timer.restart();
+        
+        const QString topLevelName = imported->topLevelName.isEmpty() ? "Model" : imported->topLevelName;
+        const int shapeCounter = imported->shapeCounter;
+        const QStringList names = imported->parts.keys();
+        const int count = names.size();
+        
+        // 2. 并行网格化（OSD_Parallel与其他文件的任务共享OCCT线程池）
+        std::vector<vtkSmartPointer<vtkPolyData>> meshes(count);
+        OSD_Parallel::For(0, count, [&](int i) {
+            try {
+                const STEPImportPart& part = imported->parts.constFind(names[i]).value();
+                double diagonal = 0.0;
+                if (!part.bounds.isEmpty()) {
+                    const QVector<double>& b = part.bounds;
+                    diagonal = std::sqrt((b[1] - b[0]) * (b[1] - b[0]) + (b[3] - b[2]) * (b[3] - b[2]) +
+                                         (b[5] - b[4]) * (b[5] - b[4]));
+                }
+                double chordError = ShapeTessellator::targetChordError(diagonal, kReferenceScreenPixels);
+                meshes[i] = ShapeTessellator::tessellateFine(part.shape, chordError);
+            } catch (...) {
+                meshes[i] = nullptr;
+            }
+        });
+        result.meshMs = timer.restart();
+        
+        // 3. 并行写入部件VTP
+        std::atomic<int> written(0);
+        OSD_Parallel::For(0, count, [&](int i) {
+            if (meshes[i] &&
+                STEPMeshCache::writePart(STEPMeshCache::partCachePath(cachePath, names[i]), meshes[i])) {
+                ++written;
+            }
+        });
+        
+        if (written == 0) {
+            result.message = "没有部件网格化成功";
+            return result;
+        }
+        
+        // 树结构最后写入，JSON存在即表示缓存完整
+        QJsonArray children;
+        for (int i = 0; i < count; ++i) {
+            if (meshes[i]) {
+                children.append(STEPMeshCache::makeTreeNode(names[i], names[i], true));
+            }
+        }
+        QJsonArray tree;
+        tree.append(STEPMeshCache::makeTreeNode(topLevelName, "Assembly", true, children));
+        if (!STEPMeshCache::writeTree(STEPMeshCache::treeJsonPath(cachePath), tree, shapeCounter)) {
+            result.message = "无法写入树结构";
+            return result;
+        }
+        result.writeMs = timer.restart();
+        
+        result.parts = written;
+        result.success = true;
+        if (written < count) {
+            result.message = QString("%1个部件网格化失败").arg(count - written);
+        }
+    } catch (const std::exception& e) {
+        result.message = QString("异常: %1").arg(e.what());
+    } catch (...) {
+        result.message = "未知异常";
+    }
+    
+    result.totalMs = total.elapsed();
+    return result;
+}
+
+QStringList collectSTEPFiles(const QStringList& inputs)
+{
+    const QStringList filters = {"*.step", "*.stp", "*.STEP", "*.STP"};
+    QStringList files;
+    
+    for (const QString& input : inputs) {
+        QFileInfo info(input);
+        if (info.isDir()) {
+            QDirIterator it(info.absoluteFilePath(), filters, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                files << it.next();
+            }
+        } else if (info.isFile()) {
+            files << info.absoluteFilePath();
+        } else {
+            printLine(QString("警告: 路径不存在: %1").arg(input));
+        }
+    }
+    
+    files.removeDuplicates();
+    files.sort();
+    return files;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("STEPPrecompile");
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("预编译STEP模型的网格/树结构缓存，供快速加载使用");
+    parser.addHelpOption();
+    parser.addPositionalArgument("paths", "STEP文件或包含STEP文件的目录", "<paths...>");
+    QCommandLineOption cacheDirOption({"o", "cache-dir"}, "缓存输出目录", "dir");
+    QCommandLineOption jobsOption({"j", "jobs"}, "同时处理的文件数", "n",
+                                  QString::number(QThread::idealThreadCount()));
+    QCommandLineOption forceOption({"f", "force"}, "强制重新生成已有的有效缓存");
+    parser.addOption(cacheDirOption);
+    parser.addOption(jobsOption);
+    parser.addOption(forceOption);
+    parser.process(app);
+    
+    if (parser.positionalArguments().isEmpty()) {
+        parser.showHelp(1);
+    }
+    
+    const QStringList files = collectSTEPFiles(parser.positionalArguments());
+    if (files.isEmpty()) {
+        printLine("未找到STEP文件");
+        return 1;
+    }
+    
+    const QString cacheDir = parser.value(cacheDirOption);
+    const bool force = parser.isSet(forceOption);
+    const int jobs = std::max(1, parser.value(jobsOption).toInt());
+    
+    // 在主线程中初始化导入引擎（含STEP转换器的静态参数），避免多线程首次初始化竞争
+    STEPImportEngine::instance();
+    
+    printLine(QString("共%1个STEP文件，并行文件数 %2，缓存目录: %3")
+              .arg(files.size()).arg(jobs)
+              .arg(cacheDir.isEmpty() ? STEPMeshCache::defaultCacheDir() : cacheDir));
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(jobs);
+    
+    std::atomic<int> finished(0);
+    std::atomic<int> failed(0);
+    QElapsedTimer total;
+    total.start();
+    
+    for (const QString& file : files) {
+        pool.start(QRunnable::create([&, file]() {
+            PrecompileResult r = precompileFile(file, cacheDir, force);
+            int index = ++finished;
+            QString name = QFileInfo(file).fileName();
+            
+            if (r.skipped) {
+                printLine(QString("[%1/%2] %3: %4").arg(index).arg(files.size()).arg(name, r.message));
+            } else if (r.success) {
+                printLine(QString("[%1/%2] %3: %4个部件, 读取转换 %5s, 网格化 %6s, 写入 %7s, 总计 %8s%9")
+                          .arg(index).arg(files.size()).arg(name).arg(r.parts)
+                          .arg(r.importMs / 1000.0, 0, 'f', 2)
+                          .arg(r.meshMs / 1000.0, 0, 'f', 2)
+                          .arg(r.writeMs / 1000.0, 0, 'f', 2)
+                          .arg(r.totalMs / 1000.0, 0, 'f', 2)
+                          .arg(r.message.isEmpty() ? QString() : QString(" (%1)").arg(r.message)));
+            } else {
+                ++failed;
+                printLine(QString("[%1/%2] %3: 失败 - %4 (%5s)").arg(index).arg(files.size())
+                          .arg(name, r.message).arg(r.totalMs / 1000.0, 0, 'f', 2));
+            }
+        }));
+    }
+    pool.waitForDone();
+    
+    printLine(QString("完成: %1个成功, %2个失败, 总耗时 %3s")
+              .arg(files.size() - failed).arg(failed.load())
+              .arg(total.elapsed() / 1000.0, 0, 'f', 2));
+    
+    return failed > 0 ? 1 : 0;
+}
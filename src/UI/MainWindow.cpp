@@ -1,5 +1,6 @@
 #include "MainWindow.h"
 #include "Visualization/VTKWidget.h"
+#include "Visualization/RenderScheduler.h"
 #include "Panels/ParameterPanel.h"
 #include "Panels/StatusPanel.h"
 #include "Panels/SafetyPanel.h"
@@ -21,6 +22,7 @@
 #include <QHBoxLayout>
 #include <QSplitter>
 #include <QAction>
+#include <QActionGroup>
 #include <QLabel>
 #include <QPushButton>
 #include <QFileDialog>
@@ -40,6 +42,7 @@
 #include <QSpinBox>
 #include <QDoubleSpinBox>
 #include <QSlider>
+#include <QInputDialog>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -171,6 +174,27 @@ void MainWindow::setupMenuBar()
     
     viewMenu->addSeparator();
     
+    // 轨迹着色菜单
+    QMenu* trajectoryColorMenu = viewMenu->addMenu("轨迹着色(&C)");
+    QActionGroup* trajectoryColorGroup = new QActionGroup(this);
+    const QList<QPair<QString, UI::TrajectoryView::ColorBy>> colorModes = {
+        { "单色", UI::TrajectoryView::Solid },
+        { "速度", UI::TrajectoryView::Speed },
+        { "流量", UI::TrajectoryView::FlowRate },
+        { "喷涂宽度", UI::TrajectoryView::SprayWidth },
+        { "奇异/限位风险", UI::TrajectoryView::Risk }
+    };
+    for (const auto& mode : colorModes) {
+        QAction* action = trajectoryColorMenu->addAction(mode.first);
+        action->setCheckable(true);
+        action->setChecked(mode.second == UI::TrajectoryView::Solid);
+        trajectoryColorGroup->addAction(action);
+        const UI::TrajectoryView::ColorBy colorBy = mode.second;
+        connect(action, &QAction::triggered, this, [this, colorBy]() {
+            m_vtkView->SetTrajectoryColorBy(colorBy);
+        });
+    }
+    
     // 面板显示/隐藏菜单
     m_panelMenu = viewMenu->addMenu("面板(&P)");
     
@@ -180,6 +204,14 @@ void MainWindow::setupMenuBar()
     connect(resetLayoutAction, &QAction::triggered, this, &MainWindow::resetLayout);
     viewMenu->addAction(resetLayoutAction);
     
+    // 分析菜单
+    QMenu* analysisMenu = menuBar()->addMenu("分析(&A)");
+    
+    QAction* deviationAction = new QAction("扫描-CAD偏差分析(&D)", this);
+    deviationAction->setToolTip("将点云配准到STEP模型并计算逐点偏差，判断已存储轨迹能否复用");
+    connect(deviationAction, &QAction::triggered, this, &MainWindow::OnAnalyzeDeviation);
+    analysisMenu->addAction(deviationAction);
+    
     // 帮助菜单
     QMenu* helpMenu = menuBar()->addMenu("帮助(&H)");
     
@@ -209,6 +241,12 @@ void MainWindow::setupToolBar()
     
     m_mainToolBar->addSeparator();
     
+    // 分析操作
+    QAction* deviationAction = m_mainToolBar->addAction("📏 偏差分析");
+    connect(deviationAction, &QAction::triggered, this, &MainWindow::OnAnalyzeDeviation);
+    
+    m_mainToolBar->addSeparator();
+    
     // 测试功能
     QAction* testTrajectoryAction = m_mainToolBar->addAction("📈 测试轨迹");
     connect(testTrajectoryAction, &QAction::triggered, this, [this]() {
@@ -681,6 +719,17 @@ void MainWindow::connectPanelSignals()
 void MainWindow::connectVTKSignals()
 {
     if (m_vtkView) {
+        // 帧率上限（车间电脑可在配置中调低），后台时降到空闲帧率
+        QSettings renderSettings("SpraySystem", "Rendering");
+        m_vtkView->renderScheduler()->setMaxFps(renderSettings.value("maxFps", 60).toInt());
+        m_vtkView->renderScheduler()->setIdleFps(renderSettings.value("idleFps", 10).toInt());
+        
+        // 模型树的重绘请求并入视图的渲染调度
+        if (m_modelTreePanel) {
+            connect(m_modelTreePanel, &STEPModelTreeWidget::renderRequested,
+                    m_vtkView, &UI::VTKWidget::RefreshRender);
+        }
+        
         connect(m_vtkView, &UI::VTKWidget::ModelLoaded, this, 
             [this](const QString& modelType, bool success) {
                 if (success) {
@@ -710,7 +759,58 @@ void MainWindow::connectVTKSignals()
             [this](double x, double y, double z) {
                 if (m_statusPanel) {
                     m_statusPanel->addLogMessage("INFO", 
-                        QString("点击位置: (%.2f, %.2f, %.2f)").arg(x).arg(y).arg(z));
+                        QString("点击位置: (%1, %2, %3)").arg(x, 0, 'f', 2).arg(y, 0, 'f', 2).arg(z, 0, 'f', 2));
+                }
+            });
+        
+        connect(m_vtkView, &UI::VTKWidget::PartPicked, this,
+            [this](const QString& partName, double, double, double) {
+                m_statusLabel->setText(QString("选中部件: %1").arg(partName));
+            });
+        
+        connect(m_vtkView, &UI::VTKWidget::DeviationAnalysisFinished, this,
+            [this](const QJsonObject& report) {
+                if (!m_statusPanel) {
+                    return;
+                }
+                if (!report["valid"].toBool()) {
+                    m_statusPanel->addLogMessage("ERROR", QString("偏差分析失败: %1").arg(report["error"].toString()));
+                    return;
+                }
+                
+                m_statusPanel->addLogMessage("INFO",
+                    QString("偏差分析完成: 已测量 %1/%2 点，偏差范围 [%3, %4] mm，RMS %5 mm，配准RMS %6 mm，耗时 %7 ms")
+                        .arg(report["measured_count"].toInteger()).arg(report["point_count"].toInteger())
+                        .arg(report["min_deviation"].toDouble(), 0, 'f', 3)
+                        .arg(report["max_deviation"].toDouble(), 0, 'f', 3)
+                        .arg(report["rms_deviation"].toDouble(), 0, 'f', 3)
+                        .arg(report["registration_rms"].toDouble(), 0, 'f', 3)
+                        .arg(report["timing"].toObject()["total_ms"].toInteger()));
+                
+                const QJsonArray regions = report["regions"].toArray();
+                const int shown = std::min<int>(regions.size(), 5);
+                for (int i = 0; i < shown; ++i) {
+                    const QJsonObject region = regions[i].toObject();
+                    const QJsonArray center = region["center"].toArray();
+                    m_statusPanel->addLogMessage("WARNING",
+                        QString("超差区域%1: %2 最大偏差 %3 mm，%4 个点，中心 (%5, %6, %7)，部件 %8")
+                            .arg(i + 1)
+                            .arg(region["excess"].toBool() ? "材料多余" : "材料不足")
+                            .arg(region["max_deviation"].toDouble(), 0, 'f', 3)
+                            .arg(region["point_count"].toInt())
+                            .arg(center[0].toDouble(), 0, 'f', 1)
+                            .arg(center[1].toDouble(), 0, 'f', 1)
+                            .arg(center[2].toDouble(), 0, 'f', 1)
+                            .arg(region["part"].toString()));
+                }
+                
+                if (report["within_tolerance"].toBool()) {
+                    m_statusPanel->addLogMessage("SUCCESS", "工件偏差在公差范围内，可复用已存储的喷涂轨迹");
+                } else {
+                    m_statusPanel->addLogMessage("WARNING",
+                        QString("发现 %1 个超差区域（超差点 %2%），建议重新规划喷涂轨迹")
+                            .arg(regions.size())
+                            .arg(report["out_of_tolerance_ratio"].toDouble() * 100.0, 0, 'f', 2));
                 }
             });
     }
@@ -798,7 +898,11 @@ void MainWindow::OnImportSTEPModel()
         // 同步加载STEP文件
         if (m_modelTreePanel && m_vtkView) {
             m_statusLabel->setText("正在加载STEP模型...");
-            QApplication::processEvents();
+            
+            // 车间模型部件众多，先显示结构树，部件首次可见时再网格化
+            m_modelTreePanel->setRenderer(m_vtkView->getRenderer());
+            m_modelTreePanel->setLazyMeshing(true);
+            m_modelTreePanel->setBatchingEnabled(true);  // 静态部件合批绘制
             
             // 同步加载STEP文件
             bool success = m_modelTreePanel->loadSTEPFile(fileName);
@@ -883,10 +987,11 @@ void MainWindow::OnImportSTEPModelFast()
         // 快速加载STEP文件（使用缓存）
         if (m_modelTreePanel && m_vtkView) {
             m_statusLabel->setText("正在快速加载STEP模型...");
-            QApplication::processEvents();
             
             // 设置renderer，这样加载完成后会自动添加Actor
             m_modelTreePanel->setRenderer(m_vtkView->getRenderer());
+            m_modelTreePanel->setLazyMeshing(false);  // 缓存需要完整网格
+            m_modelTreePanel->setBatchingEnabled(true);
             
             // 快速加载STEP文件
             bool success = m_modelTreePanel->loadSTEPFileFast(fileName);
@@ -894,12 +999,7 @@ void MainWindow::OnImportSTEPModelFast()
             if (success) {
                 qDebug() << "MainWindow: STEP模型快速加载成功";
                 
-                // 对于缓存加载，立即添加Actor
-                // 对于异步加载，会在onLoadFinished中自动添加
-                if (m_modelTreePanel->getTreeWidget()->topLevelItemCount() > 0) {
-                    m_modelTreePanel->addActorsToRenderer(m_vtkView->getRenderer());
-                }
-                qDebug() << "MainWindow: Actor已添加到VTK渲染器";
+                // 缓存加载和异步加载都在后台完成后由模型树自动添加Actor到渲染器
                 
                 // 连接可见性变化信号
                 connect(m_modelTreePanel, &STEPModelTreeWidget::partVisibilityChanged,
@@ -1005,6 +1105,38 @@ void MainWindow::OnVTKSceneReady()
     m_statusLabel->setText("VTK 3D场景已就绪");
 }
 
+void MainWindow::OnAnalyzeDeviation()
+{
+    if (!m_vtkView || !m_modelTreePanel) {
+        return;
+    }
+    
+    if (m_vtkView->IsDeviationAnalysisRunning()) {
+        m_statusLabel->setText("偏差分析正在进行中...");
+        return;
+    }
+    
+    // CAD使用模型树中当前可见的静态部件，分析前可隐藏车间和机器人
+    std::shared_ptr<const Simulation::TriangleBVH> cad = m_modelTreePanel->sceneBVH();
+    if (!cad || cad->isEmpty()) {
+        QMessageBox::warning(this, "偏差分析", "请先导入STEP模型并等待模型加载完成");
+        return;
+    }
+    
+    bool ok = false;
+    const double tolerance = QInputDialog::getDouble(this, "偏差分析", "公差带 ±(mm):",
+                                                     0.5, 0.01, 100.0, 2, &ok);
+    if (!ok) {
+        return;
+    }
+    
+    Simulation::DeviationOptions options;
+    options.tolerance = tolerance;
+    if (!m_vtkView->AnalyzeDeviation(cad, options)) {
+        QMessageBox::warning(this, "偏差分析", "无法开始偏差分析，请确认已导入点云");
+    }
+}
+
 void MainWindow::OnAbout()
 {
     QMessageBox::about(this, "关于",
@@ -1088,17 +1220,15 @@ void MainWindow::loadRobotModel(const QString& modelPath)
     if (m_modelTreePanel && m_vtkView) {
         // 设置renderer，这样加载完成后会自动添加Actor
         m_modelTreePanel->setRenderer(m_vtkView->getRenderer());
+        m_modelTreePanel->setLazyMeshing(false);  // 机器人连杆需要立即驱动
+        m_modelTreePanel->setBatchingEnabled(false);  // 机器人部件少，且连杆需单独变换
         
         bool success = m_modelTreePanel->loadSTEPFileFast(robotModelPath);
         
         if (success) {
-            // 对于缓存加载，立即添加Actor
-            // 对于异步加载，会在onLoadFinished中自动添加
-            if (m_modelTreePanel->getTreeWidget()->topLevelItemCount() > 0) {
-                m_modelTreePanel->addActorsToRenderer(m_vtkView->getRenderer());
-            }
+            // 缓存加载和异步加载都在后台完成后由模型树自动添加Actor到渲染器
             
-    // 设置STEP模型树引用到VTKWidget（用于关节变换）
+            // 设置STEP模型树引用到VTKWidget（用于关节变换）
             m_vtkView->SetSTEPModelTreeWidget(m_modelTreePanel);
             
             // 启用机器人显示/隐藏按钮
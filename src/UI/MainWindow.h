@@ -68,6 +68,7 @@ private slots:
     void OnImportWorkpiece();
     void OnImportSTEPModel();  // 新增：导入STEP模型
     void OnImportSTEPModelFast();  // 新增：快速导入STEP模型（使用缓存）
+    void OnAnalyzeDeviation();  // 扫描点云与CAD偏差分析
     void OnExportTrajectory();
     void OnStartSimulation();
     void OnStopSimulation();
@@ -1,42 +1,38 @@
 #include "STEPLoadWorker.h"
+#include "ShapeTessellator.h"
 
 #include <QDebug>
 #include <QApplication>
+#include <algorithm>
 
 // 注册自定义类型以便在信号中使用
 typedef QMap<QString, vtkSmartPointer<vtkActor>> ActorMap;
 typedef QMap<QString, TopoDS_Shape> ShapeMap;
+typedef QMap<QString, QVector<double>> BoundsMap;
 Q_DECLARE_METATYPE(ActorMap)
 Q_DECLARE_METATYPE(ShapeMap)
-
-// OpenCASCADE STEP读取
-#include <STEPCAFControl_Reader.hxx>
-#include <XCAFApp_Application.hxx>
-#include <XCAFDoc_DocumentTool.hxx>
-#include <XCAFDoc_ShapeTool.hxx>
-#include <TDataStd_Name.hxx>
-#include <TopExp_Explorer.hxx>
-#include <TopoDS.hxx>
-#include <TopoDS_Face.hxx>
-
-// OpenCASCADE到VTK转换
-#include <BRepMesh_IncrementalMesh.hxx>
-#include <BRep_Tool.hxx>
-#include <TopLoc_Location.hxx>
-#include <Poly_Triangulation.hxx>
+Q_DECLARE_METATYPE(BoundsMap)
+Q_DECLARE_METATYPE(vtkSmartPointer<vtkActor>)
 
 // VTK
-#include <vtkPoints.h>
-#include <vtkCellArray.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
-#include <vtkIdList.h>
-#include <vtkAppendPolyData.h>
 
 STEPLoadWorker::STEPLoadWorker(QObject* parent)
     : QObject(parent)
+    , m_lazyMeshing(false)
+{
+    // 进度回调在加载线程中执行，信号以队列方式送达UI线程
+    m_progress = new STEPProgressIndicator([this](int percent, const QString& stage) {
+        emit progressUpdated(percent, 100, stage);
+    });
+}
+
+void STEPLoadWorker::requestCancel()
 {
+    qDebug() << "STEPLoadWorker: 收到取消请求";
+    m_progress->requestCancel();
 }
 
 STEPLoadWorker::~STEPLoadWorker()
@@ -46,80 +42,76 @@ STEPLoadWorker::~STEPLoadWorker()
 
 void STEPLoadWorker::loadSTEPFile(const QString& filePath)
 {
-    qDebug() << "STEPLoadWorker: 开始加载STEP文件:" << filePath;
+    qDebug() << "STEPLoadWorker: 开始加载STEP文件:" << filePath
+             << (m_lazyMeshing ? "(按需网格化)" : "");
+    
+    // 清理上一次加载的结果（Worker在多次加载之间复用）
+    m_actorMap.clear();
+    m_shapeMap.clear();
+    m_boundsMap.clear();
+    m_import.reset();
+    
+    // 重置进度和上一次的取消请求
+    m_progress->Reset();
     
     try {
-        // 创建OCAF文档
-        Handle(XCAFApp_Application) app = XCAFApp_Application::GetApplication();
-        app->NewDocument("MDTV-XCAF", m_occDoc);
-        
-        // 读取STEP文件
-        STEPCAFControl_Reader reader;
-        emit progressUpdated(10, 100, "正在读取STEP文件...");
-        qDebug() << "STEPLoadWorker: 开始读取STEP文件...";
-        
-        IFSelect_ReturnStatus status = reader.ReadFile(filePath.toStdString().c_str());
-        
-        if (status != IFSelect_RetDone) {
-            qCritical() << "STEPLoadWorker: 无法读取STEP文件，状态码=" << status;
-            emit loadFinished(false, "无法读取STEP文件", m_actorMap, m_shapeMap, 0, "");
+        // 总进度划分：导入（读取/转换/解析结构）80%，网格化20%
+        Message_ProgressScope rootScope(m_progress->Start(), "STEP", 100);
+        
+        // 同一文件只读取和转换一次，与其他使用方共享内存中的文档
+        QString errorMessage;
+        m_import = STEPImportEngine::instance()->import(filePath, m_progress, rootScope.Next(80),
+                                                        &errorMessage);
+        if (rootScope.UserBreak()) {
+            emitCanceled();
             return;
         }
-        
-        qDebug() << "STEPLoadWorker: STEP文件读取成功";
-        emit progressUpdated(30, 100, "正在解析STEP数据...");
-        
-        qDebug() << "STEPLoadWorker: 开始转换STEP数据...";
-        
-        // Transfer可能会卡住，但我们无法中断它
-        // 只能让它继续执行，并定期发送进度信号
-        bool transferSuccess = reader.Transfer(m_occDoc);
-        
-        if (!transferSuccess) {
-            qCritical() << "STEPLoadWorker: 无法转换STEP数据";
-            emit loadFinished(false, "无法转换STEP数据", m_actorMap, m_shapeMap, 0, "");
+        if (!m_import) {
+            qCritical() << "STEPLoadWorker: 导入失败:" << errorMessage;
+            emit loadFinished(false, errorMessage, m_actorMap, m_shapeMap, 0, "");
             return;
         }
         
-        qDebug() << "STEPLoadWorker: STEP数据转换成功";
-        emit progressUpdated(50, 100, "正在构建模型树...");
-        
-        // 获取形状工具
-        Handle(XCAFDoc_ShapeTool) shapeTool = 
-            XCAFDoc_DocumentTool::ShapeTool(m_occDoc->Main());
-        
-        // 遍历所有顶层形状
-        TDF_LabelSequence labels;
-        shapeTool->GetFreeShapes(labels);
-        
-        qDebug() << "STEPLoadWorker: 找到" << labels.Length() << "个顶层形状";
-        
-        int totalShapes = labels.Length();
-        int shapeCounter = 0;
+        m_topLevelShapeName = m_import->topLevelName;
+        qDebug() << "STEPLoadWorker: 导入完成，共" << m_import->parts.size() << "个部件";
+        m_progress->setStage(m_lazyMeshing ? "正在构建模型树..." : "正在网格化部件...");
         
-        for (Standard_Integer i = 1; i <= labels.Length(); i++) {
-            TDF_Label label = labels.Value(i);
-            TopoDS_Shape shape = shapeTool->GetShape(label);
+        Message_ProgressScope meshScope(rootScope.Next(20), "Mesh",
+                                        std::max<int>(m_import->parts.size(), 1));
+        for (auto it = m_import->parts.constBegin();
+             it != m_import->parts.constEnd() && !meshScope.UserBreak(); ++it) {
+            const STEPImportPart& part = it.value();
             
-            if (!shape.IsNull()) {
-                // 保存顶层形状的名字
-                Handle(TDataStd_Name) nameAttr;
-                if (label.FindAttribute(TDataStd_Name::GetID(), nameAttr)) {
-                    m_topLevelShapeName = QString::fromUtf8(TCollection_AsciiString(nameAttr->Get()).ToCString());
-                } else {
-                    m_topLevelShapeName = "Model";
+            if (m_lazyMeshing) {
+                // 按需模式：只记录形状和包围盒，网格化推迟到部件首次可见时
+                meshScope.Next();
+                m_shapeMap[part.name] = part.shape;
+                if (!part.bounds.isEmpty()) {
+                    m_boundsMap[part.name] = part.bounds;
                 }
-                
-                processShape(shape, label, shapeCounter);
+                continue;
             }
             
-            // 更新进度条
-            int progress = 50 + (i * 50 / totalShapes);
-            emit progressUpdated(progress, 100, 
-                QString("正在处理形状 %1/%2...").arg(i).arg(totalShapes));
+            // 叶子节点，创建VTK Actor（共享文档中已有的三角剖分会被直接复用）
+            vtkSmartPointer<vtkActor> actor = createActorFromShape(part.shape, meshScope.Next());
+            if (actor) {
+                m_actorMap[part.name] = actor;
+                m_shapeMap[part.name] = part.shape;
+                qDebug() << "STEPLoadWorker: 创建Actor成功:" << part.name;
+            }
+        }
+        
+        if (meshScope.UserBreak()) {
+            emitCanceled();
+            return;
         }
         
+        const int shapeCounter = m_import->shapeCounter;
         qDebug() << "STEPLoadWorker: 模型树构建完成，共" << shapeCounter << "个部件，actorMap大小=" << m_actorMap.size();
+        if (m_lazyMeshing) {
+            emit partBoundsReady(m_boundsMap);
+        }
+        m_progress->setStage("加载完成！");
         emit progressUpdated(100, 100, "加载完成！");
         emit loadFinished(true, QString("STEP模型加载成功 (%1个部件)").arg(shapeCounter),
                          m_actorMap, m_shapeMap, shapeCounter, m_topLevelShapeName);
@@ -133,96 +125,50 @@ void STEPLoadWorker::loadSTEPFile(const QString& filePath)
     }
 }
 
-void STEPLoadWorker::processShape(const TopoDS_Shape& shape, const TDF_Label& label,
-                                   int& shapeCounter)
+void STEPLoadWorker::emitCanceled()
 {
-    // 获取形状名称
-    Handle(TDataStd_Name) nameAttr;
-    QString shapeName;
-    if (label.FindAttribute(TDataStd_Name::GetID(), nameAttr)) {
-        shapeName = QString::fromUtf8(TCollection_AsciiString(nameAttr->Get()).ToCString());
-    } else {
-        shapeName = QString("Part_%1").arg(++shapeCounter);
-    }
-    
-    // 处理子形状
-    Handle(XCAFDoc_ShapeTool) shapeTool = 
-        XCAFDoc_DocumentTool::ShapeTool(m_occDoc->Main());
-    
-    TDF_LabelSequence components;
-    bool hasComponents = shapeTool->GetComponents(label, components) && components.Length() > 0;
-    
-    if (hasComponents) {
-        // 有子组件，递归处理子组件
-        for (Standard_Integer i = 1; i <= components.Length(); i++) {
-            TDF_Label compLabel = components.Value(i);
-            TopoDS_Shape compShape = shapeTool->GetShape(compLabel);
-            if (!compShape.IsNull()) {
-                processShape(compShape, compLabel, shapeCounter);
-            }
-        }
-    } else {
-        // 叶子节点，创建VTK Actor
-        vtkSmartPointer<vtkActor> actor = createActorFromShape(shape);
-        if (actor) {
-            m_actorMap[shapeName] = actor;
-            m_shapeMap[shapeName] = shape;
-            shapeCounter++;  // 递增计数器
-            qDebug() << "STEPLoadWorker: 创建Actor成功:" << shapeName << "计数=" << shapeCounter;
-        }
-    }
+    qDebug() << "STEPLoadWorker: 加载已取消";
+    m_actorMap.clear();
+    m_shapeMap.clear();
+    m_boundsMap.clear();
+    m_import.reset();
+    emit loadFinished(false, "加载已取消", m_actorMap, m_shapeMap, 0, "");
 }
 
-vtkSmartPointer<vtkActor> STEPLoadWorker::createActorFromShape(const TopoDS_Shape& shape)
+void STEPLoadWorker::meshPart(const QString& partName)
 {
-    // 网格化形状 - 使用更粗糙的网格以加快速度
-    BRepMesh_IncrementalMesh mesh(shape, 0.5);
+    vtkSmartPointer<vtkActor> actor;
     
-    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkCellArray> triangles = vtkSmartPointer<vtkCellArray>::New();
+    auto it = m_shapeMap.constFind(partName);
+    if (it == m_shapeMap.constEnd()) {
+        qWarning() << "STEPLoadWorker: 按需网格化找不到部件:" << partName;
+        emit partMeshed(partName, actor);
+        return;
+    }
     
-    // 遍历所有面
-    for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next()) {
-        TopoDS_Face face = TopoDS::Face(exp.Current());
-        TopLoc_Location loc;
-        Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, loc);
-        
-        if (triangulation.IsNull()) continue;
-        
-        gp_Trsf transform = loc.Transformation();
-        Standard_Integer offset = points->GetNumberOfPoints();
-        
-        // 添加顶点
-        Standard_Integer nbNodes = triangulation->NbNodes();
-        for (Standard_Integer i = 1; i <= nbNodes; i++) {
-            gp_Pnt p = triangulation->Node(i).Transformed(transform);
-            points->InsertNextPoint(p.X(), p.Y(), p.Z());
-        }
-        
-        // 添加三角形
-        Standard_Integer nbTriangles = triangulation->NbTriangles();
-        for (Standard_Integer i = 1; i <= nbTriangles; i++) {
-            const Poly_Triangle& tri = triangulation->Triangle(i);
-            Standard_Integer n1, n2, n3;
-            tri.Get(n1, n2, n3);
-            
-            vtkSmartPointer<vtkIdList> idList = vtkSmartPointer<vtkIdList>::New();
-            idList->SetNumberOfIds(3);
-            idList->SetId(0, offset + n1 - 1);
-            idList->SetId(1, offset + n2 - 1);
-            idList->SetId(2, offset + n3 - 1);
-            triangles->InsertNextCell(idList);
+    try {
+        actor = createActorFromShape(it.value());
+        if (actor) {
+            m_actorMap[partName] = actor;
         }
+    } catch (const std::exception& e) {
+        qCritical() << "STEPLoadWorker: 部件网格化异常:" << partName << e.what();
+    } catch (...) {
+        qCritical() << "STEPLoadWorker: 部件网格化未知异常:" << partName;
     }
     
-    if (points->GetNumberOfPoints() == 0) {
+    emit partMeshed(partName, actor);
+}
+
+vtkSmartPointer<vtkActor> STEPLoadWorker::createActorFromShape(const TopoDS_Shape& shape,
+                                                               const Message_ProgressRange& range)
+{
+    // 先生成粗网格以尽快显示，精细网格由UI在后台线程中细化
+    vtkSmartPointer<vtkPolyData> polyData = ShapeTessellator::tessellateCoarse(shape, range);
+    if (!polyData) {
         return nullptr;
     }
     
-    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
-    polyData->SetPoints(points);
-    polyData->SetPolys(triangles);
-    
     vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
     mapper->SetInputData(polyData);
     
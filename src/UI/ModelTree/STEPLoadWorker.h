@@ -3,11 +3,13 @@
 #include <QObject>
 #include <QString>
 #include <QMap>
+#include <QVector>
 #include <vtkSmartPointer.h>
 #include <vtkActor.h>
 #include <TopoDS_Shape.hxx>
-#include <TDocStd_Document.hxx>
-#include <TDF_Label.hxx>
+#include <Message_ProgressRange.hxx>
+#include "../../Data/STEP/STEPProgressIndicator.h"
+#include "../../Data/STEP/STEPImportEngine.h"
 
 /**
  * @brief STEP文件加载工作线程
@@ -26,6 +28,26 @@ public:
      */
     Q_INVOKABLE void loadSTEPFile(const QString& filePath);
 
+    /**
+     * @brief 设置按需网格化模式
+     * @param lazy true时加载阶段只构建结构树和形状映射，不做网格化
+     */
+    void setLazyMeshing(bool lazy) { m_lazyMeshing = lazy; }
+
+    /**
+     * @brief 对单个部件进行网格化（按需网格化模式下由UI线程逐个请求）
+     * @param partName 部件名称
+     */
+    Q_INVOKABLE void meshPart(const QString& partName);
+
+    /**
+     * @brief 请求取消当前加载
+     * 
+     * 线程安全，应从UI线程直接调用（加载线程的事件循环在加载期间被阻塞）。
+     * ReadFile/Transfer/网格化会在下一次进度检查时中止，并以"加载已取消"结束。
+     */
+    void requestCancel();
+
 signals:
     /**
      * @brief 进度更新信号
@@ -49,14 +71,30 @@ signals:
                       QMap<QString, TopoDS_Shape> shapes,
                       int shapeCounter, const QString& topLevelName);
 
+    /**
+     * @brief 部件包围盒信号（按需网格化模式，在loadFinished之前发出）
+     * @param bounds 部件名 -> {xmin, xmax, ymin, ymax, zmin, zmax}
+     */
+    void partBoundsReady(QMap<QString, QVector<double>> bounds);
+
+    /**
+     * @brief 单个部件网格化完成信号
+     * @param partName 部件名称
+     * @param actor 生成的Actor，失败时为空
+     */
+    void partMeshed(const QString& partName, vtkSmartPointer<vtkActor> actor);
+
 private:
-    void processShape(const TopoDS_Shape& shape, const TDF_Label& label,
-                      int& shapeCounter);
-    vtkSmartPointer<vtkActor> createActorFromShape(const TopoDS_Shape& shape);
+    vtkSmartPointer<vtkActor> createActorFromShape(const TopoDS_Shape& shape,
+        const Message_ProgressRange& range = Message_ProgressRange());
+    void emitCanceled();
 
 private:
-    Handle(TDocStd_Document) m_occDoc;
+    STEPImportResultPtr m_import;  // 共享的导入结果（文档、结构和叶子形状）
     QMap<QString, vtkSmartPointer<vtkActor>> m_actorMap;
     QMap<QString, TopoDS_Shape> m_shapeMap;
+    QMap<QString, QVector<double>> m_boundsMap;   // 按需模式下的部件包围盒
     QString m_topLevelShapeName;  // 顶层形状的名字
+    bool m_lazyMeshing;           // 是否按需网格化
+    Handle(STEPProgressIndicator) m_progress;  // OCCT进度指示器（支持取消）
 };
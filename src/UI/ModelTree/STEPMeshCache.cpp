@@ -0,0 +1,138 @@
+#include "STEPMeshCache.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QRegularExpression>
+
+#include <vtkXMLPolyDataWriter.h>
+#include <vtkXMLPolyDataReader.h>
+
+QString STEPMeshCache::defaultCacheDir()
+{
+    // 获取项目根目录（向上3级：Debug -> bin -> build -> 项目根）
+    QDir appDir(QCoreApplication::applicationDirPath());
+    appDir.cdUp();  // bin
+    appDir.cdUp();  // build
+    appDir.cdUp();  // 项目根
+    
+    return appDir.absolutePath() + "/data/cache";
+}
+
+QString STEPMeshCache::cachePathFor(const QString& stepFilePath, const QString& cacheDir)
+{
+    QFileInfo fileInfo(stepFilePath);
+    QString baseName = fileInfo.completeBaseName();
+    
+    // 使用文件修改时间生成hash，确保文件更新后缓存失效
+    QDateTime modTime = fileInfo.lastModified();
+    QString timeStr = modTime.toString(Qt::ISODate);
+    QByteArray hash = QCryptographicHash::hash(timeStr.toUtf8(), QCryptographicHash::Md5);
+    QString hashStr = hash.toHex().left(8);
+    
+    QString dirPath = cacheDir.isEmpty() ? defaultCacheDir() : cacheDir;
+    
+    // 确保缓存目录存在
+    QDir dir;
+    if (!dir.exists(dirPath)) {
+        dir.mkpath(dirPath);
+        qDebug() << "STEPMeshCache: 创建缓存目录:" << dirPath;
+    }
+    
+    return QString("%1/%2_%3.vtp").arg(dirPath, baseName, hashStr);
+}
+
+QString STEPMeshCache::treeJsonPath(const QString& cachePath)
+{
+    QString jsonPath = cachePath;
+    jsonPath.replace(".vtp", ".json");
+    return jsonPath;
+}
+
+QString STEPMeshCache::partCachePath(const QString& cachePath, const QString& partName)
+{
+    static const QRegularExpression unsafeChars("[^a-zA-Z0-9_-]");
+    
+    QFileInfo cacheInfo(cachePath);
+    QString safePartName = partName;
+    safePartName.replace(unsafeChars, "_");
+    return QString("%1/%2_%3.vtp").arg(cacheInfo.absolutePath(), cacheInfo.completeBaseName(), safePartName);
+}
+
+bool STEPMeshCache::isValid(const QString& cachePath, const QString& stepFilePath)
+{
+    QFileInfo jsonInfo(treeJsonPath(cachePath));
+    if (!jsonInfo.exists()) {
+        return false;
+    }
+    
+    // 检查缓存是否比STEP文件新
+    return jsonInfo.lastModified() >= QFileInfo(stepFilePath).lastModified();
+}
+
+bool STEPMeshCache::writePart(const QString& partPath, vtkPolyData* polyData)
+{
+    if (!polyData) {
+        return false;
+    }
+    
+    vtkSmartPointer<vtkXMLPolyDataWriter> writer = vtkSmartPointer<vtkXMLPolyDataWriter>::New();
+    writer->SetFileName(partPath.toStdString().c_str());
+    writer->SetInputData(polyData);
+    writer->SetDataModeToBinary();
+    writer->SetCompressorTypeToNone();
+    return writer->Write() != 0;
+}
+
+vtkSmartPointer<vtkPolyData> STEPMeshCache::readPart(const QString& partPath)
+{
+    if (!QFileInfo::exists(partPath)) {
+        return nullptr;
+    }
+    
+    vtkSmartPointer<vtkXMLPolyDataReader> reader = vtkSmartPointer<vtkXMLPolyDataReader>::New();
+    reader->SetFileName(partPath.toStdString().c_str());
+    reader->Update();
+    
+    vtkPolyData* polyData = reader->GetOutput();
+    if (!polyData || polyData->GetNumberOfPoints() == 0) {
+        return nullptr;
+    }
+    return polyData;
+}
+
+QJsonObject STEPMeshCache::makeTreeNode(const QString& name, const QString& partName, bool checked,
+                                        const QJsonArray& children)
+{
+    QJsonObject obj;
+    obj["name"] = name;
+    obj["checked"] = checked;
+    obj["partName"] = partName;
+    if (!children.isEmpty()) {
+        obj["children"] = children;
+    }
+    return obj;
+}
+
+bool STEPMeshCache::writeTree(const QString& jsonPath, const QJsonArray& tree, int shapeCounter)
+{
+    QJsonObject root;
+    root["version"] = "1.0";
+    root["shapeCounter"] = shapeCounter;
+    root["tree"] = tree;
+    
+    QFile file(jsonPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "STEPMeshCache: 无法创建JSON文件:" << jsonPath;
+        return false;
+    }
+    
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.close();
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @brief STEP网格缓存文件格式
+ * 
+ * 缓存由一个树结构JSON和每个部件一个VTP文件组成：
+ * - <cacheDir>/<文件名>_<修改时间hash>.json   树结构
+ * - <cacheDir>/<文件名>_<修改时间hash>_<部件名>.vtp   部件网格
+ * 
+ * STEPModelTreeWidget的快速加载和命令行预编译工具共用此格式。
+ */
+class STEPMeshCache {
+public:
+    /**
+     * @brief 默认缓存目录（项目根目录下的 data/cache）
+     */
+    static QString defaultCacheDir();
+
+    /**
+     * @brief 计算STEP文件对应的缓存路径（.vtp后缀，用作其他缓存文件的基准）
+     * @param stepFilePath STEP文件路径
+     * @param cacheDir 缓存目录，为空时使用默认目录
+     */
+    static QString cachePathFor(const QString& stepFilePath, const QString& cacheDir = QString());
+
+    /**
+     * @brief 树结构JSON路径
+     */
+    static QString treeJsonPath(const QString& cachePath);
+
+    /**
+     * @brief 单个部件的VTP路径（部件名中的特殊字符替换为下划线）
+     */
+    static QString partCachePath(const QString& cachePath, const QString& partName);
+
+    /**
+     * @brief 缓存是否存在且比STEP文件新
+     */
+    static bool isValid(const QString& cachePath, const QString& stepFilePath);
+
+    /**
+     * @brief 写入/读取部件网格
+     */
+    static bool writePart(const QString& partPath, vtkPolyData* polyData);
+    static vtkSmartPointer<vtkPolyData> readPart(const QString& partPath);
+
+    /**
+     * @brief 构建树节点JSON
+     */
+    static QJsonObject makeTreeNode(const QString& name, const QString& partName, bool checked,
+                                    const QJsonArray& children = QJsonArray());
+
+    /**
+     * @brief 写入树结构JSON
+     * @param jsonPath JSON路径
+     * @param tree 顶层节点数组
+     * @param shapeCounter 形状计数
+     */
+    static bool writeTree(const QString& jsonPath, const QJsonArray& tree, int shapeCounter);
+};
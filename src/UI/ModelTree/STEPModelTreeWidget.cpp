@@ -1,5 +1,7 @@
 #include "STEPModelTreeWidget.h"
 #include "STEPLoadWorker.h"
+#include "ShapeTessellator.h"
+#include "STEPMeshCache.h"
 
 #include <QApplication>
 #include <QCoreApplication>
@@ -8,29 +10,40 @@
 #include <QDebug>
 #include <QFileInfo>
 #include <QDir>
-#include <QCryptographicHash>
 #include <QDateTime>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QFile>
-#include <QRegularExpression>
 #include <QTimer>
 #include <QProgressDialog>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QPointer>
+#include <QMetaMethod>
+#include <algorithm>
+#include <cmath>
 
 // 注册自定义类型以便在信号中使用
 typedef QMap<QString, vtkSmartPointer<vtkActor>> ActorMap;
 typedef QMap<QString, TopoDS_Shape> ShapeMap;
+typedef QMap<QString, QVector<double>> BoundsMap;
 Q_DECLARE_METATYPE(ActorMap)
 Q_DECLARE_METATYPE(ShapeMap)
+Q_DECLARE_METATYPE(BoundsMap)
+Q_DECLARE_METATYPE(vtkSmartPointer<vtkActor>)
 
 // VTK includes (需要完整定义)
 #include <vtkRenderer.h>
 #include <vtkRenderWindow.h>
+#include <vtkCamera.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkCellPicker.h>
 
-// VTK XML读写
-#include <vtkXMLPolyDataWriter.h>
-#include <vtkXMLPolyDataReader.h>
+// VTK
 #include <vtkAppendPolyData.h>
 
 // OpenCASCADE STEP读取
@@ -46,19 +59,40 @@ Q_DECLARE_METATYPE(ShapeMap)
 #include <TopoDS.hxx>
 #include <TopoDS_Face.hxx>
 
-// OpenCASCADE到VTK转换
-#include <BRepMesh_IncrementalMesh.hxx>
-#include <BRep_Tool.hxx>
-#include <TopLoc_Location.hxx>
-#include <Poly_Triangulation.hxx>
-
 // VTK
-#include <vtkPoints.h>
-#include <vtkCellArray.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkProperty.h>
-#include <vtkIdList.h>
+
+namespace {
+
+/**
+ * @brief 判断包围盒是否与相机视锥相交
+ * @param planes vtkCamera::GetFrustumPlanes 返回的6个平面 (A,B,C,D)，法向朝内
+ * @param b 包围盒 {xmin, xmax, ymin, ymax, zmin, zmax}
+ */
+bool boundsIntersectFrustum(const double planes[24], const QVector<double>& b)
+{
+    for (int i = 0; i < 6; ++i) {
+        const double* p = planes + 4 * i;
+        // 取沿平面法向最远的角点，若仍在平面外侧则整个包围盒在视锥外
+        double x = p[0] >= 0 ? b[1] : b[0];
+        double y = p[1] >= 0 ? b[3] : b[2];
+        double z = p[2] >= 0 ? b[5] : b[4];
+        if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double boundsDiagonal(const QVector<double>& b)
+{
+    double dx = b[1] - b[0], dy = b[3] - b[2], dz = b[5] - b[4];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+} // namespace
 
 STEPModelTreeWidget::STEPModelTreeWidget(QWidget* parent)
     : QWidget(parent)
@@ -73,10 +107,42 @@ STEPModelTreeWidget::STEPModelTreeWidget(QWidget* parent)
     , m_loadWorker(nullptr)
     , m_progressDialog(nullptr)
     , m_renderer(nullptr)
+    , m_lazyMeshing(false)
+    , m_refinePool(new QThreadPool(this))
+    , m_meshGeneration(0)
+    , m_loadCanceled(false)
+    , m_batching(false)
+    , m_batchRenderer(nullptr)
+    , m_batchRebuildTimer(new QTimer(this))
+    , m_bvhRebuildTimer(new QTimer(this))
+    , m_bvhRequest(0)
+    , m_bvhBuildInFlight(false)
 {
+    // 保留一个核心给UI线程和加载线程
+    m_refinePool->setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+    
+    // 网格细化/按需网格化会连续更新部件，合并为一次增量合批更新，只重新合并受影响的合批
+    m_batchRebuildTimer->setSingleShot(true);
+    m_batchRebuildTimer->setInterval(300);
+    connect(m_batchRebuildTimer, &QTimer::timeout, this, [this]() {
+        const QSet<QString> parts = m_dirtyBatchParts;
+        m_dirtyBatchParts.clear();
+        updateBatches(parts);
+        if (m_batchRenderer) {
+            requestRender(m_batchRenderer->GetRenderWindow());
+        }
+    });
+    
+    // 拾取BVH同样延迟重建，网格化/细化队列空闲后才构建，连续变化期间只在最后构建一次
+    m_bvhRebuildTimer->setSingleShot(true);
+    m_bvhRebuildTimer->setInterval(500);
+    connect(m_bvhRebuildTimer, &QTimer::timeout, this, &STEPModelTreeWidget::rebuildSceneBVH);
+    
     // 注册自定义类型
     qRegisterMetaType<QMap<QString, vtkSmartPointer<vtkActor>>>("QMap<QString, vtkSmartPointer<vtkActor>>");
     qRegisterMetaType<QMap<QString, TopoDS_Shape>>("QMap<QString, TopoDS_Shape>");
+    qRegisterMetaType<QMap<QString, QVector<double>>>("QMap<QString, QVector<double>>");
+    qRegisterMetaType<vtkSmartPointer<vtkActor>>("vtkSmartPointer<vtkActor>");
     
     setupUI();
     setupContextMenu();
@@ -86,14 +152,21 @@ STEPModelTreeWidget::~STEPModelTreeWidget()
 {
     qDebug() << "STEPModelTreeWidget: 析构";
     
-    // 清理进度对话框
+    // 等待后台细化任务结束
+    m_refinePool->clear();
+    m_refinePool->waitForDone();
+    
+    // 清理进度对话框（close会发出canceled，这里只隐藏）
     if (m_progressDialog) {
-        m_progressDialog->close();
+        m_progressDialog->hide();
         delete m_progressDialog;
         m_progressDialog = nullptr;
     }
     
-    // 清理加载线程
+    // 清理加载线程（先中止正在进行的加载，否则wait会一直阻塞）
+    if (m_loadWorker) {
+        m_loadWorker->requestCancel();
+    }
     if (m_loadThread) {
         m_loadThread->quit();
         m_loadThread->wait();
@@ -165,13 +238,22 @@ bool STEPModelTreeWidget::loadSTEPFile(const QString& filePath)
         m_progressDialog->setRange(0, 100);
         m_progressDialog->setAutoClose(true);
         m_progressDialog->setAutoReset(true);
-        m_progressDialog->setCancelButton(nullptr);
+        m_progressDialog->setCancelButtonText("取消");
+        
+        // 加载线程在OCCT调用中阻塞，取消请求需直接调用Worker（线程安全）
+        connect(m_progressDialog, &QProgressDialog::canceled, this, [this]() {
+            if (m_loadWorker) {
+                m_loadCanceled = true;
+                m_loadWorker->requestCancel();
+                m_progressDialog->setLabelText("正在取消...");
+            }
+        });
     }
+    m_loadCanceled = false;
     
     m_progressDialog->setLabelText("正在读取STEP文件...");
     m_progressDialog->setValue(0);
     m_progressDialog->show();
-    QApplication::processEvents();
     
     clearScene();
     
@@ -188,10 +270,20 @@ bool STEPModelTreeWidget::loadSTEPFile(const QString& filePath)
         connect(m_loadWorker, &STEPLoadWorker::loadFinished,
                 this, &STEPModelTreeWidget::onLoadFinished,
                 Qt::QueuedConnection);
+        connect(m_loadWorker, &STEPLoadWorker::partBoundsReady,
+                this, &STEPModelTreeWidget::onPartBoundsReady,
+                Qt::QueuedConnection);
+        connect(m_loadWorker, &STEPLoadWorker::partMeshed,
+                this, &STEPModelTreeWidget::onPartMeshed,
+                Qt::QueuedConnection);
         connect(m_loadThread, &QThread::finished,
                 m_loadWorker, &QObject::deleteLater);
     }
     
+    // Worker在启动加载前还未开始处理队列中的调用，此处设置不会与加载并发
+    m_loadWorker->setLazyMeshing(m_lazyMeshing);
+    m_currentFilePath = filePath;
+    
     // 启动加载
     QMetaObject::invokeMethod(m_loadWorker, "loadSTEPFile", Qt::QueuedConnection,
                              Q_ARG(QString, filePath));
@@ -252,56 +344,12 @@ void STEPModelTreeWidget::processShape(const TopoDS_Shape& shape,
 
 vtkSmartPointer<vtkActor> STEPModelTreeWidget::createActorFromShape(const TopoDS_Shape& shape)
 {
-    // 网格化形状 - 使用更粗糙的网格以加快速度
-    // 参数0.1是偏差值，值越大网格越粗糙，加载越快
-    BRepMesh_IncrementalMesh mesh(shape, 0.1);
-    
-    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkCellArray> triangles = vtkSmartPointer<vtkCellArray>::New();
-    
-    // 遍历所有面
-    for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next()) {
-        TopoDS_Face face = TopoDS::Face(exp.Current());
-        TopLoc_Location loc;
-        Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, loc);
-        
-        if (triangulation.IsNull()) continue;
-        
-        gp_Trsf transform = loc.Transformation();
-        Standard_Integer offset = points->GetNumberOfPoints();
-        
-        // 添加顶点 - OCC 7.7 API
-        Standard_Integer nbNodes = triangulation->NbNodes();
-        for (Standard_Integer i = 1; i <= nbNodes; i++) {
-            gp_Pnt p = triangulation->Node(i).Transformed(transform);
-            points->InsertNextPoint(p.X(), p.Y(), p.Z());
-        }
-        
-        // 添加三角形 - OCC 7.7 API
-        Standard_Integer nbTriangles = triangulation->NbTriangles();
-        for (Standard_Integer i = 1; i <= nbTriangles; i++) {
-            const Poly_Triangle& tri = triangulation->Triangle(i);
-            Standard_Integer n1, n2, n3;
-            tri.Get(n1, n2, n3);
-            
-            // 使用vtkIdList
-            vtkSmartPointer<vtkIdList> idList = vtkSmartPointer<vtkIdList>::New();
-            idList->SetNumberOfIds(3);
-            idList->SetId(0, offset + n1 - 1);
-            idList->SetId(1, offset + n2 - 1);
-            idList->SetId(2, offset + n3 - 1);
-            triangles->InsertNextCell(idList);
-        }
-    }
-    
-    if (points->GetNumberOfPoints() == 0) {
+    // 先生成粗网格，随后由scheduleRefinement在后台细化
+    vtkSmartPointer<vtkPolyData> polyData = ShapeTessellator::tessellateCoarse(shape);
+    if (!polyData) {
         return nullptr;
     }
     
-    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
-    polyData->SetPoints(points);
-    polyData->SetPolys(triangles);
-    
     vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
     mapper->SetInputData(polyData);
     
@@ -329,6 +377,7 @@ void STEPModelTreeWidget::onItemClicked(QTreeWidgetItem* item, int column)
         
         // 高亮选中部件及其所有子部件（橙色）
         highlightItemRecursive(item);
+        m_batcher.updatePartColors(m_actorMap);
         
         // 发送信号刷新渲染（只发送一次，不在循环中）
         emit partVisibilityChanged(partName, true);
@@ -346,7 +395,9 @@ void STEPModelTreeWidget::onItemChanged(QTreeWidgetItem* item, int column)
         
         // 设置当前节点的可见性
         if (m_actorMap.contains(partName)) {
-            m_actorMap[partName]->SetVisibility(visible);
+            setActorVisibility(partName, visible);
+        } else {
+            setUnmeshedPartVisibility(partName, visible);
         }
         
         // 阻止信号递归
@@ -373,8 +424,10 @@ void STEPModelTreeWidget::setItemVisibilityRecursive(QTreeWidgetItem* item, bool
     // 设置当前节点的可见性
     QString partName = item->data(0, Qt::UserRole).toString();
     if (m_actorMap.contains(partName)) {
-        m_actorMap[partName]->SetVisibility(visible);
+        setActorVisibility(partName, visible);
         qDebug() << "STEPModelTreeWidget: 设置部件可见性:" << partName << visible;
+    } else {
+        setUnmeshedPartVisibility(partName, visible);
     }
     
     // 递归设置所有子节点
@@ -412,14 +465,41 @@ void STEPModelTreeWidget::onContextMenuRequested(const QPoint& pos)
 
 void STEPModelTreeWidget::clearScene()
 {
+    // 合批Actor只由本控件持有，清空前从渲染器移除
+    m_batchRebuildTimer->stop();
+    m_dirtyBatchParts.clear();
+    if (m_batchRenderer) {
+        for (const auto& actor : m_batcher.batchActors()) {
+            m_batchRenderer->RemoveActor(actor);
+        }
+    }
+    m_batcher.clear();
+    m_dynamicParts.clear();
+    
+    // 构建中的BVH完成时会因请求编号不匹配被丢弃
+    m_bvhRebuildTimer->stop();
+    ++m_bvhRequest;
+    m_sceneBVH.reset();
+    m_bvhPartMeshes.clear();
+    
     m_actorMap.clear();
     m_shapeMap.clear();
+    m_partBounds.clear();
+    m_pendingMeshParts.clear();
+    m_meshInFlight.clear();  // 在途的网格化结果到达时会被丢弃
+    m_lazyHiddenParts.clear();
+    
+    // 丢弃尚未开始的细化任务，已在执行的任务结果会因代数不匹配被忽略
+    m_refinePool->clear();
+    m_refiningParts.clear();
+    ++m_meshGeneration;
     m_treeWidget->clear();
     m_shapeCounter = 0;
     
     if (!m_occDoc.IsNull()) {
         m_occDoc.Nullify();
     }
+    m_import.reset();
     
     qDebug() << "STEPModelTreeWidget: 场景已清空";
 }
@@ -431,6 +511,12 @@ void STEPModelTreeWidget::addActorsToRenderer(vtkRenderer* renderer)
         return;
     }
     
+    if (m_batching) {
+        m_batchRenderer = renderer;
+        rebuildBatches();
+        return;
+    }
+    
     for (auto it = m_actorMap.begin(); it != m_actorMap.end(); ++it) {
         renderer->AddActor(it.value());
     }
@@ -454,6 +540,9 @@ void STEPModelTreeWidget::removeActorsFromRenderer(vtkRenderer* renderer)
     for (auto it = m_actorMap.begin(); it != m_actorMap.end(); ++it) {
         renderer->RemoveActor(it.value());
     }
+    for (const auto& actor : m_batcher.batchActors()) {
+        renderer->RemoveActor(actor);
+    }
     
     qDebug() << "STEPModelTreeWidget: 从渲染器移除了" << m_actorMap.size() << "个Actor";
 }
@@ -473,6 +562,8 @@ void STEPModelTreeWidget::applyTransformToAllActors(vtkTransform* transform)
             actor->SetUserTransform((vtkLinearTransform*)transform);
         }
     }
+    m_batcher.setUserTransform(transform);
+    scheduleBVHRebuild();
     
     qDebug() << "STEPModelTreeWidget: 应用变换到" << m_actorMap.size() << "个Actor";
 }
@@ -484,29 +575,49 @@ void STEPModelTreeWidget::applyTransformToActor(const QString& partName, vtkTran
         return;
     }
     
-    if (!m_actorMap.contains(partName)) {
+    vtkActor* actor = resolveDynamicActor(partName);
+    if (!actor) {
         qWarning() << "STEPModelTreeWidget: 找不到部件:" << partName;
         return;
     }
     
-    vtkActor* actor = m_actorMap[partName];
-    if (actor) {
-        // 使用C风格强制转换
-        actor->SetUserTransform((vtkLinearTransform*)transform);
-        qDebug() << "STEPModelTreeWidget: 应用变换到部件:" << partName;
+    // 使用C风格强制转换
+    actor->SetUserTransform((vtkLinearTransform*)transform);
+    qDebug() << "STEPModelTreeWidget: 应用变换到部件:" << partName;
+}
+
+vtkActor* STEPModelTreeWidget::resolveDynamicActor(const QString& partName)
+{
+    auto it = m_actorMap.constFind(partName);
+    if (it == m_actorMap.constEnd() || !it.value()) {
+        return nullptr;
+    }
+    
+    // 单独运动的部件不能留在合批网格和拾取BVH中
+    if (!m_dynamicParts.contains(partName)) {
+        m_dynamicParts.insert(partName);
+        scheduleBVHRebuild();
+        if (m_batching && m_batcher.contains(partName)) {
+            qDebug() << "STEPModelTreeWidget: 部件需要单独变换，移出合批:" << partName;
+            updateBatches({partName});
+        }
     }
+    return it.value();
 }
 
 void STEPModelTreeWidget::setPartVisibility(const QString& partName, bool visible)
 {
     if (!m_actorMap.contains(partName)) {
+        if (m_lazyMeshing && m_shapeMap.contains(partName)) {
+            setUnmeshedPartVisibility(partName, visible);
+            return;
+        }
         qWarning() << "STEPModelTreeWidget: 找不到部件:" << partName;
         return;
     }
     
-    vtkActor* actor = m_actorMap[partName];
-    if (actor) {
-        actor->SetVisibility(visible);
+    if (m_actorMap[partName]) {
+        setActorVisibility(partName, visible);
         qDebug() << "STEPModelTreeWidget: 设置部件可见性:" << partName << visible;
     }
 }
@@ -515,32 +626,7 @@ void STEPModelTreeWidget::setPartVisibility(const QString& partName, bool visibl
 
 QString STEPModelTreeWidget::getCachePath(const QString& stepFilePath)
 {
-    QFileInfo fileInfo(stepFilePath);
-    QString baseName = fileInfo.completeBaseName();
-    
-    // 使用文件修改时间生成hash，确保文件更新后缓存失效
-    QDateTime modTime = fileInfo.lastModified();
-    QString timeStr = modTime.toString(Qt::ISODate);
-    QByteArray hash = QCryptographicHash::hash(timeStr.toUtf8(), QCryptographicHash::Md5);
-    QString hashStr = hash.toHex().left(8);
-    
-    // 获取项目根目录（向上3级：Debug -> bin -> build -> 项目根）
-    QDir appDir(QCoreApplication::applicationDirPath());
-    appDir.cdUp();  // bin
-    appDir.cdUp();  // build
-    appDir.cdUp();  // 项目根
-    
-    QString projectRoot = appDir.absolutePath();
-    QString cacheDir = projectRoot + "/data/cache";
-    
-    // 确保缓存目录存在
-    QDir dir;
-    if (!dir.exists(cacheDir)) {
-        dir.mkpath(cacheDir);
-        qDebug() << "STEPModelTreeWidget: 创建缓存目录:" << cacheDir;
-    }
-    
-    QString cachePath = QString("%1/%2_%3.vtp").arg(cacheDir, baseName, hashStr);
+    QString cachePath = STEPMeshCache::cachePathFor(stepFilePath);
     qDebug() << "STEPModelTreeWidget: 缓存路径:" << cachePath;
     
     return cachePath;
@@ -548,20 +634,8 @@ QString STEPModelTreeWidget::getCachePath(const QString& stepFilePath)
 
 bool STEPModelTreeWidget::isCacheValid(const QString& cachePath, const QString& stepFilePath)
 {
-    // 检查JSON文件是否存在（树结构）
-    QString jsonPath = cachePath;
-    jsonPath.replace(".vtp", ".json");
-    QFileInfo jsonInfo(jsonPath);
-    
-    if (!jsonInfo.exists()) {
-        qDebug() << "STEPModelTreeWidget: JSON缓存文件不存在:" << jsonPath;
-        return false;
-    }
-    
-    // 检查缓存是否比STEP文件新
-    QFileInfo stepInfo(stepFilePath);
-    if (jsonInfo.lastModified() < stepInfo.lastModified()) {
-        qDebug() << "STEPModelTreeWidget: 缓存过期（STEP文件更新）";
+    if (!STEPMeshCache::isValid(cachePath, stepFilePath)) {
+        qDebug() << "STEPModelTreeWidget: 缓存不存在或已过期:" << STEPMeshCache::treeJsonPath(cachePath);
         return false;
     }
     
@@ -573,69 +647,63 @@ bool STEPModelTreeWidget::saveToCache(const QString& cachePath)
 {
     try {
         qDebug() << "STEPModelTreeWidget: 开始保存缓存到:" << cachePath;
-        m_statusLabel->setText("正在保存缓存...");
-        QApplication::processEvents();
         
         if (m_actorMap.isEmpty()) {
             qWarning() << "STEPModelTreeWidget: 没有可保存的数据";
             return false;
         }
         
-        // 1. 保存树结构到JSON文件
-        QString jsonPath = cachePath;
-        jsonPath.replace(".vtp", ".json");
-        if (!saveTreeStructure(jsonPath)) {
-            qWarning() << "STEPModelTreeWidget: 树结构保存失败";
-            // 继续保存VTP，即使JSON失败
+        // 在UI线程中生成树结构和网格快照（浅拷贝），磁盘写入放到后台线程
+        QJsonArray tree;
+        for (int i = 0; i < m_treeWidget->topLevelItemCount(); ++i) {
+            tree.append(treeItemToJson(m_treeWidget->topLevelItem(i)));
         }
         
-        // 2. 为每个部件保存独立的VTP文件
-        QString cacheDir = QFileInfo(cachePath).absolutePath();
-        QString baseName = QFileInfo(cachePath).completeBaseName();
-        
-        int savedCount = 0;
-        for (auto it = m_actorMap.begin(); it != m_actorMap.end(); ++it) {
-            QString partName = it.key();
-            vtkActor* actor = it.value();
-            
-            vtkPolyDataMapper* mapper = vtkPolyDataMapper::SafeDownCast(actor->GetMapper());
+        QMap<QString, vtkSmartPointer<vtkPolyData>> meshes;
+        for (auto it = m_actorMap.constBegin(); it != m_actorMap.constEnd(); ++it) {
+            vtkPolyDataMapper* mapper = vtkPolyDataMapper::SafeDownCast(it.value()->GetMapper());
             if (!mapper || !mapper->GetInput()) {
                 continue;
             }
-            
-            // 为每个部件创建独立的VTP文件
-            // 使用安全的文件名（移除特殊字符）
-            QString safePartName = partName;
-            safePartName.replace(QRegularExpression("[^a-zA-Z0-9_-]"), "_");
-            QString partCachePath = QString("%1/%2_%3.vtp").arg(cacheDir, baseName, safePartName);
-            
-            vtkSmartPointer<vtkXMLPolyDataWriter> writer = 
-                vtkSmartPointer<vtkXMLPolyDataWriter>::New();
-            writer->SetFileName(partCachePath.toStdString().c_str());
-            writer->SetInputData(mapper->GetInput());
-            writer->SetDataModeToBinary();
-            writer->SetCompressorTypeToNone();
-            
-            if (writer->Write()) {
-                savedCount++;
-            } else {
-                qWarning() << "STEPModelTreeWidget: 部件保存失败:" << partName;
-            }
-            
-            // 定期更新UI
-            if (savedCount % 10 == 0) {
-                m_statusLabel->setText(QString("正在保存缓存... (%1/%2)").arg(savedCount).arg(m_actorMap.size()));
-                QApplication::processEvents();
-            }
+            vtkSmartPointer<vtkPolyData> snapshot = vtkSmartPointer<vtkPolyData>::New();
+            snapshot->ShallowCopy(mapper->GetInput());
+            meshes[it.key()] = snapshot;
         }
         
-        if (savedCount == 0) {
-            qCritical() << "STEPModelTreeWidget: 没有部件保存成功";
-            return false;
-        }
+        const int shapeCounter = m_shapeCounter;
+        QPointer<STEPModelTreeWidget> guard(this);
+        m_statusLabel->setText(QString("正在后台保存缓存 (%1个部件)...").arg(meshes.size()));
         
-        qDebug() << "STEPModelTreeWidget: 缓存保存成功，保存了" << savedCount << "个部件";
-        m_statusLabel->setText(QString("缓存保存成功 (%1个部件)").arg(savedCount));
+        m_refinePool->start(QRunnable::create([guard, cachePath, tree, meshes, shapeCounter]() {
+            int savedCount = 0;
+            for (auto it = meshes.constBegin(); it != meshes.constEnd(); ++it) {
+                // 为每个部件创建独立的VTP文件
+                if (STEPMeshCache::writePart(STEPMeshCache::partCachePath(cachePath, it.key()), it.value())) {
+                    savedCount++;
+                } else {
+                    qWarning() << "STEPModelTreeWidget: 部件保存失败:" << it.key();
+                }
+            }
+            
+            // 树结构最后写入，JSON存在即表示缓存完整
+            bool treeSaved = savedCount > 0 &&
+                STEPMeshCache::writeTree(STEPMeshCache::treeJsonPath(cachePath), tree, shapeCounter);
+            
+            if (guard) {
+                QMetaObject::invokeMethod(guard.data(), [guard, savedCount, treeSaved]() {
+                    if (!guard) {
+                        return;
+                    }
+                    if (treeSaved) {
+                        qDebug() << "STEPModelTreeWidget: 缓存保存成功，保存了" << savedCount << "个部件";
+                        guard->m_statusLabel->setText(QString("缓存保存成功 (%1个部件)").arg(savedCount));
+                    } else {
+                        qCritical() << "STEPModelTreeWidget: 缓存保存失败";
+                        guard->m_statusLabel->setText("缓存保存失败");
+                    }
+                }, Qt::QueuedConnection);
+            }
+        }), 2);  // 优先于网格细化任务
         
         return true;
         
@@ -655,110 +723,77 @@ bool STEPModelTreeWidget::loadFromCache(const QString& cachePath)
     try {
         qDebug() << "STEPModelTreeWidget: 从缓存加载:" << cachePath;
         m_statusLabel->setText("正在从缓存加载...");
-        QApplication::processEvents();
         
-        // 1. 加载树结构
-        QString jsonPath = cachePath;
-        jsonPath.replace(".vtp", ".json");
+        // 1. 加载树结构（数据量小，直接在UI线程中完成）
+        QString jsonPath = STEPMeshCache::treeJsonPath(cachePath);
         qDebug() << "STEPModelTreeWidget: JSON路径:" << jsonPath;
         bool treeLoaded = loadTreeStructure(jsonPath);
         
         if (!treeLoaded) {
             qWarning() << "STEPModelTreeWidget: 树结构加载失败";
+            m_treeWidget->clear();
             return false;
         }
         
         qDebug() << "STEPModelTreeWidget: 树结构加载成功";
         
-        // 2. 为每个部件加载独立的VTP文件
-        QString cacheDir = QFileInfo(cachePath).absolutePath();
-        QString baseName = QFileInfo(cachePath).completeBaseName();
+        // 2. 收集叶子节点（没有子节点的节点）对应的部件
+        QStringList partNames;
+        QTreeWidgetItemIterator it(m_treeWidget);
+        while (*it) {
+            QString partName = (*it)->data(0, Qt::UserRole).toString();
+            if (!partName.isEmpty() && (*it)->childCount() == 0) {
+                partNames.append(partName);
+            }
+            ++it;
+        }
         
-        qDebug() << "STEPModelTreeWidget: 缓存目录:" << cacheDir;
-        qDebug() << "STEPModelTreeWidget: 基础名称:" << baseName;
+        if (partNames.isEmpty()) {
+            qWarning() << "STEPModelTreeWidget: 缓存中没有部件";
+            m_treeWidget->clear();
+            return false;
+        }
         
-        int loadedCount = 0;
-        int totalParts = 0;
+        // 3. 在后台线程中读取部件VTP文件，进度和结果通过队列调用送回UI线程
+        const int generation = m_meshGeneration;
+        QPointer<STEPModelTreeWidget> guard(this);
         
-        // 遍历树，找到所有叶子节点
-        QTreeWidgetItemIterator it(m_treeWidget);
-        while (*it) {
-            QTreeWidgetItem* item = *it;
-            QString partName = item->data(0, Qt::UserRole).toString();
+        m_refinePool->start(QRunnable::create([guard, cachePath, partNames, generation]() {
+            QMap<QString, vtkSmartPointer<vtkPolyData>> parts;
+            const int total = partNames.size();
             
-            // 只处理叶子节点（没有子节点的节点）
-            if (!partName.isEmpty() && item->childCount() == 0) {
-                totalParts++;
-                
-                // 构建部件缓存文件路径
-                QString safePartName = partName;
-                safePartName.replace(QRegularExpression("[^a-zA-Z0-9_-]"), "_");
-                QString partCachePath = QString("%1/%2_%3.vtp").arg(cacheDir, baseName, safePartName);
-                
-                qDebug() << "STEPModelTreeWidget: 尝试加载部件:" << partName << "-> 文件:" << partCachePath;
-                
-                QFileInfo partFileInfo(partCachePath);
-                if (!partFileInfo.exists()) {
-                    qWarning() << "STEPModelTreeWidget: 部件缓存文件不存在:" << partCachePath;
-                    ++it;
-                    continue;
+            for (int i = 0; i < total; ++i) {
+                if (!guard) {
+                    return;
                 }
                 
-                // 读取部件VTP文件
-                vtkSmartPointer<vtkXMLPolyDataReader> reader = 
-                    vtkSmartPointer<vtkXMLPolyDataReader>::New();
-                reader->SetFileName(partCachePath.toStdString().c_str());
-                reader->Update();
-                
-                vtkPolyData* polyData = reader->GetOutput();
-                if (!polyData || polyData->GetNumberOfPoints() == 0) {
-                    qWarning() << "STEPModelTreeWidget: 部件缓存文件无效:" << partName;
-                    ++it;
-                    continue;
+                QString partCachePath = STEPMeshCache::partCachePath(cachePath, partNames[i]);
+                vtkSmartPointer<vtkPolyData> polyData = STEPMeshCache::readPart(partCachePath);
+                if (polyData) {
+                    parts[partNames[i]] = polyData;
+                } else {
+                    qWarning() << "STEPModelTreeWidget: 部件缓存文件不存在或无效:" << partCachePath;
                 }
                 
-                // 创建独立的Actor
-                vtkSmartPointer<vtkPolyDataMapper> mapper = 
-                    vtkSmartPointer<vtkPolyDataMapper>::New();
-                mapper->SetInputData(polyData);
-                
-                vtkSmartPointer<vtkActor> actor = vtkSmartPointer<vtkActor>::New();
-                actor->SetMapper(mapper);
-                actor->GetProperty()->SetColor(0.8, 0.8, 0.9);
-                actor->GetProperty()->SetSpecular(0.3);
-                actor->GetProperty()->SetSpecularPower(20);
-                
-                // 保存到Actor映射
-                m_actorMap[partName] = actor;
-                loadedCount++;
-                
-                // NAUO8 默认不显示（机器人底座/安装板）
-                if (partName == "NAUO8") {
-                    actor->SetVisibility(false);
-                    item->setCheckState(1, Qt::Unchecked);  // 第1列是可见性勾选框
-                    qDebug() << "STEPModelTreeWidget: NAUO8 默认隐藏";
-                }
-                
-                // 定期更新UI
-                if (loadedCount % 10 == 0) {
-                    m_statusLabel->setText(QString("正在加载缓存... (%1/%2)").arg(loadedCount).arg(totalParts));
-                    QApplication::processEvents();
+                if ((i + 1) % 10 == 0 || i + 1 == total) {
+                    QMetaObject::invokeMethod(guard.data(), [guard, i, total, generation]() {
+                        if (guard && generation == guard->m_meshGeneration) {
+                            guard->m_statusLabel->setText(
+                                QString("正在加载缓存... (%1/%2)").arg(i + 1).arg(total));
+                            emit guard->progressUpdated(i + 1, total, "正在加载缓存...");
+                        }
+                    }, Qt::QueuedConnection);
                 }
             }
             
-            ++it;
-        }
-        
-        if (loadedCount == 0) {
-            qWarning() << "STEPModelTreeWidget: 没有加载到任何部件";
-            return false;
-        }
-        
-        qDebug() << "STEPModelTreeWidget: 从缓存加载成功，加载了" << loadedCount << "个部件";
-        m_statusLabel->setText(QString("从缓存加载成功 (%1个部件)").arg(loadedCount));
-        
-        // 展开第一层
-        m_treeWidget->expandToDepth(1);
+            if (guard) {
+                QMetaObject::invokeMethod(guard.data(), [guard, cachePath, parts, generation]() {
+                    if (guard) {
+                        guard->applyCachedParts(cachePath, parts, generation);
+                    }
+                }, Qt::QueuedConnection);
+            }
+        }), 2);
         
         return true;
         
@@ -771,6 +806,78 @@ bool STEPModelTreeWidget::loadFromCache(const QString& cachePath)
     }
 }
 
+void STEPModelTreeWidget::applyCachedParts(const QString& cachePath,
+                                           const QMap<QString, vtkSmartPointer<vtkPolyData>>& parts,
+                                           int generation)
+{
+    // 读取期间场景已被清空或开始了新的加载
+    if (generation != m_meshGeneration) {
+        qDebug() << "STEPModelTreeWidget: 丢弃过期的缓存加载结果";
+        return;
+    }
+    
+    int loadedCount = 0;
+    QTreeWidgetItemIterator it(m_treeWidget);
+    while (*it) {
+        QTreeWidgetItem* item = *it;
+        QString partName = item->data(0, Qt::UserRole).toString();
+        auto part = parts.constFind(partName);
+        
+        if (item->childCount() == 0 && part != parts.constEnd()) {
+            // 创建独立的Actor
+            vtkSmartPointer<vtkPolyDataMapper> mapper = 
+                vtkSmartPointer<vtkPolyDataMapper>::New();
+            mapper->SetInputData(part.value());
+            
+            vtkSmartPointer<vtkActor> actor = vtkSmartPointer<vtkActor>::New();
+            actor->SetMapper(mapper);
+            actor->GetProperty()->SetColor(0.8, 0.8, 0.9);
+            actor->GetProperty()->SetSpecular(0.3);
+            actor->GetProperty()->SetSpecularPower(20);
+            
+            // 保存到Actor映射
+            m_actorMap[partName] = actor;
+            loadedCount++;
+            
+            // NAUO8 默认不显示（机器人底座/安装板）
+            if (partName == "NAUO8") {
+                actor->SetVisibility(false);
+                m_treeWidget->blockSignals(true);
+                item->setCheckState(1, Qt::Unchecked);  // 第1列是可见性勾选框
+                m_treeWidget->blockSignals(false);
+                qDebug() << "STEPModelTreeWidget: NAUO8 默认隐藏";
+            }
+        }
+        ++it;
+    }
+    
+    if (loadedCount == 0) {
+        // 缓存损坏，回退到正常加载（完成后会重新生成缓存）
+        qWarning() << "STEPModelTreeWidget: 没有加载到任何部件，回退到正常加载";
+        m_treeWidget->clear();
+        m_currentCachePath = cachePath;
+        loadSTEPFile(m_currentFilePath);
+        return;
+    }
+    
+    qDebug() << "STEPModelTreeWidget: 从缓存加载成功，加载了" << loadedCount << "个部件";
+    m_statusLabel->setText(QString("从缓存快速加载成功 (%1个部件)").arg(loadedCount));
+    
+    // 展开第一层
+    m_treeWidget->expandToDepth(1);
+    scheduleBVHRebuild();
+    
+    if (m_renderer) {
+        addActorsToRenderer(m_renderer);
+        m_renderer->ResetCamera();
+        m_renderer->ResetCameraClippingRange();
+        requestRender(m_renderer->GetRenderWindow());
+    }
+    
+    emit partActorsAdded();
+    emit loadCompleted(true, "从缓存快速加载成功");
+}
+
 bool STEPModelTreeWidget::loadSTEPFileFast(const QString& filePath)
 {
     QFileInfo fileInfo(filePath);
@@ -788,9 +895,9 @@ bool STEPModelTreeWidget::loadSTEPFileFast(const QString& filePath)
     if (isCacheValid(cachePath, filePath)) {
         qDebug() << "STEPModelTreeWidget: 使用缓存快速加载";
         
+        // 部件网格在后台读取，完成后发出loadCompleted
+        m_currentFilePath = filePath;
         if (loadFromCache(cachePath)) {
-            m_statusLabel->setText("从缓存快速加载成功");
-            emit loadCompleted(true, "从缓存快速加载成功");
             return true;
         } else {
             qWarning() << "STEPModelTreeWidget: 缓存加载失败，回退到正常加载";
@@ -812,21 +919,14 @@ QJsonObject STEPModelTreeWidget::treeItemToJson(QTreeWidgetItem* item)
 {
     if (!item) return QJsonObject();
     
-    QJsonObject obj;
-    obj["name"] = item->text(0);
-    obj["checked"] = (item->checkState(1) == Qt::Checked);
-    obj["partName"] = item->data(0, Qt::UserRole).toString();
-    
     // 递归保存子节点
-    if (item->childCount() > 0) {
-        QJsonArray children;
-        for (int i = 0; i < item->childCount(); ++i) {
-            children.append(treeItemToJson(item->child(i)));
-        }
-        obj["children"] = children;
+    QJsonArray children;
+    for (int i = 0; i < item->childCount(); ++i) {
+        children.append(treeItemToJson(item->child(i)));
     }
     
-    return obj;
+    return STEPMeshCache::makeTreeNode(item->text(0), item->data(0, Qt::UserRole).toString(),
+                                       item->checkState(1) == Qt::Checked, children);
 }
 
 QTreeWidgetItem* STEPModelTreeWidget::jsonToTreeItem(const QJsonObject& json, QTreeWidgetItem* parent)
@@ -849,42 +949,6 @@ QTreeWidgetItem* STEPModelTreeWidget::jsonToTreeItem(const QJsonObject& json, QT
     return item;
 }
 
-bool STEPModelTreeWidget::saveTreeStructure(const QString& jsonPath)
-{
-    try {
-        QJsonArray rootArray;
-        
-        // 保存所有顶层节点
-        for (int i = 0; i < m_treeWidget->topLevelItemCount(); ++i) {
-            QTreeWidgetItem* item = m_treeWidget->topLevelItem(i);
-            rootArray.append(treeItemToJson(item));
-        }
-        
-        QJsonObject root;
-        root["version"] = "1.0";
-        root["shapeCounter"] = m_shapeCounter;
-        root["tree"] = rootArray;
-        
-        // 写入JSON文件
-        QFile file(jsonPath);
-        if (!file.open(QIODevice::WriteOnly)) {
-            qCritical() << "STEPModelTreeWidget: 无法创建JSON文件:" << jsonPath;
-            return false;
-        }
-        
-        QJsonDocument doc(root);
-        file.write(doc.toJson(QJsonDocument::Compact));
-        file.close();
-        
-        qDebug() << "STEPModelTreeWidget: 树结构已保存到:" << jsonPath;
-        return true;
-        
-    } catch (const std::exception& e) {
-        qCritical() << "STEPModelTreeWidget: 保存树结构失败:" << e.what();
-        return false;
-    }
-}
-
 bool STEPModelTreeWidget::loadTreeStructure(const QString& jsonPath)
 {
     try {
@@ -929,7 +993,6 @@ void STEPModelTreeWidget::onLoadProgress(int current, int total, const QString&
         m_progressDialog->setMaximum(total);
         m_progressDialog->setValue(current);
         m_progressDialog->setLabelText(message);
-        QApplication::processEvents();
     }
 }
 
@@ -948,6 +1011,12 @@ void STEPModelTreeWidget::onLoadFinished(bool success, const QString& message,
         m_shapeMap = shapes;
         m_shapeCounter = shapeCounter;
         
+        // 与加载线程共享同一份导入结果，不再重复读取文档
+        m_import = STEPImportEngine::instance()->cached(m_currentFilePath);
+        if (m_import) {
+            m_occDoc = m_import->document;
+        }
+        
         qDebug() << "STEPModelTreeWidget: 复制完成，m_actorMap大小=" << m_actorMap.size();
         
         // 构建树形视图
@@ -959,13 +1028,27 @@ void STEPModelTreeWidget::onLoadFinished(bool success, const QString& message,
         rootItem->setData(0, Qt::UserRole, "Assembly");
         
         // 然后添加所有部件作为子节点
-        for (auto it = m_actorMap.begin(); it != m_actorMap.end(); ++it) {
+        // 按需模式下Actor尚未生成，以形状映射为准构建结构树
+        const QStringList partNames = m_lazyMeshing ? m_shapeMap.keys() : m_actorMap.keys();
+        m_treeWidget->blockSignals(true);
+        for (const QString& partName : partNames) {
             QTreeWidgetItem* item = new QTreeWidgetItem(rootItem);
-            item->setText(0, it.key());
+            item->setText(0, partName);
             item->setCheckState(1, Qt::Checked);
-            item->setData(0, Qt::UserRole, it.key());
-            qDebug() << "STEPModelTreeWidget: 添加树节点:" << it.key();
+            item->setData(0, Qt::UserRole, partName);
+            
+            if (m_lazyMeshing) {
+                // NAUO8 默认不显示（机器人底座/安装板），也不进行网格化
+                if (partName == "NAUO8") {
+                    item->setCheckState(1, Qt::Unchecked);
+                    m_lazyHiddenParts.insert(partName);
+                } else {
+                    m_pendingMeshParts.append(partName);
+                }
+            }
+            qDebug() << "STEPModelTreeWidget: 添加树节点:" << partName;
         }
+        m_treeWidget->blockSignals(false);
         
         // 展开第一层
         m_treeWidget->expandToDepth(1);
@@ -973,7 +1056,6 @@ void STEPModelTreeWidget::onLoadFinished(bool success, const QString& message,
         m_statusLabel->setText(message);
         m_progressDialog->setLabelText("加载完成！");
         m_progressDialog->setValue(100);
-        QApplication::processEvents();
         
         // 自动添加Actor到渲染器（如果已设置）
         if (m_renderer) {
@@ -981,35 +1063,657 @@ void STEPModelTreeWidget::onLoadFinished(bool success, const QString& message,
             qDebug() << "STEPModelTreeWidget: 自动添加Actor到渲染器";
             
             // 重置相机以显示完整模型
-            m_renderer->ResetCamera();
+            // 按需模式下还没有Actor，使用部件包围盒的并集定位相机
+            if (m_lazyMeshing && !m_partBounds.isEmpty()) {
+                double bounds[6] = {VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX,
+                                    VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN};
+                for (auto it = m_partBounds.constBegin(); it != m_partBounds.constEnd(); ++it) {
+                    const QVector<double>& b = it.value();
+                    for (int i = 0; i < 6; i += 2) {
+                        bounds[i] = std::min(bounds[i], b[i]);
+                        bounds[i + 1] = std::max(bounds[i + 1], b[i + 1]);
+                    }
+                }
+                m_renderer->ResetCamera(bounds);
+            } else {
+                m_renderer->ResetCamera();
+            }
             m_renderer->ResetCameraClippingRange();
             
             // 触发渲染
-            vtkRenderWindow* renderWindow = m_renderer->GetRenderWindow();
-            if (renderWindow) {
-                renderWindow->Render();
-                qDebug() << "STEPModelTreeWidget: 渲染窗口已刷新";
-            }
+            requestRender(m_renderer->GetRenderWindow());
             
             qDebug() << "STEPModelTreeWidget: 相机已重置";
         }
         
-        // 如果有缓存路径，保存缓存
-        if (!m_currentCachePath.isEmpty()) {
-            qDebug() << "STEPModelTreeWidget: 加载成功，保存缓存到:" << m_currentCachePath;
-            saveToCache(m_currentCachePath);
-            m_currentCachePath.clear();
+        // 在后台细化已生成的粗网格
+        for (auto it = m_actorMap.constBegin(); it != m_actorMap.constEnd(); ++it) {
+            scheduleRefinement(it.key());
         }
+        scheduleBVHRebuild();
         
+        // 如果有缓存路径，保存缓存（等所有部件网格化并细化后再保存）
+        saveCacheIfComplete();
+        
+        emit partActorsAdded();
         emit loadCompleted(true, message);
         
-        // 延迟关闭进度对话框
-        QTimer::singleShot(500, m_progressDialog, &QProgressDialog::close);
+        // 开始按需网格化可见部件
+        if (m_lazyMeshing) {
+            scheduleNextMesh();
+        }
+        
+        // 延迟隐藏进度对话框。不能用close：QProgressDialog关闭时会发出canceled，
+        // 而加载线程在按需网格化期间仍在工作，会被当作用户取消
+        QTimer::singleShot(500, m_progressDialog, &QProgressDialog::hide);
     } else {
-        m_statusLabel->setText("加载失败");
-        m_progressDialog->close();
-        QMessageBox::critical(this, "错误", message);
+        const bool canceled = m_loadCanceled;
+        m_progressDialog->hide();
         m_currentCachePath.clear();
+        
+        if (canceled) {
+            // 用户主动取消，不弹出错误框
+            m_statusLabel->setText("加载已取消");
+            qDebug() << "STEPModelTreeWidget: 用户取消加载";
+        } else {
+            m_statusLabel->setText("加载失败");
+            QMessageBox::critical(this, "错误", message);
+        }
         emit loadCompleted(false, message);
     }
+    m_loadCanceled = false;
+}
+
+// ==================== 按需网格化 ====================
+
+void STEPModelTreeWidget::onPartBoundsReady(QMap<QString, QVector<double>> bounds)
+{
+    m_partBounds = bounds;
+    qDebug() << "STEPModelTreeWidget: 收到" << m_partBounds.size() << "个部件包围盒";
+}
+
+void STEPModelTreeWidget::onPartMeshed(const QString& partName, vtkSmartPointer<vtkActor> actor)
+{
+    // 场景已清空或已重新加载，丢弃过期结果
+    if (partName != m_meshInFlight) {
+        qDebug() << "STEPModelTreeWidget: 丢弃过期的网格化结果:" << partName;
+        return;
+    }
+    m_meshInFlight.clear();
+    
+    if (actor && m_shapeMap.contains(partName)) {
+        m_actorMap[partName] = actor;
+        actor->SetVisibility(!m_lazyHiddenParts.contains(partName));
+        
+        if (m_renderer) {
+            m_renderer->AddActor(actor);
+            m_renderer->ResetCameraClippingRange();
+            requestRender(m_renderer->GetRenderWindow());
+        }
+        qDebug() << "STEPModelTreeWidget: 按需网格化完成:" << partName;
+        scheduleRefinement(partName);
+        scheduleBatchUpdate(partName);
+        scheduleBVHRebuild();
+        emit partActorsAdded();
+    } else {
+        qWarning() << "STEPModelTreeWidget: 部件网格化失败:" << partName;
+    }
+    
+    if (m_pendingMeshParts.isEmpty()) {
+        m_statusLabel->setText(QString("按需网格化完成 (%1/%2个部件)")
+                               .arg(m_actorMap.size()).arg(m_shapeMap.size()));
+    } else {
+        m_statusLabel->setText(QString("正在按需网格化... (剩余%1个部件)")
+                               .arg(m_pendingMeshParts.size()));
+    }
+    
+    saveCacheIfComplete();
+    scheduleNextMesh();
+}
+
+void STEPModelTreeWidget::setUnmeshedPartVisibility(const QString& partName, bool visible)
+{
+    if (!m_lazyMeshing || !m_shapeMap.contains(partName)) {
+        return;
+    }
+    
+    if (visible) {
+        m_lazyHiddenParts.remove(partName);
+        requestPartMesh(partName);
+    } else {
+        m_lazyHiddenParts.insert(partName);
+        m_pendingMeshParts.removeAll(partName);
+    }
+}
+
+void STEPModelTreeWidget::requestPartMesh(const QString& partName)
+{
+    if (m_actorMap.contains(partName) || m_meshInFlight == partName ||
+        m_pendingMeshParts.contains(partName)) {
+        return;
+    }
+    
+    m_pendingMeshParts.append(partName);
+    qDebug() << "STEPModelTreeWidget: 部件首次可见，加入网格化队列:" << partName;
+    scheduleNextMesh();
+}
+
+void STEPModelTreeWidget::scheduleNextMesh()
+{
+    // 一次只提交一个部件，以便每次都按当前相机重新排定优先级
+    if (!m_meshInFlight.isEmpty() || m_pendingMeshParts.isEmpty() || !m_loadWorker) {
+        return;
+    }
+    
+    double planes[24];
+    bool hasFrustum = false;
+    if (m_renderer && m_renderer->GetActiveCamera()) {
+        m_renderer->GetActiveCamera()->GetFrustumPlanes(m_renderer->GetTiledAspectRatio(), planes);
+        hasFrustum = true;
+    }
+    
+    // 视锥内的部件优先，其次包围盒更大的部件优先
+    int bestIndex = 0;
+    bool bestInFrustum = false;
+    double bestSize = -1.0;
+    for (int i = 0; i < m_pendingMeshParts.size(); ++i) {
+        auto it = m_partBounds.constFind(m_pendingMeshParts[i]);
+        bool inFrustum = true;
+        double size = 0.0;
+        if (it != m_partBounds.constEnd()) {
+            inFrustum = !hasFrustum || boundsIntersectFrustum(planes, it.value());
+            size = boundsDiagonal(it.value());
+        }
+        
+        if ((inFrustum && !bestInFrustum) || (inFrustum == bestInFrustum && size > bestSize)) {
+            bestIndex = i;
+            bestInFrustum = inFrustum;
+            bestSize = size;
+        }
+    }
+    
+    m_meshInFlight = m_pendingMeshParts.takeAt(bestIndex);
+    QMetaObject::invokeMethod(m_loadWorker, "meshPart", Qt::QueuedConnection,
+                              Q_ARG(QString, m_meshInFlight));
+}
+
+void STEPModelTreeWidget::saveCacheIfComplete()
+{
+    // 缓存需要完整的精细网格，按需模式下部分部件可能从未网格化
+    if (m_currentCachePath.isEmpty() || m_actorMap.size() < m_shapeMap.size() ||
+        !m_refiningParts.isEmpty()) {
+        return;
+    }
+    
+    qDebug() << "STEPModelTreeWidget: 加载成功，保存缓存到:" << m_currentCachePath;
+    saveToCache(m_currentCachePath);
+    m_currentCachePath.clear();
+}
+
+// ==================== 渐进式网格化 ====================
+
+double STEPModelTreeWidget::screenPixelsForBounds(const double bounds[6]) const
+{
+    const double defaultPixels = 1000.0;
+    if (!m_renderer || !m_renderer->GetActiveCamera()) {
+        return defaultPixels;
+    }
+    
+    int* size = m_renderer->GetSize();
+    if (!size || size[1] <= 0) {
+        return defaultPixels;
+    }
+    
+    vtkCamera* camera = m_renderer->GetActiveCamera();
+    double center[3] = {(bounds[0] + bounds[1]) / 2, (bounds[2] + bounds[3]) / 2,
+                        (bounds[4] + bounds[5]) / 2};
+    double dx = bounds[1] - bounds[0], dy = bounds[3] - bounds[2], dz = bounds[5] - bounds[4];
+    double diagonal = std::sqrt(dx * dx + dy * dy + dz * dz);
+    
+    // 视口高度对应的世界尺寸
+    double viewHeight = 0.0;
+    if (camera->GetParallelProjection()) {
+        viewHeight = 2.0 * camera->GetParallelScale();
+    } else {
+        double* pos = camera->GetPosition();
+        double distance = std::sqrt(vtkMath::Distance2BetweenPoints(pos, center));
+        viewHeight = 2.0 * distance * std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2.0);
+    }
+    
+    if (viewHeight <= 0.0) {
+        return defaultPixels;
+    }
+    return diagonal / viewHeight * size[1];
+}
+
+void STEPModelTreeWidget::scheduleRefinement(const QString& partName)
+{
+    if (!m_shapeMap.contains(partName) || !m_actorMap.contains(partName) ||
+        m_refiningParts.contains(partName)) {
+        return;
+    }
+    
+    vtkActor* actor = m_actorMap[partName];
+    double bounds[6];
+    actor->GetBounds(bounds);
+    double dx = bounds[1] - bounds[0], dy = bounds[3] - bounds[2], dz = bounds[5] - bounds[4];
+    double diagonal = std::sqrt(dx * dx + dy * dy + dz * dz);
+    double chordError = ShapeTessellator::targetChordError(diagonal, screenPixelsForBounds(bounds));
+    
+    // 可见部件优先细化
+    int priority = actor->GetVisibility() ? 1 : 0;
+    
+    TopoDS_Shape shape = m_shapeMap[partName];
+    int generation = m_meshGeneration;
+    QPointer<STEPModelTreeWidget> guard(this);
+    
+    m_refiningParts.insert(partName);
+    m_refinePool->start(QRunnable::create([guard, partName, shape, chordError, generation]() {
+        vtkSmartPointer<vtkPolyData> polyData;
+        try {
+            polyData = ShapeTessellator::tessellateFine(shape, chordError);
+        } catch (...) {
+            qWarning() << "STEPModelTreeWidget: 网格细化异常:" << partName;
+        }
+        
+        if (guard) {
+            QMetaObject::invokeMethod(guard.data(), [guard, partName, polyData, generation]() {
+                if (guard) {
+                    guard->applyRefinedMesh(partName, polyData, generation);
+                }
+            }, Qt::QueuedConnection);
+        }
+    }), priority);
+    
+    qDebug() << "STEPModelTreeWidget: 提交网格细化:" << partName << "弦高误差=" << chordError;
+}
+
+void STEPModelTreeWidget::applyRefinedMesh(const QString& partName,
+                                           vtkSmartPointer<vtkPolyData> polyData,
+                                           int generation)
+{
+    if (generation != m_meshGeneration) {
+        return;
+    }
+    m_refiningParts.remove(partName);
+    
+    auto it = m_actorMap.find(partName);
+    if (polyData && it != m_actorMap.end()) {
+        // 在UI线程中整体替换输入数据，渲染时不会看到半成品网格
+        vtkPolyDataMapper* mapper = vtkPolyDataMapper::SafeDownCast(it.value()->GetMapper());
+        scheduleBVHRebuild();
+        if (mapper && m_batcher.contains(partName)) {
+            // 合批中的部件在重建合批后才显示细网格
+            mapper->SetInputData(polyData);
+            scheduleBatchUpdate(partName);
+        } else if (mapper) {
+            mapper->SetInputData(polyData);
+            if (m_renderer && it.value()->GetVisibility()) {
+                requestRender(m_renderer->GetRenderWindow());
+            }
+        }
+    }
+    
+    if (m_refiningParts.isEmpty()) {
+        qDebug() << "STEPModelTreeWidget: 所有部件网格细化完成";
+        saveCacheIfComplete();
+    }
+}
+
+// ==================== 合批渲染 ====================
+
+void STEPModelTreeWidget::setBatchingEnabled(bool enabled)
+{
+    if (m_batching == enabled) {
+        return;
+    }
+    m_batching = enabled;
+    
+    if (!m_batchRenderer) {
+        return;
+    }
+    
+    if (enabled) {
+        rebuildBatches();
+    } else {
+        // 恢复为每个部件单独绘制
+        m_batchRebuildTimer->stop();
+        m_dirtyBatchParts.clear();
+        for (const auto& actor : m_batcher.batchActors()) {
+            m_batchRenderer->RemoveActor(actor);
+        }
+        m_batcher.clear();
+        for (auto it = m_actorMap.constBegin(); it != m_actorMap.constEnd(); ++it) {
+            m_batchRenderer->AddActor(it.value());
+        }
+    }
+}
+
+void STEPModelTreeWidget::setActorVisibility(const QString& partName, bool visible)
+{
+    vtkActor* actor = m_actorMap.value(partName);
+    if (!actor) {
+        return;
+    }
+    
+    // 独立Actor的可见性仍作为部件状态的来源（细化优先级、合批重建、拾取BVH）
+    actor->SetVisibility(visible);
+    m_batcher.setPartVisibility(partName, visible);
+    scheduleBVHRebuild();
+}
+
+void STEPModelTreeWidget::rebuildBatches()
+{
+    m_batchRebuildTimer->stop();
+    m_dirtyBatchParts.clear();
+    if (!m_batching || !m_batchRenderer) {
+        return;
+    }
+    
+    try {
+        for (const auto& actor : m_batcher.batchActors()) {
+            m_batchRenderer->RemoveActor(actor);
+        }
+        
+        m_batcher.rebuild(m_actorMap, m_dynamicParts);
+        
+        // 合批中的部件不再单独绘制，其余部件（机器人连杆、空网格）保持独立Actor
+        for (auto it = m_actorMap.constBegin(); it != m_actorMap.constEnd(); ++it) {
+            if (m_batcher.contains(it.key())) {
+                m_batchRenderer->RemoveActor(it.value());
+            } else {
+                m_batchRenderer->AddActor(it.value());
+            }
+        }
+        for (const auto& actor : m_batcher.batchActors()) {
+            m_batchRenderer->AddActor(actor);
+        }
+        
+        qDebug() << "STEPModelTreeWidget: 合批重建完成," << m_actorMap.size() << "个部件 ->"
+                 << m_batcher.batchCount() << "个合批 +" << m_dynamicParts.size() << "个独立部件";
+    } catch (const std::exception& e) {
+        qCritical() << "STEPModelTreeWidget: 合批重建失败:" << e.what();
+    }
+}
+
+void STEPModelTreeWidget::updateBatches(const QSet<QString>& parts)
+{
+    if (!m_batching || !m_batchRenderer || parts.isEmpty()) {
+        return;
+    }
+    if (m_batcher.isEmpty()) {
+        rebuildBatches();
+        return;
+    }
+    
+    try {
+        for (const auto& actor : m_batcher.update(m_actorMap, m_dynamicParts, parts)) {
+            m_batchRenderer->AddActor(actor);
+        }
+        
+        // 新加入合批的部件不再单独绘制，移出合批的部件恢复独立Actor
+        for (const QString& partName : parts) {
+            vtkActor* actor = m_actorMap.value(partName);
+            if (!actor) {
+                continue;
+            }
+            if (m_batcher.contains(partName)) {
+                m_batchRenderer->RemoveActor(actor);
+            } else {
+                m_batchRenderer->AddActor(actor);
+            }
+        }
+    } catch (const std::exception& e) {
+        qCritical() << "STEPModelTreeWidget: 合批更新失败:" << e.what();
+    }
+}
+
+void STEPModelTreeWidget::scheduleBatchUpdate(const QString& partName)
+{
+    if (m_batching && m_batchRenderer) {
+        m_dirtyBatchParts.insert(partName);
+        m_batchRebuildTimer->start();
+    }
+}
+
+QString STEPModelTreeWidget::pickPart(int x, int y, double* worldPosition)
+{
+    vtkRenderer* renderer = m_batchRenderer ? m_batchRenderer : m_renderer;
+    if (!renderer) {
+        return QString();
+    }
+    
+    if (m_sceneBVH) {
+        // 静态部件在BVH中求交，机器人连杆等单独变换的部件仍用VTK拾取器
+        double nearPoint[4];
+        double farPoint[4];
+        renderer->SetDisplayPoint(x, y, 0.0);
+        renderer->DisplayToWorld();
+        renderer->GetWorldPoint(nearPoint);
+        renderer->SetDisplayPoint(x, y, 1.0);
+        renderer->DisplayToWorld();
+        renderer->GetWorldPoint(farPoint);
+        for (int i = 0; i < 3; ++i) {
+            nearPoint[i] /= nearPoint[3];
+            farPoint[i] /= farPoint[3];
+        }
+        const double direction[3] = {farPoint[0] - nearPoint[0], farPoint[1] - nearPoint[1],
+                                     farPoint[2] - nearPoint[2]};
+        
+        QString partName;
+        double hitDistance = std::sqrt(vtkMath::Dot(direction, direction));
+        double hitPosition[3] = {0.0, 0.0, 0.0};
+        
+        Simulation::TriangleBVH::RayHit hit;
+        if (m_sceneBVH->intersectRay(nearPoint, direction, hit, hitDistance)) {
+            partName = m_sceneBVH->partName(hit.part);
+            hitDistance = hit.distance;
+            std::copy(hit.point, hit.point + 3, hitPosition);
+        }
+        
+        if (!m_dynamicParts.isEmpty()) {
+            vtkSmartPointer<vtkCellPicker> picker = vtkSmartPointer<vtkCellPicker>::New();
+            picker->SetTolerance(0.0005);
+            picker->PickFromListOn();
+            for (const QString& dynamicPart : m_dynamicParts) {
+                vtkActor* actor = m_actorMap.value(dynamicPart);
+                if (actor && actor->GetVisibility()) {
+                    picker->AddPickList(actor);
+                }
+            }
+            if (picker->Pick(x, y, 0, renderer) &&
+                std::sqrt(vtkMath::Distance2BetweenPoints(nearPoint, picker->GetPickPosition())) < hitDistance) {
+                for (const QString& dynamicPart : m_dynamicParts) {
+                    if (m_actorMap.value(dynamicPart).GetPointer() == picker->GetActor()) {
+                        partName = dynamicPart;
+                        picker->GetPickPosition(hitPosition);
+                        break;
+                    }
+                }
+            }
+        }
+        
+        if (worldPosition && !partName.isEmpty()) {
+            std::copy(hitPosition, hitPosition + 3, worldPosition);
+        }
+        qDebug() << "STEPModelTreeWidget: 拾取部件:" << partName;
+        return partName;
+    }
+    
+    // BVH尚未构建完成时使用VTK拾取器
+    vtkSmartPointer<vtkCellPicker> picker = vtkSmartPointer<vtkCellPicker>::New();
+    picker->SetTolerance(0.0005);
+    if (!picker->Pick(x, y, 0, renderer)) {
+        return QString();
+    }
+    
+    // 合批Actor通过单元的部件ID查找，独立Actor直接反查映射
+    vtkActor* actor = picker->GetActor();
+    QString partName = m_batcher.partAt(actor, picker->GetCellId());
+    if (partName.isEmpty()) {
+        for (auto it = m_actorMap.constBegin(); it != m_actorMap.constEnd(); ++it) {
+            if (it.value().GetPointer() == actor) {
+                partName = it.key();
+                break;
+            }
+        }
+    }
+    if (worldPosition && !partName.isEmpty()) {
+        picker->GetPickPosition(worldPosition);
+    }
+    
+    qDebug() << "STEPModelTreeWidget: 拾取部件:" << partName;
+    return partName;
+}
+
+// ==================== 拾取/距离查询BVH ====================
+
+void STEPModelTreeWidget::requestRender(vtkRenderWindow* renderWindow)
+{
+    // 接入视图的渲染调度器时合并到下一帧，否则直接渲染
+    if (isSignalConnected(QMetaMethod::fromSignal(&STEPModelTreeWidget::renderRequested))) {
+        emit renderRequested();
+    } else if (renderWindow) {
+        renderWindow->Render();
+    }
+}
+
+void STEPModelTreeWidget::scheduleBVHRebuild()
+{
+    m_bvhRebuildTimer->start();
+}
+
+void STEPModelTreeWidget::rebuildSceneBVH()
+{
+    // 网格化/细化仍在进行时每个部件都会再次触发重建，等队列空闲后再构建；
+    // 尚无BVH时先构建一次，使拾取和偏差分析尽早可用
+    const bool queueBusy = !m_pendingMeshParts.isEmpty() || !m_meshInFlight.isEmpty() ||
+                           !m_refiningParts.isEmpty();
+    if (m_bvhBuildInFlight || (queueBusy && m_sceneBVH)) {
+        m_bvhRebuildTimer->start();
+        return;
+    }
+    
+    // 在UI线程中快照可见静态部件：网格和变换未变的部件复用已提取的世界坐标三角形，
+    // 变化的部件浅拷贝网格，三角形提取和SAH构建在后台完成
+    struct PartMesh {
+        QString name;
+        vtkSmartPointer<vtkPolyData> polyData;    // 需要重新提取时非空
+        BVHPartMesh mesh;
+    };
+    std::vector<PartMesh> meshes;
+    int extractCount = 0;
+    for (auto it = m_actorMap.constBegin(); it != m_actorMap.constEnd(); ++it) {
+        vtkActor* actor = it.value();
+        if (!actor || !actor->GetVisibility() || m_dynamicParts.contains(it.key())) {
+            continue;
+        }
+        vtkPolyDataMapper* mapper = vtkPolyDataMapper::SafeDownCast(actor->GetMapper());
+        vtkPolyData* input = mapper ? vtkPolyData::SafeDownCast(mapper->GetInput()) : nullptr;
+        if (!input) {
+            continue;
+        }
+        
+        PartMesh part;
+        part.name = it.key();
+        part.mesh.source = input;
+        part.mesh.sourceTime = input->GetMTime();
+        vtkMatrix4x4::DeepCopy(part.mesh.matrix, actor->GetMatrix());
+        
+        auto cached = m_bvhPartMeshes.constFind(part.name);
+        if (cached != m_bvhPartMeshes.constEnd() && cached->source == part.mesh.source &&
+            cached->sourceTime == part.mesh.sourceTime &&
+            std::equal(part.mesh.matrix, part.mesh.matrix + 16, cached->matrix)) {
+            part.mesh.vertices = cached->vertices;
+            part.mesh.indices = cached->indices;
+        } else {
+            part.polyData = vtkSmartPointer<vtkPolyData>::New();
+            part.polyData->ShallowCopy(input);
+            ++extractCount;
+        }
+        meshes.push_back(part);
+    }
+    
+    // 已删除部件的缓存不再需要
+    for (auto it = m_bvhPartMeshes.begin(); it != m_bvhPartMeshes.end();) {
+        if (m_actorMap.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_bvhPartMeshes.erase(it);
+        }
+    }
+    
+    const int request = ++m_bvhRequest;
+    m_bvhBuildInFlight = true;
+    QPointer<STEPModelTreeWidget> guard(this);
+    qDebug() << "STEPModelTreeWidget: 重建场景BVH," << meshes.size() << "个部件，重新提取"
+             << extractCount << "个";
+    
+    m_refinePool->start(QRunnable::create([guard, meshes, request]() mutable {
+        auto bvh = std::make_shared<Simulation::TriangleBVH>();
+        
+        for (PartMesh& part : meshes) {
+            if (part.polyData) {
+                vtkPoints* points = part.polyData->GetPoints();
+                vtkCellArray* polys = part.polyData->GetPolys();
+                auto vertices = std::make_shared<std::vector<double>>();
+                auto indices = std::make_shared<std::vector<int>>();
+                
+                if (points && polys) {
+                    // 顶点变换到世界坐标
+                    const vtkIdType pointCount = points->GetNumberOfPoints();
+                    vertices->resize(static_cast<size_t>(pointCount) * 3);
+                    for (vtkIdType i = 0; i < pointCount; ++i) {
+                        double p[4] = {0.0, 0.0, 0.0, 1.0};
+                        points->GetPoint(i, p);
+                        double world[4];
+                        vtkMatrix4x4::MultiplyPoint(part.mesh.matrix, p, world);
+                        std::copy(world, world + 3, &(*vertices)[static_cast<size_t>(i) * 3]);
+                    }
+                    
+                    // 多边形按扇形三角化
+                    vtkIdType npts = 0;
+                    const vtkIdType* pts = nullptr;
+                    for (polys->InitTraversal(); polys->GetNextCell(npts, pts);) {
+                        for (vtkIdType k = 1; k + 1 < npts; ++k) {
+                            indices->push_back(static_cast<int>(pts[0]));
+                            indices->push_back(static_cast<int>(pts[k]));
+                            indices->push_back(static_cast<int>(pts[k + 1]));
+                        }
+                    }
+                }
+                part.mesh.vertices = vertices;
+                part.mesh.indices = indices;
+                part.polyData = nullptr;
+            }
+            
+            const std::vector<double>& vertices = *part.mesh.vertices;
+            const std::vector<int>& indices = *part.mesh.indices;
+            if (!indices.empty()) {
+                bvh->addMesh(part.name, vertices.data(), static_cast<int>(vertices.size() / 3),
+                             indices.data(), static_cast<int>(indices.size() / 3));
+            }
+        }
+        bvh->build();
+        
+        if (guard) {
+            std::shared_ptr<const Simulation::TriangleBVH> result = bvh;
+            QMetaObject::invokeMethod(guard.data(), [guard, result, meshes, request]() {
+                if (!guard) {
+                    return;
+                }
+                guard->m_bvhBuildInFlight = false;
+                if (request != guard->m_bvhRequest) {
+                    return;
+                }
+                for (const PartMesh& part : meshes) {
+                    if (guard->m_actorMap.contains(part.name)) {
+                        guard->m_bvhPartMeshes.insert(part.name, part.mesh);
+                    }
+                }
+                guard->m_sceneBVH = result;
+                emit guard->sceneBVHUpdated();
+            }, Qt::QueuedConnection);
+        }
+    }), 1);
 }
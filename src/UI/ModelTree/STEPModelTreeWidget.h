@@ -7,14 +7,24 @@
 #include <QAction>
 #include <QLabel>
 #include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QStringList>
 #include <QString>
 #include <QThread>
 #include <QProgressDialog>
 #include <memory>
+#include <vector>
+
+#include "STEPPartBatcher.h"
+#include "TriangleBVH.h"
+#include "../../Data/STEP/STEPImportEngine.h"
 
 // VTK includes
 #include <vtkSmartPointer.h>
 #include <vtkActor.h>
+#include <vtkPolyData.h>
 
 // OpenCASCADE includes
 #include <TopoDS_Shape.hxx>
@@ -23,6 +33,8 @@
 
 // 前向声明
 class STEPLoadWorker;
+class QThreadPool;
+class QTimer;
 
 /**
  * @brief STEP模型树控件（简化版，支持异步加载）
@@ -96,6 +108,21 @@ public:
      */
     void applyTransformToActor(const QString& partName, vtkTransform* transform);
     
+    /**
+     * @brief 解析由变换驱动的部件Actor
+     * 
+     * 供高频位姿更新一次性解析后直接持有，避免每帧按名称查找；部件会移出合批和BVH。
+     * 清空场景后（sceneGeneration变化）需重新解析。
+     * @param partName 部件名称
+     * @return Actor，部件不存在或尚未网格化时返回nullptr
+     */
+    vtkActor* resolveDynamicActor(const QString& partName);
+    
+    /**
+     * @brief 场景代数，每次清空场景后递增
+     */
+    int sceneGeneration() const { return m_meshGeneration; }
+    
     /**
      * @brief 设置部件的可见性
      * @param partName 部件名称
@@ -103,6 +130,48 @@ public:
      */
     void setPartVisibility(const QString& partName, bool visible);
 
+    /**
+     * @brief 设置按需网格化模式
+     * 
+     * 开启后异步加载只构建结构树，部件在首次可见时才网格化，
+     * 视锥内的部件优先处理；默认隐藏的部件（如NAUO8）不会被网格化。
+     * 需在loadSTEPFile之前调用。
+     * @param enabled 是否开启
+     */
+    void setLazyMeshing(bool enabled) { m_lazyMeshing = enabled; }
+    bool isLazyMeshing() const { return m_lazyMeshing; }
+
+    /**
+     * @brief 设置静态部件合批渲染
+     * 
+     * 开启后材质相同的静态部件合并为少量大网格绘制，部件可见性、高亮和拾取仍按部件进行。
+     * 通过applyTransformToActor驱动的部件（机器人连杆）会自动移出合批单独绘制。
+     * @param enabled 是否开启
+     */
+    void setBatchingEnabled(bool enabled);
+    bool isBatchingEnabled() const { return m_batching; }
+
+    /**
+     * @brief 拾取屏幕坐标处的部件
+     * 
+     * 静态部件在场景BVH中求交，单独变换的部件（机器人连杆）使用VTK拾取器；BVH未就绪时全部使用VTK拾取器。
+     * @param x 显示坐标x
+     * @param y 显示坐标y
+     * @param worldPosition 可选，输出拾取点的世界坐标
+     * @return 部件名称，未拾取到时返回空
+     */
+    QString pickPart(int x, int y, double* worldPosition = nullptr);
+    
+    /**
+     * @brief 获取场景三角形BVH（可见的静态部件，世界坐标）
+     * 
+     * 网格、可见性或变换变化后，待网格化/细化队列空闲时在后台重建（只重新提取变化的部件），
+     * 重建完成时发出sceneBVHUpdated。
+     * 返回的BVH只读，可在任意线程中用于射线、最近点和有符号距离查询（如间隙检查）。
+     * @return BVH，尚未构建时为空
+     */
+    std::shared_ptr<const Simulation::TriangleBVH> sceneBVH() const { return m_sceneBVH; }
+
 signals:
     /**
      * @brief 加载完成信号
@@ -125,6 +194,23 @@ signals:
      * @param message 消息
      */
     void progressUpdated(int current, int total, const QString& message);
+    
+    /**
+     * @brief 场景BVH重建完成信号
+     */
+    void sceneBVHUpdated();
+    
+    /**
+     * @brief 部件Actor增加信号（整体加载完成或单个部件按需网格化完成）
+     *
+     * 持有resolveDynamicActor结果的一方据此重试尚未解析到的部件。
+     */
+    void partActorsAdded();
+    
+    /**
+     * @brief 请求重绘信号（连接到视图的渲染调度器，未连接时直接同步渲染）
+     */
+    void renderRequested();
 
 private slots:
     void onItemClicked(QTreeWidgetItem* item, int column);
@@ -135,6 +221,8 @@ private slots:
                         QMap<QString, vtkSmartPointer<vtkActor>> actors,
                         QMap<QString, TopoDS_Shape> shapes,
                         int shapeCounter, const QString& topLevelName);
+    void onPartBoundsReady(QMap<QString, QVector<double>> bounds);
+    void onPartMeshed(const QString& partName, vtkSmartPointer<vtkActor> actor);
 
 private:
     void setupUI();
@@ -149,14 +237,40 @@ private:
     // 辅助函数：递归高亮
     void highlightItemRecursive(QTreeWidgetItem* item);
     
+    // 按需网格化相关
+    void setUnmeshedPartVisibility(const QString& partName, bool visible);
+    void requestPartMesh(const QString& partName);
+    void scheduleNextMesh();
+    void saveCacheIfComplete();
+    
+    // 渐进式网格化：粗网格显示后在后台线程池中细化
+    void scheduleRefinement(const QString& partName);
+    void applyRefinedMesh(const QString& partName, vtkSmartPointer<vtkPolyData> polyData,
+                          int generation);
+    double screenPixelsForBounds(const double bounds[6]) const;
+    
+    // 合批渲染相关
+    void setActorVisibility(const QString& partName, bool visible);
+    void rebuildBatches();
+    void updateBatches(const QSet<QString>& parts);
+    void scheduleBatchUpdate(const QString& partName);
+    
+    // 渲染请求
+    void requestRender(vtkRenderWindow* renderWindow);
+    
+    // 拾取/距离查询BVH
+    void scheduleBVHRebuild();
+    void rebuildSceneBVH();
+    
     // 缓存相关
     QString getCachePath(const QString& stepFilePath);
     bool isCacheValid(const QString& cachePath, const QString& stepFilePath);
     bool saveToCache(const QString& cachePath);
     bool loadFromCache(const QString& cachePath);
+    void applyCachedParts(const QString& cachePath,
+                          const QMap<QString, vtkSmartPointer<vtkPolyData>>& parts, int generation);
     
-    // 树结构保存/加载
-    bool saveTreeStructure(const QString& jsonPath);
+    // 树结构序列化/加载
     bool loadTreeStructure(const QString& jsonPath);
     QJsonObject treeItemToJson(QTreeWidgetItem* item);
     QTreeWidgetItem* jsonToTreeItem(const QJsonObject& json, QTreeWidgetItem* parent = nullptr);
@@ -166,8 +280,9 @@ private:
     QTreeWidget* m_treeWidget;
     QLabel* m_statusLabel;
     
-    // OpenCASCADE文档
+    // OpenCASCADE文档（来自共享的导入结果，m_import保证文档在使用期间不被关闭）
     Handle(TDocStd_Document) m_occDoc;
+    STEPImportResultPtr m_import;
     
     // Actor映射
     QMap<QString, vtkSmartPointer<vtkActor>> m_actorMap;
@@ -186,5 +301,48 @@ private:
     STEPLoadWorker* m_loadWorker;
     QProgressDialog* m_progressDialog;
     QString m_currentCachePath;  // 当前加载的缓存路径
+    QString m_currentFilePath;   // 当前异步加载的STEP文件路径
     vtkRenderer* m_renderer;  // VTK渲染器引用
+    
+    // 按需网格化状态
+    bool m_lazyMeshing;
+    QMap<QString, QVector<double>> m_partBounds;  // 部件包围盒（用于视锥优先级）
+    QStringList m_pendingMeshParts;               // 等待网格化的部件
+    QString m_meshInFlight;                       // 正在网格化的部件
+    QSet<QString> m_lazyHiddenParts;              // 尚未网格化但被设为隐藏的部件
+    
+    // 渐进式网格化状态
+    QThreadPool* m_refinePool;                    // 网格细化线程池
+    QSet<QString> m_refiningParts;                // 正在细化的部件
+    int m_meshGeneration;                         // 场景代数，清空场景后丢弃旧的细化结果
+    
+    bool m_loadCanceled;                          // 用户是否取消了当前加载
+    
+    // 合批渲染状态
+    bool m_batching;
+    STEPPartBatcher m_batcher;
+    QSet<QString> m_dynamicParts;                 // 由关节变换驱动、不参与合批的部件
+    vtkRenderer* m_batchRenderer;                 // 合批Actor所在的渲染器
+    QTimer* m_batchRebuildTimer;                  // 网格更新后延迟更新合批
+    QSet<QString> m_dirtyBatchParts;              // 网格变化、等待更新合批的部件
+    
+    // 场景BVH
+    std::shared_ptr<const Simulation::TriangleBVH> m_sceneBVH;
+    QTimer* m_bvhRebuildTimer;                    // 网格/可见性变化后延迟重建BVH
+    int m_bvhRequest;                             // BVH构建请求编号，丢弃过期的构建结果
+    bool m_bvhBuildInFlight;                      // 后台是否有BVH正在构建
+    
+    /**
+     * @brief 部件的世界坐标三角形（BVH构建输入）
+     *
+     * 按网格对象、修改时间和世界变换缓存，重建BVH时只重新提取变化的部件。
+     */
+    struct BVHPartMesh {
+        const vtkPolyData* source = nullptr;      // 提取时的网格（仅用于比较，不持有）
+        vtkMTimeType sourceTime = 0;
+        double matrix[16];
+        std::shared_ptr<const std::vector<double>> vertices;
+        std::shared_ptr<const std::vector<int>> indices;
+    };
+    QHash<QString, BVHPartMesh> m_bvhPartMeshes;
 };
\ No newline at end of file
@@ -0,0 +1,408 @@
+#include "STEPPartBatcher.h"
+
+#include <QDebug>
+#include <algorithm>
+
+// VTK
+#include <vtkAppendPolyData.h>
+#include <vtkCellData.h>
+#include <vtkDataSetAttributes.h>
+#include <vtkIntArray.h>
+#include <vtkLinearTransform.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkUnsignedCharArray.h>
+
+const char* const STEPPartBatcher::kPartIdArrayName = "PartId";
+
+namespace {
+
+/**
+ * @brief 生成材质分组键（颜色通过单元颜色表达，不参与分组）
+ */
+QString materialKey(vtkProperty* property)
+{
+    return QString::asprintf("%.3f/%.3f/%.3f/%.1f/%.3f/%d",
+                             property->GetAmbient(), property->GetDiffuse(),
+                             property->GetSpecular(), property->GetSpecularPower(),
+                             property->GetOpacity(), property->GetRepresentation());
+}
+
+vtkPolyData* partInput(vtkActor* actor)
+{
+    if (!actor) {
+        return nullptr;
+    }
+    vtkPolyDataMapper* mapper = vtkPolyDataMapper::SafeDownCast(actor->GetMapper());
+    vtkPolyData* input = mapper ? vtkPolyData::SafeDownCast(mapper->GetInput()) : nullptr;
+    return (input && input->GetNumberOfCells() > 0) ? input : nullptr;
+}
+
+} // namespace
+
+void STEPPartBatcher::clear()
+{
+    m_batches.clear();
+    m_partNames.clear();
+    m_partIds.clear();
+    m_partBatches.clear();
+    m_partRanges.clear();
+}
+
+QVector<vtkSmartPointer<vtkActor>> STEPPartBatcher::batchActors() const
+{
+    QVector<vtkSmartPointer<vtkActor>> actors;
+    actors.reserve(m_batches.size());
+    for (const Batch& batch : m_batches) {
+        actors.append(batch.actor);
+    }
+    return actors;
+}
+
+void STEPPartBatcher::rebuild(const QMap<QString, vtkSmartPointer<vtkActor>>& actors,
+                              const QSet<QString>& excluded)
+{
+    clear();
+    
+    // 按材质分组
+    QMap<QString, QStringList> groups;
+    for (auto it = actors.constBegin(); it != actors.constEnd(); ++it) {
+        if (excluded.contains(it.key()) || !partInput(it.value())) {
+            continue;
+        }
+        groups[materialKey(it.value()->GetProperty())].append(it.key());
+    }
+    
+    // 每组按单元数上限切分为若干合批
+    for (auto group = groups.constBegin(); group != groups.constEnd(); ++group) {
+        QStringList parts;
+        vtkIdType cellCount = 0;
+        for (const QString& partName : group.value()) {
+            const vtkIdType cells = partInput(actors.value(partName))->GetNumberOfCells();
+            
+            // 单个合批过大时，修改可见性/颜色需要重新上传的数据也会很大
+            if (cellCount > 0 && cellCount + cells > kMaxCellsPerBatch) {
+                appendBatch(group.key(), parts, cellCount);
+                parts.clear();
+                cellCount = 0;
+            }
+            parts.append(partName);
+            cellCount += cells;
+        }
+        if (!parts.isEmpty()) {
+            appendBatch(group.key(), parts, cellCount);
+        }
+    }
+    
+    for (int i = 0; i < m_batches.size(); ++i) {
+        buildBatch(i, actors);
+    }
+    
+    qDebug() << "STEPPartBatcher: 合批完成," << m_partBatches.size() << "个部件合并为"
+             << m_batches.size() << "个绘制批次";
+}
+
+QVector<vtkSmartPointer<vtkActor>> STEPPartBatcher::update(const QMap<QString, vtkSmartPointer<vtkActor>>& actors,
+                                                           const QSet<QString>& excluded,
+                                                           const QSet<QString>& parts)
+{
+    const int oldBatchCount = m_batches.size();
+    QSet<int> dirtyBatches;
+    
+    for (const QString& partName : parts) {
+        vtkActor* actor = actors.value(partName);
+        vtkPolyData* input = excluded.contains(partName) ? nullptr : partInput(actor);
+        auto batchIt = m_partBatches.constFind(partName);
+        
+        if (batchIt != m_partBatches.constEnd()) {
+            // 已合批：所在合批重新合并（网格为空或被排除时移出）
+            const int batchIndex = batchIt.value();
+            if (!input) {
+                m_batches[batchIndex].parts.removeAll(partName);
+                m_partBatches.remove(partName);
+                m_partRanges.remove(partName);
+            }
+            dirtyBatches.insert(batchIndex);
+            continue;
+        }
+        if (!input) {
+            continue;
+        }
+        
+        // 新部件：加入同材质中仍有空间的合批，否则新建合批
+        const QString material = materialKey(actor->GetProperty());
+        const vtkIdType cells = input->GetNumberOfCells();
+        int target = -1;
+        for (int i = 0; i < m_batches.size(); ++i) {
+            if (m_batches[i].material == material && m_batches[i].cellCount + cells <= kMaxCellsPerBatch) {
+                target = i;
+                break;
+            }
+        }
+        if (target < 0) {
+            appendBatch(material, QStringList(), 0);
+            target = m_batches.size() - 1;
+        }
+        m_batches[target].parts.append(partName);
+        m_batches[target].cellCount += cells;
+        m_partBatches.insert(partName, target);
+        dirtyBatches.insert(target);
+    }
+    
+    // 细化后的网格可能使合批超过单元数上限，超出的部件移到新合批
+    const QList<int> resized = dirtyBatches.values();
+    for (int batchIndex : resized) {
+        QStringList kept;
+        QStringList moved;
+        vtkIdType keptCells = 0;
+        vtkIdType movedCells = 0;
+        const QStringList batchParts = m_batches[batchIndex].parts;   // appendBatch会使m_batches重新分配
+        const QString material = m_batches[batchIndex].material;
+        for (const QString& partName : batchParts) {
+            vtkPolyData* input = partInput(actors.value(partName));
+            const vtkIdType cells = input ? input->GetNumberOfCells() : 0;
+            if (moved.isEmpty() && (keptCells == 0 || keptCells + cells <= kMaxCellsPerBatch)) {
+                kept.append(partName);
+                keptCells += cells;
+            } else {
+                if (!moved.isEmpty() && movedCells + cells > kMaxCellsPerBatch) {
+                    appendBatch(material, moved, movedCells);
+                    dirtyBatches.insert(m_batches.size() - 1);
+                    moved.clear();
+                    movedCells = 0;
+                }
+                moved.append(partName);
+                movedCells += cells;
+            }
+        }
+        if (!moved.isEmpty()) {
+            m_batches[batchIndex].parts = kept;
+            appendBatch(material, moved, movedCells);
+            dirtyBatches.insert(m_batches.size() - 1);
+        }
+    }
+    
+    for (int batchIndex : dirtyBatches) {
+        buildBatch(batchIndex, actors);
+    }
+    
+    QVector<vtkSmartPointer<vtkActor>> created;
+    for (int i = oldBatchCount; i < m_batches.size(); ++i) {
+        created.append(m_batches[i].actor);
+    }
+    qDebug() << "STEPPartBatcher: 增量合批," << parts.size() << "个部件变化，重建"
+             << dirtyBatches.size() << "/" << m_batches.size() << "个绘制批次";
+    return created;
+}
+
+void STEPPartBatcher::appendBatch(const QString& material, const QStringList& parts, vtkIdType cellCount)
+{
+    Batch batch;
+    batch.material = material;
+    batch.parts = parts;
+    batch.cellCount = cellCount;
+    batch.polyData = vtkSmartPointer<vtkPolyData>::New();
+    
+    vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    mapper->SetInputData(batch.polyData);
+    mapper->SetScalarModeToUseCellData();
+    mapper->SetColorModeToDirectScalars();
+    mapper->ScalarVisibilityOn();
+    
+    batch.actor = vtkSmartPointer<vtkActor>::New();
+    batch.actor->SetMapper(mapper);
+    if (m_userTransform) {
+        batch.actor->SetUserTransform(m_userTransform);
+    }
+    
+    const int batchIndex = m_batches.size();
+    for (const QString& partName : parts) {
+        m_partBatches.insert(partName, batchIndex);
+    }
+    m_batches.append(batch);
+}
+
+void STEPPartBatcher::buildBatch(int batchIndex, const QMap<QString, vtkSmartPointer<vtkActor>>& actors)
+{
+    Batch& batch = m_batches[batchIndex];
+    vtkSmartPointer<vtkAppendPolyData> append = vtkSmartPointer<vtkAppendPolyData>::New();
+    QStringList parts;
+    vtkIdType cellCount = 0;
+    
+    for (const QString& partName : batch.parts) {
+        m_partRanges.remove(partName);
+        vtkPolyData* input = partInput(actors.value(partName));
+        if (!input) {
+            m_partBatches.remove(partName);
+            continue;
+        }
+        
+        // 浅拷贝几何，只保留部件ID单元数组，保证所有输入的数组一致
+        const vtkIdType cells = input->GetNumberOfCells();
+        vtkSmartPointer<vtkPolyData> tagged = vtkSmartPointer<vtkPolyData>::New();
+        tagged->ShallowCopy(input);
+        tagged->GetCellData()->Initialize();
+        
+        vtkSmartPointer<vtkIntArray> partIds = vtkSmartPointer<vtkIntArray>::New();
+        partIds->SetName(kPartIdArrayName);
+        partIds->SetNumberOfTuples(cells);
+        partIds->FillValue(partId(partName));
+        tagged->GetCellData()->AddArray(partIds);
+        
+        append->AddInputData(tagged);
+        parts.append(partName);
+        cellCount += cells;
+    }
+    batch.parts = parts;
+    batch.cellCount = cellCount;
+    
+    // 替换整个输入数据，Actor保持不变，不需要重新加入渲染器
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    if (!parts.isEmpty()) {
+        append->Update();
+        polyData->ShallowCopy(append->GetOutput());
+    }
+    batch.polyData = polyData;
+    vtkPolyDataMapper::SafeDownCast(batch.actor->GetMapper())->SetInputData(polyData);
+    batch.actor->SetVisibility(!parts.isEmpty());
+    if (parts.isEmpty()) {
+        return;
+    }
+    batch.actor->GetProperty()->DeepCopy(actors.value(parts.first())->GetProperty());
+    
+    const vtkIdType cells = polyData->GetNumberOfCells();
+    vtkIntArray* partIds = vtkIntArray::SafeDownCast(polyData->GetCellData()->GetArray(kPartIdArrayName));
+    if (!partIds) {
+        qWarning() << "STEPPartBatcher: 合批网格缺少部件ID数组";
+        return;
+    }
+    
+    // 记录每个部件的连续单元区间（vtkAppendPolyData按单元类型重排，同一部件可能有多段）
+    vtkIdType runStart = 0;
+    for (vtkIdType i = 1; i <= cells; ++i) {
+        if (i == cells || partIds->GetValue(i) != partIds->GetValue(runStart)) {
+            const QString& partName = m_partNames[partIds->GetValue(runStart)];
+            m_partRanges[partName].append({batchIndex, runStart, i});
+            runStart = i;
+        }
+    }
+    
+    // 单元颜色（直接作为RGB使用）和隐藏单元标记
+    vtkSmartPointer<vtkUnsignedCharArray> colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    colors->SetName("Colors");
+    colors->SetNumberOfComponents(3);
+    colors->SetNumberOfTuples(cells);
+    colors->FillValue(255);
+    polyData->GetCellData()->SetScalars(colors);
+    
+    vtkSmartPointer<vtkUnsignedCharArray> ghosts = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    ghosts->SetName(vtkDataSetAttributes::GhostArrayName());
+    ghosts->SetNumberOfTuples(cells);
+    ghosts->FillValue(0);
+    polyData->GetCellData()->AddArray(ghosts);
+    
+    // 按部件Actor的当前状态初始化颜色和可见性
+    for (const QString& partName : parts) {
+        vtkActor* actor = actors.value(partName);
+        fillColors(partName, actor->GetProperty()->GetColor());
+        if (!actor->GetVisibility()) {
+            setPartVisibility(partName, false);
+        }
+    }
+}
+
+int STEPPartBatcher::partId(const QString& partName)
+{
+    auto it = m_partIds.constFind(partName);
+    if (it != m_partIds.constEnd()) {
+        return it.value();
+    }
+    const int id = m_partNames.size();
+    m_partNames.append(partName);
+    m_partIds.insert(partName, id);
+    return id;
+}
+
+void STEPPartBatcher::setPartVisibility(const QString& partName, bool visible)
+{
+    auto it = m_partRanges.constFind(partName);
+    if (it == m_partRanges.constEnd()) {
+        return;
+    }
+    
+    const unsigned char flag = visible ? 0 : vtkDataSetAttributes::HIDDENCELL;
+    for (const CellRange& range : it.value()) {
+        vtkPolyData* polyData = m_batches[range.batch].polyData;
+        vtkUnsignedCharArray* ghosts = vtkUnsignedCharArray::SafeDownCast(
+            polyData->GetCellData()->GetArray(vtkDataSetAttributes::GhostArrayName()));
+        if (!ghosts) {
+            continue;
+        }
+        std::fill(ghosts->GetPointer(range.begin), ghosts->GetPointer(range.end), flag);
+        ghosts->Modified();
+        polyData->Modified();
+    }
+}
+
+void STEPPartBatcher::fillColors(const QString& partName, const double color[3])
+{
+    const unsigned char rgb[3] = {
+        static_cast<unsigned char>(std::clamp(color[0], 0.0, 1.0) * 255.0 + 0.5),
+        static_cast<unsigned char>(std::clamp(color[1], 0.0, 1.0) * 255.0 + 0.5),
+        static_cast<unsigned char>(std::clamp(color[2], 0.0, 1.0) * 255.0 + 0.5)
+    };
+    
+    for (const CellRange& range : m_partRanges.value(partName)) {
+        vtkUnsignedCharArray* colors = vtkUnsignedCharArray::SafeDownCast(
+            m_batches[range.batch].polyData->GetCellData()->GetScalars());
+        if (!colors) {
+            continue;
+        }
+        unsigned char* data = colors->GetPointer(0);
+        for (vtkIdType i = range.begin; i < range.end; ++i) {
+            std::copy(rgb, rgb + 3, data + 3 * i);
+        }
+    }
+}
+
+void STEPPartBatcher::updatePartColors(const QMap<QString, vtkSmartPointer<vtkActor>>& actors)
+{
+    for (auto it = m_partBatches.constBegin(); it != m_partBatches.constEnd(); ++it) {
+        vtkActor* actor = actors.value(it.key());
+        if (actor) {
+            fillColors(it.key(), actor->GetProperty()->GetColor());
+        }
+    }
+    
+    for (const Batch& batch : m_batches) {
+        vtkDataArray* colors = batch.polyData->GetCellData()->GetScalars();
+        if (colors) {
+            colors->Modified();
+            batch.polyData->Modified();
+        }
+    }
+}
+
+void STEPPartBatcher::setUserTransform(vtkLinearTransform* transform)
+{
+    m_userTransform = transform;
+    for (const Batch& batch : m_batches) {
+        batch.actor->SetUserTransform(transform);
+    }
+}
+
+QString STEPPartBatcher::partAt(vtkProp* prop, vtkIdType cellId) const
+{
+    for (const Batch& batch : m_batches) {
+        if (batch.actor.GetPointer() != prop) {
+            continue;
+        }
+        vtkIntArray* partIds = vtkIntArray::SafeDownCast(
+            batch.polyData->GetCellData()->GetArray(kPartIdArrayName));
+        if (!partIds || cellId < 0 || cellId >= partIds->GetNumberOfTuples()) {
+            return QString();
+        }
+        return m_partNames.value(partIds->GetValue(cellId));
+    }
+    return QString();
+}
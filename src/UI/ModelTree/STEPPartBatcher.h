@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+#include <vtkPolyData.h>
+
+class vtkProp;
+class vtkLinearTransform;
+class vtkProperty;
+
+/**
+ * @brief 静态部件合批渲染
+ * 
+ * 将材质相同且不会单独运动的部件合并为少量大网格，减少绘制调用。
+ * 合并网格带有逐单元的部件ID数组，可见性（隐藏单元标记）、高亮（单元颜色）
+ * 和拾取仍可按部件进行。部件的独立Actor仍由调用方持有，作为合批的数据源。
+ */
+class STEPPartBatcher {
+public:
+    static constexpr vtkIdType kMaxCellsPerBatch = 1000000;  // 单个合批网格的最大单元数
+    static const char* const kPartIdArrayName;
+
+    /**
+     * @brief 根据部件Actor重新生成合批网格
+     * 
+     * 部件的颜色和可见性取自各自Actor的当前状态。
+     * @param actors 部件Actor映射
+     * @param excluded 不参与合批的部件（如由关节变换驱动的机器人连杆）
+     */
+    void rebuild(const QMap<QString, vtkSmartPointer<vtkActor>>& actors, const QSet<QString>& excluded);
+
+    /**
+     * @brief 只重建包含指定部件的合批网格（网格细化、按需网格化后调用）
+     * 
+     * 已合批部件所在的合批按部件Actor的当前网格重新合并；新部件加入同材质中仍有空间的合批，
+     * 否则新建合批；被排除或网格为空的部件移出合批。其余合批保持不变，不需要重新上传。
+     * @param actors 部件Actor映射
+     * @param excluded 不参与合批的部件
+     * @param parts 网格或状态发生变化的部件
+     * @return 新建的合批Actor，需由调用方加入渲染器
+     */
+    QVector<vtkSmartPointer<vtkActor>> update(const QMap<QString, vtkSmartPointer<vtkActor>>& actors,
+                                              const QSet<QString>& excluded, const QSet<QString>& parts);
+
+    /**
+     * @brief 清空所有合批网格
+     */
+    void clear();
+
+    bool isEmpty() const { return m_batches.isEmpty(); }
+    bool contains(const QString& partName) const { return m_partBatches.contains(partName); }
+    int batchCount() const { return m_batches.size(); }
+
+    /**
+     * @brief 获取所有合批Actor
+     */
+    QVector<vtkSmartPointer<vtkActor>> batchActors() const;
+
+    /**
+     * @brief 设置合批中某个部件的可见性
+     */
+    void setPartVisibility(const QString& partName, bool visible);
+
+    /**
+     * @brief 按部件Actor的当前颜色刷新合批网格的单元颜色（用于高亮）
+     */
+    void updatePartColors(const QMap<QString, vtkSmartPointer<vtkActor>>& actors);
+
+    /**
+     * @brief 应用变换到所有合批Actor
+     */
+    void setUserTransform(vtkLinearTransform* transform);
+
+    /**
+     * @brief 根据拾取结果查找部件名称
+     * @param prop 拾取到的Actor
+     * @param cellId 拾取到的单元ID
+     * @return 部件名称，不是合批Actor时返回空
+     */
+    QString partAt(vtkProp* prop, vtkIdType cellId) const;
+
+private:
+    struct Batch {
+        vtkSmartPointer<vtkActor> actor;
+        vtkSmartPointer<vtkPolyData> polyData;
+        QString material;                               // 材质分组键
+        QStringList parts;                              // 合批中的部件
+        vtkIdType cellCount = 0;
+    };
+
+    // 部件在合批网格中的单元区间 [begin, end)
+    struct CellRange {
+        int batch;
+        vtkIdType begin;
+        vtkIdType end;
+    };
+
+    void appendBatch(const QString& material, const QStringList& parts, vtkIdType cellCount);
+    void buildBatch(int batchIndex, const QMap<QString, vtkSmartPointer<vtkActor>>& actors);
+    void fillColors(const QString& partName, const double color[3]);
+    int partId(const QString& partName);
+
+    QVector<Batch> m_batches;
+    QStringList m_partNames;                            // 部件ID -> 部件名称
+    QHash<QString, int> m_partIds;                      // 部件名称 -> 部件ID（重建合批时保持不变）
+    QHash<QString, int> m_partBatches;                  // 部件名称 -> 所在合批
+    QHash<QString, QVector<CellRange>> m_partRanges;    // 部件名称 -> 单元区间
+    vtkSmartPointer<vtkLinearTransform> m_userTransform;
+};
@@ -0,0 +1,104 @@
+#include "ShapeTessellator.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+
+// OpenCASCADE
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <IMeshTools_Parameters.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRep_Tool.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopLoc_Location.hxx>
+#include <Poly_Triangulation.hxx>
+
+// VTK
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+
+QMutex ShapeTessellator::s_topologyMutex;
+
+vtkSmartPointer<vtkPolyData> ShapeTessellator::tessellateCoarse(const TopoDS_Shape& shape,
+                                                              const Message_ProgressRange& range)
+{
+    IMeshTools_Parameters params;
+    params.Deflection = kCoarseRelativeDeflection;
+    params.Angle = kCoarseAngularDeflection;
+    params.Relative = Standard_True;
+    params.InParallel = Standard_False;
+    
+    QMutexLocker locker(&s_topologyMutex);
+    BRepMesh_IncrementalMesh mesh(shape, params, range);
+    if (range.UserBreak()) {
+        return nullptr;
+    }
+    return extractPolyData(shape);
+}
+
+vtkSmartPointer<vtkPolyData> ShapeTessellator::tessellateFine(const TopoDS_Shape& shape, double chordError)
+{
+    TopoDS_Shape copy;
+    {
+        QMutexLocker locker(&s_topologyMutex);
+        BRepBuilderAPI_Copy copier(shape, Standard_True, Standard_False);
+        copy = copier.Shape();
+    }
+    
+    BRepMesh_IncrementalMesh mesh(copy, chordError, Standard_False,
+                                  kFineAngularDeflection, Standard_False);
+    return extractPolyData(copy);
+}
+
+double ShapeTessellator::targetChordError(double partDiagonal, double screenPixels)
+{
+    // 屏幕误差换算到世界坐标：一个像素约对应 对角线/投影像素 毫米
+    double screenError = kScreenPixelTolerance * partDiagonal / std::max(screenPixels, 1.0);
+    double sizeError = kMaxRelativeChordError * partDiagonal;
+    return std::max(kMinChordError, std::min(screenError, sizeError));
+}
+
+vtkSmartPointer<vtkPolyData> ShapeTessellator::extractPolyData(const TopoDS_Shape& shape)
+{
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> triangles = vtkSmartPointer<vtkCellArray>::New();
+    
+    // 遍历所有面
+    for (TopExp_Explorer exp(shape, TopAbs_FACE); exp.More(); exp.Next()) {
+        TopoDS_Face face = TopoDS::Face(exp.Current());
+        TopLoc_Location loc;
+        Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, loc);
+        
+        if (triangulation.IsNull()) continue;
+        
+        gp_Trsf transform = loc.Transformation();
+        vtkIdType offset = points->GetNumberOfPoints();
+        
+        // 添加顶点 - OCC 7.7 API
+        Standard_Integer nbNodes = triangulation->NbNodes();
+        for (Standard_Integer i = 1; i <= nbNodes; i++) {
+            gp_Pnt p = triangulation->Node(i).Transformed(transform);
+            points->InsertNextPoint(p.X(), p.Y(), p.Z());
+        }
+        
+        // 添加三角形
+        Standard_Integer nbTriangles = triangulation->NbTriangles();
+        for (Standard_Integer i = 1; i <= nbTriangles; i++) {
+            Standard_Integer n1, n2, n3;
+            triangulation->Triangle(i).Get(n1, n2, n3);
+            
+            vtkIdType ids[3] = {offset + n1 - 1, offset + n2 - 1, offset + n3 - 1};
+            triangles->InsertNextCell(3, ids);
+        }
+    }
+    
+    if (points->GetNumberOfPoints() == 0) {
+        return nullptr;
+    }
+    
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetPolys(triangles);
+    return polyData;
+}
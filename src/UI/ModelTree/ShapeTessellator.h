@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QMutex>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <TopoDS_Shape.hxx>
+#include <Message_ProgressRange.hxx>
+
+/**
+ * @brief OpenCASCADE形状网格化工具
+ * 
+ * 支持渐进式网格化：先用相对偏差快速生成粗网格用于首屏显示，
+ * 再根据部件尺寸和屏幕投影尺寸计算目标弦高误差，在后台线程细化。
+ */
+class ShapeTessellator {
+public:
+    // 粗网格参数：相对偏差（相对于边的尺寸）和角度偏差（弧度）
+    static constexpr double kCoarseRelativeDeflection = 0.05;
+    static constexpr double kCoarseAngularDeflection = 0.8;
+
+    // 细网格参数
+    static constexpr double kFineAngularDeflection = 0.2;
+    static constexpr double kMinChordError = 0.01;             // 弦高误差下限 (mm)
+    static constexpr double kMaxRelativeChordError = 0.001;    // 弦高误差上限（相对包围盒对角线）
+    static constexpr double kScreenPixelTolerance = 0.5;       // 允许的屏幕误差 (像素)
+
+    /**
+     * @brief 生成粗网格（直接在原形状上网格化）
+     * @param shape 形状
+     * @param range 进度范围，取消时网格化提前结束
+     * @return 网格数据，形状无三角面时返回空
+     */
+    static vtkSmartPointer<vtkPolyData> tessellateCoarse(const TopoDS_Shape& shape,
+        const Message_ProgressRange& range = Message_ProgressRange());
+
+    /**
+     * @brief 生成细网格
+     * 
+     * 在形状的几何副本上网格化，不修改原形状上已有的三角剖分，
+     * 因此可以在后台线程中与其他网格化任务并行执行。
+     * @param shape 形状
+     * @param chordError 目标弦高误差 (mm)
+     */
+    static vtkSmartPointer<vtkPolyData> tessellateFine(const TopoDS_Shape& shape, double chordError);
+
+    /**
+     * @brief 根据部件尺寸和屏幕尺寸计算目标弦高误差
+     * @param partDiagonal 部件包围盒对角线长度 (mm)
+     * @param screenPixels 部件在屏幕上的投影尺寸 (像素)
+     * @return 弦高误差 (mm)
+     */
+    static double targetChordError(double partDiagonal, double screenPixels);
+
+    /**
+     * @brief 从形状已有的三角剖分提取VTK网格
+     */
+    static vtkSmartPointer<vtkPolyData> extractPolyData(const TopoDS_Shape& shape);
+
+private:
+    // 网格化会写入共享TShape上的三角剖分，实例化部件可能共享同一TShape，
+    // 因此对原形状的网格化和复制需要串行
+    static QMutex s_topologyMutex;
+};
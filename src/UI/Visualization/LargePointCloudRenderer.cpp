@@ -0,0 +1,382 @@
+#include "LargePointCloudRenderer.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// VTK includes
+#include <vtkCommand.h>
+#include <vtkDataArray.h>
+#include <vtkEDLShading.h>
+#include <vtkFloatArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkOpenGLRenderer.h>
+#include <vtkPointData.h>
+#include <vtkPointGaussianMapper.h>
+#include <vtkPoints.h>
+#include <vtkProperty.h>
+#include <vtkRenderStepsPass.h>
+#include <vtkRenderWindow.h>
+#include <vtkScalarsToColors.h>
+#include <vtkUnsignedCharArray.h>
+
+namespace UI {
+
+namespace {
+
+const vtkIdType kMinLevelPoints = 200000;   // 最粗层级的点数下限
+const int kLevelFactor = 4;                 // 相邻层级点数之比
+const double kMaxPointScale = 4.0;          // 粗层级点尺寸最大放大倍数
+
+/**
+ * @brief 复制数组的前count个元组
+ */
+vtkSmartPointer<vtkDataArray> prefixCopy(vtkDataArray* source, vtkIdType count)
+{
+    vtkSmartPointer<vtkDataArray> copy = vtkSmartPointer<vtkDataArray>::Take(source->NewInstance());
+    copy->SetName(source->GetName());
+    copy->SetNumberOfComponents(source->GetNumberOfComponents());
+    copy->SetNumberOfTuples(count);
+    copy->InsertTuples(0, count, 0, source);
+    return copy;
+}
+
+} // namespace
+
+LargePointCloudRenderer::LargePointCloudRenderer()
+    : m_actor(vtkSmartPointer<vtkActor>::New())
+    , m_startObserverTag(0)
+    , m_endObserverTag(0)
+    , m_currentLevel(-1)
+    , m_frameInteractive(false)
+    , m_eyeDomeLighting(true)
+    , m_basePointSize(1.5)
+    , m_targetFrameMs(16.0)
+    , m_pointsPerMs(100000.0)
+    , m_stillBudget(50000000)
+{
+    m_actor->GetProperty()->SetColor(0.8, 0.2, 0.2);
+    m_actor->GetProperty()->SetRenderPointsAsSpheres(false);
+}
+
+LargePointCloudRenderer::~LargePointCloudRenderer()
+{
+    detach();
+}
+
+bool LargePointCloudRenderer::setPointCloud(vtkPolyData* cloud)
+{
+    if (!cloud || !cloud->GetPoints() || cloud->GetNumberOfPoints() == 0) {
+        qWarning() << "LargePointCloudRenderer: 点云为空";
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    vtkPoints* sourcePoints = cloud->GetPoints();
+    const vtkIdType count = sourcePoints->GetNumberOfPoints();
+
+    vtkDataArray* sourceColors = cloud->GetPointData()->GetScalars();
+    if (sourceColors && (sourceColors->GetDataType() != VTK_UNSIGNED_CHAR ||
+                         sourceColors->GetNumberOfComponents() < 3)) {
+        sourceColors = nullptr;
+    }
+
+    // 打乱点顺序（固定种子，结果可复现），任意前缀都是均匀子采样
+    std::vector<vtkIdType> order(static_cast<size_t>(count));
+    for (vtkIdType i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    std::mt19937_64 random(0x5eed);
+    std::shuffle(order.begin(), order.end(), random);
+
+    vtkSmartPointer<vtkFloatArray> coordinates = vtkSmartPointer<vtkFloatArray>::New();
+    coordinates->SetNumberOfComponents(3);
+    coordinates->SetNumberOfTuples(count);
+    float* xyz = coordinates->GetPointer(0);
+    double p[3];
+    for (vtkIdType i = 0; i < count; ++i) {
+        sourcePoints->GetPoint(order[i], p);
+        xyz[i * 3] = static_cast<float>(p[0]);
+        xyz[i * 3 + 1] = static_cast<float>(p[1]);
+        xyz[i * 3 + 2] = static_cast<float>(p[2]);
+    }
+
+    vtkSmartPointer<vtkUnsignedCharArray> colors;
+    if (sourceColors) {
+        const int components = sourceColors->GetNumberOfComponents();
+        colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+        colors->SetName("Colors");
+        colors->SetNumberOfComponents(components);
+        colors->SetNumberOfTuples(count);
+        const unsigned char* src = static_cast<const unsigned char*>(sourceColors->GetVoidPointer(0));
+        unsigned char* dst = colors->GetPointer(0);
+        for (vtkIdType i = 0; i < count; ++i) {
+            std::copy(src + order[i] * components, src + (order[i] + 1) * components, dst + i * components);
+        }
+    }
+
+    // 层级：全分辨率，1/4，1/16 ... 直到不足kMinLevelPoints
+    if (m_renderer) {
+        for (const Level& level : m_levels) {
+            m_renderer->RemoveActor(level.actor);
+        }
+    }
+    m_levels.clear();
+    m_currentLevel = -1;
+    for (vtkIdType levelCount = count; ; levelCount /= kLevelFactor) {
+        Level level;
+        level.count = levelCount;
+        level.pointScale = std::min(kMaxPointScale, std::sqrt(static_cast<double>(count) / levelCount));
+
+        vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+        if (levelCount == count) {
+            points->SetData(coordinates);
+        } else {
+            points->SetData(prefixCopy(coordinates, levelCount));
+        }
+        level.data = vtkSmartPointer<vtkPolyData>::New();
+        level.data->SetPoints(points);
+        if (colors) {
+            level.colors = levelCount == count ? vtkSmartPointer<vtkDataArray>(colors)
+                                               : prefixCopy(colors, levelCount);
+            level.data->GetPointData()->SetScalars(level.colors);
+        }
+
+        // 缩放因子为0时按点图元绘制，点尺寸取自Actor属性
+        level.mapper = vtkSmartPointer<vtkPointGaussianMapper>::New();
+        level.mapper->SetInputData(level.data);
+        level.mapper->SetScaleFactor(0.0);
+        level.mapper->EmissiveOff();
+        level.mapper->SetScalarVisibility(colors != nullptr);
+        level.mapper->SetColorModeToDirectScalars();
+
+        // 每层的点尺寸固定，切换层级时不修改属性，避免重建顶点缓冲
+        level.actor = vtkSmartPointer<vtkActor>::New();
+        level.actor->SetMapper(level.mapper);
+        level.actor->GetProperty()->DeepCopy(m_actor->GetProperty());
+        level.actor->GetProperty()->SetPointSize(m_basePointSize * level.pointScale);
+        level.actor->SetVisibility(false);
+        if (m_renderer) {
+            m_renderer->AddActor(level.actor);
+        }
+        m_levels.push_back(level);
+
+        if (levelCount / kLevelFactor < kMinLevelPoints) {
+            break;
+        }
+    }
+
+    useLevel(0);
+    qDebug() << "LargePointCloudRenderer: 点数" << count << "LOD层级" << m_levels.size()
+             << "颜色" << (colors != nullptr) << "耗时" << timer.elapsed() << "ms";
+    return true;
+}
+
+void LargePointCloudRenderer::attach(vtkRenderer* renderer)
+{
+    if (renderer == m_renderer) {
+        return;
+    }
+    detach();
+    if (!renderer) {
+        return;
+    }
+
+    m_renderer = renderer;
+    for (const Level& level : m_levels) {
+        m_renderer->AddActor(level.actor);
+    }
+    m_startObserverTag = m_renderer->AddObserver(vtkCommand::StartEvent, this,
+                                                 &LargePointCloudRenderer::onStartRender);
+    m_endObserverTag = m_renderer->AddObserver(vtkCommand::EndEvent, this,
+                                               &LargePointCloudRenderer::onEndRender);
+    applyEyeDomeLighting();
+}
+
+void LargePointCloudRenderer::detach()
+{
+    if (!m_renderer) {
+        return;
+    }
+
+    m_renderer->RemoveObserver(m_startObserverTag);
+    m_renderer->RemoveObserver(m_endObserverTag);
+    for (const Level& level : m_levels) {
+        m_renderer->RemoveActor(level.actor);
+    }
+
+    vtkOpenGLRenderer* glRenderer = vtkOpenGLRenderer::SafeDownCast(m_renderer);
+    if (glRenderer && m_edlPass && glRenderer->GetPass() == m_edlPass) {
+        glRenderer->SetPass(nullptr);
+    }
+    m_renderer = nullptr;
+}
+
+vtkPolyData* LargePointCloudRenderer::fullResolution() const
+{
+    return m_levels.empty() ? nullptr : m_levels.front().data.Get();
+}
+
+vtkIdType LargePointCloudRenderer::pointCount() const
+{
+    return m_levels.empty() ? 0 : m_levels.front().count;
+}
+
+vtkIdType LargePointCloudRenderer::renderedPointCount() const
+{
+    return m_currentLevel >= 0 ? m_levels[m_currentLevel].count : 0;
+}
+
+void LargePointCloudRenderer::setBasePointSize(double size)
+{
+    m_basePointSize = std::max(1.0, size);
+    for (Level& level : m_levels) {
+        level.actor->GetProperty()->SetPointSize(m_basePointSize * level.pointScale);
+    }
+}
+
+void LargePointCloudRenderer::setEyeDomeLighting(bool enabled)
+{
+    if (m_eyeDomeLighting == enabled) {
+        return;
+    }
+    m_eyeDomeLighting = enabled;
+    applyEyeDomeLighting();
+}
+
+void LargePointCloudRenderer::setPointScalars(vtkDataArray* scalars, vtkScalarsToColors* lookupTable,
+                                              double minValue, double maxValue)
+{
+    if (!scalars || m_levels.empty() || scalars->GetNumberOfTuples() != pointCount()) {
+        qWarning() << "LargePointCloudRenderer: 标量数量与点数不一致";
+        return;
+    }
+
+    for (Level& level : m_levels) {
+        level.data->GetPointData()->SetScalars(level.count == pointCount()
+                                                   ? vtkSmartPointer<vtkDataArray>(scalars)
+                                                   : prefixCopy(scalars, level.count));
+        level.mapper->SetLookupTable(lookupTable);
+        level.mapper->SetScalarRange(minValue, maxValue);
+        level.mapper->SetColorModeToMapScalars();
+        level.mapper->ScalarVisibilityOn();
+    }
+}
+
+void LargePointCloudRenderer::clearPointScalars()
+{
+    for (Level& level : m_levels) {
+        level.data->GetPointData()->SetScalars(level.colors);
+        level.mapper->SetColorModeToDirectScalars();
+        level.mapper->SetScalarVisibility(level.colors != nullptr);
+    }
+}
+
+void LargePointCloudRenderer::onStartRender(vtkObject* caller, unsigned long eventId, void* callData)
+{
+    Q_UNUSED(caller);
+    Q_UNUSED(eventId);
+    Q_UNUSED(callData);
+
+    if (m_levels.empty()) {
+        return;
+    }
+    syncLevelActors();
+    if (!m_actor->GetVisibility()) {
+        return;
+    }
+
+    // 交互器在旋转/平移期间把期望帧率设为交互帧率，结束后恢复为静止帧率
+    vtkRenderWindow* window = m_renderer->GetRenderWindow();
+    const double desiredRate = window ? window->GetDesiredUpdateRate() : 0.0;
+    m_frameInteractive = desiredRate > 1.0;
+
+    vtkIdType budget = m_stillBudget;
+    if (m_frameInteractive) {
+        const double frameMs = std::min(m_targetFrameMs, 1000.0 / desiredRate);
+        // 预留两成时间给场景中的其他对象
+        budget = std::min(budget, static_cast<vtkIdType>(m_pointsPerMs * frameMs * 0.8));
+    }
+    useLevel(selectLevel(budget));
+}
+
+void LargePointCloudRenderer::onEndRender(vtkObject* caller, unsigned long eventId, void* callData)
+{
+    Q_UNUSED(caller);
+    Q_UNUSED(eventId);
+    Q_UNUSED(callData);
+
+    // 静止帧（全分辨率、首次上传顶点缓冲）不代表交互吞吐量
+    if (!m_frameInteractive || m_currentLevel < 0) {
+        return;
+    }
+
+    const double frameMs = m_renderer->GetLastRenderTimeInSeconds() * 1000.0;
+    if (frameMs <= 0.0) {
+        return;
+    }
+    const double rate = m_levels[m_currentLevel].count / frameMs;
+    // 单帧增长限制为2倍，避免一次测量偏快导致下一帧跳到过细的层级
+    m_pointsPerMs = 0.7 * m_pointsPerMs + 0.3 * std::min(rate, m_pointsPerMs * 2.0);
+}
+
+int LargePointCloudRenderer::selectLevel(vtkIdType budget) const
+{
+    for (size_t i = 0; i < m_levels.size(); ++i) {
+        if (m_levels[i].count <= budget) {
+            return static_cast<int>(i);
+        }
+    }
+    return static_cast<int>(m_levels.size()) - 1;
+}
+
+void LargePointCloudRenderer::useLevel(int level)
+{
+    if (level == m_currentLevel || level < 0 || level >= static_cast<int>(m_levels.size())) {
+        return;
+    }
+    if (m_currentLevel >= 0) {
+        m_levels[m_currentLevel].actor->SetVisibility(false);
+    }
+    m_currentLevel = level;
+    m_levels[level].actor->SetVisibility(m_actor->GetVisibility());
+}
+
+void LargePointCloudRenderer::syncLevelActors()
+{
+    // 代理Actor的可见性和用户矩阵（如配准变换）由外部设置
+    vtkMatrix4x4* matrix = m_actor->GetUserMatrix();
+    const bool visible = m_actor->GetVisibility() != 0;
+    for (size_t i = 0; i < m_levels.size(); ++i) {
+        vtkActor* actor = m_levels[i].actor;
+        if (actor->GetUserMatrix() != matrix) {
+            actor->SetUserMatrix(matrix);
+        }
+        actor->SetVisibility(visible && static_cast<int>(i) == m_currentLevel);
+    }
+}
+
+void LargePointCloudRenderer::applyEyeDomeLighting()
+{
+    vtkOpenGLRenderer* glRenderer = vtkOpenGLRenderer::SafeDownCast(m_renderer);
+    if (!glRenderer) {
+        return;
+    }
+
+    if (m_eyeDomeLighting) {
+        if (!m_edlPass) {
+            vtkSmartPointer<vtkRenderStepsPass> basicPasses = vtkSmartPointer<vtkRenderStepsPass>::New();
+            m_edlPass = vtkSmartPointer<vtkEDLShading>::New();
+            m_edlPass->SetDelegatePass(basicPasses);
+        }
+        glRenderer->SetPass(m_edlPass);
+    } else if (m_edlPass && glRenderer->GetPass() == m_edlPass) {
+        glRenderer->SetPass(nullptr);
+    }
+}
+
+} // namespace UI
@@ -0,0 +1,135 @@
+#ifndef LARGEPOINTCLOUDRENDERER_H
+#define LARGEPOINTCLOUDRENDERER_H
+
+#include <vector>
+
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+
+class vtkDataArray;
+class vtkEDLShading;
+class vtkObject;
+class vtkPointGaussianMapper;
+class vtkScalarsToColors;
+
+namespace UI {
+
+/**
+ * @brief 大规模点云渲染（千万级点）
+ *
+ * - 加载时把点打乱一次，任意前缀都是均匀子采样；按1/4递减生成LOD层级，
+ *   每层一个Actor和vtkPointGaussianMapper，点尺寸在创建时设定；切换层级只改变Actor可见性，
+ *   顶点缓冲只在首次绘制时上传，之后切换层级不再上传
+ * - 每帧开始时按点预算选择层级：静止时绘制不超过静止预算的最细层级，
+ *   交互（旋转/平移）时按上一帧实测吞吐量把帧时间控制在目标值附近
+ * - 粗层级自动放大点尺寸（屏幕空间splat）填补稀疏处的空洞
+ * - 可选眼罩光照（EDL）增强深度感，作用于整个渲染器
+ *
+ * 只绘制点，不需要顶点单元，相比vtkVertexGlyphFilter省去每点两个整数的单元数组。
+ * 需在GUI线程中使用。
+ */
+class LargePointCloudRenderer
+{
+public:
+    LargePointCloudRenderer();
+    ~LargePointCloudRenderer();
+
+    /**
+     * @brief 设置点云
+     * @param cloud 点云，点标量为unsigned char的RGB(A)时作为颜色
+     * @return 是否成功
+     */
+    bool setPointCloud(vtkPolyData* cloud);
+
+    /**
+     * @brief 添加到渲染器并开始按帧选择层级
+     */
+    void attach(vtkRenderer* renderer);
+
+    /**
+     * @brief 从渲染器移除
+     */
+    void detach();
+
+    /**
+     * @brief 代理Actor：本身不参与绘制，其可见性和用户矩阵在每帧开始时同步到各层级的Actor
+     */
+    vtkActor* actor() const { return m_actor; }
+
+    /**
+     * @brief 全分辨率点云（点顺序已打乱，偏差等逐点结果需按此顺序对应）
+     */
+    vtkPolyData* fullResolution() const;
+
+    vtkIdType pointCount() const;
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    vtkIdType renderedPointCount() const;
+
+    /**
+     * @brief 静止时最多绘制的点数
+     */
+    void setStillPointBudget(vtkIdType budget) { m_stillBudget = budget; }
+
+    /**
+     * @brief 交互时的目标帧时间 (ms)
+     */
+    void setTargetFrameTime(double ms) { m_targetFrameMs = ms; }
+
+    /**
+     * @brief 全分辨率时的点尺寸（像素），粗层级按稀疏程度放大
+     */
+    void setBasePointSize(double size);
+
+    void setEyeDomeLighting(bool enabled);
+    bool eyeDomeLighting() const { return m_eyeDomeLighting; }
+
+    /**
+     * @brief 按标量着色（如偏差），标量与fullResolution的点一一对应
+     */
+    void setPointScalars(vtkDataArray* scalars, vtkScalarsToColors* lookupTable, double minValue, double maxValue);
+
+    /**
+     * @brief 恢复点云原始颜色
+     */
+    void clearPointScalars();
+
+private:
+    struct Level {
+        vtkIdType count = 0;
+        double pointScale = 1.0;
+        vtkSmartPointer<vtkPolyData> data;
+        vtkSmartPointer<vtkPointGaussianMapper> mapper;
+        vtkSmartPointer<vtkActor> actor;
+        vtkSmartPointer<vtkDataArray> colors;
+    };
+
+    void onStartRender(vtkObject* caller, unsigned long eventId, void* callData);
+    void onEndRender(vtkObject* caller, unsigned long eventId, void* callData);
+    int selectLevel(vtkIdType budget) const;
+    void useLevel(int level);
+    void syncLevelActors();
+    void applyEyeDomeLighting();
+
+private:
+    std::vector<Level> m_levels;
+    vtkSmartPointer<vtkActor> m_actor;
+    vtkSmartPointer<vtkRenderer> m_renderer;
+    vtkSmartPointer<vtkEDLShading> m_edlPass;
+
+    unsigned long m_startObserverTag;
+    unsigned long m_endObserverTag;
+
+    int m_currentLevel;
+    bool m_frameInteractive;
+    bool m_eyeDomeLighting;
+    double m_basePointSize;
+    double m_targetFrameMs;
+    double m_pointsPerMs;       // 交互帧实测吞吐量（指数平滑）
+    vtkIdType m_stillBudget;
+};
+
+} // namespace UI
+
+#endif // LARGEPOINTCLOUDRENDERER_H
@@ -0,0 +1,143 @@
+#include "RenderScheduler.h"
+
+#include <QDebug>
+#include <QEvent>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+namespace UI {
+
+RenderScheduler::RenderScheduler(vtkRenderWindow* renderWindow, QWidget* viewWidget, QObject* parent)
+    : QObject(parent)
+    , m_renderWindow(renderWindow)
+    , m_viewWidget(viewWidget)
+    , m_frameTimer(new QTimer(this))
+    , m_dirty(false)
+    , m_rendering(false)
+    , m_maxFps(60)
+    , m_idleFps(10)
+    , m_requestCount(0)
+    , m_frameCount(0)
+{
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, &RenderScheduler::renderFrame);
+
+    // 回到前台时按前台帧率补上积压的一帧
+    connect(qGuiApp, &QGuiApplication::applicationStateChanged, this, [this](Qt::ApplicationState) {
+        if (m_dirty) {
+            m_frameTimer->stop();
+            scheduleFrame();
+        }
+    });
+
+    if (m_viewWidget) {
+        m_viewWidget->installEventFilter(this);
+    }
+
+    m_sinceLastFrame.start();
+}
+
+void RenderScheduler::requestRender()
+{
+    ++m_requestCount;
+    m_dirty = true;
+    if (!m_rendering) {
+        scheduleFrame();
+    }
+}
+
+void RenderScheduler::renderNow()
+{
+    m_frameTimer->stop();
+    m_dirty = true;
+    renderFrame();
+}
+
+void RenderScheduler::setMaxFps(int fps)
+{
+    m_maxFps = std::max(1, fps);
+    qDebug() << "RenderScheduler: 帧率上限" << m_maxFps << "FPS";
+}
+
+void RenderScheduler::setIdleFps(int fps)
+{
+    m_idleFps = std::max(1, fps);
+}
+
+void RenderScheduler::scheduleFrame()
+{
+    if (m_frameTimer->isActive()) {
+        return;
+    }
+
+    // 距上一帧不足一个帧间隔时等到下一个帧时刻，期间的请求都合并到这一帧
+    const qint64 wait = frameIntervalMs() - m_sinceLastFrame.elapsed();
+    m_frameTimer->start(static_cast<int>(std::max<qint64>(0, wait)));
+}
+
+void RenderScheduler::renderFrame()
+{
+    if (!m_dirty || !m_renderWindow) {
+        return;
+    }
+
+    // 不可见时保留脏标记，重新显示时再渲染
+    if (!isViewVisible()) {
+        return;
+    }
+
+    m_dirty = false;
+    m_rendering = true;
+    QElapsedTimer renderTimer;
+    renderTimer.start();
+
+    m_renderWindow->Render();
+    if (m_viewWidget) {
+        m_viewWidget->update();
+    }
+
+    m_rendering = false;
+    m_sinceLastFrame.restart();
+    ++m_frameCount;
+    emit frameRendered(renderTimer.elapsed());
+
+    if (m_dirty) {
+        scheduleFrame();
+    }
+}
+
+int RenderScheduler::frameIntervalMs() const
+{
+    int fps = m_maxFps;
+    if (QGuiApplication::applicationState() != Qt::ApplicationActive) {
+        fps = std::min(fps, m_idleFps);
+    } else if (m_viewWidget && m_viewWidget->screen()) {
+        const double refreshRate = m_viewWidget->screen()->refreshRate();
+        if (refreshRate >= 1.0) {
+            fps = std::min(fps, static_cast<int>(std::lround(refreshRate)));
+        }
+    }
+    return 1000 / std::max(1, fps);
+}
+
+bool RenderScheduler::isViewVisible() const
+{
+    if (!m_viewWidget) {
+        return true;
+    }
+    return m_viewWidget->isVisible() && !m_viewWidget->window()->isMinimized();
+}
+
+bool RenderScheduler::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == m_viewWidget && event->type() == QEvent::Show && m_dirty) {
+        scheduleFrame();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+} // namespace UI
@@ -0,0 +1,104 @@
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QWidget>
+
+#include <vtkSmartPointer.h>
+#include <vtkRenderWindow.h>
+
+class QTimer;
+
+namespace UI {
+
+/**
+ * @brief 渲染调度器
+ *
+ * 调用方只标记场景已变化（requestRender），重绘合并到定时器中执行：
+ * - 每个显示帧最多渲染一次，帧率上限可配置，默认不超过屏幕刷新率
+ * - 应用程序在后台时降到空闲帧率
+ * - 视图不可见（最小化/被隐藏）时暂停渲染，重新显示后补一帧
+ *
+ * 关节滑块拖动、按需网格化等高频更新由此合并，避免每次变化都同步渲染整个场景。
+ * 需在GUI线程中使用。
+ */
+class RenderScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造
+     * @param renderWindow 被调度的渲染窗口
+     * @param viewWidget 显示该窗口的Qt控件（用于判断可见性并触发重绘）
+     * @param parent 父对象
+     */
+    RenderScheduler(vtkRenderWindow* renderWindow, QWidget* viewWidget, QObject* parent = nullptr);
+
+    /**
+     * @brief 标记场景已变化，在下一个可用帧渲染
+     */
+    void requestRender();
+
+    /**
+     * @brief 立即渲染，丢弃已排队的请求
+     */
+    void renderNow();
+
+    /**
+     * @brief 设置前台帧率上限（同时受屏幕刷新率限制）
+     * @param fps 帧率，最小为1
+     */
+    void setMaxFps(int fps);
+    int maxFps() const { return m_maxFps; }
+
+    /**
+     * @brief 设置应用程序在后台时的帧率
+     * @param fps 帧率，最小为1
+     */
+    void setIdleFps(int fps);
+    int idleFps() const { return m_idleFps; }
+
+    bool isDirty() const { return m_dirty; }
+
+    /**
+     * @brief 统计：请求次数和实际渲染帧数（两者之差即被合并的重绘）
+     */
+    quint64 requestCount() const { return m_requestCount; }
+    quint64 frameCount() const { return m_frameCount; }
+
+signals:
+    /**
+     * @brief 一帧渲染完成
+     * @param renderTimeMs 本帧渲染耗时
+     */
+    void frameRendered(qint64 renderTimeMs);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    void scheduleFrame();
+    void renderFrame();
+    int frameIntervalMs() const;
+    bool isViewVisible() const;
+
+private:
+    vtkSmartPointer<vtkRenderWindow> m_renderWindow;
+    QPointer<QWidget> m_viewWidget;
+    QTimer* m_frameTimer;
+    QElapsedTimer m_sinceLastFrame;
+
+    bool m_dirty;
+    bool m_rendering;               // 渲染过程中产生的请求顺延到下一帧
+    int m_maxFps;
+    int m_idleFps;
+    quint64 m_requestCount;
+    quint64 m_frameCount;
+};
+
+} // namespace UI
+
+#endif // RENDERSCHEDULER_H
@@ -7,7 +7,12 @@
 #include <QOpenGLShaderProgram>
 #include <QOpenGLBuffer>
 #include <QOpenGLVertexArrayObject>
+#include <QElapsedTimer>
+#include <QSurfaceFormat>
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <random>
 
 namespace UI {
 
@@ -120,33 +125,71 @@ bool Simple3DWidget::LoadPointCloud(const QString& filePath)
         
         QTextStream in(&file);
         std::vector<QVector3D> points;
+        std::vector<QVector3D> colors;
+        std::vector<QVector3D> normals;
         
-        // 跳过PLY头部
+        // 解析PLY头部，记录顶点属性的列号
         QString line;
         int vertexCount = 0;
         bool inHeader = true;
+        bool inVertexElement = false;
+        QStringList vertexProperties;
         
         while (!in.atEnd() && inHeader) {
-            line = in.readLine();
-            if (line.startsWith("element vertex")) {
-                QStringList parts = line.split(' ');
-                if (parts.size() >= 3) {
+            line = in.readLine().trimmed();
+            if (line.startsWith("element")) {
+                QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+                inVertexElement = parts.size() >= 3 && parts[1] == "vertex";
+                if (inVertexElement) {
                     vertexCount = parts[2].toInt();
                 }
+            } else if (line.startsWith("property") && inVertexElement) {
+                vertexProperties.append(line.split(' ', Qt::SkipEmptyParts).last());
             } else if (line == "end_header") {
                 inHeader = false;
             }
         }
         
+        const int columnX = std::max(0, static_cast<int>(vertexProperties.indexOf("x")));
+        const int columnY = vertexProperties.contains("y") ? static_cast<int>(vertexProperties.indexOf("y")) : 1;
+        const int columnZ = vertexProperties.contains("z") ? static_cast<int>(vertexProperties.indexOf("z")) : 2;
+        const int columnRed = static_cast<int>(vertexProperties.indexOf("red"));
+        const int columnNormalX = static_cast<int>(vertexProperties.indexOf("nx"));
+        const bool hasColors = columnRed >= 0 && vertexProperties.indexOf("green") == columnRed + 1
+                               && vertexProperties.indexOf("blue") == columnRed + 2;
+        const bool hasNormals = columnNormalX >= 0 && vertexProperties.indexOf("ny") == columnNormalX + 1
+                                && vertexProperties.indexOf("nz") == columnNormalX + 2;
+        const int requiredColumns = std::max({ columnX, columnY, columnZ,
+                                               hasColors ? columnRed + 2 : 0,
+                                               hasNormals ? columnNormalX + 2 : 0 }) + 1;
+        
+        points.reserve(vertexCount);
+        if (hasColors) {
+            colors.reserve(vertexCount);
+        }
+        if (hasNormals) {
+            normals.reserve(vertexCount);
+        }
+        
         // 读取顶点数据
         for (int i = 0; i < vertexCount && !in.atEnd(); ++i) {
             line = in.readLine();
-            QStringList coords = line.split(' ');
-            if (coords.size() >= 3) {
-                float x = coords[0].toFloat();
-                float y = coords[1].toFloat();
-                float z = coords[2].toFloat();
+            QStringList coords = line.split(' ', Qt::SkipEmptyParts);
+            if (coords.size() >= requiredColumns) {
+                float x = coords[columnX].toFloat();
+                float y = coords[columnY].toFloat();
+                float z = coords[columnZ].toFloat();
                 points.push_back(QVector3D(x, y, z));
+                if (hasColors) {
+                    colors.push_back(QVector3D(coords[columnRed].toFloat(),
+                                               coords[columnRed + 1].toFloat(),
+                                               coords[columnRed + 2].toFloat()) / 255.0f);
+                }
+                if (hasNormals) {
+                    normals.push_back(QVector3D(coords[columnNormalX].toFloat(),
+                                                coords[columnNormalX + 1].toFloat(),
+                                                coords[columnNormalX + 2].toFloat()));
+                }
             }
         }
         
@@ -155,7 +198,7 @@ bool Simple3DWidget::LoadPointCloud(const QString& filePath)
         }
         
         // 设置点云数据到渲染器
-        m_renderer->SetPointCloudData(points);
+        m_renderer->SetPointCloudData(points, colors, normals);
         
         qDebug() << "✅ 点云加载成功，点数:" << points.size();
         m_statusLabel->setText(QString("点云已加载 (%1 个点)").arg(points.size()));
@@ -221,10 +264,80 @@ void Simple3DWidget::OnClearData()
 }
 
 // Simple3DRenderer 实现
+namespace {
+
+const int kTargetPointsPerCell = 8192;      // 网格单元的目标点数
+const int kMaxGridResolution = 128;         // 每个轴最多的网格数
+const int kMinPointsPerCell = 64;           // 可见单元至少绘制的点数
+const float kFovY = 45.0f;
+const float kBasePointSize = 2.0f;
+const float kMaxPointScale = 3.0f;          // 子采样单元点尺寸最大放大倍数
+
+enum AttributeLocation {
+    PositionAttribute = 0,
+    ColorAttribute = 1,
+    NormalAttribute = 2
+};
+
+// 顶点着色器；法向用于头灯漫反射，扫描点云的法向朝向不一定一致，取绝对值
+const char* const kVertexShaderSource = R"(
+attribute vec3 a_position;
+attribute vec4 a_color;
+attribute vec3 a_normal;
+uniform mat4 u_mvp;
+uniform mat3 u_normalMatrix;
+uniform float u_pointSize;
+uniform vec4 u_color;
+uniform bool u_useColor;
+uniform bool u_useNormal;
+varying vec4 v_color;
+void main()
+{
+    gl_Position = u_mvp * vec4(a_position, 1.0);
+    gl_PointSize = u_pointSize;
+    vec4 color = u_useColor ? a_color : u_color;
+    if (u_useNormal) {
+        vec3 normal = u_normalMatrix * a_normal;
+        float len = length(normal);
+        if (len > 0.0) {
+            color.rgb *= 0.3 + 0.7 * abs(normal.z / len);
+        }
+    }
+    v_color = color;
+}
+)";
+
+const char* const kFragmentShaderSource = R"(
+void main()
+{
+    FRAG_COLOR = v_color;
+}
+)";
+
+// 坐标轴（0-5）和测试立方体（6-29）
+const int kAxesFirst = 0;
+const int kAxesCount = 6;
+const int kCubeFirst = 6;
+const int kCubeCount = 24;
+
+} // namespace
+
 Simple3DWidget::Simple3DRenderer::Simple3DRenderer(QWidget *parent)
     : QOpenGLWidget(parent)
+    , m_pointCount(0)
+    , m_renderedPointCount(0)
     , m_hasPointCloud(false)
+    , m_hasColors(false)
+    , m_hasNormals(false)
+    , m_uploadPending(false)
     , m_showTestData(false)
+    , m_stillPointBudget(20000000)
+    , m_interactivePointBudget(2000000)
+    , m_positionBuffer(QOpenGLBuffer::VertexBuffer)
+    , m_colorBuffer(QOpenGLBuffer::VertexBuffer)
+    , m_normalBuffer(QOpenGLBuffer::VertexBuffer)
+    , m_lineBuffer(QOpenGLBuffer::VertexBuffer)
+    , m_glReady(false)
     , m_cameraPos(0, 0, 5)
     , m_cameraTarget(0, 0, 0)
     , m_cameraUp(0, 1, 0)
@@ -232,20 +345,175 @@ Simple3DWidget::Simple3DRenderer::Simple3DRenderer(QWidget *parent)
     , m_cameraDistance(5.0f)
     , m_cameraYaw(0.0f)
     , m_cameraPitch(0.0f)
+    , m_sceneRadius(1.0f)
+    , m_viewportWidth(1)
+    , m_viewportHeight(1)
 {
     setFocusPolicy(Qt::StrongFocus);
 }
 
 Simple3DWidget::Simple3DRenderer::~Simple3DRenderer()
 {
-    // OpenGL资源会自动清理
+    // GPU资源需要在上下文有效时释放
+    if (m_glReady) {
+        makeCurrent();
+        releasePointBuffers();
+        m_lineBuffer.destroy();
+        m_pointVao.destroy();
+        m_lineVao.destroy();
+        m_program.removeAllShaders();
+        doneCurrent();
+    }
 }
 
-void Simple3DWidget::Simple3DRenderer::SetPointCloudData(const std::vector<QVector3D>& points)
+void Simple3DWidget::Simple3DRenderer::SetPointCloudData(const std::vector<QVector3D>& points,
+                                                         const std::vector<QVector3D>& colors,
+                                                         const std::vector<QVector3D>& normals)
 {
-    m_pointCloudData = points;
+    if (points.empty()) {
+        ClearData();
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const int count = static_cast<int>(points.size());
+    m_hasColors = colors.size() == points.size();
+    m_hasNormals = normals.size() == points.size();
+
+    // 包围盒
+    m_boundsMin = points[0];
+    m_boundsMax = points[0];
+    for (const auto& point : points) {
+        m_boundsMin.setX(std::min(m_boundsMin.x(), point.x()));
+        m_boundsMin.setY(std::min(m_boundsMin.y(), point.y()));
+        m_boundsMin.setZ(std::min(m_boundsMin.z(), point.z()));
+        m_boundsMax.setX(std::max(m_boundsMax.x(), point.x()));
+        m_boundsMax.setY(std::max(m_boundsMax.y(), point.y()));
+        m_boundsMax.setZ(std::max(m_boundsMax.z(), point.z()));
+    }
+
+    // 网格分辨率：按体积使每个单元平均约kTargetPointsPerCell个点，扁平方向至少一层
+    const QVector3D size = m_boundsMax - m_boundsMin;
+    const float maxExtent = std::max({ size.x(), size.y(), size.z(), 1e-6f });
+    float extent[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        extent[axis] = std::max(size[axis], maxExtent * 1e-3f);
+    }
+    const double volume = double(extent[0]) * extent[1] * extent[2];
+    const float cellSize = static_cast<float>(std::cbrt(volume * kTargetPointsPerCell / count));
+    int dims[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        dims[axis] = std::max(1, std::min(kMaxGridResolution, int(std::ceil(extent[axis] / cellSize))));
+    }
+
+    // 计数排序到网格单元
+    auto cellIndexOf = [&](const QVector3D& point) {
+        int index[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            const float t = (point[axis] - m_boundsMin[axis]) / extent[axis];
+            index[axis] = std::max(0, std::min(dims[axis] - 1, int(t * dims[axis])));
+        }
+        return (index[2] * dims[1] + index[1]) * dims[0] + index[0];
+    };
+
+    std::vector<int> offsets(size_t(dims[0]) * dims[1] * dims[2] + 1, 0);
+    std::vector<int> cellOfPoint(points.size());
+    for (int i = 0; i < count; ++i) {
+        cellOfPoint[i] = cellIndexOf(points[i]);
+        ++offsets[cellOfPoint[i] + 1];
+    }
+    for (size_t c = 1; c < offsets.size(); ++c) {
+        offsets[c] += offsets[c - 1];
+    }
+    std::vector<int> order(points.size());
+    {
+        std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+        for (int i = 0; i < count; ++i) {
+            order[cursor[cellOfPoint[i]]++] = i;
+        }
+    }
+
+    // 单元内打乱（固定种子），任意前缀都是该单元的均匀子采样
+    std::mt19937 random(0x5eed);
+    m_cells.clear();
+    for (size_t c = 0; c + 1 < offsets.size(); ++c) {
+        const int first = offsets[c];
+        const int cellCount = offsets[c + 1] - first;
+        if (cellCount == 0) {
+            continue;
+        }
+        std::shuffle(order.begin() + first, order.begin() + first + cellCount, random);
+
+        PointCell cell;
+        cell.first = first;
+        cell.count = cellCount;
+        cell.minBound = points[order[first]];
+        cell.maxBound = cell.minBound;
+        for (int i = first; i < first + cellCount; ++i) {
+            const QVector3D& point = points[order[i]];
+            cell.minBound.setX(std::min(cell.minBound.x(), point.x()));
+            cell.minBound.setY(std::min(cell.minBound.y(), point.y()));
+            cell.minBound.setZ(std::min(cell.minBound.z(), point.z()));
+            cell.maxBound.setX(std::max(cell.maxBound.x(), point.x()));
+            cell.maxBound.setY(std::max(cell.maxBound.y(), point.y()));
+            cell.maxBound.setZ(std::max(cell.maxBound.z(), point.z()));
+        }
+        m_cells.push_back(cell);
+    }
+    m_cellDrawCounts.assign(m_cells.size(), 0);
+
+    // 按单元顺序整理顶点数据，颜色和法向压缩为字节
+    m_pendingPositions.resize(points.size() * 3);
+    m_pendingColors.clear();
+    m_pendingNormals.clear();
+    if (m_hasColors) {
+        m_pendingColors.resize(points.size() * 4);
+    }
+    if (m_hasNormals) {
+        m_pendingNormals.resize(points.size() * 4);
+    }
+    auto toUnsignedByte = [](float value) {
+        return static_cast<unsigned char>(std::lround(std::max(0.0f, std::min(1.0f, value)) * 255.0f));
+    };
+    for (int i = 0; i < count; ++i) {
+        const int source = order[i];
+        const QVector3D& point = points[source];
+        m_pendingPositions[i * 3] = point.x();
+        m_pendingPositions[i * 3 + 1] = point.y();
+        m_pendingPositions[i * 3 + 2] = point.z();
+        if (m_hasColors) {
+            const QVector3D& color = colors[source];
+            m_pendingColors[i * 4] = toUnsignedByte(color.x());
+            m_pendingColors[i * 4 + 1] = toUnsignedByte(color.y());
+            m_pendingColors[i * 4 + 2] = toUnsignedByte(color.z());
+            m_pendingColors[i * 4 + 3] = 255;
+        }
+        if (m_hasNormals) {
+            const QVector3D normal = normals[source].normalized();
+            m_pendingNormals[i * 4] = static_cast<signed char>(std::lround(normal.x() * 127.0f));
+            m_pendingNormals[i * 4 + 1] = static_cast<signed char>(std::lround(normal.y() * 127.0f));
+            m_pendingNormals[i * 4 + 2] = static_cast<signed char>(std::lround(normal.z() * 127.0f));
+            m_pendingNormals[i * 4 + 3] = 0;
+        }
+    }
+
+    m_pointCount = count;
     m_hasPointCloud = true;
     m_showTestData = false;
+    m_uploadPending = true;
+
+    // 上下文已创建时立即上传，否则在initializeGL中上传
+    if (m_glReady) {
+        makeCurrent();
+        uploadPointCloud();
+        doneCurrent();
+    }
+
+    qDebug() << "Simple3DRenderer: 点数" << count << "网格" << dims[0] << "x" << dims[1] << "x" << dims[2]
+             << "非空单元" << m_cells.size() << "颜色" << m_hasColors << "法向" << m_hasNormals
+             << "耗时" << timer.elapsed() << "ms";
     update();
 }
 
@@ -258,9 +526,24 @@ void Simple3DWidget::Simple3DRenderer::SetTestData()
 
 void Simple3DWidget::Simple3DRenderer::ClearData()
 {
-    m_pointCloudData.clear();
+    m_pendingPositions = std::vector<float>();
+    m_pendingColors = std::vector<unsigned char>();
+    m_pendingNormals = std::vector<signed char>();
+    m_cells.clear();
+    m_cellDrawCounts.clear();
+    m_pointCount = 0;
+    m_renderedPointCount = 0;
     m_hasPointCloud = false;
+    m_hasColors = false;
+    m_hasNormals = false;
+    m_uploadPending = false;
     m_showTestData = false;
+
+    if (m_glReady) {
+        makeCurrent();
+        releasePointBuffers();
+        doneCurrent();
+    }
     update();
 }
 
@@ -275,33 +558,30 @@ void Simple3DWidget::Simple3DRenderer::ResetCamera()
 
 void Simple3DWidget::Simple3DRenderer::FitToScene()
 {
-    if (m_hasPointCloud && !m_pointCloudData.empty()) {
-        // 计算点云边界
-        QVector3D minBound = m_pointCloudData[0];
-        QVector3D maxBound = m_pointCloudData[0];
-        
-        for (const auto& point : m_pointCloudData) {
-            minBound.setX(std::min(minBound.x(), point.x()));
-            minBound.setY(std::min(minBound.y(), point.y()));
-            minBound.setZ(std::min(minBound.z(), point.z()));
-            maxBound.setX(std::max(maxBound.x(), point.x()));
-            maxBound.setY(std::max(maxBound.y(), point.y()));
-            maxBound.setZ(std::max(maxBound.z(), point.z()));
-        }
-        
-        QVector3D center = (minBound + maxBound) * 0.5f;
-        float size = (maxBound - minBound).length();
+    if (m_hasPointCloud) {
+        QVector3D center = (m_boundsMin + m_boundsMax) * 0.5f;
+        float size = (m_boundsMax - m_boundsMin).length();
         
         m_cameraTarget = center;
         m_cameraDistance = size * 1.5f;
+        m_sceneRadius = std::max(size * 0.5f, 1e-3f);
     } else {
+        m_cameraTarget = QVector3D(0, 0, 0);
         m_cameraDistance = 5.0f;
+        m_sceneRadius = std::sqrt(3.0f);    // 测试立方体
     }
     
     updateCamera();
     update();
 }
 
+void Simple3DWidget::Simple3DRenderer::SetPointBudget(int stillPoints, int interactivePoints)
+{
+    m_stillPointBudget = std::max(1, stillPoints);
+    m_interactivePointBudget = std::max(1, interactivePoints);
+    update();
+}
+
 void Simple3DWidget::Simple3DRenderer::initializeGL()
 {
     initializeOpenGLFunctions();
@@ -310,38 +590,61 @@ void Simple3DWidget::Simple3DRenderer::initializeGL()
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_PROGRAM_POINT_SIZE);
     
-    qDebug() << "✅ OpenGL初始化完成";
+    if (!createShaderProgram()) {
+        qCritical() << "Simple3DRenderer: 着色器创建失败" << m_program.log();
+        return;
+    }
+    
+    // VAO不可用时（旧驱动）每次绘制前重新设置顶点属性
+    m_pointVao.create();
+    m_lineVao.create();
+    uploadLineGeometry();
+    m_glReady = true;
+    
+    if (m_uploadPending) {
+        uploadPointCloud();
+    }
+    
+    qDebug() << "✅ OpenGL初始化完成" << (m_lineVao.isCreated() ? "(VAO)" : "(无VAO)");
 }
 
 void Simple3DWidget::Simple3DRenderer::paintGL()
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-    // 设置变换矩阵
-    glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(m_projection.constData());
+    if (!m_glReady) {
+        return;
+    }
+    if (m_uploadPending) {
+        uploadPointCloud();
+    }
     
-    glMatrixMode(GL_MODELVIEW);
-    glLoadMatrixf(m_view.constData());
+    const QMatrix4x4 viewProjection = m_projection * m_view;
+    m_program.bind();
     
-    // 绘制坐标轴
-    drawAxes();
+    // 绘制坐标轴（随场景尺度缩放）
+    QMatrix4x4 axesMvp = viewProjection;
+    axesMvp.scale(std::max(1.0f, m_sceneRadius * 0.2f));
+    glLineWidth(2.0f);
+    drawLines(axesMvp, kAxesFirst, kAxesCount);
+    glLineWidth(1.0f);
     
     // 绘制数据
     if (m_hasPointCloud) {
-        drawPointCloud();
+        drawPointCloud(viewProjection);
     } else if (m_showTestData) {
-        drawTestCube();
+        drawLines(viewProjection, kCubeFirst, kCubeCount);
     }
+    
+    m_program.release();
 }
 
 void Simple3DWidget::Simple3DRenderer::resizeGL(int width, int height)
 {
     glViewport(0, 0, width, height);
     
-    float aspect = float(width) / float(height ? height : 1);
-    m_projection.setToIdentity();
-    m_projection.perspective(45.0f, aspect, 0.1f, 1000.0f);
+    m_viewportWidth = std::max(1, width);
+    m_viewportHeight = std::max(1, height);
     
     updateCamera();
 }
@@ -370,11 +673,21 @@ void Simple3DWidget::Simple3DRenderer::mouseMoveEvent(QMouseEvent *event)
     update();
 }
 
+void Simple3DWidget::Simple3DRenderer::mouseReleaseEvent(QMouseEvent *event)
+{
+    Q_UNUSED(event);
+    m_mousePressed = false;
+    
+    // 拖动结束后按静止预算重绘完整细节
+    update();
+}
+
 void Simple3DWidget::Simple3DRenderer::wheelEvent(QWheelEvent *event)
 {
     float delta = event->angleDelta().y() / 120.0f;
     m_cameraDistance *= (1.0f - delta * 0.1f);
-    m_cameraDistance = std::max(0.1f, std::min(100.0f, m_cameraDistance));
+    m_cameraDistance = std::max(std::max(0.01f, m_sceneRadius * 0.01f),
+                                std::min(std::max(100.0f, m_sceneRadius * 20.0f), m_cameraDistance));
     
     updateCamera();
     update();
@@ -392,69 +705,268 @@ void Simple3DWidget::Simple3DRenderer::updateCamera()
     
     m_view.setToIdentity();
     m_view.lookAt(m_cameraPos, m_cameraTarget, m_cameraUp);
+    
+    updateProjection();
 }
 
-void Simple3DWidget::Simple3DRenderer::drawAxes()
+void Simple3DWidget::Simple3DRenderer::updateProjection()
 {
-    glLineWidth(2.0f);
-    glBegin(GL_LINES);
+    // 裁剪面随场景尺度变化，保证毫米级大工件和原点坐标轴都在视锥内
+    const float nearPlane = std::max(m_cameraDistance * 0.01f, m_cameraDistance - 2.0f * m_sceneRadius);
+    const float farPlane = std::max(nearPlane * 2.0f,
+                                    m_cameraPos.length() + m_cameraDistance + 2.0f * m_sceneRadius);
     
-    // X轴 - 红色
-    glColor3f(1.0f, 0.0f, 0.0f);
-    glVertex3f(0.0f, 0.0f, 0.0f);
-    glVertex3f(1.0f, 0.0f, 0.0f);
+    const float aspect = float(m_viewportWidth) / float(m_viewportHeight);
+    m_projection.setToIdentity();
+    m_projection.perspective(kFovY, aspect, nearPlane, farPlane);
+}
+
+bool Simple3DWidget::Simple3DRenderer::createShaderProgram()
+{
+    // 兼容配置文件用GLSL 1.20，核心配置文件用GLSL 1.50
+    const bool core = context()->format().profile() == QSurfaceFormat::CoreProfile;
+    const QByteArray vertexSource = QByteArray(core
+        ? "#version 150\n#define attribute in\n#define varying out\n"
+        : "#version 120\n") + kVertexShaderSource;
+    const QByteArray fragmentSource = QByteArray(core
+        ? "#version 150\nin vec4 v_color;\nout vec4 fragColor;\n#define FRAG_COLOR fragColor\n"
+        : "#version 120\nvarying vec4 v_color;\n#define FRAG_COLOR gl_FragColor\n") + kFragmentShaderSource;
+    
+    if (!m_program.addShaderFromSourceCode(QOpenGLShader::Vertex, vertexSource) ||
+        !m_program.addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentSource)) {
+        return false;
+    }
+    m_program.bindAttributeLocation("a_position", PositionAttribute);
+    m_program.bindAttributeLocation("a_color", ColorAttribute);
+    m_program.bindAttributeLocation("a_normal", NormalAttribute);
+    return m_program.link();
+}
+
+void Simple3DWidget::Simple3DRenderer::uploadPointCloud()
+{
+    releasePointBuffers();
+    m_uploadPending = false;
+    if (!m_hasPointCloud) {
+        return;
+    }
     
-    // Y轴 - 绿色
-    glColor3f(0.0f, 1.0f, 0.0f);
-    glVertex3f(0.0f, 0.0f, 0.0f);
-    glVertex3f(0.0f, 1.0f, 0.0f);
+    auto upload = [](QOpenGLBuffer& buffer, const void* data, size_t bytes) {
+        buffer.create();
+        buffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+        buffer.bind();
+        buffer.allocate(data, static_cast<int>(bytes));
+        buffer.release();
+    };
+    upload(m_positionBuffer, m_pendingPositions.data(), m_pendingPositions.size() * sizeof(float));
+    if (m_hasColors) {
+        upload(m_colorBuffer, m_pendingColors.data(), m_pendingColors.size());
+    }
+    if (m_hasNormals) {
+        upload(m_normalBuffer, m_pendingNormals.data(), m_pendingNormals.size());
+    }
     
-    // Z轴 - 蓝色
-    glColor3f(0.0f, 0.0f, 1.0f);
-    glVertex3f(0.0f, 0.0f, 0.0f);
-    glVertex3f(0.0f, 0.0f, 1.0f);
+    if (m_pointVao.isCreated()) {
+        QOpenGLVertexArrayObject::Binder binder(&m_pointVao);
+        bindPointAttributes();
+    }
     
-    glEnd();
+    // 数据已在GPU上，释放CPU副本
+    m_pendingPositions = std::vector<float>();
+    m_pendingColors = std::vector<unsigned char>();
+    m_pendingNormals = std::vector<signed char>();
 }
 
-void Simple3DWidget::Simple3DRenderer::drawPointCloud()
+void Simple3DWidget::Simple3DRenderer::uploadLineGeometry()
 {
-    glPointSize(2.0f);
-    glColor3f(0.8f, 0.2f, 0.2f); // 红色点云
+    std::vector<LineVertex> vertices;
+    vertices.reserve(kAxesCount + kCubeCount);
+    auto add = [&vertices](float x, float y, float z, unsigned char r, unsigned char g, unsigned char b) {
+        vertices.push_back({ { x, y, z }, { r, g, b, 255 } });
+    };
+    
+    // X轴 - 红色，Y轴 - 绿色，Z轴 - 蓝色
+    add(0, 0, 0, 255, 0, 0); add(1, 0, 0, 255, 0, 0);
+    add(0, 0, 0, 0, 255, 0); add(0, 1, 0, 0, 255, 0);
+    add(0, 0, 0, 0, 0, 255); add(0, 0, 1, 0, 0, 255);
+    
+    // 测试立方体线框 - 绿色：底面、顶面、垂直边
+    const float corners[8][3] = {
+        { -1, -1, -1 }, { 1, -1, -1 }, { 1, 1, -1 }, { -1, 1, -1 },
+        { -1, -1,  1 }, { 1, -1,  1 }, { 1, 1,  1 }, { -1, 1,  1 }
+    };
+    const int edges[12][2] = {
+        { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 },
+        { 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 },
+        { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+    };
+    for (const auto& edge : edges) {
+        for (int end = 0; end < 2; ++end) {
+            const float* corner = corners[edge[end]];
+            add(corner[0], corner[1], corner[2], 51, 204, 51);
+        }
+    }
+    
+    m_lineBuffer.create();
+    m_lineBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_lineBuffer.bind();
+    m_lineBuffer.allocate(vertices.data(), static_cast<int>(vertices.size() * sizeof(LineVertex)));
+    m_lineBuffer.release();
     
-    glBegin(GL_POINTS);
-    for (const auto& point : m_pointCloudData) {
-        glVertex3f(point.x(), point.y(), point.z());
+    if (m_lineVao.isCreated()) {
+        QOpenGLVertexArrayObject::Binder binder(&m_lineVao);
+        bindLineAttributes();
     }
-    glEnd();
 }
 
-void Simple3DWidget::Simple3DRenderer::drawTestCube()
+void Simple3DWidget::Simple3DRenderer::releasePointBuffers()
 {
-    glColor3f(0.2f, 0.8f, 0.2f); // 绿色立方体
+    m_positionBuffer.destroy();
+    m_colorBuffer.destroy();
+    m_normalBuffer.destroy();
+}
+
+void Simple3DWidget::Simple3DRenderer::bindPointAttributes()
+{
+    m_positionBuffer.bind();
+    glEnableVertexAttribArray(PositionAttribute);
+    glVertexAttribPointer(PositionAttribute, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    
+    if (m_hasColors) {
+        m_colorBuffer.bind();
+        glEnableVertexAttribArray(ColorAttribute);
+        glVertexAttribPointer(ColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, nullptr);
+    } else {
+        glDisableVertexAttribArray(ColorAttribute);
+    }
     
-    // 绘制立方体的线框
-    glBegin(GL_LINES);
+    if (m_hasNormals) {
+        m_normalBuffer.bind();
+        glEnableVertexAttribArray(NormalAttribute);
+        glVertexAttribPointer(NormalAttribute, 3, GL_BYTE, GL_TRUE, 4, nullptr);
+    } else {
+        glDisableVertexAttribArray(NormalAttribute);
+    }
     
-    // 底面
-    glVertex3f(-1, -1, -1); glVertex3f( 1, -1, -1);
-    glVertex3f( 1, -1, -1); glVertex3f( 1,  1, -1);
-    glVertex3f( 1,  1, -1); glVertex3f(-1,  1, -1);
-    glVertex3f(-1,  1, -1); glVertex3f(-1, -1, -1);
+    m_positionBuffer.release();
+}
+
+void Simple3DWidget::Simple3DRenderer::bindLineAttributes()
+{
+    m_lineBuffer.bind();
+    glEnableVertexAttribArray(PositionAttribute);
+    glVertexAttribPointer(PositionAttribute, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex),
+                          reinterpret_cast<const void*>(offsetof(LineVertex, position)));
+    glEnableVertexAttribArray(ColorAttribute);
+    glVertexAttribPointer(ColorAttribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(LineVertex),
+                          reinterpret_cast<const void*>(offsetof(LineVertex, color)));
+    glDisableVertexAttribArray(NormalAttribute);
+    m_lineBuffer.release();
+}
+
+void Simple3DWidget::Simple3DRenderer::drawLines(const QMatrix4x4& mvp, int first, int count)
+{
+    m_program.setUniformValue("u_mvp", mvp);
+    m_program.setUniformValue("u_pointSize", 1.0f);
+    m_program.setUniformValue("u_useColor", true);
+    m_program.setUniformValue("u_useNormal", false);
+    
+    if (m_lineVao.isCreated()) {
+        QOpenGLVertexArrayObject::Binder binder(&m_lineVao);
+        glDrawArrays(GL_LINES, first, count);
+    } else {
+        bindLineAttributes();
+        glDrawArrays(GL_LINES, first, count);
+    }
+}
+
+void Simple3DWidget::Simple3DRenderer::drawPointCloud(const QMatrix4x4& viewProjection)
+{
+    m_renderedPointCount = 0;
+    if (!m_positionBuffer.isCreated()) {
+        return;
+    }
+    
+    // 视锥平面（从视图投影矩阵提取，法向朝内）
+    const QVector4D row0 = viewProjection.row(0);
+    const QVector4D row1 = viewProjection.row(1);
+    const QVector4D row2 = viewProjection.row(2);
+    const QVector4D row3 = viewProjection.row(3);
+    const QVector4D planes[6] = {
+        row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2
+    };
+    
+    // 按单元投影面积确定绘制点数：约每像素一个点，近处单元绘制全部点
+    const float pixelsPerUnit = m_viewportHeight / (2.0f * std::tan(kFovY * 0.5f * float(M_PI) / 180.0f));
+    qint64 total = 0;
+    for (size_t c = 0; c < m_cells.size(); ++c) {
+        const PointCell& cell = m_cells[c];
+        int drawCount = 0;
+        if (isCellVisible(cell, planes)) {
+            const QVector3D center = (cell.minBound + cell.maxBound) * 0.5f;
+            const float radius = (cell.maxBound - cell.minBound).length() * 0.5f;
+            const float distance = (center - m_cameraPos).length();
+            drawCount = cell.count;
+            if (distance > radius) {
+                const float projected = 2.0f * radius * pixelsPerUnit / distance;
+                const float area = projected * projected;
+                if (area < drawCount) {
+                    drawCount = std::max(std::min(kMinPointsPerCell, cell.count), int(area));
+                }
+            }
+        }
+        m_cellDrawCounts[c] = drawCount;
+        total += drawCount;
+    }
     
-    // 顶面
-    glVertex3f(-1, -1,  1); glVertex3f( 1, -1,  1);
-    glVertex3f( 1, -1,  1); glVertex3f( 1,  1,  1);
-    glVertex3f( 1,  1,  1); glVertex3f(-1,  1,  1);
-    glVertex3f(-1,  1,  1); glVertex3f(-1, -1,  1);
+    // 超出点预算时所有单元等比例减少（拖动旋转时用较小的预算保证流畅）
+    const int budget = m_mousePressed ? m_interactivePointBudget : m_stillPointBudget;
+    const double budgetScale = total > budget ? double(budget) / double(total) : 1.0;
     
-    // 垂直边
-    glVertex3f(-1, -1, -1); glVertex3f(-1, -1,  1);
-    glVertex3f( 1, -1, -1); glVertex3f( 1, -1,  1);
-    glVertex3f( 1,  1, -1); glVertex3f( 1,  1,  1);
-    glVertex3f(-1,  1, -1); glVertex3f(-1,  1,  1);
+    m_program.setUniformValue("u_mvp", viewProjection);
+    m_program.setUniformValue("u_normalMatrix", m_view.normalMatrix());
+    m_program.setUniformValue("u_color", QVector4D(0.8f, 0.2f, 0.2f, 1.0f)); // 红色点云
+    m_program.setUniformValue("u_useColor", m_hasColors);
+    m_program.setUniformValue("u_useNormal", m_hasNormals);
+    const int pointSizeLocation = m_program.uniformLocation("u_pointSize");
+    
+    if (m_pointVao.isCreated()) {
+        m_pointVao.bind();
+    } else {
+        bindPointAttributes();
+    }
     
-    glEnd();
+    for (size_t c = 0; c < m_cells.size(); ++c) {
+        if (m_cellDrawCounts[c] == 0) {
+            continue;
+        }
+        const PointCell& cell = m_cells[c];
+        const int drawCount = std::max(1, int(m_cellDrawCounts[c] * budgetScale));
+        
+        // 子采样的单元放大点尺寸填补空隙
+        const float pointScale = std::min(kMaxPointScale, std::sqrt(float(cell.count) / drawCount));
+        m_program.setUniformValue(pointSizeLocation, kBasePointSize * pointScale);
+        glDrawArrays(GL_POINTS, cell.first, drawCount);
+        m_renderedPointCount += drawCount;
+    }
+    
+    if (m_pointVao.isCreated()) {
+        m_pointVao.release();
+    }
+}
+
+bool Simple3DWidget::Simple3DRenderer::isCellVisible(const PointCell& cell, const QVector4D planes[6]) const
+{
+    for (int i = 0; i < 6; ++i) {
+        const QVector4D& plane = planes[i];
+        // 包围盒沿平面法向最远的角点在平面外侧则整个单元不可见
+        const float x = plane.x() >= 0.0f ? cell.maxBound.x() : cell.minBound.x();
+        const float y = plane.y() >= 0.0f ? cell.maxBound.y() : cell.minBound.y();
+        const float z = plane.z() >= 0.0f ? cell.maxBound.z() : cell.minBound.z();
+        if (plane.x() * x + plane.y() * y + plane.z() * z + plane.w() < 0.0f) {
+            return false;
+        }
+    }
+    return true;
 }
 
-} // namespace UI
\ No newline at end of file
+} // namespace UI
@@ -3,8 +3,12 @@
 
 #include <QOpenGLWidget>
 #include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
 #include <QMatrix4x4>
 #include <QVector3D>
+#include <QVector4D>
 #include <QMouseEvent>
 #include <QWheelEvent>
 #include <QTimer>
@@ -76,7 +80,10 @@ private:
 /**
  * @brief 简化的3D渲染器
  * 
- * 使用OpenGL直接渲染点云和基本几何体
+ * 使用着色器和顶点缓冲渲染点云和基本几何体（VTK不可用时的备用查看器）：
+ * - 点云设置时按空间网格重排，每个网格单元内点顺序打乱，一次上传到GPU后不再修改
+ * - 每帧按视锥剔除网格单元，并按单元的屏幕投影面积只绘制其前缀（均匀子采样）
+ * - 可选逐点颜色和法向（法向用于头灯漫反射着色）
  */
 class Simple3DWidget::Simple3DRenderer : public QOpenGLWidget, protected QOpenGLFunctions
 {
@@ -87,13 +94,29 @@ public:
     ~Simple3DRenderer();
 
     // 数据管理
-    void SetPointCloudData(const std::vector<QVector3D>& points);
+    /**
+     * @brief 设置点云
+     * @param points 点坐标
+     * @param colors 逐点颜色（0-1），为空或数量不符时使用单色
+     * @param normals 逐点法向，为空或数量不符时不做光照
+     */
+    void SetPointCloudData(const std::vector<QVector3D>& points,
+                           const std::vector<QVector3D>& colors = std::vector<QVector3D>(),
+                           const std::vector<QVector3D>& normals = std::vector<QVector3D>());
     void SetTestData();
     void ClearData();
     
     // 相机控制
     void ResetCamera();
     void FitToScene();
+    
+    /**
+     * @brief 点预算：静止时和拖动旋转时每帧最多绘制的点数
+     */
+    void SetPointBudget(int stillPoints, int interactivePoints);
+    
+    int pointCount() const { return m_pointCount; }
+    int renderedPointCount() const { return m_renderedPointCount; }
 
 protected:
     void initializeGL() override;
@@ -102,20 +125,71 @@ protected:
     
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
     void wheelEvent(QWheelEvent *event) override;
 
 private:
+    /**
+     * @brief 空间网格单元，对应顶点缓冲中连续的一段
+     */
+    struct PointCell {
+        int first;
+        int count;
+        QVector3D minBound;
+        QVector3D maxBound;
+    };
+    
+    /**
+     * @brief 线框顶点（坐标轴和测试立方体）
+     */
+    struct LineVertex {
+        float position[3];
+        unsigned char color[4];
+    };
+    
     void updateCamera();
-    void drawAxes();
-    void drawPointCloud();
-    void drawTestCube();
+    void updateProjection();
+    bool createShaderProgram();
+    void uploadPointCloud();
+    void uploadLineGeometry();
+    void releasePointBuffers();
+    void bindPointAttributes();
+    void bindLineAttributes();
+    void drawLines(const QMatrix4x4& mvp, int first, int count);
+    void drawPointCloud(const QMatrix4x4& viewProjection);
+    bool isCellVisible(const PointCell& cell, const QVector4D planes[6]) const;
 
 private:
-    // 点云数据
-    std::vector<QVector3D> m_pointCloudData;
+    // 点云数据（上传前暂存，上传后释放，只保留网格单元和包围盒）
+    std::vector<float> m_pendingPositions;
+    std::vector<unsigned char> m_pendingColors;
+    std::vector<signed char> m_pendingNormals;
+    std::vector<PointCell> m_cells;
+    std::vector<int> m_cellDrawCounts;      // 每帧各单元绘制的点数（复用，避免每帧分配）
+    QVector3D m_boundsMin;
+    QVector3D m_boundsMax;
+    int m_pointCount;
+    int m_renderedPointCount;
     bool m_hasPointCloud;
+    bool m_hasColors;
+    bool m_hasNormals;
+    bool m_uploadPending;
     bool m_showTestData;
     
+    // 点预算
+    int m_stillPointBudget;
+    int m_interactivePointBudget;
+    
+    // OpenGL资源
+    QOpenGLShaderProgram m_program;
+    QOpenGLVertexArrayObject m_pointVao;
+    QOpenGLVertexArrayObject m_lineVao;
+    QOpenGLBuffer m_positionBuffer;
+    QOpenGLBuffer m_colorBuffer;
+    QOpenGLBuffer m_normalBuffer;
+    QOpenGLBuffer m_lineBuffer;
+    bool m_glReady;
+    
     // 相机参数
     QMatrix4x4 m_projection;
     QMatrix4x4 m_view;
@@ -129,6 +203,9 @@ private:
     float m_cameraDistance;
     float m_cameraYaw;
     float m_cameraPitch;
+    float m_sceneRadius;
+    int m_viewportWidth;
+    int m_viewportHeight;
 };
 
 } // namespace UI
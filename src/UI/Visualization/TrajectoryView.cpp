@@ -0,0 +1,371 @@
+#include "TrajectoryView.h"
+
+#include <algorithm>
+
+// VTK includes
+#include <vtkPointData.h>
+#include <vtkProperty.h>
+
+namespace UI {
+
+namespace {
+
+const char* const kAttributeNames[4] = { "Speed", "FlowRate", "SprayWidth", "Risk" };
+const double kRangeHeadroom = 0.25;     // 自动范围扩展时预留的余量（占跨度比例）
+
+} // namespace
+
+TrajectoryView::TrajectoryView()
+    : m_assembly(vtkSmartPointer<vtkAssembly>::New())
+    , m_lookupTable(vtkSmartPointer<vtkLookupTable>::New())
+    , m_firstDirtyChunk(0)
+    , m_pointCount(0)
+    , m_expectedPoints(0)
+    , m_colorBy(Solid)
+    , m_fixedRange(false)
+    , m_hasRisk(false)
+    , m_lineWidth(3.0)
+{
+    // 蓝(低) -> 红(高)
+    m_lookupTable->SetHueRange(0.667, 0.0);
+    m_lookupTable->SetNumberOfTableValues(256);
+    m_lookupTable->Build();
+
+    m_displayRange[0] = 0.0;
+    m_displayRange[1] = 1.0;
+    m_solidColor[0] = 0.0;
+    m_solidColor[1] = 1.0;
+    m_solidColor[2] = 0.0;
+    clear();
+}
+
+void TrajectoryView::clear(vtkIdType expectedPoints)
+{
+    for (const Chunk& chunk : m_chunks) {
+        m_assembly->RemovePart(chunk.actor);
+    }
+    m_chunks.clear();
+    m_firstDirtyChunk = 0;
+    m_pointCount = 0;
+    m_hasRisk = false;
+    m_expectedPoints = std::max<vtkIdType>(0, expectedPoints);
+    for (auto& range : m_dataRange) {
+        range[0] = 0.0f;
+        range[1] = 0.0f;
+    }
+    if (!m_fixedRange) {
+        // 空范围，第一批数据到达时按数据设置
+        m_displayRange[0] = 0.0;
+        m_displayRange[1] = 0.0;
+    }
+    m_assembly->Modified();
+}
+
+void TrajectoryView::append(const Data::TrajectoryPoint* points, size_t count)
+{
+    if (!points || count == 0) {
+        return;
+    }
+
+    float position[3];
+    float attributes[kAttributeCount];
+    for (size_t i = 0; i < count; ++i) {
+        const Data::TrajectoryPoint& point = points[i];
+        position[0] = point.position.x();
+        position[1] = point.position.y();
+        position[2] = point.position.z();
+        attributes[0] = static_cast<float>(point.speed);
+        attributes[1] = static_cast<float>(point.flowRate);
+        attributes[2] = static_cast<float>(point.sprayWidth);
+        attributes[3] = 0.0f;
+        appendPoint(position, attributes);
+    }
+    finishAppend();
+}
+
+void TrajectoryView::append(const QList<Data::TrajectoryPoint>& points)
+{
+    if (!points.isEmpty()) {
+        append(points.constData(), static_cast<size_t>(points.size()));
+    }
+}
+
+void TrajectoryView::append(const std::vector<std::array<double, 3>>& positions)
+{
+    if (positions.empty()) {
+        return;
+    }
+
+    float position[3];
+    const float attributes[kAttributeCount] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (const auto& p : positions) {
+        position[0] = static_cast<float>(p[0]);
+        position[1] = static_cast<float>(p[1]);
+        position[2] = static_cast<float>(p[2]);
+        appendPoint(position, attributes);
+    }
+    finishAppend();
+}
+
+void TrajectoryView::setRiskValues(const float* values, size_t count)
+{
+    if (!values || m_chunks.empty()) {
+        return;
+    }
+
+    // 相邻块共用边界点：第c块的第p个点是轨迹的第 c*(kChunkSize-1)+p 个点
+    const int risk = Risk - 1;
+    size_t begin = 0;
+    for (Chunk& chunk : m_chunks) {
+        if (begin >= count) {
+            break;
+        }
+        vtkFloatArray* attribute = chunk.attributes[risk];
+        const size_t n = std::min(static_cast<size_t>(attribute->GetNumberOfTuples()), count - begin);
+        std::copy(values + begin, values + begin + n, attribute->GetPointer(0));
+        attribute->Modified();
+        chunk.data->Modified();
+        begin += static_cast<size_t>(kChunkSize - 1);
+    }
+
+    auto& range = m_dataRange[risk];
+    const size_t n = std::min(count, static_cast<size_t>(m_pointCount));
+    if (n > 0) {
+        const auto bounds = std::minmax_element(values, values + n);
+        range[0] = *bounds.first;
+        range[1] = *bounds.second;
+    }
+    const bool hadRisk = m_hasRisk;
+    m_hasRisk = count >= static_cast<size_t>(m_pointCount);
+    if (m_colorBy == Risk) {
+        updateDisplayRange(true);
+        if (hadRisk != m_hasRisk) {
+            applyColoringToAll();
+        }
+    }
+}
+
+void TrajectoryView::setRiskValues(const std::vector<float>& values)
+{
+    setRiskValues(values.data(), values.size());
+}
+
+void TrajectoryView::setColorBy(ColorBy colorBy)
+{
+    if (m_colorBy == colorBy) {
+        return;
+    }
+    m_colorBy = colorBy;
+    updateDisplayRange(true);
+    applyColoringToAll();
+}
+
+void TrajectoryView::setScalarRange(double minValue, double maxValue)
+{
+    m_fixedRange = minValue < maxValue;
+    if (m_fixedRange) {
+        m_displayRange[0] = minValue;
+        m_displayRange[1] = maxValue;
+        m_lookupTable->SetTableRange(m_displayRange);
+    } else {
+        updateDisplayRange(true);
+    }
+}
+
+void TrajectoryView::scalarRange(double range[2]) const
+{
+    range[0] = m_displayRange[0];
+    range[1] = m_displayRange[1];
+}
+
+QString TrajectoryView::attributeName(ColorBy colorBy)
+{
+    if (colorBy == Solid) {
+        return QString();
+    }
+    return QString::fromLatin1(kAttributeNames[colorBy - 1]);
+}
+
+void TrajectoryView::setSolidColor(double r, double g, double b)
+{
+    m_solidColor[0] = r;
+    m_solidColor[1] = g;
+    m_solidColor[2] = b;
+    for (const Chunk& chunk : m_chunks) {
+        chunk.actor->GetProperty()->SetColor(m_solidColor);
+    }
+}
+
+void TrajectoryView::setLineWidth(double width)
+{
+    m_lineWidth = width;
+    for (const Chunk& chunk : m_chunks) {
+        chunk.actor->GetProperty()->SetLineWidth(m_lineWidth);
+    }
+}
+
+TrajectoryView::Chunk& TrajectoryView::newChunk(vtkIdType capacity)
+{
+    Chunk chunk;
+    chunk.points = vtkSmartPointer<vtkPoints>::New();
+    chunk.points->SetDataTypeToFloat();
+    chunk.points->Allocate(capacity);
+
+    chunk.lines = vtkSmartPointer<vtkCellArray>::New();
+    chunk.lines->AllocateExact(1, capacity);
+    chunk.lines->InsertNextCell(0);     // 整块一条折线，点数随追加更新
+
+    chunk.data = vtkSmartPointer<vtkPolyData>::New();
+    chunk.data->SetPoints(chunk.points);
+    chunk.data->SetLines(chunk.lines);
+    for (int i = 0; i < kAttributeCount; ++i) {
+        chunk.attributes[i] = vtkSmartPointer<vtkFloatArray>::New();
+        chunk.attributes[i]->SetName(kAttributeNames[i]);
+        chunk.attributes[i]->Allocate(capacity);
+        chunk.data->GetPointData()->AddArray(chunk.attributes[i]);
+    }
+
+    chunk.mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    chunk.mapper->SetInputData(chunk.data);
+    chunk.mapper->SetLookupTable(m_lookupTable);
+    chunk.mapper->UseLookupTableScalarRangeOn();
+    chunk.mapper->SetScalarModeToUsePointFieldData();
+    chunk.mapper->SetColorModeToMapScalars();
+
+    chunk.actor = vtkSmartPointer<vtkActor>::New();
+    chunk.actor->SetMapper(chunk.mapper);
+    chunk.actor->GetProperty()->SetColor(m_solidColor);
+    chunk.actor->GetProperty()->SetLineWidth(m_lineWidth);
+    applyColoring(chunk);
+
+    m_assembly->AddPart(chunk.actor);
+    m_chunks.push_back(chunk);
+    return m_chunks.back();
+}
+
+void TrajectoryView::appendPoint(const float position[3], const float attributes[kAttributeCount])
+{
+    if (m_chunks.empty() || m_chunks.back().points->GetNumberOfPoints() >= kChunkSize) {
+        // 新块容量：已知总点数时按剩余点数预留，否则按整块预留
+        vtkIdType capacity = kChunkSize;
+        if (m_expectedPoints > m_pointCount) {
+            capacity = std::min(capacity, m_expectedPoints - m_pointCount + 1);
+        }
+
+        if (m_chunks.empty()) {
+            newChunk(capacity);
+        } else {
+            // 新块以上一块的终点开始，折线在块间保持连续
+            Chunk& previous = m_chunks.back();
+            const vtkIdType last = previous.points->GetNumberOfPoints() - 1;
+            double p[3];
+            previous.points->GetPoint(last, p);
+            float carried[kAttributeCount];
+            for (int i = 0; i < kAttributeCount; ++i) {
+                carried[i] = previous.attributes[i]->GetValue(last);
+            }
+
+            Chunk& chunk = newChunk(capacity);
+            chunk.points->InsertNextPoint(p);
+            chunk.lines->InsertCellPoint(0);
+            for (int i = 0; i < kAttributeCount; ++i) {
+                chunk.attributes[i]->InsertNextValue(carried[i]);
+            }
+        }
+    }
+
+    Chunk& chunk = m_chunks.back();
+    const vtkIdType id = chunk.points->InsertNextPoint(position);
+    chunk.lines->InsertCellPoint(id);
+    for (int i = 0; i < kAttributeCount; ++i) {
+        chunk.attributes[i]->InsertNextValue(attributes[i]);
+        auto& range = m_dataRange[i];
+        if (m_pointCount == 0) {
+            range[0] = range[1] = attributes[i];
+        } else {
+            range[0] = std::min(range[0], attributes[i]);
+            range[1] = std::max(range[1], attributes[i]);
+        }
+    }
+    ++m_pointCount;
+
+    // 只有被修改的块需要重新上传GPU缓冲
+    m_firstDirtyChunk = std::min(m_firstDirtyChunk, m_chunks.size() - 1);
+}
+
+void TrajectoryView::finishAppend()
+{
+    for (size_t c = m_firstDirtyChunk; c < m_chunks.size(); ++c) {
+        Chunk& chunk = m_chunks[c];
+        chunk.lines->UpdateCellCount(static_cast<int>(chunk.points->GetNumberOfPoints()));
+        chunk.points->Modified();
+        chunk.lines->Modified();
+        for (auto& attribute : chunk.attributes) {
+            attribute->Modified();
+        }
+        chunk.data->Modified();
+    }
+    m_firstDirtyChunk = m_chunks.size();
+
+    // 新追加的点没有风险值，等待重新分析
+    if (m_hasRisk) {
+        m_hasRisk = false;
+        if (m_colorBy == Risk) {
+            applyColoringToAll();
+        }
+    }
+    updateDisplayRange(false);
+}
+
+void TrajectoryView::updateDisplayRange(bool reset)
+{
+    if (m_fixedRange || m_colorBy == Solid || m_pointCount == 0) {
+        return;
+    }
+
+    // 风险值固定为0-1，0.5（阈值）位于色标中间
+    if (m_colorBy == Risk) {
+        m_displayRange[0] = 0.0;
+        m_displayRange[1] = 1.0;
+        m_lookupTable->SetTableRange(m_displayRange);
+        return;
+    }
+
+    // 数据超出显示范围时扩展并预留余量，颜色表变化才会触发全部块重新着色
+    const auto& range = m_dataRange[m_colorBy - 1];
+    reset = reset || m_displayRange[1] <= m_displayRange[0];
+    if (!reset && range[0] >= m_displayRange[0] && range[1] <= m_displayRange[1]) {
+        return;
+    }
+
+    const double span = std::max<double>(range[1] - range[0], 1e-6);
+    double low = range[0] - kRangeHeadroom * span;
+    double high = range[1] + kRangeHeadroom * span;
+    if (!reset) {
+        low = std::min(low, m_displayRange[0]);
+        high = std::max(high, m_displayRange[1]);
+    }
+    m_displayRange[0] = low;
+    m_displayRange[1] = high;
+    m_lookupTable->SetTableRange(m_displayRange);
+}
+
+void TrajectoryView::applyColoring(Chunk& chunk) const
+{
+    // 风险尚未分析时不能显示为0（安全）
+    if (m_colorBy == Solid || (m_colorBy == Risk && !m_hasRisk)) {
+        chunk.mapper->ScalarVisibilityOff();
+    } else {
+        chunk.mapper->SelectColorArray(kAttributeNames[m_colorBy - 1]);
+        chunk.mapper->ScalarVisibilityOn();
+    }
+}
+
+void TrajectoryView::applyColoringToAll()
+{
+    for (Chunk& chunk : m_chunks) {
+        applyColoring(chunk);
+    }
+}
+
+} // namespace UI
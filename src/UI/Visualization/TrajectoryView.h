@@ -0,0 +1,146 @@
+#ifndef TRAJECTORYVIEW_H
+#define TRAJECTORYVIEW_H
+
+#include <QList>
+#include <QString>
+#include <array>
+#include <vector>
+
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+#include <vtkAssembly.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkLookupTable.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+
+#include "Models/TrajectoryData.h"
+
+namespace UI {
+
+/**
+ * @brief 流式喷涂轨迹显示
+ *
+ * 轨迹按固定大小分块，每块是一条折线单元（相邻块共用边界点保证连续），
+ * 点和属性数组预留块容量后原地追加：
+ * - 追加只修改最后一块，已写满的块不再变化，GPU缓冲不重新上传
+ * - 速度、流量、喷涂宽度和风险各存一个点标量数组，切换着色属性不重建几何
+ * - 标量范围随数据扩展时预留余量，避免每次追加都重新映射全部颜色
+ *
+ * 百万点轨迹可在规划过程中逐批追加显示。需在GUI线程中使用。
+ */
+class TrajectoryView
+{
+public:
+    /**
+     * @brief 着色属性
+     */
+    enum ColorBy {
+        Solid = 0,      // 单色
+        Speed,          // 速度 mm/s
+        FlowRate,       // 流量 0.0-1.0
+        SprayWidth,     // 喷涂宽度 mm
+        Risk            // 奇异/限位风险 0.0-1.0（TrajectoryRiskAnalyzer），0.5为阈值
+    };
+
+    static const vtkIdType kChunkSize = 65536;
+
+    TrajectoryView();
+
+    /**
+     * @brief 轨迹显示对象（各分块Actor的组合）
+     */
+    vtkAssembly* prop() const { return m_assembly; }
+
+    /**
+     * @brief 清空轨迹
+     * @param expectedPoints 预计点数，用于预留第一块的容量
+     */
+    void clear(vtkIdType expectedPoints = 0);
+
+    /**
+     * @brief 追加轨迹点
+     */
+    void append(const Data::TrajectoryPoint* points, size_t count);
+    void append(const QList<Data::TrajectoryPoint>& points);
+
+    /**
+     * @brief 追加只有位置的轨迹点（属性为0）
+     */
+    void append(const std::vector<std::array<double, 3>>& positions);
+
+    /**
+     * @brief 设置已追加各点的风险值，按点序对应，超出点数的部分忽略
+     *
+     * 清空或追加新点后风险值失效，未设置时按风险着色显示为单色，而不是全部为0（安全）。
+     */
+    void setRiskValues(const float* values, size_t count);
+    void setRiskValues(const std::vector<float>& values);
+    bool hasRiskValues() const { return m_hasRisk; }
+
+    vtkIdType pointCount() const { return m_pointCount; }
+
+    void setColorBy(ColorBy colorBy);
+    ColorBy colorBy() const { return m_colorBy; }
+
+    /**
+     * @brief 固定标量范围；min >= max时恢复为按数据自动扩展
+     */
+    void setScalarRange(double minValue, double maxValue);
+
+    /**
+     * @brief 当前着色属性的显示范围
+     */
+    void scalarRange(double range[2]) const;
+
+    vtkLookupTable* lookupTable() const { return m_lookupTable; }
+
+    /**
+     * @brief 着色属性的数组名（"Speed"/"FlowRate"/"SprayWidth"/"Risk"），单色时为空
+     */
+    static QString attributeName(ColorBy colorBy);
+
+    void setSolidColor(double r, double g, double b);
+    void setLineWidth(double width);
+
+private:
+    static const int kAttributeCount = 4;
+
+    struct Chunk {
+        vtkSmartPointer<vtkPolyData> data;
+        vtkSmartPointer<vtkPoints> points;
+        vtkSmartPointer<vtkCellArray> lines;
+        std::array<vtkSmartPointer<vtkFloatArray>, kAttributeCount> attributes;
+        vtkSmartPointer<vtkPolyDataMapper> mapper;
+        vtkSmartPointer<vtkActor> actor;
+    };
+
+    Chunk& newChunk(vtkIdType capacity);
+    void appendPoint(const float position[3], const float attributes[kAttributeCount]);
+    void finishAppend();
+    void updateDisplayRange(bool reset);
+    void applyColoring(Chunk& chunk) const;
+    void applyColoringToAll();
+
+private:
+    vtkSmartPointer<vtkAssembly> m_assembly;
+    vtkSmartPointer<vtkLookupTable> m_lookupTable;
+    std::vector<Chunk> m_chunks;
+    size_t m_firstDirtyChunk;                           // 上次提交后第一个被追加的块
+
+    vtkIdType m_pointCount;
+    vtkIdType m_expectedPoints;
+    ColorBy m_colorBy;
+    bool m_fixedRange;
+    bool m_hasRisk;                     // 风险值覆盖全部已追加的点
+    double m_displayRange[2];
+    std::array<std::array<float, 2>, kAttributeCount> m_dataRange;    // 各属性已追加数据的范围
+    double m_solidColor[3];
+    double m_lineWidth;
+};
+
+} // namespace UI
+
+#endif // TRAJECTORYVIEW_H
@@ -1,7 +1,11 @@
 #include "VTKWidget.h"
+#include "RenderScheduler.h"
+#include "LargePointCloudRenderer.h"
 #include "../Panels/StatusPanel.h"
 #include "../ModelTree/STEPModelTreeWidget.h"
 #include "../../Data/STEP/STEPModelTree.h"  // 添加STEP模型树头文件
+#include "DampedLeastSquaresIK.h"
+#include "TrajectoryRiskAnalyzer.h"
 #include <QDebug>
 #include <QMessageBox>
 #include <QFileInfo>
@@ -49,6 +53,14 @@
 #include <IFSelect_ReturnStatus.hxx>
 #include <Standard_Failure.hxx>  // 添加异常处理头文件
 #include <vtkMatrix4x4.h>
+#include <vtkCommand.h>
+#include <vtkCellPicker.h>
+#include <vtkFloatArray.h>
+#include <vtkLookupTable.h>
+#include <vtkTextProperty.h>
+#include <QPointer>
+#include <QThreadPool>
+#include <QRunnable>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -76,10 +88,10 @@ VTKWidget::VTKWidget(QWidget *parent)
     , m_renderer(nullptr)
     , m_renderWindow(nullptr)
     , m_interactor(nullptr)
+    , m_renderScheduler(nullptr)
     , m_workshopActor(nullptr)
     , m_workpieceActor(nullptr)
     , m_robotActor(nullptr)
-    , m_trajectoryActor(nullptr)
     , m_axesActor(nullptr)
     , m_axesWidget(nullptr)
     , m_workshopLoaded(false)
@@ -92,6 +104,15 @@ VTKWidget::VTKWidget(QWidget *parent)
     , m_currentAnimationStep(0)
     , m_statusPanel(nullptr)
     , m_modelTreeWidget(nullptr)
+    , m_pressObserverTag(0)
+    , m_releaseObserverTag(0)
+    , m_robotKinematics(nullptr)
+    , m_linkActorGeneration(-1)
+    , m_linkActorsDirty(true)
+    , m_deviationRunning(false)
+    , m_deviationRequest(0)
+    , m_trajectoryRiskRequest(0)
+    , m_largePointCloudMode(false)
 {
     setupUI();
     setupVTKPipeline();
@@ -104,6 +125,13 @@ VTKWidget::VTKWidget(QWidget *parent)
     // 初始化机械臂变换
     m_robotTransform = vtkSmartPointer<vtkTransform>::New();
     
+    // 连杆位姿更新使用的运动学模型和预分配矩阵
+    m_robotKinematics = new Robot::RobotKinematics(this);
+    for (auto& matrix : m_linkMatrices) {
+        matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    }
+    m_robotEndMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    
     // 初始化位姿
     for (int i = 0; i < 6; ++i) {
         m_robotCurrentPose[i] = 0.0;
@@ -118,6 +146,12 @@ VTKWidget::~VTKWidget()
         m_robotAnimationTimer->stop();
     }
     
+    // 交互器由渲染窗口持有，可能比本控件存活更久
+    if (m_interactor) {
+        m_interactor->RemoveObserver(m_pressObserverTag);
+        m_interactor->RemoveObserver(m_releaseObserverTag);
+    }
+    
     qDebug() << "=== VTKWidget析构完成 ===";
     // VTK智能指针会自动清理资源
 }
@@ -192,6 +226,9 @@ void VTKWidget::setupVTKPipeline()
     // 设置VTK widget的渲染窗口
     m_vtkWidget->setRenderWindow(m_renderWindow);
     
+    // 场景更新只请求重绘，由调度器按帧率合并
+    m_renderScheduler = new RenderScheduler(m_renderWindow, m_vtkWidget, this);
+    
     // 获取交互器
     m_interactor = m_renderWindow->GetInteractor();
     
@@ -199,6 +236,15 @@ void VTKWidget::setupVTKPipeline()
     vtkSmartPointer<vtkInteractorStyleTrackballCamera> style = 
         vtkSmartPointer<vtkInteractorStyleTrackballCamera>::New();
     m_interactor->SetInteractorStyle(style);
+    // 交互期间的期望帧率，大点云据此在旋转/平移时切换到粗层级
+    m_interactor->SetDesiredUpdateRate(30.0);
+    
+    // 单击拾取（不影响轨迹球的旋转/平移）
+    m_pressPosition[0] = m_pressPosition[1] = 0;
+    m_pressObserverTag = m_interactor->AddObserver(vtkCommand::LeftButtonPressEvent, this,
+                                                   &VTKWidget::OnLeftButtonPress);
+    m_releaseObserverTag = m_interactor->AddObserver(vtkCommand::LeftButtonReleaseEvent, this,
+                                                     &VTKWidget::OnLeftButtonRelease);
     
     // 添加坐标轴
     m_axesActor = vtkSmartPointer<vtkAxesActor>::New();
@@ -390,6 +436,11 @@ bool VTKWidget::LoadSTLModel(const QString& filePath)
             if (m_workpieceActor) {
                 m_renderer->RemoveActor(m_workpieceActor);
             }
+            if (m_largeCloud) {
+                ClearDeviationMap();
+                m_largeCloud->detach();
+                m_largeCloud.reset();
+            }
             targetActor = &m_workpieceActor;
             targetButton = m_toggleWorkpieceBtn;
             loadedFlag = &m_workpieceLoaded;
@@ -453,8 +504,7 @@ bool VTKWidget::LoadSTLModel(const QString& filePath)
         }
         
         // 刷新渲染
-        m_renderWindow->Render();
-        m_vtkWidget->update();
+        RefreshRender();
         QApplication::processEvents();
         
         qDebug() << "✅" << modelType << "渲染完成";
@@ -500,7 +550,7 @@ void VTKWidget::SetRobotPose(double x, double y, double z, double rx, double ry,
     m_robotActor->SetUserTransform(m_robotTransform);
     
     // 刷新渲染
-    m_renderWindow->Render();
+    RefreshRender();
     
     qDebug() << "机械臂位姿已更新:" << x << y << z << rx << ry << rz;
 }
@@ -585,7 +635,7 @@ void VTKWidget::updateRobotAnimation()
     m_robotActor->SetUserTransform(m_robotTransform);
     
     // 刷新渲染
-    m_renderWindow->Render();
+    RefreshRender();
     
     m_currentAnimationStep++;
     
@@ -597,140 +647,86 @@ void VTKWidget::updateRobotAnimation()
     }
 }
 
+void VTKWidget::SetSTEPModelTreeWidget(STEPModelTreeWidget* treeWidget)
+{
+    if (m_modelTreeWidget == treeWidget) {
+        return;
+    }
+    if (m_modelTreeWidget) {
+        disconnect(m_modelTreeWidget, &STEPModelTreeWidget::partActorsAdded,
+                   this, &VTKWidget::onModelTreeActorsAdded);
+    }
+    m_modelTreeWidget = treeWidget;
+    m_linkActorsDirty = true;
+    if (m_modelTreeWidget) {
+        connect(m_modelTreeWidget, &STEPModelTreeWidget::partActorsAdded,
+                this, &VTKWidget::onModelTreeActorsAdded);
+    }
+}
+
+void VTKWidget::onModelTreeActorsAdded()
+{
+    m_linkActorsDirty = true;
+}
+
 void VTKWidget::UpdateRobotJoints(const std::array<double, 6>& jointAngles)
 {
-    // 使用DH参数计算每个关节的变换矩阵
-    // TODO: 更新为 MPX3500 机器人的实际 DH 参数
-    
-    const double DEG_TO_RAD = M_PI / 180.0;
-    
-    // DH参数表：a(mm), alpha(rad), d(mm), theta_offset(rad)
-    // 这些是占位符参数，需要根据 MPX3500 规格更新
-    struct DHParam {
-        double a, alpha, d, theta_offset;
-    };
-    
-    const DHParam dhParams[6] = {
-        {0,      -M_PI/2, 0,    0},      // J1: 待更新
-        {0,      0,       0,    0},      // J2: 待更新
-        {0,      -M_PI/2, 0,    0},      // J3: 待更新
-        {0,      M_PI/2,  0,    0},      // J4: 待更新
-        {0,      -M_PI/2, 0,    0},      // J5: 待更新
-        {0,      0,       0,    0}       // J6: 待更新
-    };
-    
-    // 部件名称映射
-    const QString partNames[6] = {"NAUO1", "NAUO2", "NAUO3", "NAUO4", "NAUO5", "NAUO6"};
+    // 连杆位移由运动学模块计算，与RobotKinematics使用同一套DH参数
+    m_robotKinematics->computeLinkDisplacements(jointAngles, m_linkPoses);
+    UpdateRobotLinkPoses(m_linkPoses);
     
+    // 记录显示的姿态，作为轨迹风险分析的逆解初值
+    m_robotKinematics->setJointAngles(jointAngles);
+}
+
+void VTKWidget::UpdateRobotLinkPoses(const Robot::LinkPoses& poses)
+{
     if (m_modelTreeWidget) {
-        // 计算从基座到各关节的累积变换矩阵
-        vtkSmartPointer<vtkTransform> cumulativeTransform = vtkSmartPointer<vtkTransform>::New();
-        cumulativeTransform->Identity();
-        
-        for (int i = 0; i < 6; ++i) {
-            const DHParam& dh = dhParams[i];
-            double theta = jointAngles[i] * DEG_TO_RAD + dh.theta_offset;
-            
-            // DH变换矩阵 = Rot_Z(theta) * Trans_Z(d) * Trans_X(a) * Rot_X(alpha)
-            vtkSmartPointer<vtkTransform> jointTransform = vtkSmartPointer<vtkTransform>::New();
-            jointTransform->Identity();
-            
-            // 应用DH变换
-            double ct = cos(theta);
-            double st = sin(theta);
-            double ca = cos(dh.alpha);
-            double sa = sin(dh.alpha);
-            
-            // 构建4x4变换矩阵
-            vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
-            matrix->SetElement(0, 0, ct);
-            matrix->SetElement(0, 1, -st * ca);
-            matrix->SetElement(0, 2, st * sa);
-            matrix->SetElement(0, 3, dh.a * ct);
-            
-            matrix->SetElement(1, 0, st);
-            matrix->SetElement(1, 1, ct * ca);
-            matrix->SetElement(1, 2, -ct * sa);
-            matrix->SetElement(1, 3, dh.a * st);
-            
-            matrix->SetElement(2, 0, 0);
-            matrix->SetElement(2, 1, sa);
-            matrix->SetElement(2, 2, ca);
-            matrix->SetElement(2, 3, dh.d);
-            
-            matrix->SetElement(3, 0, 0);
-            matrix->SetElement(3, 1, 0);
-            matrix->SetElement(3, 2, 0);
-            matrix->SetElement(3, 3, 1);
-            
-            jointTransform->SetMatrix(matrix);
-            
-            // 累积变换
-            cumulativeTransform->Concatenate(jointTransform);
-            
-            // 应用变换到对应的部件
-            m_modelTreeWidget->applyTransformToActor(partNames[i], cumulativeTransform);
-            
-            qDebug() << "VTKWidget: 应用变换到" << partNames[i] 
-                     << "- 关节角度:" << jointAngles[i] << "°";
+        // 只在场景清空或有部件新网格化后重新解析，缺失的连杆不会导致每帧查找
+        if (m_linkActorsDirty || m_linkActorGeneration != m_modelTreeWidget->sceneGeneration()) {
+            resolveRobotLinkActors();
         }
         
-        m_renderWindow->Render();
+        // 热路径：只就地改写预分配矩阵，不分配、不查找、不输出日志
+        for (size_t i = 0; i < m_linkActors.size(); ++i) {
+            if (m_linkActors[i]) {
+                std::copy(poses[i].begin(), poses[i].end(), &m_linkMatrices[i]->Element[0][0]);
+                m_linkMatrices[i]->Modified();
+            }
+        }
     }
     else if (m_robotActor) {
-        // 如果有专用机器人Actor，计算末端位姿
-        vtkSmartPointer<vtkTransform> endEffectorTransform = vtkSmartPointer<vtkTransform>::New();
-        endEffectorTransform->Identity();
-        
-        for (int i = 0; i < 6; ++i) {
-            const DHParam& dh = dhParams[i];
-            double theta = jointAngles[i] * DEG_TO_RAD + dh.theta_offset;
-            
-            vtkSmartPointer<vtkTransform> jointTransform = vtkSmartPointer<vtkTransform>::New();
-            jointTransform->Identity();
-            
-            double ct = cos(theta);
-            double st = sin(theta);
-            double ca = cos(dh.alpha);
-            double sa = sin(dh.alpha);
-            
-            vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
-            matrix->SetElement(0, 0, ct);
-            matrix->SetElement(0, 1, -st * ca);
-            matrix->SetElement(0, 2, st * sa);
-            matrix->SetElement(0, 3, dh.a * ct);
-            
-            matrix->SetElement(1, 0, st);
-            matrix->SetElement(1, 1, ct * ca);
-            matrix->SetElement(1, 2, -ct * sa);
-            matrix->SetElement(1, 3, dh.a * st);
-            
-            matrix->SetElement(2, 0, 0);
-            matrix->SetElement(2, 1, sa);
-            matrix->SetElement(2, 2, ca);
-            matrix->SetElement(2, 3, dh.d);
-            
-            matrix->SetElement(3, 0, 0);
-            matrix->SetElement(3, 1, 0);
-            matrix->SetElement(3, 2, 0);
-            matrix->SetElement(3, 3, 1);
-            
-            jointTransform->SetMatrix(matrix);
-            endEffectorTransform->Concatenate(jointTransform);
+        // 单一机器人模型只能整体显示末端位姿
+        std::copy(poses.back().begin(), poses.back().end(), &m_robotEndMatrix->Element[0][0]);
+        m_robotEndMatrix->Modified();
+        if (m_robotActor->GetUserMatrix() != m_robotEndMatrix) {
+            m_robotActor->SetUserMatrix(m_robotEndMatrix);
         }
-        
-        m_robotActor->SetUserTransform(endEffectorTransform);
-        m_renderWindow->Render();
     }
     else {
-        // 仿真模式下，关节角度变化仍然有效，只是没有3D可视化
-        qDebug() << "VTKWidget: 关节角度更新 (无3D模型) -"
-                 << "J1:" << jointAngles[0]
-                 << "J2:" << jointAngles[1]
-                 << "J3:" << jointAngles[2]
-                 << "J4:" << jointAngles[3]
-                 << "J5:" << jointAngles[4]
-                 << "J6:" << jointAngles[5];
+        // 仿真模式下没有3D模型，关节角度变化仍然有效
+        return;
+    }
+    
+    RefreshRender();
+}
+
+void VTKWidget::resolveRobotLinkActors()
+{
+    static const QString linkPartNames[6] = {"NAUO1", "NAUO2", "NAUO3", "NAUO4", "NAUO5", "NAUO6"};
+    
+    m_linkActorGeneration = m_modelTreeWidget->sceneGeneration();
+    m_linkActorsDirty = false;
+    for (size_t i = 0; i < m_linkActors.size(); ++i) {
+        vtkActor* actor = m_modelTreeWidget->resolveDynamicActor(linkPartNames[i]);
+        m_linkActors[i] = actor;
+        if (!actor) {
+            // 部件尚未网格化或模型中没有该连杆，等模型树发出partActorsAdded后重试
+            continue;
+        }
+        if (actor->GetUserMatrix() != m_linkMatrices[i]) {
+            actor->SetUserMatrix(m_linkMatrices[i]);
+        }
     }
 }
 
@@ -748,6 +744,14 @@ bool VTKWidget::LoadPointCloud(const QString& filePath)
     m_statusLabel->setText("正在加载点云数据...");
     QApplication::processEvents();
     
+    // 新点云替换旧点云，丢弃旧点云的偏差结果
+    ClearDeviationMap();
+    if (m_largeCloud) {
+        m_largeCloud->detach();
+        m_largeCloud.reset();
+        m_workpieceActor = nullptr;
+    }
+    
     try {
         // 使用VTK PLY读取器
         vtkSmartPointer<vtkPLYReader> reader = vtkSmartPointer<vtkPLYReader>::New();
@@ -785,6 +789,11 @@ bool VTKWidget::LoadPointCloud(const QString& filePath)
             return CreateFallbackPointCloud();
         }
         
+        // 大点云不经过顶点滤波器，直接按LOD层级绘制
+        if (m_largePointCloudMode || reader->GetOutput()->GetNumberOfPoints() > kLargePointCloudThreshold) {
+            return loadLargePointCloud(reader->GetOutput());
+        }
+        
         // 创建点云可视化
         vtkSmartPointer<vtkVertexGlyphFilter> vertexFilter = 
             vtkSmartPointer<vtkVertexGlyphFilter>::New();
@@ -898,10 +907,7 @@ bool VTKWidget::LoadPointCloud(const QString& filePath)
         }
         
         // 🔧 关键修复：强制刷新渲染
-        m_renderWindow->Render();
-        
-        // 强制Qt widget更新
-        m_vtkWidget->update();
+        RefreshRender();
         QApplication::processEvents();
         
         qDebug() << "✅ 渲染完成";
@@ -922,6 +928,58 @@ bool VTKWidget::LoadPointCloud(const QString& filePath)
     }
 }
 
+bool VTKWidget::loadLargePointCloud(vtkPolyData* cloud)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    std::unique_ptr<LargePointCloudRenderer> largeCloud(new LargePointCloudRenderer());
+    if (!largeCloud->setPointCloud(cloud)) {
+        m_statusLabel->setText("错误: 点云数据无效");
+        emit ModelLoaded("PointCloud", false);
+        return false;
+    }
+
+    if (m_workpieceActor) {
+        m_renderer->RemoveActor(m_workpieceActor);
+    }
+    m_largeCloud = std::move(largeCloud);
+    m_largeCloud->attach(m_renderer);
+    m_workpieceActor = m_largeCloud->actor();
+
+    const vtkIdType numPoints = m_largeCloud->pointCount();
+    double bounds[6];
+    m_largeCloud->fullResolution()->GetBounds(bounds);
+    const double sizeX = bounds[1] - bounds[0];
+    const double sizeY = bounds[3] - bounds[2];
+    const double sizeZ = bounds[5] - bounds[4];
+
+    m_workpieceLoaded = true;
+    m_toggleWorkpieceBtn->setEnabled(true);
+    m_statusLabel->setText(QString("点云已加载 (%1 个点, %2 级LOD, 尺寸: %3x%4x%5)")
+        .arg(numPoints).arg(m_largeCloud->levelCount())
+        .arg(sizeX, 0, 'f', 0).arg(sizeY, 0, 'f', 0).arg(sizeZ, 0, 'f', 0));
+    qDebug() << "VTKWidget: 大点云模式加载完成，点数" << numPoints
+             << "LOD层级" << m_largeCloud->levelCount() << "耗时" << timer.elapsed() << "ms";
+
+    FitToScene();
+    emit ModelLoaded("PointCloud", true);
+    return true;
+}
+
+vtkPolyData* VTKWidget::workpieceCloudData() const
+{
+    if (m_largeCloud) {
+        return m_largeCloud->fullResolution();
+    }
+    if (m_deviationSourceCloud) {
+        return m_deviationSourceCloud;
+    }
+    vtkPolyDataMapper* mapper = m_workpieceActor
+        ? vtkPolyDataMapper::SafeDownCast(m_workpieceActor->GetMapper()) : nullptr;
+    return mapper ? mapper->GetInput() : nullptr;
+}
+
 bool VTKWidget::LoadRobotModel(const QString& urdfPath)
 {
     // 机器人模型加载（URDF支持）
@@ -931,6 +989,201 @@ bool VTKWidget::LoadRobotModel(const QString& urdfPath)
     return false;
 }
 
+bool VTKWidget::AnalyzeDeviation(std::shared_ptr<const Simulation::TriangleBVH> cad,
+                                 const Simulation::DeviationOptions& options)
+{
+    if (m_deviationRunning) {
+        qWarning() << "VTKWidget: 偏差分析正在进行，忽略本次请求";
+        return false;
+    }
+    if (!cad || !cad->isBuilt() || cad->isEmpty()) {
+        qWarning() << "VTKWidget: CAD模型未就绪，无法进行偏差分析";
+        m_statusLabel->setText("偏差分析: CAD模型未就绪");
+        return false;
+    }
+
+    vtkPolyData* cloud = workpieceCloudData();
+    if (!cloud || !cloud->GetPoints() || cloud->GetNumberOfPoints() == 0) {
+        qWarning() << "VTKWidget: 未加载点云，无法进行偏差分析";
+        m_statusLabel->setText("偏差分析: 请先导入点云");
+        return false;
+    }
+
+    // 点坐标拷贝为连续的float数组，分析期间点云可被替换而不影响后台线程
+    vtkPoints* points = cloud->GetPoints();
+    const vtkIdType count = points->GetNumberOfPoints();
+    auto xyz = std::make_shared<std::vector<float>>(static_cast<size_t>(count) * 3);
+    if (points->GetDataType() == VTK_FLOAT) {
+        const float* source = static_cast<const float*>(points->GetVoidPointer(0));
+        std::copy(source, source + count * 3, xyz->begin());
+    } else {
+        double p[3];
+        for (vtkIdType i = 0; i < count; ++i) {
+            points->GetPoint(i, p);
+            (*xyz)[i * 3] = static_cast<float>(p[0]);
+            (*xyz)[i * 3 + 1] = static_cast<float>(p[1]);
+            (*xyz)[i * 3 + 2] = static_cast<float>(p[2]);
+        }
+    }
+
+    m_deviationRunning = true;
+    const int request = ++m_deviationRequest;
+    m_statusLabel->setText(QString("正在进行偏差分析 (%1 个点)...").arg(count));
+    if (m_statusPanel) {
+        m_statusPanel->addLogMessage("INFO", QString("开始扫描-CAD偏差分析，点数: %1，公差: ±%2 mm")
+            .arg(count).arg(options.tolerance));
+    }
+
+    QPointer<VTKWidget> guard(this);
+    QThreadPool::globalInstance()->start(QRunnable::create([guard, cad, xyz, options, request]() {
+        auto report = std::make_shared<Simulation::DeviationReport>();
+        try {
+            *report = Simulation::DeviationAnalyzer::analyze(*cad, xyz->data(), xyz->size() / 3, options);
+        } catch (const std::exception& e) {
+            report->valid = false;
+            report->errorMessage = QString("偏差分析异常: %1").arg(e.what());
+            qCritical() << "VTKWidget:" << report->errorMessage;
+        }
+
+        QMetaObject::invokeMethod(guard.data(), [guard, report, request]() {
+            if (!guard) {
+                return;
+            }
+            guard->m_deviationRunning = false;
+            if (request != guard->m_deviationRequest) {
+                qDebug() << "VTKWidget: 点云已变化，丢弃过期的偏差分析结果";
+                return;
+            }
+
+            if (report->valid) {
+                guard->applyDeviationMap(*report);
+            } else {
+                guard->m_statusLabel->setText(QString("偏差分析失败: %1").arg(report->errorMessage));
+            }
+            emit guard->DeviationAnalysisFinished(report->toJson());
+        }, Qt::QueuedConnection);
+    }));
+    return true;
+}
+
+void VTKWidget::applyDeviationMap(const Simulation::DeviationReport& report)
+{
+    vtkPolyData* cloud = workpieceCloudData();
+    if (!cloud || cloud->GetNumberOfPoints() != static_cast<vtkIdType>(report.deviations.size())) {
+        qWarning() << "VTKWidget: 点云与偏差结果不匹配，跳过着色";
+        return;
+    }
+
+    vtkSmartPointer<vtkFloatArray> scalars = vtkSmartPointer<vtkFloatArray>::New();
+    scalars->SetName("Deviation");
+    scalars->SetNumberOfTuples(static_cast<vtkIdType>(report.deviations.size()));
+    std::copy(report.deviations.begin(), report.deviations.end(), scalars->GetPointer(0));
+
+    // 发散色表：公差带内为绿色，向两侧分别过渡到蓝色（不足）和红色（多余），超出范围饱和
+    const double tolerance = std::max(report.tolerance, 1e-6);
+    const double maxAbs = std::max(std::abs(report.minDeviation), std::abs(report.maxDeviation));
+    const double range = std::max(2.0 * tolerance, std::min(maxAbs, 10.0 * tolerance));
+    const int tableSize = 256;
+    vtkSmartPointer<vtkLookupTable> lut = vtkSmartPointer<vtkLookupTable>::New();
+    lut->SetNumberOfTableValues(tableSize);
+    lut->SetTableRange(-range, range);
+    for (int i = 0; i < tableSize; ++i) {
+        const double value = -range + 2.0 * range * (i + 0.5) / tableSize;
+        if (std::abs(value) <= tolerance) {
+            lut->SetTableValue(i, 0.2, 0.8, 0.2, 1.0);
+            continue;
+        }
+        const double t = std::min(1.0, (std::abs(value) - tolerance) / (range - tolerance));
+        if (value > 0.0) {
+            lut->SetTableValue(i, 1.0, 0.8 * (1.0 - t), 0.0, 1.0);
+        } else {
+            lut->SetTableValue(i, 0.0, 0.8 * (1.0 - t), 1.0, 1.0);
+        }
+    }
+    lut->SetNanColor(0.5, 0.5, 0.5, 1.0);
+    lut->SetUseBelowRangeColor(false);
+    lut->SetUseAboveRangeColor(false);
+
+    if (m_largeCloud) {
+        // LOD模式下各层级按各自的前缀取标量
+        m_largeCloud->setPointScalars(scalars, lut, -range, range);
+    } else {
+        // 在浅拷贝上挂载偏差标量，原始点云（及其颜色）保留用于恢复
+        m_deviationSourceCloud = cloud;
+        vtkSmartPointer<vtkPolyData> colored = vtkSmartPointer<vtkPolyData>::New();
+        colored->ShallowCopy(cloud);
+        colored->GetPointData()->SetScalars(scalars);
+
+        vtkPolyDataMapper* mapper = vtkPolyDataMapper::SafeDownCast(m_workpieceActor->GetMapper());
+        mapper->SetInputData(colored);
+        mapper->SetLookupTable(lut);
+        mapper->SetScalarRange(-range, range);
+        mapper->SetScalarModeToUsePointData();
+        mapper->ScalarVisibilityOn();
+    }
+
+    // 点云变换到CAD坐标系
+    vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            matrix->SetElement(r, c, report.registration(r, c));
+        }
+    }
+    m_workpieceActor->SetUserMatrix(matrix);
+
+    if (!m_deviationScalarBar) {
+        m_deviationScalarBar = vtkSmartPointer<vtkScalarBarActor>::New();
+        m_deviationScalarBar->SetTitle("Deviation (mm)");
+        m_deviationScalarBar->SetNumberOfLabels(5);
+        m_deviationScalarBar->SetWidth(0.08);
+        m_deviationScalarBar->SetHeight(0.5);
+        m_deviationScalarBar->SetPosition(0.9, 0.25);
+        m_deviationScalarBar->GetTitleTextProperty()->SetFontSize(12);
+        m_deviationScalarBar->GetLabelTextProperty()->SetFontSize(10);
+    }
+    m_deviationScalarBar->SetLookupTable(lut);
+    if (!m_renderer->HasViewProp(m_deviationScalarBar)) {
+        m_renderer->AddActor2D(m_deviationScalarBar);
+    }
+
+    m_statusLabel->setText(QString("偏差分析完成: RMS %1 mm，超差 %2%，超差区域 %3 个")
+        .arg(report.rmsDeviation, 0, 'f', 3)
+        .arg(report.outOfToleranceRatio() * 100.0, 0, 'f', 2)
+        .arg(report.regions.size()));
+    RefreshRender();
+}
+
+void VTKWidget::ClearDeviationMap()
+{
+    // 使进行中的分析结果失效
+    ++m_deviationRequest;
+
+    if (m_deviationScalarBar && m_renderer) {
+        m_renderer->RemoveActor2D(m_deviationScalarBar);
+    }
+
+    if (m_largeCloud) {
+        m_largeCloud->clearPointScalars();
+        m_workpieceActor->SetUserMatrix(nullptr);
+        RefreshRender();
+        return;
+    }
+
+    if (!m_deviationSourceCloud) {
+        return;
+    }
+
+    vtkPolyDataMapper* mapper = m_workpieceActor
+        ? vtkPolyDataMapper::SafeDownCast(m_workpieceActor->GetMapper()) : nullptr;
+    if (mapper) {
+        mapper->SetInputData(m_deviationSourceCloud);
+        mapper->SetScalarModeToDefault();
+        m_workpieceActor->SetUserMatrix(nullptr);
+    }
+    m_deviationSourceCloud = nullptr;
+    RefreshRender();
+}
+
 void VTKWidget::ShowSprayTrajectory(const std::vector<std::array<double, 3>>& trajectory)
 {
     if (trajectory.empty()) {
@@ -940,62 +1193,159 @@ void VTKWidget::ShowSprayTrajectory(const std::vector<std::array<double, 3>>& tr
     
     qDebug() << "显示喷涂轨迹，点数:" << trajectory.size();
     
-    // 创建轨迹点
-    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-    for (const auto& point : trajectory) {
-        points->InsertNextPoint(point[0], point[1], point[2]);
-    }
+    TrajectoryView* view = trajectoryView();
+    view->clear(static_cast<vtkIdType>(trajectory.size()));
+    view->append(trajectory);
+    RefreshRender();
     
-    // 创建轨迹线
-    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
-    polyData->SetPoints(points);
-    
-    // 创建线段连接
-    vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
-    for (size_t i = 0; i < trajectory.size() - 1; ++i) {
-        vtkSmartPointer<vtkLine> line = vtkSmartPointer<vtkLine>::New();
-        line->GetPointIds()->SetId(0, i);
-        line->GetPointIds()->SetId(1, i + 1);
-        lines->InsertNextCell(line);
+    m_statusLabel->setText(QString("轨迹已显示 (%1 个点)").arg(trajectory.size()));
+}
+
+void VTKWidget::ShowSprayTrajectory(const QList<Data::TrajectoryPoint>& trajectory)
+{
+    if (trajectory.isEmpty()) {
+        qWarning() << "轨迹数据为空";
+        return;
     }
-    polyData->SetLines(lines);
-    
-    // 创建mapper
-    vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-    mapper->SetInputData(polyData);
     
-    // 创建或更新actor
-    if (!m_trajectoryActor) {
-        m_trajectoryActor = vtkSmartPointer<vtkActor>::New();
-        m_renderer->AddActor(m_trajectoryActor);
+    BeginTrajectoryStream(trajectory.size());
+    AppendTrajectoryPoints(trajectory);
+    analyzeTrajectoryRisk(trajectory);
+}
+
+void VTKWidget::BeginTrajectoryStream(vtkIdType expectedPoints)
+{
+    // 使进行中的风险分析结果失效
+    ++m_trajectoryRiskRequest;
+    trajectoryView()->clear(expectedPoints);
+    RefreshRender();
+}
+
+void VTKWidget::analyzeTrajectoryRisk(const QList<Data::TrajectoryPoint>& trajectory)
+{
+    const int request = ++m_trajectoryRiskRequest;
+    const std::array<double, 6> seed = m_robotKinematics->getJointAngles();
+
+    QPointer<VTKWidget> guard(this);
+    QThreadPool::globalInstance()->start(QRunnable::create([guard, trajectory, seed, request]() {
+        auto risk = std::make_shared<std::vector<float>>();
+        int flaggedCount = 0;
+        int failedCount = 0;
+        try {
+            // 工作线程使用独立的运动学对象，与界面线程的关节状态互不影响
+            Robot::RobotKinematics robot;
+            Robot::DampedLeastSquaresIK ik(robot);
+            Data::TrajectoryData data;
+            data.setPoints(trajectory);
+            const Robot::DampedLeastSquaresIK::PathResult path = ik.solvePath(trajectory, seed.data());
+            const Robot::TrajectoryRiskAnalyzer::Report report = Robot::TrajectoryRiskAnalyzer(robot).analyze(data, path);
+            *risk = report.riskValues();
+            flaggedCount = report.flaggedCount;
+            failedCount = path.failedCount;
+        } catch (const std::exception& e) {
+            risk->clear();
+            qCritical() << "VTKWidget: 轨迹风险分析异常:" << e.what();
+        }
+
+        QMetaObject::invokeMethod(guard.data(), [guard, risk, flaggedCount, failedCount, request]() {
+            if (!guard) {
+                return;
+            }
+            if (request != guard->m_trajectoryRiskRequest) {
+                qDebug() << "VTKWidget: 轨迹已变化，丢弃过期的风险分析结果";
+                return;
+            }
+            if (risk->empty()) {
+                qWarning() << "VTKWidget: 轨迹风险分析没有结果，按风险着色时显示为单色";
+                return;
+            }
+
+            guard->SetTrajectoryRisk(*risk);
+            qDebug() << "VTKWidget: 轨迹风险分析完成，风险点:" << flaggedCount << "逆解未收敛:" << failedCount;
+            if (guard->m_statusPanel) {
+                guard->m_statusPanel->addLogMessage(flaggedCount > 0 ? "WARNING" : "INFO",
+                    QString("轨迹风险分析完成: %1 个点，%2 个奇异/限位风险点，%3 个点逆解未收敛")
+                        .arg(risk->size()).arg(flaggedCount).arg(failedCount));
+            }
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void VTKWidget::AppendTrajectoryPoints(const QList<Data::TrajectoryPoint>& points)
+{
+    if (points.isEmpty()) {
+        return;
     }
     
-    m_trajectoryActor->SetMapper(mapper);
-    
-    // 设置轨迹显示属性
-    m_trajectoryActor->GetProperty()->SetColor(0.0, 1.0, 0.0); // 绿色轨迹
-    m_trajectoryActor->GetProperty()->SetLineWidth(3.0);
+    TrajectoryView* view = trajectoryView();
+    view->append(points);
+    RefreshRender();
     
-    // 刷新渲染
-    m_renderWindow->Render();
+    m_statusLabel->setText(QString("轨迹已显示 (%1 个点)").arg(view->pointCount()));
+}
+
+void VTKWidget::SetTrajectoryRisk(const std::vector<float>& risk)
+{
+    TrajectoryView* view = trajectoryView();
+    view->setRiskValues(risk);
+    RefreshRender();
+}
+
+void VTKWidget::SetTrajectoryColorBy(TrajectoryView::ColorBy colorBy)
+{
+    TrajectoryView* view = trajectoryView();
+    view->setColorBy(colorBy);
+    if (colorBy == TrajectoryView::Risk && view->pointCount() > 0 && !view->hasRiskValues()) {
+        m_statusLabel->setText("轨迹风险尚未分析，暂以单色显示");
+    }
     
-    m_statusLabel->setText(QString("轨迹已显示 (%1 个点)").arg(trajectory.size()));
+    // 按属性着色时显示色标
+    if (!m_trajectoryScalarBar) {
+        m_trajectoryScalarBar = vtkSmartPointer<vtkScalarBarActor>::New();
+        m_trajectoryScalarBar->SetNumberOfLabels(5);
+        m_trajectoryScalarBar->SetWidth(0.08);
+        m_trajectoryScalarBar->SetHeight(0.5);
+        m_trajectoryScalarBar->SetPosition(0.02, 0.25);
+        m_trajectoryScalarBar->GetTitleTextProperty()->SetFontSize(12);
+        m_trajectoryScalarBar->GetLabelTextProperty()->SetFontSize(10);
+        m_trajectoryScalarBar->SetLookupTable(view->lookupTable());
+    }
+    if (colorBy == TrajectoryView::Solid) {
+        m_renderer->RemoveActor2D(m_trajectoryScalarBar);
+    } else {
+        m_trajectoryScalarBar->SetTitle(TrajectoryView::attributeName(colorBy).toStdString().c_str());
+        if (!m_renderer->HasViewProp(m_trajectoryScalarBar)) {
+            m_renderer->AddActor2D(m_trajectoryScalarBar);
+        }
+    }
+    RefreshRender();
 }
 
 void VTKWidget::ClearTrajectory()
 {
-    if (m_trajectoryActor) {
-        m_renderer->RemoveActor(m_trajectoryActor);
-        m_trajectoryActor = nullptr;
-        m_renderWindow->Render();
+    ++m_trajectoryRiskRequest;
+    if (m_trajectoryView && m_trajectoryView->pointCount() > 0) {
+        m_trajectoryView->clear();
+        RefreshRender();
         qDebug() << "轨迹已清除";
     }
 }
 
+TrajectoryView* VTKWidget::trajectoryView()
+{
+    if (!m_trajectoryView) {
+        m_trajectoryView.reset(new TrajectoryView());
+        m_trajectoryView->setSolidColor(0.0, 1.0, 0.0); // 绿色轨迹
+        m_trajectoryView->setLineWidth(3.0);
+        m_renderer->AddViewProp(m_trajectoryView->prop());
+    }
+    return m_trajectoryView.get();
+}
+
 void VTKWidget::ResetCamera()
 {
     m_renderer->ResetCamera();
-    m_renderWindow->Render();
+    RefreshRender();
     qDebug() << "相机已重置";
 }
 
@@ -1003,7 +1353,7 @@ void VTKWidget::FitToScene()
 {
     m_renderer->ResetCamera();
     m_renderer->GetActiveCamera()->Zoom(0.8); // 稍微缩小以留出边距
-    m_renderWindow->Render();
+    RefreshRender();
     qDebug() << "场景已适应";
 }
 
@@ -1024,7 +1374,7 @@ void VTKWidget::SetViewMode(const QString& mode)
     
     camera->SetFocalPoint(0, 0, 0);
     m_renderer->ResetCamera();
-    m_renderWindow->Render();
+    RefreshRender();
     
     qDebug() << "视图模式设置为:" << mode;
 }
@@ -1033,7 +1383,7 @@ void VTKWidget::SetWorkpieceVisible(bool visible)
 {
     if (m_workpieceActor) {
         m_workpieceActor->SetVisibility(visible);
-        m_renderWindow->Render();
+        RefreshRender();
     }
 }
 
@@ -1053,14 +1403,14 @@ void VTKWidget::SetRobotVisible(bool visible)
         }
     }
     
-    m_renderWindow->Render();
+    RefreshRender();
 }
 
 void VTKWidget::SetTrajectoryVisible(bool visible)
 {
-    if (m_trajectoryActor) {
-        m_trajectoryActor->SetVisibility(visible);
-        m_renderWindow->Render();
+    if (m_trajectoryView) {
+        m_trajectoryView->prop()->SetVisibility(visible);
+        RefreshRender();
     }
 }
 
@@ -1081,7 +1431,7 @@ void VTKWidget::OnToggleAxes()
 {
     m_axesVisible = !m_axesVisible;
     m_axesWidget->SetEnabled(m_axesVisible);
-    m_renderWindow->Render();
+    RefreshRender();
     
     m_toggleAxesBtn->setText(m_axesVisible ? "坐标轴" : "坐标轴");
     qDebug() << "坐标轴显示:" << (m_axesVisible ? "开启" : "关闭");
@@ -1103,7 +1453,7 @@ void VTKWidget::OnToggleRobot()
 
 void VTKWidget::updateScene()
 {
-    m_renderWindow->Render();
+    RefreshRender();
 }
 
 bool VTKWidget::CreateFallbackPointCloud()
@@ -1162,7 +1512,7 @@ bool VTKWidget::CreateFallbackPointCloud()
         FitToScene();
         
         // 刷新渲染
-        m_renderWindow->Render();
+        RefreshRender();
         
         emit ModelLoaded("PointCloud", true);
         return true;
@@ -1182,14 +1532,52 @@ void VTKWidget::SetStatusPanel(StatusPanel* statusPanel)
 
 void VTKWidget::RefreshRender()
 {
-    // 直接同步渲染，参考123/StepViewerWidget.cpp
-    if (m_renderWindow) {
-        m_renderWindow->Render();
+    // 只标记场景已变化，由渲染调度器合并到下一帧
+    if (m_renderScheduler) {
+        m_renderScheduler->requestRender();
+    }
+}
+
+void VTKWidget::OnLeftButtonPress(vtkObject* caller, unsigned long eventId, void* callData)
+{
+    Q_UNUSED(caller);
+    Q_UNUSED(eventId);
+    Q_UNUSED(callData);
+    m_interactor->GetEventPosition(m_pressPosition);
+}
+
+void VTKWidget::OnLeftButtonRelease(vtkObject* caller, unsigned long eventId, void* callData)
+{
+    Q_UNUSED(caller);
+    Q_UNUSED(eventId);
+    Q_UNUSED(callData);
+    
+    int position[2];
+    m_interactor->GetEventPosition(position);
+    
+    // 拖动（旋转视角）不算单击
+    if (std::abs(position[0] - m_pressPosition[0]) > 3 || std::abs(position[1] - m_pressPosition[1]) > 3) {
+        return;
+    }
+    
+    // STEP部件优先通过模型树的BVH拾取
+    double worldPosition[3] = {0.0, 0.0, 0.0};
+    if (m_modelTreeWidget) {
+        QString partName = m_modelTreeWidget->pickPart(position[0], position[1], worldPosition);
+        if (!partName.isEmpty()) {
+            emit PartPicked(partName, worldPosition[0], worldPosition[1], worldPosition[2]);
+            emit SceneClicked(worldPosition[0], worldPosition[1], worldPosition[2]);
+            return;
+        }
     }
     
-    if (m_vtkWidget) {
-        m_vtkWidget->update();
+    // 其他对象（点云、轨迹等）使用VTK拾取器
+    vtkSmartPointer<vtkCellPicker> picker = vtkSmartPointer<vtkCellPicker>::New();
+    picker->SetTolerance(0.0005);
+    if (picker->Pick(position[0], position[1], 0, m_renderer)) {
+        picker->GetPickPosition(worldPosition);
+        emit SceneClicked(worldPosition[0], worldPosition[1], worldPosition[2]);
     }
 }
 
-} // namespace UI
\ No newline at end of file
+} // namespace UI
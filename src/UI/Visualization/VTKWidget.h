@@ -33,7 +33,14 @@
 #include <vtkMatrix4x4.h>
 #include <QThread>
 #include <QMutex>
+#include <QJsonObject>
 #include <array>
+#include <memory>
+#include <vtkScalarBarActor.h>
+
+#include "DeviationAnalyzer.h"
+#include "RobotKinematics.h"
+#include "TrajectoryView.h"
 
 // Forward declarations for OpenCASCADE
 class TopoDS_Shape;
@@ -41,11 +48,17 @@ class TopoDS_Shape;
 // Forward declarations for UI
 namespace UI {
     class StatusPanel;
+    class RenderScheduler;
+    class LargePointCloudRenderer;
 }
 
 // Forward declaration for STEP Model Tree Widget
 class STEPModelTreeWidget;
 
+namespace Simulation {
+    class TriangleBVH;
+}
+
 namespace UI {
 
 /**
@@ -71,8 +84,64 @@ public:
     bool LoadPointCloud(const QString& filePath);
     bool LoadRobotModel(const QString& urdfPath);
     
+    /**
+     * @brief 对当前点云与CAD做偏差分析（后台线程执行）
+     * 
+     * 完成后点云按偏差着色（蓝色为材料不足，绿色为公差内，红色为材料多余）并变换到CAD坐标系，
+     * 然后发出DeviationAnalysisFinished。分析进行中再次调用会被忽略。
+     * @param cad CAD场景BVH（STEPModelTreeWidget::sceneBVH）
+     * @param options 分析参数
+     * @return 是否已开始分析
+     */
+    bool AnalyzeDeviation(std::shared_ptr<const Simulation::TriangleBVH> cad,
+                          const Simulation::DeviationOptions& options = Simulation::DeviationOptions());
+    
+    /**
+     * @brief 清除偏差着色，恢复点云原始显示
+     */
+    void ClearDeviationMap();
+    
+    bool IsDeviationAnalysisRunning() const { return m_deviationRunning; }
+    
+    /**
+     * @brief 强制使用大点云渲染模式（LOD + 屏幕空间点精灵）
+     * 
+     * 关闭时点数超过kLargePointCloudThreshold的点云仍自动使用该模式，下次加载点云时生效。
+     */
+    void SetLargePointCloudMode(bool enabled) { m_largePointCloudMode = enabled; }
+    bool IsLargePointCloudMode() const { return m_largePointCloudMode; }
+    
+    static const vtkIdType kLargePointCloudThreshold = 2000000;
+    
     // 轨迹显示
     void ShowSprayTrajectory(const std::vector<std::array<double, 3>>& trajectory);
+    
+    /**
+     * @brief 显示带工艺参数的轨迹，按当前着色属性着色
+     */
+    void ShowSprayTrajectory(const QList<Data::TrajectoryPoint>& trajectory);
+    
+    /**
+     * @brief 开始流式显示轨迹（清空现有轨迹）
+     * @param expectedPoints 预计点数，用于预留缓冲，未知时为0
+     */
+    void BeginTrajectoryStream(vtkIdType expectedPoints = 0);
+    
+    /**
+     * @brief 追加轨迹点，规划过程中可分批调用，只重新上传最后一段缓冲
+     */
+    void AppendTrajectoryPoints(const QList<Data::TrajectoryPoint>& points);
+    
+    /**
+     * @brief 设置轨迹着色属性（单色/速度/流量/喷涂宽度/风险）
+     */
+    void SetTrajectoryColorBy(TrajectoryView::ColorBy colorBy);
+    
+    /**
+     * @brief 设置轨迹各点的奇异/限位风险（TrajectoryRiskAnalyzer::Report::riskValues），按风险着色时显示
+     */
+    void SetTrajectoryRisk(const std::vector<float>& risk);
+    
     void ClearTrajectory();
     
     // 机械臂控制（简化版）
@@ -83,6 +152,15 @@ public:
     // 机械臂关节控制（6轴）
     void UpdateRobotJoints(const std::array<double, 6>& jointAngles);
     
+    /**
+     * @brief 用预先计算的连杆位移驱动机器人连杆（RobotKinematics::computeLinkDisplacements）
+     * 
+     * 连杆Actor只在场景变化后解析一次，每次更新只改写预分配的矩阵，
+     * 可按控制器周期（250 Hz）调用，重绘由渲染调度器合并。
+     * @param poses 6个连杆相对零位的位移
+     */
+    void UpdateRobotLinkPoses(const Robot::LinkPoses& poses);
+    
     // 视图控制
     void ResetCamera();
     void FitToScene();
@@ -92,7 +170,12 @@ public:
     void SetWorkpieceVisible(bool visible);
     void SetRobotVisible(bool visible);
     void SetTrajectoryVisible(bool visible);
-    void RefreshRender();  // 刷新渲染
+    void RefreshRender();  // 请求重绘（合并到下一帧，不同步渲染）
+    
+    /**
+     * @brief 渲染调度器，可设置帧率上限和后台帧率
+     */
+    RenderScheduler* renderScheduler() const { return m_renderScheduler; }
     
     // 获取渲染器
     vtkRenderer* getRenderer() const { return m_renderer; }
@@ -101,7 +184,7 @@ public:
     void SetStatusPanel(StatusPanel* statusPanel);
     
     // 设置STEP模型树引用（用于关节变换）
-    void SetSTEPModelTreeWidget(STEPModelTreeWidget* treeWidget) { m_modelTreeWidget = treeWidget; }
+    void SetSTEPModelTreeWidget(STEPModelTreeWidget* treeWidget);
     
     // 启用/禁用机器人按钮
     void enableRobotToggleButton(bool enable) { 
@@ -114,7 +197,14 @@ public:
 signals:
     void ModelLoaded(const QString& modelType, bool success);
     void SceneClicked(double x, double y, double z);
+    void PartPicked(const QString& partName, double x, double y, double z);
     void CameraChanged();
+    
+    /**
+     * @brief 偏差分析完成信号
+     * @param report 报告摘要（DeviationReport::toJson）
+     */
+    void DeviationAnalysisFinished(const QJsonObject& report);
 
 private slots:
     void OnResetCamera();
@@ -123,6 +213,7 @@ private slots:
     void OnToggleWorkpiece();
     void OnToggleRobot();
     void updateRobotAnimation();
+    void onModelTreeActorsAdded();
 
 private:
     void setupUI();
@@ -130,6 +221,44 @@ private:
     void setupControls();
     void updateScene();
     
+    /**
+     * @brief 鼠标单击（按下和抬起位置基本不变）时拾取场景
+     */
+    void OnLeftButtonPress(vtkObject* caller, unsigned long eventId, void* callData);
+    void OnLeftButtonRelease(vtkObject* caller, unsigned long eventId, void* callData);
+    
+    /**
+     * @brief 解析机器人连杆Actor并挂上预分配的用户矩阵
+     */
+    void resolveRobotLinkActors();
+    
+    /**
+     * @brief 轨迹显示对象，首次使用时创建并加入场景
+     */
+    TrajectoryView* trajectoryView();
+    
+    /**
+     * @brief 后台对轨迹逐点逆解并分析奇异/限位风险，完成后调用SetTrajectoryRisk
+     *
+     * 以当前关节角度为初值；轨迹在分析完成前被替换或清除时丢弃结果。
+     */
+    void analyzeTrajectoryRisk(const QList<Data::TrajectoryPoint>& trajectory);
+    
+    /**
+     * @brief 以LOD模式显示大点云
+     */
+    bool loadLargePointCloud(vtkPolyData* cloud);
+    
+    /**
+     * @brief 当前工件点云（LOD模式下为全分辨率数据）
+     */
+    vtkPolyData* workpieceCloudData() const;
+    
+    /**
+     * @brief 将偏差结果应用到点云显示
+     */
+    void applyDeviationMap(const Simulation::DeviationReport& report);
+    
     /**
      * @brief 创建备用测试点云（当文件读取失败时）
      */
@@ -156,12 +285,14 @@ private:
     vtkSmartPointer<vtkRenderer> m_renderer;
     vtkSmartPointer<vtkRenderWindow> m_renderWindow;
     vtkSmartPointer<vtkRenderWindowInteractor> m_interactor;
+    RenderScheduler* m_renderScheduler;             // 合并重绘请求
     
     // 3D模型actors
     vtkSmartPointer<vtkActor> m_workshopActor;      // 车间模型
     vtkSmartPointer<vtkActor> m_workpieceActor;     // 点云工件
     vtkSmartPointer<vtkActor> m_robotActor;         // 机器人模型
-    vtkSmartPointer<vtkActor> m_trajectoryActor;    // 喷涂轨迹
+    std::unique_ptr<TrajectoryView> m_trajectoryView;   // 喷涂轨迹
+    vtkSmartPointer<vtkScalarBarActor> m_trajectoryScalarBar;
     
     // 坐标轴
     vtkSmartPointer<vtkAxesActor> m_axesActor;
@@ -186,6 +317,31 @@ private:
     
     // STEP模型树引用（用于关节变换）
     STEPModelTreeWidget* m_modelTreeWidget;
+    
+    // 单击拾取
+    int m_pressPosition[2];
+    unsigned long m_pressObserverTag;
+    unsigned long m_releaseObserverTag;
+    
+    // 机器人连杆位姿（预分配，更新时不分配内存）
+    Robot::RobotKinematics* m_robotKinematics;
+    Robot::LinkPoses m_linkPoses;
+    std::array<vtkSmartPointer<vtkActor>, 6> m_linkActors;
+    std::array<vtkSmartPointer<vtkMatrix4x4>, 6> m_linkMatrices;
+    vtkSmartPointer<vtkMatrix4x4> m_robotEndMatrix;
+    int m_linkActorGeneration;                      // 解析连杆时的场景代数
+    bool m_linkActorsDirty;                         // 模型树有新Actor，下次更新时重新解析连杆
+    
+    // 偏差分析
+    bool m_deviationRunning;
+    int m_deviationRequest;                                 // 点云变化后丢弃过期的分析结果
+    int m_trajectoryRiskRequest;                            // 轨迹变化后丢弃过期的风险分析结果
+    vtkSmartPointer<vtkScalarBarActor> m_deviationScalarBar;
+    vtkSmartPointer<vtkPolyData> m_deviationSourceCloud;    // 着色前的点云，用于恢复显示
+    
+    // 大点云渲染
+    std::unique_ptr<LargePointCloudRenderer> m_largeCloud;
+    bool m_largePointCloudMode;
 };
 
 } // namespace UI
@@ -0,0 +1,824 @@
+// 运动学内核微基准：正解、逆解、雅可比、欧拉角提取
+//
+// 每个内核按线程数1、2、4…给出ns/操作和吞吐量，随机构型由种子决定，结果可复现。
+// 可写出CSV作为基线，之后与基线比较，变慢超过容差时返回1，用于在上线前发现热路径回归。
+//
+// 用法: KinematicsMicroBenchmark [--count N] [--seed N] [--threads N] [--filter 文本]
+//                                 [--csv 路径] [--baseline 路径] [--tolerance 比例]
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMatrix4x4>
+#include <QString>
+#include <QTextStream>
+#include <QVector>
+#include <QVector3D>
+#include <QtMath>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "BatchForwardKinematics.h"
+#include "DHChain.h"
+#include "DHParameters.h"
+#include "DampedLeastSquaresIK.h"
+#include "RobotKinematics.h"
+#include "TrajectoryRiskAnalyzer.h"
+
+using Robot::LinkMatrix;
+using Robot::LinkPoses;
+
+namespace {
+
+const int kJoints = 6;
+const double kDegToRad = M_PI / 180.0;
+const double kRadToDeg = 180.0 / M_PI;
+
+using Joints = std::array<double, kJoints>;
+
+struct Settings {
+    size_t count = 200000;          // 每个内核的操作数，迭代逆解为其1/10
+    unsigned seed = 42;
+    int maxThreads = 0;             // 0表示硬件线程数
+    QString filter;
+    QString csvPath;
+    QString baselinePath;
+    double tolerance = 0.15;        // 与基线相比允许变慢的比例
+};
+
+/**
+ * @brief 一个被测内核：以给定线程数执行count次操作，返回校验和（防止被优化掉）
+ */
+struct Kernel {
+    QString group;
+    QString name;
+    size_t count;
+    std::function<double(int)> run;
+};
+
+struct Sample {
+    QString group;
+    QString name;
+    int threads;
+    double nsPerOp;
+    double mopsPerSecond;
+};
+
+/**
+ * @brief 把[0, count)静态均分给threads个线程执行，单线程时在当前线程执行
+ */
+double runParallel(size_t count, int threads, const std::function<double(size_t, size_t)>& body)
+{
+    if (threads <= 1 || count < static_cast<size_t>(threads)) {
+        return body(0, count);
+    }
+    std::vector<double> sums(threads, 0.0);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    const size_t block = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        const size_t begin = std::min(count, t * block);
+        const size_t end = std::min(count, begin + block);
+        workers.emplace_back([&body, &sums, t, begin, end]() { sums[t] = body(begin, end); });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return std::accumulate(sums.begin(), sums.end(), 0.0);
+}
+
+/**
+ * @brief 计时，返回每次操作的纳秒数（墙钟时间）；取三次中最快的一次
+ */
+double measure(const Kernel& kernel, int threads)
+{
+    double best = 0.0;
+    volatile double sink = 0.0;
+    for (int run = 0; run < 3; ++run) {
+        QElapsedTimer timer;
+        timer.start();
+        sink = sink + kernel.run(threads);
+        const double ns = static_cast<double>(timer.nsecsElapsed()) / static_cast<double>(kernel.count);
+        best = run == 0 ? ns : std::min(best, ns);
+    }
+    return best;
+}
+
+/**
+ * @brief QMatrix4x4（单精度）逐关节相乘，可选输出各关节坐标系
+ */
+QMatrix4x4 qtForward(const double* radians, QMatrix4x4* frames = nullptr)
+{
+    const auto& table = Robot::Mpx3500Model::kDH;
+    QMatrix4x4 T;
+    for (int i = 0; i < kJoints; ++i) {
+        const float theta = static_cast<float>(table[i].theta + radians[i]);
+        const float ct = qCos(theta);
+        const float st = qSin(theta);
+        const float ca = qCos(static_cast<float>(table[i].alpha));
+        const float sa = qSin(static_cast<float>(table[i].alpha));
+        const float a = static_cast<float>(table[i].a);
+        const float d = static_cast<float>(table[i].d);
+        T = T * QMatrix4x4(ct, -st * ca, st * sa, a * ct,
+                           st, ct * ca, -ct * sa, a * st,
+                           0, sa, ca, d,
+                           0, 0, 0, 1);
+        if (frames) {
+            frames[i] = T;
+        }
+    }
+    return T;
+}
+
+/**
+ * @brief 运行时DH表的双精度循环（DHChain之前的computeLinkPoses实现），作为编译期特化的对照
+ */
+void runtimeForward(const double* radians, LinkMatrix& out)
+{
+    const auto& table = Robot::Mpx3500Model::kDH;
+    double t[12] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+    for (int i = 0; i < kJoints; ++i) {
+        const double theta = table[i].theta + radians[i];
+        const double ct = std::cos(theta);
+        const double st = std::sin(theta);
+        const double ca = std::cos(table[i].alpha);
+        const double sa = std::sin(table[i].alpha);
+        const double c0[3] = {ct, st, 0.0};
+        const double c1[3] = {-st * ca, ct * ca, sa};
+        const double c2[3] = {st * sa, -ct * sa, ca};
+        const double c3[3] = {table[i].a * ct, table[i].a * st, table[i].d};
+        double n[12];
+        for (int r = 0; r < 3; ++r) {
+            const double* row = t + r * 4;
+            n[r * 4 + 0] = row[0] * c0[0] + row[1] * c0[1];
+            n[r * 4 + 1] = row[0] * c1[0] + row[1] * c1[1] + row[2] * c1[2];
+            n[r * 4 + 2] = row[0] * c2[0] + row[1] * c2[1] + row[2] * c2[2];
+            n[r * 4 + 3] = row[0] * c3[0] + row[1] * c3[1] + row[2] * c3[2] + row[3];
+        }
+        std::copy(n, n + 12, t);
+    }
+    std::copy(t, t + 12, out.begin());
+}
+
+/**
+ * @brief Aubo i5H逐关节Eigen::Matrix4d相乘（含末端偏移），与DHChain<AuboI5HModel>对照
+ */
+Eigen::Matrix4d auboEigenForward(const AuboI5HDHParameters& aubo, const double* radians)
+{
+    Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+    for (int j = 0; j < kJoints; ++j) {
+        T = T * aubo.computeDHTransform(j, radians[j]);
+    }
+    return T * aubo.computeDHTransform(kJoints, 0.0);
+}
+
+/**
+ * @brief 法兰处的几何雅可比（行主序6×6，前三行平移），关节i绕坐标系i-1的z轴
+ */
+void jacobianFromPoses(const LinkPoses& poses, double J[36])
+{
+    const LinkMatrix& tcp = poses[kJoints - 1];
+    for (int i = 0; i < kJoints; ++i) {
+        double z[3] = {0.0, 0.0, 1.0};
+        double o[3] = {0.0, 0.0, 0.0};
+        if (i > 0) {
+            const LinkMatrix& frame = poses[i - 1];
+            z[0] = frame[2];
+            z[1] = frame[6];
+            z[2] = frame[10];
+            o[0] = frame[3];
+            o[1] = frame[7];
+            o[2] = frame[11];
+        }
+        const double dx = tcp[3] - o[0];
+        const double dy = tcp[7] - o[1];
+        const double dz = tcp[11] - o[2];
+        J[0 * 6 + i] = z[1] * dz - z[2] * dy;
+        J[1 * 6 + i] = z[2] * dx - z[0] * dz;
+        J[2 * 6 + i] = z[0] * dy - z[1] * dx;
+        J[3 * 6 + i] = z[0];
+        J[4 * 6 + i] = z[1];
+        J[5 * 6 + i] = z[2];
+    }
+}
+
+Eigen::Matrix<double, 6, 6> jacobianEigen(const double* radians)
+{
+    LinkPoses poses;
+    Robot::DHChain<Robot::Mpx3500Model>::computeLinkPoses(radians, poses.data());
+    const Eigen::Vector3d tcp(poses[kJoints - 1][3], poses[kJoints - 1][7], poses[kJoints - 1][11]);
+    Eigen::Matrix<double, 6, 6> J;
+    for (int i = 0; i < kJoints; ++i) {
+        Eigen::Vector3d z = Eigen::Vector3d::UnitZ();
+        Eigen::Vector3d o = Eigen::Vector3d::Zero();
+        if (i > 0) {
+            const LinkMatrix& frame = poses[i - 1];
+            z = Eigen::Vector3d(frame[2], frame[6], frame[10]);
+            o = Eigen::Vector3d(frame[3], frame[7], frame[11]);
+        }
+        J.block<3, 1>(0, i) = z.cross(tcp - o);
+        J.block<3, 1>(3, i) = z;
+    }
+    return J;
+}
+
+void jacobianQt(const double* radians, float J[36])
+{
+    QMatrix4x4 frames[kJoints];
+    qtForward(radians, frames);
+    const QVector3D tcp = frames[kJoints - 1].column(3).toVector3D();
+    for (int i = 0; i < kJoints; ++i) {
+        const QVector3D z = i > 0 ? frames[i - 1].column(2).toVector3D() : QVector3D(0, 0, 1);
+        const QVector3D o = i > 0 ? frames[i - 1].column(3).toVector3D() : QVector3D();
+        const QVector3D v = QVector3D::crossProduct(z, tcp - o);
+        J[0 * 6 + i] = v.x();
+        J[1 * 6 + i] = v.y();
+        J[2 * 6 + i] = v.z();
+        J[3 * 6 + i] = z.x();
+        J[4 * 6 + i] = z.y();
+        J[5 * 6 + i] = z.z();
+    }
+}
+
+/**
+ * @brief ZYX欧拉角（roll, pitch, yaw，弧度），与MatrixUtils::extractEulerAngles约定一致
+ */
+void eulerFromLinkMatrix(const LinkMatrix& T, double euler[3])
+{
+    const double sy = std::sqrt(T[0] * T[0] + T[4] * T[4]);
+    if (sy >= 1e-6) {
+        euler[0] = std::atan2(T[9], T[10]);
+        euler[1] = std::atan2(-T[8], sy);
+        euler[2] = std::atan2(T[4], T[0]);
+    } else {
+        euler[0] = std::atan2(-T[6], T[5]);
+        euler[1] = std::atan2(-T[8], sy);
+        euler[2] = 0.0;
+    }
+}
+
+QVector3D eulerFromQt(const QMatrix4x4& T)
+{
+    const float sy = qSqrt(T(0, 0) * T(0, 0) + T(1, 0) * T(1, 0));
+    return QVector3D(qAtan2(T(2, 1), T(2, 2)), qAtan2(-T(2, 0), sy), qAtan2(T(1, 0), T(0, 0)));
+}
+
+bool parseArguments(int argc, char* argv[], Settings& settings)
+{
+    for (int i = 1; i < argc; ++i) {
+        const QString option = QString::fromLocal8Bit(argv[i]);
+        if (i + 1 >= argc) {
+            qWarning() << "缺少参数值:" << option;
+            return false;
+        }
+        const QString value = QString::fromLocal8Bit(argv[++i]);
+        if (option == "--count") {
+            settings.count = std::max<qulonglong>(100, value.toULongLong());
+        } else if (option == "--seed") {
+            settings.seed = value.toUInt();
+        } else if (option == "--threads") {
+            settings.maxThreads = value.toInt();
+        } else if (option == "--filter") {
+            settings.filter = value;
+        } else if (option == "--csv") {
+            settings.csvPath = value;
+        } else if (option == "--baseline") {
+            settings.baselinePath = value;
+        } else if (option == "--tolerance") {
+            settings.tolerance = value.toDouble();
+        } else {
+            qWarning() << "未知选项:" << option;
+            return false;
+        }
+    }
+    return true;
+}
+
+QString sampleKey(const QString& group, const QString& name, int threads)
+{
+    return group + '|' + name + '|' + QString::number(threads);
+}
+
+/**
+ * @brief CSV文本字段：加双引号，内部双引号写两次（实现名中含逗号）
+ */
+QString csvField(const QString& text)
+{
+    QString escaped = text;
+    escaped.replace('"', "\"\"");
+    return '"' + escaped + '"';
+}
+
+/**
+ * @brief 拆分一行CSV，支持带引号的字段
+ */
+QStringList splitCsvLine(const QString& line)
+{
+    QStringList fields;
+    QString field;
+    bool quoted = false;
+    for (int i = 0; i < line.size(); ++i) {
+        const QChar c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.append(field);
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.append(field);
+    return fields;
+}
+
+bool writeCsv(const QString& path, const std::vector<Sample>& samples)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "无法写入CSV:" << path;
+        return false;
+    }
+    QTextStream out(&file);
+    out << "group,name,threads,ns_per_op,mops\n";
+    for (const Sample& sample : samples) {
+        out << csvField(sample.group) << ',' << csvField(sample.name) << ',' << sample.threads << ','
+            << QString::number(sample.nsPerOp, 'f', 3) << ',' << QString::number(sample.mopsPerSecond, 'f', 4) << '\n';
+    }
+    return true;
+}
+
+/**
+ * @brief 读取基线CSV，键为 组|实现|线程数，值为ns/操作
+ */
+bool readBaseline(const QString& path, QHash<QString, double>& baseline)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "无法读取基线:" << path;
+        return false;
+    }
+    QTextStream in(&file);
+    in.readLine();  // 表头
+    while (!in.atEnd()) {
+        const QStringList fields = splitCsvLine(in.readLine());
+        if (fields.size() >= 4) {
+            baseline.insert(sampleKey(fields[0], fields[1], fields[2].toInt()), fields[3].toDouble());
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Settings settings;
+    if (!parseArguments(argc, argv, settings)) {
+        qWarning() << "用法: KinematicsMicroBenchmark [--count N] [--seed N] [--threads N] [--filter 文本]"
+                      " [--csv 路径] [--baseline 路径] [--tolerance 比例]";
+        return 2;
+    }
+    const int hardwareThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const int maxThreads = settings.maxThreads > 0 ? settings.maxThreads : hardwareThreads;
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(maxThreads);
+
+    const size_t count = settings.count;
+    const size_t iterativeCount = std::max<size_t>(10, count / 10);
+
+    qDebug() << "=== 运动学内核微基准 ===";
+    qDebug() << "操作数:" << count << " 迭代逆解:" << iterativeCount << " 种子:" << settings.seed
+             << " 线程数:" << QVector<int>(threadCounts.begin(), threadCounts.end());
+
+    Robot::RobotKinematics robot;
+    AuboI5HDHParameters aubo;
+
+    // 限位内的随机构型（MPX3500为度，另存弧度）；逆解种子为构型加±5°扰动
+    std::mt19937 rng(settings.seed);
+    std::vector<Joints> degrees(count);
+    std::vector<Joints> seeds(count);
+    std::vector<double> radians(count * kJoints);
+    Robot::JointBatch batch;
+    batch.resize(count);
+    std::uniform_real_distribution<double> noise(-5.0, 5.0);
+    for (int j = 0; j < kJoints; ++j) {
+        const Robot::JointLimit limit = robot.getJointLimit(j);
+        std::uniform_real_distribution<double> dist(limit.min, limit.max);
+        for (size_t i = 0; i < count; ++i) {
+            const double value = dist(rng);
+            degrees[i][j] = value;
+            seeds[i][j] = std::min(limit.max, std::max(limit.min, value + noise(rng)));
+            radians[i * kJoints + j] = value * kDegToRad;
+            batch.angles[j][i] = value;
+        }
+    }
+
+    std::vector<LinkMatrix> flange(count);
+    std::vector<Eigen::Matrix4d> flangeEigen(count);
+    for (size_t i = 0; i < count; ++i) {
+        LinkPoses poses;
+        robot.computeLinkPoses(degrees[i], poses);
+        flange[i] = poses[kJoints - 1];
+        for (int r = 0; r < 4; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                flangeEigen[i](r, c) = flange[i][r * 4 + c];
+            }
+        }
+    }
+
+    // Aubo i5H：限位内的随机构型 (弧度)，迭代逆解的目标为含末端偏移的TCP
+    Robot::DampedLeastSquaresIK mpxIk(robot);
+    Robot::DampedLeastSquaresIK auboIk(aubo);
+    std::vector<double> auboRadians(count * kJoints);
+    std::vector<double> auboDegrees(iterativeCount * kJoints);
+    std::vector<double> auboSeeds(iterativeCount * kJoints);
+    std::vector<LinkMatrix> auboTargets(iterativeCount);
+    for (int j = 0; j < kJoints; ++j) {
+        const DHParameter& parameter = aubo.getParameter(j);
+        std::uniform_real_distribution<double> dist(parameter.min_angle, parameter.max_angle);
+        for (size_t i = 0; i < count; ++i) {
+            auboRadians[i * kJoints + j] = dist(rng);
+        }
+        for (size_t i = 0; i < iterativeCount; ++i) {
+            auboDegrees[i * kJoints + j] = auboRadians[i * kJoints + j] * kRadToDeg;
+            auboSeeds[i * kJoints + j] = auboDegrees[i * kJoints + j] + noise(rng);
+        }
+    }
+    for (size_t i = 0; i < iterativeCount; ++i) {
+        auboIk.forwardKinematics(auboDegrees.data() + i * kJoints, auboTargets[i]);
+    }
+
+    // 路径逆解：限位内的随机游走，相邻点关节差不超过0.5°
+    std::vector<LinkMatrix> pathTargets(iterativeCount);
+    std::vector<Joints> pathJoints(iterativeCount);
+    {
+        Joints q = degrees[0];
+        std::uniform_real_distribution<double> step(-0.5, 0.5);
+        for (size_t i = 0; i < iterativeCount; ++i) {
+            for (int j = 0; j < kJoints; ++j) {
+                const Robot::JointLimit limit = robot.getJointLimit(j);
+                q[j] = std::min(limit.max - 1.0, std::max(limit.min + 1.0, q[j] + step(rng)));
+            }
+            pathJoints[i] = q;
+            LinkPoses poses;
+            robot.computeLinkPoses(q, poses);
+            pathTargets[i] = poses[kJoints - 1];
+        }
+    }
+
+    Robot::BatchForwardKinematics batchFk(robot);
+    std::vector<LinkMatrix> batchTcp(count);
+    Robot::TrajectoryRiskAnalyzer analyzer(robot);
+    Robot::TrajectoryRiskAnalyzer::Options analyzerOptions;
+    analyzerOptions.rollStep = 0.0;     // 只测逐点分析
+    analyzer.setOptions(analyzerOptions);
+    std::vector<double> anglesFlat(count * kJoints);
+    for (size_t i = 0; i < count; ++i) {
+        std::copy(degrees[i].begin(), degrees[i].end(), anglesFlat.begin() + i * kJoints);
+    }
+
+    // --- 一致性 ---
+    const size_t checkCount = std::min<size_t>(count, 10000);
+    double fkDiff = 0.0;
+    double qtFkDiff = 0.0;
+    double runtimeFkDiff = 0.0;
+    double auboFkDiff = 0.0;
+    double jacobianDiff = 0.0;
+    double qtJacobianDiff = 0.0;
+    double eulerDiff = 0.0;
+    double ikPositionError = 0.0;
+    double ikRotationError = 0.0;
+    int ikSolved = 0;
+    for (size_t i = 0; i < checkCount; ++i) {
+        const double* q = radians.data() + i * kJoints;
+        LinkMatrix chain;
+        Robot::DHChain<Robot::Mpx3500Model>::computeForward(q, chain);
+        const QMatrix4x4 qt = qtForward(q);
+        LinkMatrix runtime;
+        runtimeForward(q, runtime);
+        LinkMatrix auboChain;
+        Robot::DHChain<Robot::AuboI5HModel>::computeForward(auboRadians.data() + i * kJoints, auboChain);
+        const Eigen::Matrix4d auboEigen = auboEigenForward(aubo, auboRadians.data() + i * kJoints);
+        for (int e = 0; e < 12; ++e) {
+            fkDiff = std::max(fkDiff, std::abs(chain[e] - flange[i][e]));
+            qtFkDiff = std::max(qtFkDiff, std::abs(chain[e] - qt(e / 4, e % 4)));
+            runtimeFkDiff = std::max(runtimeFkDiff, std::abs(chain[e] - runtime[e]));
+            auboFkDiff = std::max(auboFkDiff, std::abs(auboChain[e] - auboEigen(e / 4, e % 4)));
+        }
+
+        LinkPoses poses;
+        robot.computeLinkPoses(degrees[i], poses);
+        double J[36];
+        jacobianFromPoses(poses, J);
+        const Eigen::Matrix<double, 6, 6> Je = jacobianEigen(q);
+        float Jq[36];
+        jacobianQt(q, Jq);
+        for (int e = 0; e < 36; ++e) {
+            jacobianDiff = std::max(jacobianDiff, std::abs(J[e] - Je(e / 6, e % 6)));
+            qtJacobianDiff = std::max(qtJacobianDiff, std::abs(J[e] - Jq[e]));
+        }
+
+        double euler[3];
+        eulerFromLinkMatrix(flange[i], euler);
+        const Eigen::Vector3d reference = MatrixUtils::extractEulerAngles(flangeEigen[i]);
+        for (int k = 0; k < 3; ++k) {
+            eulerDiff = std::max(eulerDiff, std::abs(euler[k] - reference(k)));
+        }
+
+        Joints solution;
+        if (robot.inverseKinematics(flange[i], seeds[i], solution)) {
+            ++ikSolved;
+            LinkPoses solved;
+            robot.computeLinkPoses(solution, solved);
+            for (int e = 0; e < 12; ++e) {
+                double& error = e % 4 == 3 ? ikPositionError : ikRotationError;
+                error = std::max(error, std::abs(solved[kJoints - 1][e] - flange[i][e]));
+            }
+        }
+    }
+    qDebug() << "\n--- 一致性（" << checkCount << "个构型）---";
+    qDebug() << "正解 DHChain vs computeLinkPoses:" << fkDiff << " 运行时DH表:" << runtimeFkDiff
+             << " QMatrix4x4单精度:" << qtFkDiff << " Aubo Eigen逐关节相乘:" << auboFkDiff;
+    qDebug() << "雅可比 Eigen vs 双精度数组:" << jacobianDiff << " QVector3D单精度:" << qtJacobianDiff;
+    qDebug() << "欧拉角 双精度数组 vs MatrixUtils:" << eulerDiff << "rad";
+    qDebug() << "解析逆解 成功" << ikSolved << "/" << checkCount
+             << " 回代误差 位置:" << ikPositionError << "mm 旋转矩阵元素:" << ikRotationError;
+
+    // --- 内核 ---
+    std::vector<Kernel> kernels;
+    auto addSingle = [&](const QString& group, const QString& name, size_t ops,
+                         std::function<double(size_t, size_t)> body) {
+        kernels.push_back({group, name, ops, [ops, body](int threads) { return runParallel(ops, threads, body); }});
+    };
+    auto addBatched = [&](const QString& group, const QString& name, size_t ops, std::function<double(int)> run) {
+        kernels.push_back({group, name, ops, run});
+    };
+
+    addSingle("正解", "QMatrix4x4单精度", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            sum += qtForward(radians.data() + i * kJoints)(0, 3);
+        }
+        return sum;
+    });
+    addSingle("正解", "RobotKinematics::computeLinkPoses", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        LinkPoses poses;
+        for (size_t i = begin; i < end; ++i) {
+            robot.computeLinkPoses(degrees[i], poses);
+            sum += poses[kJoints - 1][3];
+        }
+        return sum;
+    });
+    addSingle("正解", "运行时DH表双精度循环", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        LinkMatrix T;
+        for (size_t i = begin; i < end; ++i) {
+            runtimeForward(radians.data() + i * kJoints, T);
+            sum += T[3];
+        }
+        return sum;
+    });
+    addSingle("正解", "DHChain<Mpx3500Model>::computeForward", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        LinkMatrix T;
+        for (size_t i = begin; i < end; ++i) {
+            Robot::DHChain<Robot::Mpx3500Model>::computeForward(radians.data() + i * kJoints, T);
+            sum += T[3];
+        }
+        return sum;
+    });
+    addSingle("正解", "DHChain<Mpx3500Model>::computeLinkPoses", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        LinkPoses poses;
+        for (size_t i = begin; i < end; ++i) {
+            Robot::DHChain<Robot::Mpx3500Model>::computeLinkPoses(radians.data() + i * kJoints, poses.data());
+            sum += poses[kJoints - 1][3];
+        }
+        return sum;
+    });
+    addSingle("正解", "Aubo i5H Eigen逐关节相乘", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            sum += auboEigenForward(aubo, auboRadians.data() + i * kJoints)(0, 3);
+        }
+        return sum;
+    });
+    addSingle("正解", "DHChain<AuboI5HModel>::computeForward", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        LinkMatrix T;
+        for (size_t i = begin; i < end; ++i) {
+            Robot::DHChain<Robot::AuboI5HModel>::computeForward(auboRadians.data() + i * kJoints, T);
+            sum += T[3];
+        }
+        return sum;
+    });
+    addSingle("正解", "AuboI5HDHParameters::computeForwardKinematics（Eigen接口）", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        QVector<double> q(kJoints);
+        for (size_t i = begin; i < end; ++i) {
+            std::copy(auboRadians.begin() + i * kJoints, auboRadians.begin() + (i + 1) * kJoints, q.begin());
+            sum += aubo.computeForwardKinematics(q)(0, 3);
+        }
+        return sum;
+    });
+    addBatched("正解", "BatchForwardKinematics（批量）", count, [&](int threads) {
+        batchFk.setThreadCount(threads);
+        batchFk.compute(batch, batchTcp.data());
+        return batchTcp[0][3];
+    });
+
+    addSingle("逆解", "RobotKinematics::inverseKinematics（解析，最近解）", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        Joints solution;
+        for (size_t i = begin; i < end; ++i) {
+            if (robot.inverseKinematics(flange[i], seeds[i], solution)) {
+                sum += solution[0];
+            }
+        }
+        return sum;
+    });
+    addSingle("逆解", "RobotKinematics::inverseKinematicsAll（解析，全部解）", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        std::array<Joints, Robot::RobotKinematics::MAX_IK_SOLUTIONS> solutions;
+        for (size_t i = begin; i < end; ++i) {
+            sum += robot.inverseKinematicsAll(flange[i], seeds[i], solutions);
+        }
+        return sum;
+    });
+    addSingle("逆解", "DampedLeastSquaresIK::solve MPX3500（迭代）", iterativeCount, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        double solution[kJoints];
+        for (size_t i = begin; i < end; ++i) {
+            sum += mpxIk.solve(flange[i], seeds[i].data(), solution).iterations;
+        }
+        return sum;
+    });
+    addSingle("逆解", "DampedLeastSquaresIK::solve Aubo i5H（迭代）", iterativeCount, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        double solution[kJoints];
+        for (size_t i = begin; i < end; ++i) {
+            sum += auboIk.solve(auboTargets[i], auboSeeds.data() + i * kJoints, solution).iterations;
+        }
+        return sum;
+    });
+    addBatched("逆解", "DampedLeastSquaresIK::solvePath（迭代，路径热启动）", iterativeCount, [&](int threads) {
+        mpxIk.setThreadCount(threads);
+        const Robot::DampedLeastSquaresIK::PathResult path = mpxIk.solvePath(pathTargets, pathJoints[0].data());
+        return static_cast<double>(path.failedCount) + path.angles.back();
+    });
+
+    addSingle("雅可比", "QMatrix4x4/QVector3D单精度", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        float J[36];
+        for (size_t i = begin; i < end; ++i) {
+            jacobianQt(radians.data() + i * kJoints, J);
+            sum += J[0];
+        }
+        return sum;
+    });
+    addSingle("雅可比", "computeLinkPoses + 双精度数组", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        LinkPoses poses;
+        double J[36];
+        for (size_t i = begin; i < end; ++i) {
+            robot.computeLinkPoses(degrees[i], poses);
+            jacobianFromPoses(poses, J);
+            sum += J[0];
+        }
+        return sum;
+    });
+    addSingle("雅可比", "DHChain + Eigen::Matrix<double,6,6>", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            sum += jacobianEigen(radians.data() + i * kJoints)(0, 0);
+        }
+        return sum;
+    });
+    addBatched("雅可比", "TrajectoryRiskAnalyzer（雅可比+条件数+奇异距离，批量）", count, [&](int threads) {
+        analyzer.setThreadCount(threads);
+        return static_cast<double>(analyzer.analyze(anglesFlat.data(), count).flaggedCount);
+    });
+
+    addSingle("欧拉角", "MatrixUtils::extractEulerAngles（Eigen）", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            sum += MatrixUtils::extractEulerAngles(flangeEigen[i])(0);
+        }
+        return sum;
+    });
+    addSingle("欧拉角", "Eigen::Matrix3d::eulerAngles(2,1,0)", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            const Eigen::Matrix3d R = flangeEigen[i].block<3, 3>(0, 0);
+            sum += R.eulerAngles(2, 1, 0)(0);
+        }
+        return sum;
+    });
+    addSingle("欧拉角", "QMatrix4x4单精度 qAtan2", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i) {
+            const LinkMatrix& T = flange[i];
+            const QMatrix4x4 m(T[0], T[1], T[2], T[3], T[4], T[5], T[6], T[7],
+                               T[8], T[9], T[10], T[11], 0, 0, 0, 1);
+            sum += eulerFromQt(m).x();
+        }
+        return sum;
+    });
+    addSingle("欧拉角", "LinkMatrix双精度数组", count, [&](size_t begin, size_t end) {
+        double sum = 0.0;
+        double euler[3];
+        for (size_t i = begin; i < end; ++i) {
+            eulerFromLinkMatrix(flange[i], euler);
+            sum += euler[0];
+        }
+        return sum;
+    });
+
+    // --- 计时 ---
+    std::vector<Sample> samples;
+    QString currentGroup;
+    for (const Kernel& kernel : kernels) {
+        if (!settings.filter.isEmpty() && !kernel.group.contains(settings.filter) && !kernel.name.contains(settings.filter)) {
+            continue;
+        }
+        if (kernel.group != currentGroup) {
+            currentGroup = kernel.group;
+            qDebug().noquote() << "\n---" << currentGroup << "(ns/操作, 百万次/秒) ---";
+        }
+        QString line = "    ";
+        for (int threads : threadCounts) {
+            const double ns = measure(kernel, threads);
+            const double mops = 1e3 / ns;
+            samples.push_back({kernel.group, kernel.name, threads, ns, mops});
+            line += QString("%1线程: %2 ns  %3 M/s   ").arg(threads)
+                        .arg(ns, 0, 'f', ns < 100.0 ? 1 : 0).arg(mops, 0, 'f', 2);
+        }
+        qDebug().noquote() << kernel.name;
+        qDebug().noquote() << line;
+    }
+
+    bool ok = fkDiff < 1e-9 && runtimeFkDiff < 1e-9 && auboFkDiff < 1e-9 && jacobianDiff < 1e-9 && eulerDiff < 1e-9
+           && ikSolved == static_cast<int>(checkCount) && ikPositionError < 1e-3 && ikRotationError < 1e-6;
+    if (!ok) {
+        qCritical() << "\n❌ 实现之间结果不一致";
+    }
+
+    if (!settings.csvPath.isEmpty() && writeCsv(settings.csvPath, samples)) {
+        qDebug() << "\n结果已写入" << settings.csvPath;
+    }
+
+    // --- 与基线比较 ---
+    if (!settings.baselinePath.isEmpty()) {
+        QHash<QString, double> baseline;
+        if (!readBaseline(settings.baselinePath, baseline)) {
+            return 1;
+        }
+        int regressions = 0;
+        int compared = 0;
+        qDebug() << "\n--- 与基线比较（容差" << settings.tolerance * 100.0 << "%）---";
+        for (const Sample& sample : samples) {
+            const auto it = baseline.constFind(sampleKey(sample.group, sample.name, sample.threads));
+            if (it == baseline.constEnd() || !(it.value() > 0.0)) {
+                continue;
+            }
+            ++compared;
+            const double ratio = sample.nsPerOp / it.value();
+            if (ratio > 1.0 + settings.tolerance) {
+                ++regressions;
+                qWarning().noquote() << QString("回归: [%1] %2 %3线程 %4 ns -> %5 ns (+%6%)")
+                                            .arg(sample.group, sample.name).arg(sample.threads)
+                                            .arg(it.value(), 0, 'f', 1).arg(sample.nsPerOp, 0, 'f', 1)
+                                            .arg((ratio - 1.0) * 100.0, 0, 'f', 0);
+            }
+        }
+        qDebug() << "比较" << compared << "项，回归" << regressions << "项";
+        ok = ok && regressions == 0;
+    }
+
+    if (ok) {
+        qDebug() << "\n✅ 完成";
+    }
+    return ok ? 0 : 1;
+}
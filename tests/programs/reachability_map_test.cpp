@@ -0,0 +1,221 @@
+// 可达性体素图测试：保存→加载往返、缓存命中和逐点查询
+//
+// 用小规模采样构建MPX3500的体素图，检查：
+// - 保存后加载得到逐体素一致的结果，键值不匹配时拒绝加载
+// - loadOrBuild第二次直接命中磁盘缓存
+// - voxelAt与体素中心互为逆映射，网格外返回空
+// - 随机构型的TCP落在可达体素中，evaluatePlacement与逐点查询一致
+//
+// 用法: TestReachabilityMap [--samples N] [--seed N]
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QList>
+#include <QMatrix3x3>
+#include <QQuaternion>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QVector3D>
+#include <algorithm>
+#include <array>
+#include <random>
+
+#include "Models/TrajectoryData.h"
+#include "ReachabilityMap.h"
+#include "RobotKinematics.h"
+
+namespace {
+
+using Robot::LinkMatrix;
+using Robot::ReachabilityMap;
+
+int g_failures = 0;
+
+void check(bool condition, const QString& what)
+{
+    if (condition) {
+        qDebug().noquote() << "  ✓" << what;
+    } else {
+        qCritical().noquote() << "  ✗" << what;
+        ++g_failures;
+    }
+}
+
+bool sameVoxels(const ReachabilityMap& a, const ReachabilityMap& b)
+{
+    if (a.dimX() != b.dimX() || a.dimY() != b.dimY() || a.dimZ() != b.dimZ() ||
+        a.origin() != b.origin() || a.voxelSize() != b.voxelSize() ||
+        a.voxels().size() != b.voxels().size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.voxels().size(); ++i) {
+        const ReachabilityMap::Voxel& x = a.voxels()[i];
+        const ReachabilityMap::Voxel& y = b.voxels()[i];
+        if (x.sampleCount != y.sampleCount || x.orientationMask != y.orientationMask ||
+            x.meanManipulability != y.meanManipulability || x.maxManipulability != y.maxManipulability) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 构型的TCP位置和工具z轴（基座坐标系）
+ */
+void toolPose(const Robot::RobotKinematics& robot, const LinkMatrix& flangeToTool,
+              const std::array<double, 6>& degrees, QVector3D& position, QMatrix3x3& rotation)
+{
+    Robot::LinkPoses poses;
+    robot.computeLinkPoses(degrees, poses);
+    const LinkMatrix& F = poses[5];
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            double value = 0.0;
+            for (int k = 0; k < 3; ++k) {
+                value += F[r * 4 + k] * flangeToTool[k * 4 + c];
+            }
+            rotation(r, c) = static_cast<float>(value);
+        }
+        double value = F[r * 4 + 3];
+        for (int k = 0; k < 3; ++k) {
+            value += F[r * 4 + k] * flangeToTool[k * 4 + 3];
+        }
+        position[r] = static_cast<float>(value);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    ReachabilityMap::Options options;
+    options.voxelSize = 100.0;
+    options.sampleCount = 500000;
+    options.seed = 7;
+    const QStringList args = app.arguments();
+    for (int i = 1; i + 1 < args.size(); i += 2) {
+        if (args[i] == "--samples") {
+            options.sampleCount = args[i + 1].toULongLong();
+        } else if (args[i] == "--seed") {
+            options.seed = args[i + 1].toUInt();
+        } else {
+            qWarning() << "用法: TestReachabilityMap [--samples N] [--seed N]";
+            return 2;
+        }
+    }
+
+    QTemporaryDir cacheDir;
+    if (!cacheDir.isValid()) {
+        qCritical() << "无法创建临时目录";
+        return 1;
+    }
+
+    Robot::RobotKinematics robot;
+    const QString toolName = "TestGun";
+    const LinkMatrix flangeToTool = {1, 0, 0, 0,
+                                     0, 1, 0, 0,
+                                     0, 0, 1, 150,
+                                     0, 0, 0, 1};
+
+    qDebug() << "=== 可达性体素图测试 ===";
+    qDebug() << "采样数:" << options.sampleCount << " 体素:" << options.voxelSize << "mm  种子:" << options.seed;
+
+    // --- 构建与往返 ---
+    qDebug() << "\n--- 保存/加载往返 ---";
+    ReachabilityMap built;
+    check(built.build(robot, toolName, flangeToTool, options) && built.isValid(), "构建体素图");
+    const QString key = ReachabilityMap::computeKey(robot, toolName, flangeToTool, options);
+    check(built.key() == key, "构建结果的键值与computeKey一致");
+
+    const QString path = cacheDir.filePath("roundtrip.rmap");
+    check(built.save(path), "保存");
+    ReachabilityMap loaded;
+    check(loaded.load(path, key), "按键值加载");
+    check(sameVoxels(built, loaded), "加载结果逐体素一致");
+    check(loaded.robotName() == built.robotName() && loaded.toolName() == toolName, "机器人和工具名称一致");
+
+    ReachabilityMap rejected;
+    check(!rejected.load(path, key + "0"), "键值不匹配时拒绝加载");
+
+    LinkMatrix longerTool = flangeToTool;
+    longerTool[11] = 200.0;
+    check(ReachabilityMap::computeKey(robot, toolName, longerTool, options) != key, "工具坐标系变化时键值变化");
+
+    // --- 磁盘缓存 ---
+    qDebug() << "\n--- 磁盘缓存 ---";
+    ReachabilityMap first;
+    check(first.loadOrBuild(robot, toolName, flangeToTool, options, cacheDir.path()), "首次loadOrBuild（构建并写缓存）");
+    const QString cachePath = ReachabilityMap::cachePathFor(robot.getRobotName(), toolName, key, cacheDir.path());
+    check(QFile::exists(cachePath), "缓存文件已写入");
+    ReachabilityMap second;
+    check(second.loadOrBuild(robot, toolName, flangeToTool, options, cacheDir.path()), "再次loadOrBuild（命中缓存）");
+    check(sameVoxels(first, second) && sameVoxels(built, second), "缓存结果与构建结果一致");
+
+    // --- 查询 ---
+    qDebug() << "\n--- 查询 ---";
+    bool inverse = true;
+    for (int k = 0; k < loaded.dimZ() && inverse; ++k) {
+        for (int j = 0; j < loaded.dimY() && inverse; ++j) {
+            for (int i = 0; i < loaded.dimX(); ++i) {
+                const size_t index = (static_cast<size_t>(k) * loaded.dimY() + j) * loaded.dimX() + i;
+                if (loaded.voxelAt(loaded.voxelCenter(i, j, k)) != &loaded.voxels()[index]) {
+                    inverse = false;
+                    break;
+                }
+            }
+        }
+    }
+    check(inverse, "voxelAt(voxelCenter(i, j, k))返回体素(i, j, k)");
+    const float outside = static_cast<float>(loaded.voxelSize() * loaded.dimX());
+    check(!loaded.voxelAt(loaded.origin() - QVector3D(1, 1, 1)) &&
+          !loaded.voxelAt(loaded.origin() + QVector3D(outside, 0, 0)) &&
+          !loaded.isReachable(QVector3D(outside, outside, outside)), "网格外的点不可达");
+
+    // 限位内的随机构型：TCP应落在可达体素中（采样有限，允许极少数落在未采到的边缘体素）
+    std::mt19937 rng(options.seed + 1);
+    std::array<std::uniform_real_distribution<double>, 6> distributions;
+    for (int j = 0; j < 6; ++j) {
+        const Robot::JointLimit limit = robot.getJointLimit(j);
+        distributions[j] = std::uniform_real_distribution<double>(limit.min, limit.max);
+    }
+    const int pointCount = 2000;
+    QList<Data::TrajectoryPoint> points;
+    int reachable = 0;
+    int approachReachable = 0;
+    for (int n = 0; n < pointCount; ++n) {
+        std::array<double, 6> degrees;
+        for (int j = 0; j < 6; ++j) {
+            degrees[j] = distributions[j](rng);
+        }
+        QVector3D position;
+        QMatrix3x3 rotation;
+        toolPose(robot, flangeToTool, degrees, position, rotation);
+        const QVector3D approach(rotation(0, 2), rotation(1, 2), rotation(2, 2));
+        reachable += loaded.isReachable(position) ? 1 : 0;
+        approachReachable += loaded.isReachable(position, approach) ? 1 : 0;
+        points.append(Data::TrajectoryPoint(n, position, QQuaternion::fromRotationMatrix(rotation)));
+    }
+    qDebug() << "随机构型TCP可达:" << reachable << "/" << pointCount << " 含接近方向:" << approachReachable;
+    check(reachable >= pointCount * 99 / 100, "随机构型的TCP至少99%落在可达体素中");
+    // 每个体素54个方向区间，小规模采样下方向覆盖不完整，只检查至少三分之一可达
+    check(approachReachable <= reachable && approachReachable >= pointCount / 3, "随机构型的接近方向至少三分之一可达");
+
+    const ReachabilityMap::PlacementScore score = loaded.evaluatePlacement(points);
+    check(score.pointCount == pointCount && score.reachableCount == reachable &&
+          score.orientationCount == approachReachable, "evaluatePlacement与逐点查询一致");
+    check(score.minManipulability <= score.meanManipulability && score.meanManipulability > 0.0,
+          "可操作度统计有效");
+    const ReachabilityMap::PlacementScore shifted = loaded.evaluatePlacement(points, QVector3D(outside, 0, 0));
+    check(shifted.reachableCount == 0 && shifted.reachableRatio() == 0.0, "平移到工作空间外后全部不可达");
+
+    if (g_failures > 0) {
+        qCritical() << "\n❌" << g_failures << "项检查失败";
+        return 1;
+    }
+    qDebug() << "\n✅ 全部通过";
+    return 0;
+}